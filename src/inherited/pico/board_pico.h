@@ -112,5 +112,14 @@
 
 	#define TEST_FAST_FREQ 300000 // target frequency
 
+	/****************************
+	 * Sample Config
+	****************************/
+
+	#define SAMPLE_BITS 12 // resolution of ADC samples
+	#define SAMPLE_MAX ((1 << SAMPLE_BITS) - 1) // largest ADC sample
+
+	typedef uint16_t sample_t; // storage type of ADC samples
+
 #endif
 #endif
\ No newline at end of file
@@ -0,0 +1,240 @@
+/*
+	board_pico_arena.c - arena and pool allocators for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "board_pico_arena.h"
+
+#include <stddef.h>
+
+#define POOL_FREE_TAG (uintptr_t)0x9e3779b9u // marks free blocks, mixed with pool address
+
+uint8_t boardArenaMemory[BOARD_ARENA_SIZE];
+
+struct arena boardArena = {
+	.base = boardArenaMemory,
+	.size = BOARD_ARENA_SIZE,
+	.bottom = 0u,
+	.top = BOARD_ARENA_SIZE,
+	.highWater = 0u,
+	.failures = 0u,
+};
+
+/**
+ * Checks alignment
+ * 
+ * @param align alignment to check, 0 becomes ARENA_ALIGN
+ * 
+ * @return alignment, 0 if not a power of 2
+ */
+static uint32_t arenaAlignment(uint32_t align) {
+	if (align == 0u) {
+		return ARENA_ALIGN;
+	}
+	return (align & (align - 1u)) == 0u ? align : 0u;
+}
+
+/**
+ * Updates high water mark
+ * 
+ * @param arena arena
+ */
+static void arenaUpdateHighWater(struct arena *arena) {
+	uint32_t used = arena->bottom + (arena->size - arena->top);
+	if (used > arena->highWater) {
+		arena->highWater = used;
+	}
+}
+
+bool arenaBegin(struct arena *arena, void *memory, uint32_t size) {
+
+	if (memory == NULL) {
+		return false;
+	}
+
+	arena->base = (uint8_t*)memory;
+	arena->size = size;
+	arena->bottom = 0u;
+	arena->top = size;
+	arena->highWater = 0u;
+	arena->failures = 0u;
+	return true;
+}
+
+void* arenaAlloc(struct arena *arena, uint32_t size, uint32_t align) {
+
+	align = arenaAlignment(align);
+	if (align == 0u) {
+		arena->failures++;
+		return NULL;
+	}
+
+	// aligns address, not offset, so base alignment doesn't matter
+	uintptr_t address = (uintptr_t)arena->base + arena->bottom;
+	uint32_t start = arena->bottom + (uint32_t)((align - (address & (align - 1u))) & (align - 1u));
+	if (start > arena->top || arena->top - start < size) {
+		arena->failures++;
+		return NULL;
+	}
+
+	arena->bottom = start + size;
+	arenaUpdateHighWater(arena);
+	return arena->base + start;
+}
+
+void* arenaAllocPersistent(struct arena *arena, uint32_t size, uint32_t align) {
+
+	align = arenaAlignment(align);
+	if (align == 0u || size > arena->top - arena->bottom) {
+		arena->failures++;
+		return NULL;
+	}
+
+	uintptr_t address = (uintptr_t)arena->base + arena->top - size;
+	uint32_t start = arena->top - size - (uint32_t)(address & (align - 1u));
+	if (start > arena->top || start < arena->bottom) {
+		arena->failures++;
+		return NULL;
+	}
+
+	arena->top = start;
+	arenaUpdateHighWater(arena);
+	return arena->base + start;
+}
+
+uint32_t arenaMark(const struct arena *arena) {
+	return arena->bottom;
+}
+
+void arenaRelease(struct arena *arena, uint32_t mark) {
+	if (mark < arena->bottom) {
+		arena->bottom = mark;
+	}
+}
+
+void arenaReset(struct arena *arena) {
+	arena->bottom = 0u;
+}
+
+uint32_t arenaFree(const struct arena *arena) {
+	return arena->top - arena->bottom;
+}
+
+/**
+ * Gets size blocks take up
+ * 
+ * @param blockSize bytes asked for
+ * 
+ * @return bytes rounded up to ARENA_ALIGN, at least next pointer and tag
+ */
+static uint32_t poolBlockSize(uint32_t blockSize) {
+	blockSize = (blockSize + ARENA_ALIGN - 1u) & ~(ARENA_ALIGN - 1u);
+	return blockSize < 2u * sizeof(void*) ? 2u * sizeof(void*) : blockSize;
+}
+
+/**
+ * Checks whether block is on free list
+ * 
+ * @param pool pool
+ * @param block block of pool
+ * 
+ * @return whether block is free
+ * 
+ * @note only walks the list when block carries the free tag
+ */
+static bool poolIsFree(const struct pool *pool, void **block) {
+
+	if ((uintptr_t)block[1] != ((uintptr_t)pool ^ POOL_FREE_TAG)) {
+		return false;
+	}
+
+	// data can match the tag by chance, the list says for sure
+	for (void **next = (void**)pool->freeList; next != NULL; next = (void**)*next) {
+		if (next == block) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool poolBegin(struct pool *pool, void *memory, uint32_t blockSize, uint32_t count) {
+
+	if (memory == NULL || ((uintptr_t)memory & (ARENA_ALIGN - 1u)) != 0u || count == 0u) {
+		return false;
+	}
+
+	blockSize = poolBlockSize(blockSize);
+
+	pool->base = (uint8_t*)memory;
+	pool->blockSize = blockSize;
+	pool->count = count;
+	pool->used = 0u;
+	pool->highWater = 0u;
+	pool->failures = 0u;
+	pool->badFrees = 0u;
+
+	pool->freeList = NULL;
+	for (uint32_t i = count; i > 0u; i--) {
+		void **block = (void**)(pool->base + (i - 1u) * blockSize);
+		block[0] = pool->freeList;
+		block[1] = (void*)((uintptr_t)pool ^ POOL_FREE_TAG);
+		pool->freeList = block;
+	}
+	return true;
+}
+
+bool poolBeginArena(struct pool *pool, struct arena *arena, uint32_t blockSize, uint32_t count) {
+
+	blockSize = poolBlockSize(blockSize);
+	if (count == 0u || blockSize > UINT32_MAX / count) {
+		return false;
+	}
+	return poolBegin(pool, arenaAlloc(arena, blockSize * count, ARENA_ALIGN), blockSize, count);
+}
+
+void* poolAlloc(struct pool *pool) {
+
+	void **block = (void**)pool->freeList;
+	if (block == NULL) {
+		pool->failures++;
+		return NULL;
+	}
+
+	pool->freeList = block[0];
+	block[1] = NULL;
+	pool->used++;
+	if (pool->used > pool->highWater) {
+		pool->highWater = pool->used;
+	}
+	return block;
+}
+
+bool poolFree(struct pool *pool, void *block) {
+
+	uintptr_t offset = (uintptr_t)block - (uintptr_t)pool->base;
+	if (block == NULL || (uintptr_t)block < (uintptr_t)pool->base ||
+		offset >= (uintptr_t)pool->blockSize * pool->count || offset % pool->blockSize != 0u ||
+		poolIsFree(pool, (void**)block)) {
+		pool->badFrees++;
+		return false;
+	}
+
+	((void**)block)[0] = pool->freeList;
+	((void**)block)[1] = (void*)((uintptr_t)pool ^ POOL_FREE_TAG);
+	pool->freeList = block;
+	pool->used--;
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+/*
+	board_pico_arena.h - arena and pool allocators for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_ARENA_H
+#define BOARD_PICO_ARENA_H
+
+#include "board_pico.h"
+#include "board_pico_serial.h"
+
+#include <hardware/flash.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Arena Config
+ * 
+ * Arena hands out memory from a fixed region instead of malloc:
+ * 	mode buffers grow up from the bottom and are freed all at
+ * 	once with arenaRelease or arenaReset when the mode changes
+ * 	persistent buffers grow down from the top and are never freed
+ * 
+ * Pools split memory into equal blocks for packets and frames,
+ * every call is O(1) and nothing locks, so give each core its own
+ * arena and pools or only touch them from one core
+ * 
+ * boardArena holds the NVM shadow and serial ring as persistent
+ * buffers of the modules built in, plus BOARD_ARENA_USER_SIZE
+ * bytes for capture and processing buffers
+****************************/
+
+#define ARENA_ALIGN 4u // default alignment of allocations
+
+#ifdef NVM_INTERNAL
+	#define ARENA_NVM_SIZE FLASH_SECTOR_SIZE // NVM sector shadow
+#else
+	#define ARENA_NVM_SIZE 0u
+#endif
+
+#ifndef PLATFORMIO
+	// ring is aligned to its size, worst case padding included
+	#define ARENA_SERIAL_SIZE (2u * SERIAL_TX_BUFFER_SIZE - ARENA_ALIGN)
+#else
+	#define ARENA_SERIAL_SIZE 0u
+#endif
+
+#ifndef BOARD_ARENA_USER_SIZE
+	#define BOARD_ARENA_USER_SIZE 8192u // bytes in boardArena left for the sketch
+#endif
+
+#ifndef BOARD_ARENA_SIZE
+	#define BOARD_ARENA_SIZE (ARENA_NVM_SIZE + ARENA_SERIAL_SIZE + BOARD_ARENA_USER_SIZE) // bytes in boardArena
+#endif
+
+struct arena {
+	uint8_t *base; // start of region
+	uint32_t size; // bytes in region
+	uint32_t bottom; // end of mode buffers
+	uint32_t top; // start of persistent buffers
+	uint32_t highWater; // most bytes ever in use
+	uint32_t failures; // allocations that didn't fit
+};
+
+struct pool {
+	uint8_t *base; // start of blocks
+	uint32_t blockSize; // bytes in each block
+	uint32_t count; // amount of blocks
+	void *freeList; // first free block, each free block points to the next
+	uint32_t used; // blocks handed out
+	uint32_t highWater; // most blocks ever handed out
+	uint32_t failures; // allocations with no free block
+	uint32_t badFrees; // frees of blocks not handed out by pool
+};
+
+extern struct arena boardArena; // arena shared by the library and sketch
+
+/**
+ * Sets up arena over region
+ * 
+ * @param arena arena to set up
+ * @param memory region handed out by arena
+ * @param size bytes in region
+ * 
+ * @return whether arena was set up
+ */
+bool arenaBegin(struct arena *arena, void *memory, uint32_t size);
+
+/**
+ * Allocates mode buffer
+ * 
+ * @param arena arena
+ * @param size amount of bytes
+ * @param align alignment (power of 2), 0 for ARENA_ALIGN
+ * 
+ * @return buffer, NULL if it doesn't fit
+ */
+void* arenaAlloc(struct arena *arena, uint32_t size, uint32_t align);
+
+/**
+ * Allocates buffer that is never freed
+ * 
+ * @param arena arena
+ * @param size amount of bytes
+ * @param align alignment (power of 2), 0 for ARENA_ALIGN
+ * 
+ * @return buffer, NULL if it doesn't fit
+ */
+void* arenaAllocPersistent(struct arena *arena, uint32_t size, uint32_t align);
+
+/**
+ * Marks current mode buffers
+ * 
+ * @param arena arena
+ * 
+ * @return mark to pass to arenaRelease
+ */
+uint32_t arenaMark(const struct arena *arena);
+
+/**
+ * Frees every mode buffer allocated since mark
+ * 
+ * @param arena arena
+ * @param mark mark from arenaMark
+ */
+void arenaRelease(struct arena *arena, uint32_t mark);
+
+/**
+ * Frees every mode buffer
+ * 
+ * @param arena arena
+ */
+void arenaReset(struct arena *arena);
+
+/**
+ * Gets bytes left between mode and persistent buffers
+ * 
+ * @param arena arena
+ * 
+ * @return amount of free bytes
+ */
+uint32_t arenaFree(const struct arena *arena);
+
+/**
+ * Sets up pool over memory
+ * 
+ * @param pool pool to set up
+ * @param memory blocks, 4 byte aligned
+ * @param blockSize bytes in each block, rounded up to 4
+ * @param count amount of blocks
+ * 
+ * @return whether pool was set up
+ * 
+ * @note blocks are at least two pointers, free ones hold the free list and a tag
+ */
+bool poolBegin(struct pool *pool, void *memory, uint32_t blockSize, uint32_t count);
+
+/**
+ * Sets up pool with blocks from arena
+ * 
+ * @param pool pool to set up
+ * @param arena arena blocks come from as a mode buffer
+ * @param blockSize bytes in each block, rounded up to 4
+ * @param count amount of blocks
+ * 
+ * @return whether pool was set up
+ */
+bool poolBeginArena(struct pool *pool, struct arena *arena, uint32_t blockSize, uint32_t count);
+
+/**
+ * Gets free block
+ * 
+ * @param pool pool
+ * 
+ * @return block, NULL if none are free
+ */
+void* poolAlloc(struct pool *pool);
+
+/**
+ * Returns block to pool
+ * 
+ * @param pool pool block came from
+ * @param block block to free
+ * 
+ * @return whether block was handed out by pool and not already freed
+ */
+bool poolFree(struct pool *pool, void *block);
+
+#endif
\ No newline at end of file
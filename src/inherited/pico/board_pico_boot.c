@@ -0,0 +1,231 @@
+/*
+	board_pico_boot.c - boot sequencer for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <hardware/sync.h>
+#include <hardware/timer.h>
+
+#include "board_pico_boot.h"
+#include "board_pico_threads.h"
+
+#include <stddef.h>
+#include <string.h>
+
+struct bootStage bootStages[BOOT_STAGES_MAX];
+uint8_t bootStageCount = 0u;
+uint32_t bootStartUS = 0u; // time first bootRun started
+uint32_t bootReadyUS = 0u; // time device was marked ready
+bool bootStarted = false; // first bootRun has been called
+
+void __attribute__((weak)) bootUserStages(void) {
+}
+
+uint8_t bootAddStage(const char *name, boot_stage_t function, void *param, uint32_t depends, enum BootCore core) {
+
+	if (function == NULL || bootStageCount >= BOOT_STAGES_MAX) {
+		return BOOT_STAGE_INVALID;
+	}
+
+	struct bootStage *stage = &bootStages[bootStageCount];
+	stage->name = name;
+	stage->function = function;
+	stage->param = param;
+	stage->depends = depends;
+	stage->core = (uint8_t)core;
+	stage->status = BOOT_PENDING;
+	stage->readyUS = 0u;
+	stage->startUS = 0u;
+	stage->endUS = 0u;
+	return bootStageCount++;
+}
+
+uint8_t bootFindStage(const char *name) {
+	for (uint8_t i = 0; i < bootStageCount; i++) {
+		if (bootStages[i].name != NULL && name != NULL && strcmp(bootStages[i].name, name) == 0) {
+			return i;
+		}
+	}
+	return BOOT_STAGE_INVALID;
+}
+
+/**
+ * Runs stage and records its times
+ * 
+ * @param param pointer to struct bootStage
+ * 
+ * @note runs on core 1 for core 1 stages, wakes core 0 once done
+ */
+void bootRunStage(void *param) {
+
+	struct bootStage *stage = (struct bootStage*)param;
+
+	stage->startUS = time_us_32();
+	bool result = stage->function(stage->param);
+	stage->endUS = time_us_32();
+
+	// times are visible before status
+	__dmb();
+	stage->status = result ? BOOT_DONE : BOOT_FAILED;
+	__sev();
+}
+
+/**
+ * Gets stages that finished successfully
+ * 
+ * @param finished pointer to bits of stages that ended any way
+ * 
+ * @return bits of stages that succeeded
+ */
+static uint32_t bootDoneStages(uint32_t *finished) {
+
+	uint32_t done = 0u;
+	*finished = 0u;
+	for (uint8_t i = 0; i < bootStageCount; i++) {
+		uint8_t status = bootStages[i].status;
+		if (status == BOOT_DONE) {
+			done |= 1u << i;
+		}
+		if (status >= BOOT_DONE) {
+			*finished |= 1u << i;
+		}
+	}
+	return done;
+}
+
+bool bootRun(void) {
+
+	if (!bootStarted) {
+		bootStarted = true;
+		bootStartUS = time_us_32();
+		bootUserStages();
+	}
+
+	while (true) {
+
+		uint32_t finished;
+		uint32_t done = bootDoneStages(&finished);
+		bool running = false;
+		bool progressed = false;
+		struct bootStage *local = NULL;
+
+		for (uint8_t i = 0; i < bootStageCount; i++) {
+
+			struct bootStage *stage = &bootStages[i];
+			if (stage->status == BOOT_RUNNING) {
+				running = true;
+				continue;
+			}
+			if (stage->status != BOOT_PENDING) {
+				continue;
+			}
+
+			// a failed dependency can't be made up for
+			if ((stage->depends & finished & ~done) != 0u) {
+				stage->status = BOOT_SKIPPED;
+				progressed = true;
+				continue;
+			}
+			if ((stage->depends & done) != stage->depends) {
+				continue;
+			}
+
+			if (stage->readyUS == 0u) {
+				stage->readyUS = time_us_32();
+			}
+			stage->status = BOOT_RUNNING;
+			progressed = true;
+
+			if (stage->core == BOOT_CORE1 && (core1Started() || core1Begin()) && core1Queue(bootRunStage, stage)) {
+				running = true;
+				continue;
+			}
+
+			// core 1 stages are all queued before core 0 starts one
+			if (local == NULL) {
+				local = stage;
+			}
+			else {
+				stage->status = BOOT_PENDING;
+			}
+		}
+
+		if (local != NULL) {
+			bootRunStage(local);
+			continue;
+		}
+		if (running) {
+			__wfe();
+			continue;
+		}
+		if (!progressed) {
+			// core 1 stage may have finished since snapshot
+			uint32_t after;
+			bootDoneStages(&after);
+			if (after == finished) {
+				break;
+			}
+		}
+	}
+
+	// anything left waits on a stage that doesn't exist or on itself
+	bool result = true;
+	for (uint8_t i = 0; i < bootStageCount; i++) {
+		if (bootStages[i].status == BOOT_PENDING) {
+			bootStages[i].status = BOOT_SKIPPED;
+		}
+		if (bootStages[i].status != BOOT_DONE) {
+			result = false;
+		}
+	}
+	return result;
+}
+
+const struct bootStage* bootGetStage(uint8_t stage) {
+	if (stage >= bootStageCount) {
+		return NULL;
+	}
+	return &bootStages[stage];
+}
+
+void bootMarkReady(void) {
+	if (bootReadyUS == 0u) {
+		bootReadyUS = time_us_32();
+	}
+}
+
+void bootGetSummary(struct bootSummary *summary) {
+
+	summary->startUS = bootStartUS;
+	summary->endUS = bootStartUS;
+	summary->serialUS = 0u;
+	summary->readyUS = bootReadyUS;
+	summary->stages = bootStageCount;
+	summary->failed = 0u;
+
+	for (uint8_t i = 0; i < bootStageCount; i++) {
+		const struct bootStage *stage = &bootStages[i];
+		if (stage->status == BOOT_DONE || stage->status == BOOT_FAILED) {
+			summary->serialUS += stage->endUS - stage->startUS;
+			if ((int32_t)(stage->endUS - summary->endUS) > 0) {
+				summary->endUS = stage->endUS;
+			}
+		}
+		if (stage->status == BOOT_FAILED || stage->status == BOOT_SKIPPED) {
+			summary->failed++;
+		}
+	}
+}
\ No newline at end of file
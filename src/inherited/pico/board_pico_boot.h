@@ -0,0 +1,141 @@
+/*
+	board_pico_boot.h - boot sequencer for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_BOOT_H
+#define BOARD_PICO_BOOT_H
+
+#include "board_pico.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Boot Config
+ * 
+ * Init stages form a dependency graph, a stage runs once
+ * every stage it depends on is done, slow stages are queued
+ * to core 1 so core 0 keeps running the rest meanwhile
+ * 
+ * Every stage keeps its timestamps so boot can
+ * be measured after the fact
+****************************/
+
+#define BOOT_STAGES_MAX 16u // stages in graph
+#define BOOT_STAGE_INVALID BOOT_STAGES_MAX // stage that doesn't exist
+
+#define BOOT_DEPENDS(stage) (((stage) < BOOT_STAGES_MAX) ? (1u << (stage)) : 0u) // dependency bit of stage
+
+typedef bool (*boot_stage_t)(void *param); // returns whether stage succeeded
+
+enum BootCore {
+	BOOT_CORE0, // runs on core 0
+	BOOT_CORE1, // queued to core 1
+};
+
+enum BootStatus {
+	BOOT_PENDING, // waiting on dependencies
+	BOOT_RUNNING, // running
+	BOOT_DONE, // succeeded
+	BOOT_FAILED, // returned false
+	BOOT_SKIPPED, // dependency failed or can never finish
+};
+
+struct bootStage {
+	const char *name; // stage name
+	boot_stage_t function; // stage to run
+	void *param; // passed to function
+	uint32_t depends; // BOOT_DEPENDS bits of stages that finish first
+	uint8_t core; // enum BootCore stage runs on
+	volatile uint8_t status; // enum BootStatus
+	uint32_t readyUS; // time dependencies finished in us since boot
+	uint32_t startUS; // time stage started in us since boot
+	volatile uint32_t endUS; // time stage ended in us since boot
+};
+
+struct bootSummary {
+	uint32_t startUS; // time first bootRun started
+	uint32_t endUS; // time last stage ended
+	uint32_t serialUS; // time stages took added up, boot time if run one after another
+	uint32_t readyUS; // time bootMarkReady was called, 0 if not yet
+	uint8_t stages; // stages in graph
+	uint8_t failed; // stages failed or skipped
+};
+
+/**
+ * Adds stage to graph
+ * 
+ * @param name stage name
+ * @param function stage to run
+ * @param param passed to function
+ * @param depends BOOT_DEPENDS bits of stages that finish first
+ * @param core core stage runs on
+ * 
+ * @return stage number, BOOT_STAGE_INVALID if graph is full
+ * 
+ * @note core 1 stages run on core 0 if core 1 can't be launched
+ */
+uint8_t bootAddStage(const char *name, boot_stage_t function, void *param, uint32_t depends, enum BootCore core);
+
+/**
+ * Finds stage by name
+ * 
+ * @param name stage name
+ * 
+ * @return stage number, BOOT_STAGE_INVALID if not found
+ */
+uint8_t bootFindStage(const char *name);
+
+/**
+ * Adds application stages to first bootRun
+ * 
+ * @note weak, define to add stages that run alongside board stages
+ */
+void bootUserStages(void);
+
+/**
+ * Runs every pending stage
+ * 
+ * @return whether every stage succeeded
+ * 
+ * @note can be called again after adding more stages
+ * @warning only call from core 0
+ */
+bool bootRun(void);
+
+/**
+ * Gets stage
+ * 
+ * @param stage stage number
+ * 
+ * @return stage, NULL if it doesn't exist
+ */
+const struct bootStage* bootGetStage(uint8_t stage);
+
+/**
+ * Marks device ready, such as first capture landing
+ */
+void bootMarkReady(void);
+
+/**
+ * Gets boot timing
+ * 
+ * @param summary pointer to summary
+ */
+void bootGetSummary(struct bootSummary *summary);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,224 @@
+/*
+	board_pico_calibration.c - ADC calibration for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "board_pico_calibration.h"
+#include "board_pico_nvm.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define CALIBRATION_MAGIC 0x43414C31u // "CAL1"
+#define CALIBRATION_VERSION 1u
+
+#define OFFSET_ROUND (1 << 15) // half of output LSB in Q16
+#define CODE_FIRST 1u // lowest code used for INL, 0 saturates
+#define CODE_LAST ((uint32_t)SAMPLE_MAX - 1u) // highest code used for INL, max saturates
+#define CODE_COUNT (CODE_LAST - CODE_FIRST + 1u)
+
+struct storedCalibration {
+	uint32_t magic; // marks valid calibration
+	uint16_t version; // layout version
+	uint16_t checksum; // fletcher 16 of calibration
+	struct adcCalibration cal; // calibration values
+};
+
+struct adcCalibration boardCalibration;
+
+_Static_assert(sizeof(struct storedCalibration) <= NVM_RESERVED_CALIBRATION_SIZE, "calibration doesn't fit reserved NVM");
+
+/**
+ * Fletcher 16 checksum
+ * 
+ * @param data data to check
+ * @param length amount of bytes
+ * 
+ * @return checksum
+ */
+static uint16_t fletcher16(const uint8_t *data, uint32_t length) {
+	uint32_t sumA = 0u;
+	uint32_t sumB = 0u;
+	for (uint32_t i = 0; i < length; i++) {
+		sumA = (sumA + data[i]) % 255u;
+		sumB = (sumB + sumA) % 255u;
+	}
+	return (uint16_t)((sumB << 8) | sumA);
+}
+
+/**
+ * Averages INL corrected samples
+ * 
+ * @param channel channel calibration
+ * @param samples samples to average
+ * @param count amount of samples
+ * 
+ * @return average in 1/4 LSB
+ */
+static int32_t averageQ2(const struct adcChannelCalibration *channel, const sample_t *samples, uint32_t count) {
+	int64_t sum = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t raw = samples[i] & SAMPLE_MAX;
+		sum += (int32_t)(raw << 2) + channel->inl[raw >> CALIBRATION_INL_SHIFT];
+	}
+	return (int32_t)((sum + (count >> 1)) / count);
+}
+
+void calibrationDefaults(struct adcCalibration *cal) {
+	for (uint8_t channel = 0; channel < CALIBRATION_CHANNELS; channel++) {
+		cal->channels[channel].gain = CALIBRATION_GAIN_ONE;
+		cal->channels[channel].offset = OFFSET_ROUND;
+		memset(cal->channels[channel].inl, 0, sizeof(cal->channels[channel].inl));
+	}
+}
+
+enum CalibrationStatus calibrationMeasureGain(struct adcCalibration *cal, uint8_t channel,
+	const sample_t *lowSamples, uint32_t lowCount, sample_t lowExpected,
+	const sample_t *highSamples, uint32_t highCount, sample_t highExpected) {
+
+	if (channel >= CALIBRATION_CHANNELS) {
+		return CALIBRATION_BAD_CHANNEL;
+	}
+	if (lowSamples == NULL || highSamples == NULL || lowCount == 0u || highCount == 0u) {
+		return CALIBRATION_NO_SAMPLES;
+	}
+
+	struct adcChannelCalibration *channelCal = &cal->channels[channel];
+	int32_t lowMeasured = averageQ2(channelCal, lowSamples, lowCount);
+	int32_t highMeasured = averageQ2(channelCal, highSamples, highCount);
+
+	if (highMeasured <= lowMeasured || highExpected <= lowExpected) {
+		return CALIBRATION_BAD_POINTS;
+	}
+
+	// Q2 input to Q16 output needs 2 ^ 14 scale for gain of 1
+	int32_t span = highMeasured - lowMeasured;
+	uint32_t gain = ((((uint32_t)highExpected - lowExpected) << 16) + ((uint32_t)span >> 1)) / (uint32_t)span;
+	if (gain > UINT16_MAX) {
+		return CALIBRATION_BAD_POINTS;
+	}
+
+	channelCal->gain = (uint16_t)gain;
+	channelCal->offset = ((int32_t)lowExpected << 16) - lowMeasured * (int32_t)gain + OFFSET_ROUND;
+
+	return CALIBRATION_OK;
+}
+
+enum CalibrationStatus calibrationMeasureINL(struct adcCalibration *cal, uint8_t channel, const uint16_t *histogram) {
+
+	if (channel >= CALIBRATION_CHANNELS) {
+		return CALIBRATION_BAD_CHANNEL;
+	}
+	if (histogram == NULL) {
+		return CALIBRATION_NO_SAMPLES;
+	}
+
+	uint64_t total = 0u;
+	for (uint32_t code = CODE_FIRST; code <= CODE_LAST; code++) {
+		total += histogram[code];
+	}
+	if (total == 0u) {
+		return CALIBRATION_NO_SAMPLES;
+	}
+
+	int8_t *inl = cal->channels[channel].inl;
+	uint64_t below = 0u; // hits of codes below current code
+	int64_t segmentSum = 0;
+	uint32_t segmentCodes = 0u;
+
+	for (uint32_t code = CODE_FIRST; code <= CODE_LAST; code++) {
+
+		// center of code along ramp in 1/4 LSB, ideal histogram puts it at code * 4
+		int64_t center = 2 + (int64_t)(((2u * below + histogram[code]) * 2u * CODE_COUNT + (total >> 1)) / total);
+		segmentSum += center - (int64_t)code * CALIBRATION_INL_SCALE;
+		segmentCodes++;
+		below += histogram[code];
+
+		uint32_t segment = code >> CALIBRATION_INL_SHIFT;
+		if (code == CODE_LAST || ((code + 1u) >> CALIBRATION_INL_SHIFT) != segment) {
+			int64_t correction = segmentSum / (int64_t)segmentCodes;
+			if (correction > INT8_MAX) {
+				correction = INT8_MAX;
+			}
+			else if (correction < INT8_MIN) {
+				correction = INT8_MIN;
+			}
+			inl[segment] = (int8_t)correction;
+			segmentSum = 0;
+			segmentCodes = 0u;
+		}
+	}
+
+	return CALIBRATION_OK;
+}
+
+void RUN_IN_RAM(calibrationApply) calibrationApply(const struct adcCalibration *cal, uint8_t channel, sample_t *samples, uint32_t count) {
+
+	if (channel >= CALIBRATION_CHANNELS) {
+		return;
+	}
+
+	const struct adcChannelCalibration *channelCal = &cal->channels[channel];
+	const int8_t *inl = channelCal->inl;
+	const int32_t gain = channelCal->gain;
+	const int32_t offset = channelCal->offset;
+
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t raw = samples[i] & SAMPLE_MAX;
+		int32_t value = (((int32_t)(raw << 2) + inl[raw >> CALIBRATION_INL_SHIFT]) * gain + offset) >> 16;
+		if (value < 0) {
+			value = 0;
+		}
+		else if (value > SAMPLE_MAX) {
+			value = SAMPLE_MAX;
+		}
+		samples[i] = (sample_t)value;
+	}
+}
+
+enum CalibrationStatus calibrationSave(const struct adcCalibration *cal) {
+
+	struct storedCalibration stored;
+	memset(&stored, 0, sizeof(stored));
+	stored.magic = CALIBRATION_MAGIC;
+	stored.version = CALIBRATION_VERSION;
+	stored.cal = *cal;
+	stored.checksum = fletcher16((const uint8_t*)&stored.cal, sizeof(stored.cal));
+
+	if (!nvmWriteReserved(NVM_RESERVED_CALIBRATION, &stored, sizeof(stored))) {
+		return CALIBRATION_NVM_FAIL;
+	}
+	return CALIBRATION_OK;
+}
+
+enum CalibrationStatus calibrationLoad(struct adcCalibration *cal) {
+
+	struct storedCalibration stored;
+
+	if (!nvmGetReserved(NVM_RESERVED_CALIBRATION, &stored, sizeof(stored))) {
+		calibrationDefaults(cal);
+		return CALIBRATION_NVM_FAIL;
+	}
+
+	if (stored.magic != CALIBRATION_MAGIC || stored.version != CALIBRATION_VERSION ||
+		stored.checksum != fletcher16((const uint8_t*)&stored.cal, sizeof(stored.cal))) {
+		calibrationDefaults(cal);
+		return CALIBRATION_NVM_EMPTY;
+	}
+
+	*cal = stored.cal;
+	return CALIBRATION_OK;
+}
\ No newline at end of file
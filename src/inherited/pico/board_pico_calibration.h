@@ -0,0 +1,141 @@
+/*
+	board_pico_calibration.h - ADC calibration for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_CALIBRATION_H
+#define BOARD_PICO_CALIBRATION_H
+
+#include "board_pico.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Calibration Config
+ * 
+ * corrected = ((raw * 4 + inl[raw >> 7]) * gain + offset) >> 16
+ * 
+ * inl is in 1/4 LSB, gain is Q14 and
+ * offset is Q16 (includes rounding)
+ * 
+ * Code density gives DNL of each code, the table keeps
+ * INL (running sum of DNL) averaged over each segment of
+ * codes, which corrects bowing and the large RP2040 steps
+ * at segment edges but not DNL of single codes
+****************************/
+
+#ifndef CALIBRATION_CHANNELS
+	#define CALIBRATION_CHANNELS 3 // ADC channels with calibration
+#endif
+
+#define CALIBRATION_INL_SHIFT 7 // codes per INL segment = 1 << shift
+#define CALIBRATION_INL_SEGMENTS ((SAMPLE_MAX + 1) >> CALIBRATION_INL_SHIFT) // entries in INL table
+#define CALIBRATION_GAIN_ONE (1 << 14) // gain of 1.0
+#define CALIBRATION_INL_SCALE 4 // INL entries per LSB
+
+struct adcChannelCalibration {
+	int32_t offset; // Q16 offset added after gain
+	uint16_t gain; // Q14 gain
+	int8_t inl[CALIBRATION_INL_SEGMENTS]; // average INL of each code segment in 1/4 LSB
+};
+
+struct adcCalibration {
+	struct adcChannelCalibration channels[CALIBRATION_CHANNELS]; // calibration of each channel
+};
+
+extern struct adcCalibration boardCalibration; // calibration loaded at boot
+
+enum CalibrationStatus {
+	CALIBRATION_OK, // calibration updated
+	CALIBRATION_NO_SAMPLES, // no samples given
+	CALIBRATION_BAD_POINTS, // reference points are too close
+	CALIBRATION_BAD_CHANNEL, // channel doesn't exist
+	CALIBRATION_NVM_FAIL, // unable to read or write NVM
+	CALIBRATION_NVM_EMPTY, // NVM has no valid calibration
+};
+
+/**
+ * Sets calibration to pass samples through unchanged
+ * 
+ * @param cal calibration to reset
+ */
+void calibrationDefaults(struct adcCalibration *cal);
+
+/**
+ * Measures offset and gain from two known inputs
+ * 
+ * @param cal calibration to update
+ * @param channel ADC channel
+ * @param lowSamples samples taken with low reference applied
+ * @param lowCount amount of low samples
+ * @param lowExpected ideal code of low reference
+ * @param highSamples samples taken with high reference applied
+ * @param highCount amount of high samples
+ * @param highExpected ideal code of high reference
+ * 
+ * @return result of calibration
+ * 
+ * @note INL table is applied while averaging, so measure INL first
+ */
+enum CalibrationStatus calibrationMeasureGain(struct adcCalibration *cal, uint8_t channel,
+	const sample_t *lowSamples, uint32_t lowCount, sample_t lowExpected,
+	const sample_t *highSamples, uint32_t highCount, sample_t highExpected);
+
+/**
+ * Builds averaged INL table from code density test
+ * 
+ * @param cal calibration to update
+ * @param channel ADC channel
+ * @param histogram hits of each code while sampling a slow full scale ramp or triangle
+ * 
+ * @return result of calibration
+ */
+enum CalibrationStatus calibrationMeasureINL(struct adcCalibration *cal, uint8_t channel, const uint16_t *histogram);
+
+/**
+ * Corrects samples in place
+ * 
+ * @param cal calibration
+ * @param channel ADC channel samples came from
+ * @param samples samples to correct
+ * @param count amount of samples
+ * 
+ * @note single fused pass, meant to run as each DMA buffer completes
+ */
+void calibrationApply(const struct adcCalibration *cal, uint8_t channel, sample_t *samples, uint32_t count);
+
+/**
+ * Writes calibration to NVM
+ * 
+ * @param cal calibration to save
+ * 
+ * @return result of saving
+ */
+enum CalibrationStatus calibrationSave(const struct adcCalibration *cal);
+
+/**
+ * Gets calibration from NVM
+ * 
+ * @param cal pointer to calibration
+ * 
+ * @return result of loading
+ * 
+ * @note cal is set to defaults if NVM has no valid calibration
+ */
+enum CalibrationStatus calibrationLoad(struct adcCalibration *cal);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,386 @@
+/*
+	board_pico_clock.c - clock configuration for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+
+#include <hardware/adc.h>
+#include <hardware/clocks.h>
+#include <hardware/pio.h>
+#include <hardware/structs/ssi.h>
+#include <hardware/vreg.h>
+#include <pico/stdlib.h>
+
+#include "board_pico_clock.h"
+#include "board_pico_nvm.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define CLOCK_MAGIC 0x434C4B31u // "CLK1"
+#define CLOCK_VERSION 1u
+#define KHZ 1000u
+#define PIO_BLOCKS 2u
+#define PIO_STATE_MACHINES 4u
+#define CLOCK_DIV_ONE (1u << CLOCK_DIV_FRAC_BITS)
+
+struct storedClock {
+	uint32_t magic; // marks valid profile
+	uint16_t version; // layout of profile
+	uint16_t checksum; // sum of profile words
+	struct clockProfile profile; // clock profile
+};
+
+_Static_assert(sizeof(struct storedClock) <= NVM_RESERVED_CLOCK_SIZE, "clock profile doesn't fit reserved NVM");
+
+_Static_assert(CLOCK_SYS_MAX_KHZ <= CLOCK_SYS_LIMIT_KHZ, "clk_sys above CLOCK_SYS_LIMIT_KHZ has no core voltage step");
+
+struct clockVoltageStep {
+	uint32_t maxKHz; // fastest clk_sys at voltage
+	enum vreg_voltage voltage; // core voltage
+};
+
+const struct clockVoltageStep clockVoltageSteps[] = {
+	{CLOCK_SYS_RATED_KHZ, VREG_VOLTAGE_DEFAULT},
+	{200000u, VREG_VOLTAGE_1_15},
+	{250000u, VREG_VOLTAGE_1_20},
+	{CLOCK_SYS_LIMIT_KHZ, VREG_VOLTAGE_1_30},
+};
+
+struct clockPIORate {
+	uint8_t pio; // PIO block number
+	uint8_t sm; // state machine
+	uint32_t hz; // state machine clock
+};
+
+struct clockProfile clockCurrent = {
+	.sysKHz = CLOCK_DEFAULT_SYS_KHZ,
+	.periSource = CLOCK_SOURCE_SYS,
+	.adcSource = CLOCK_SOURCE_USB,
+	.reserved = 0u,
+};
+
+clock_listener_t clockListeners[CLOCK_LISTENERS_MAX];
+uint8_t clockListenerCount = 0u;
+
+struct clockPIORate clockPIORates[CLOCK_PIO_MAX];
+uint8_t clockPIORateCount = 0u;
+
+uint32_t clockNSFactor = CLOCK_NS_FACTOR(CLOCK_DEFAULT_SYS_KHZ * KHZ);
+
+enum vreg_voltage clockVoltageNow = VREG_VOLTAGE_DEFAULT; // core voltage last set
+uint32_t clockFlashDivNow = CLOCK_FLASH_DIV_DEFAULT; // flash SCK divider last set
+
+uint32_t clockADCSampleRate = 0u; // sample rate kept by clockSetADCRate
+bool clockADCRateSet = false;
+
+/**
+ * Checksum of stored profile
+ * 
+ * @param profile profile to check
+ * 
+ * @return checksum
+ */
+static uint16_t clockChecksum(const struct clockProfile *profile) {
+	uint32_t sum = profile->sysKHz + profile->periSource + ((uint32_t)profile->adcSource << 8);
+	return (uint16_t)(sum ^ (sum >> 16) ^ CLOCK_MAGIC);
+}
+
+uint32_t clockADCDivider(uint32_t adcHz, uint32_t sampleRate) {
+
+	if (sampleRate == 0u) {
+		return 0u;
+	}
+
+	// conversion takes 1 + divider cycles but never less than 96
+	uint64_t divider = (((uint64_t)adcHz << CLOCK_DIV_FRAC_BITS) + (sampleRate >> 1)) / sampleRate;
+	if (divider < (uint64_t)CLOCK_ADC_MIN_CYCLES << CLOCK_DIV_FRAC_BITS) {
+		return 0u;
+	}
+	divider -= CLOCK_DIV_ONE;
+	if (divider > CLOCK_PIO_DIV_MAX) {
+		divider = CLOCK_PIO_DIV_MAX;
+	}
+	return (uint32_t)divider;
+}
+
+uint32_t clockADCRate(uint32_t adcHz, uint32_t divider) {
+	if (divider == 0u) {
+		return (adcHz + (CLOCK_ADC_MIN_CYCLES >> 1)) / CLOCK_ADC_MIN_CYCLES;
+	}
+	uint64_t cycles = (uint64_t)divider + CLOCK_DIV_ONE;
+	return (uint32_t)((((uint64_t)adcHz << CLOCK_DIV_FRAC_BITS) + (cycles >> 1)) / cycles);
+}
+
+uint32_t clockPIODivider(uint32_t sysHz, uint32_t hz) {
+
+	if (hz == 0u || hz >= sysHz) {
+		return CLOCK_DIV_ONE;
+	}
+
+	uint64_t divider = (((uint64_t)sysHz << CLOCK_DIV_FRAC_BITS) + (hz >> 1)) / hz;
+	if (divider > CLOCK_PIO_DIV_MAX) {
+		divider = CLOCK_PIO_DIV_MAX;
+	}
+	return (uint32_t)divider;
+}
+
+uint32_t clockADCSourceDivider(uint32_t sysHz) {
+	const uint32_t maxHz = CLOCK_ADC_MAX_KHZ * KHZ;
+	return (sysHz + maxHz - 1u) / maxHz;
+}
+
+enum vreg_voltage clockVoltage(uint32_t sysKHz) {
+	const uint8_t steps = sizeof(clockVoltageSteps) / sizeof(clockVoltageSteps[0]);
+	for (uint8_t i = 0; i < steps; i++) {
+		if (sysKHz <= clockVoltageSteps[i].maxKHz) {
+			return clockVoltageSteps[i].voltage;
+		}
+	}
+	return clockVoltageSteps[steps - 1u].voltage;
+}
+
+uint32_t clockFlashDivider(uint32_t sysHz) {
+	const uint32_t maxHz = CLOCK_FLASH_MAX_KHZ * KHZ;
+	uint32_t divider = (sysHz + maxHz - 1u) / maxHz;
+	// SSI ignores lowest bit
+	divider += divider & 1u;
+	return divider < CLOCK_FLASH_DIV_DEFAULT ? CLOCK_FLASH_DIV_DEFAULT : divider;
+}
+
+/**
+ * Sets core voltage, waiting for it to settle when raised
+ * 
+ * @param voltage core voltage
+ */
+static void clockSetVoltage(enum vreg_voltage voltage) {
+	if (voltage == clockVoltageNow) {
+		return;
+	}
+	vreg_set_voltage(voltage);
+	if (voltage > clockVoltageNow) {
+		busy_wait_us(CLOCK_VREG_SETTLE_US);
+	}
+	clockVoltageNow = voltage;
+}
+
+/**
+ * Sets flash SCK divider
+ * 
+ * @param divider even divider of clk_sys
+ * 
+ * @note XIP stops while SSI is disabled, so this runs from RAM with
+ * @note interrupts masked and core 1 paused
+ */
+static void RUN_IN_RAM(clockSetFlashDivider) clockSetFlashDivider(uint32_t divider) {
+
+	if (divider == clockFlashDivNow) {
+		return;
+	}
+
+	startThreadSafety();
+	ssi_hw->ssienr = 0u;
+	ssi_hw->baudr = divider;
+	ssi_hw->ssienr = 1u;
+	endThreadSafety();
+	clockFlashDivNow = divider;
+}
+
+void clockDefaults(struct clockProfile *profile) {
+	profile->sysKHz = CLOCK_DEFAULT_SYS_KHZ;
+	profile->periSource = CLOCK_SOURCE_SYS;
+	profile->adcSource = CLOCK_SOURCE_USB;
+	profile->reserved = 0u;
+}
+
+/**
+ * Writes ADC divider for kept sample rate
+ */
+void clockUpdateADC(void) {
+	if (clockADCRateSet) {
+		adc_hw->div = clockADCDivider(clock_get_hz(clk_adc), clockADCSampleRate);
+	}
+}
+
+/**
+ * Writes PIO dividers for kept state machine clocks
+ */
+void clockUpdatePIO(void) {
+	const uint32_t sysHz = clock_get_hz(clk_sys);
+	for (uint8_t i = 0; i < clockPIORateCount; i++) {
+		uint32_t divider = clockPIODivider(sysHz, clockPIORates[i].hz);
+		PIO pio = clockPIORates[i].pio == 0u ? pio0 : pio1;
+		pio_sm_set_clkdiv_int_frac(pio, clockPIORates[i].sm,
+			(uint16_t)(divider >> CLOCK_DIV_FRAC_BITS), (uint8_t)divider);
+	}
+}
+
+enum ClockStatus clockApply(const struct clockProfile *profile) {
+
+	uint32_t vco;
+	uint32_t postDiv1;
+	uint32_t postDiv2;
+
+	if (profile->sysKHz < CLOCK_SYS_MIN_KHZ || profile->sysKHz > CLOCK_SYS_MAX_KHZ ||
+		!check_sys_clock_khz(profile->sysKHz, &vco, &postDiv1, &postDiv2)) {
+		return CLOCK_BAD_FREQ;
+	}
+	if (get_core_num() != 0u) {
+		return CLOCK_BAD_CORE;
+	}
+
+	const uint32_t sysHz = profile->sysKHz * KHZ;
+	const enum vreg_voltage voltage = clockVoltage(profile->sysKHz);
+	const uint32_t flashDiv = clockFlashDivider(sysHz);
+
+	// core and flash are ready for the faster clock before PLL switches
+	if (voltage > clockVoltageNow) {
+		clockSetVoltage(voltage);
+	}
+	if (flashDiv > clockFlashDivNow) {
+		clockSetFlashDivider(flashDiv);
+	}
+
+	// also moves clk_peri to clk_sys
+	set_sys_clock_pll(vco, postDiv1, postDiv2);
+
+	// and only slow down once it has
+	clockSetFlashDivider(flashDiv);
+	clockSetVoltage(voltage);
+
+	const uint32_t usbHz = CLOCK_USB_KHZ * KHZ;
+
+	if (profile->periSource == CLOCK_SOURCE_USB) {
+		clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB, usbHz, usbHz);
+	}
+
+	if (profile->adcSource == CLOCK_SOURCE_SYS) {
+		clock_configure(clk_adc, 0, CLOCKS_CLK_ADC_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS,
+			sysHz, sysHz / clockADCSourceDivider(sysHz));
+	}
+	else {
+		clock_configure(clk_adc, 0, CLOCKS_CLK_ADC_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB, usbHz, usbHz);
+	}
+
+	clockCurrent = *profile;
+	clockNSFactor = CLOCK_NS_FACTOR(sysHz);
+
+	clockUpdateADC();
+	clockUpdatePIO();
+	for (uint8_t i = 0; i < clockListenerCount; i++) {
+		clockListeners[i]();
+	}
+
+	return CLOCK_OK;
+}
+
+void clockGetProfile(struct clockProfile *profile) {
+	*profile = clockCurrent;
+}
+
+bool clockAddListener(clock_listener_t listener) {
+
+	if (listener == NULL) {
+		return false;
+	}
+	for (uint8_t i = 0; i < clockListenerCount; i++) {
+		if (clockListeners[i] == listener) {
+			return true;
+		}
+	}
+	if (clockListenerCount >= CLOCK_LISTENERS_MAX) {
+		return false;
+	}
+	clockListeners[clockListenerCount++] = listener;
+	return true;
+}
+
+uint32_t clockSetADCRate(uint32_t sampleRate) {
+	clockADCSampleRate = sampleRate;
+	clockADCRateSet = true;
+	clockUpdateADC();
+	return clockADCRate(clock_get_hz(clk_adc), adc_hw->div);
+}
+
+bool clockSetPIORate(uint8_t pio, uint8_t sm, uint32_t hz) {
+
+	if (pio >= PIO_BLOCKS || sm >= PIO_STATE_MACHINES) {
+		return false;
+	}
+
+	uint8_t index = 0;
+	while (index < clockPIORateCount &&
+		(clockPIORates[index].pio != pio || clockPIORates[index].sm != sm)) {
+		index++;
+	}
+	if (index == clockPIORateCount) {
+		if (clockPIORateCount >= CLOCK_PIO_MAX) {
+			return false;
+		}
+		clockPIORateCount++;
+	}
+
+	clockPIORates[index].pio = pio;
+	clockPIORates[index].sm = sm;
+	clockPIORates[index].hz = hz;
+	clockUpdatePIO();
+	return true;
+}
+
+enum ClockStatus clockSave(const struct clockProfile *profile) {
+
+	struct storedClock stored;
+	memset(&stored, 0, sizeof(stored));
+	stored.magic = CLOCK_MAGIC;
+	stored.version = CLOCK_VERSION;
+	stored.profile = *profile;
+	stored.checksum = clockChecksum(&stored.profile);
+
+	if (!nvmWriteReserved(NVM_RESERVED_CLOCK, &stored, sizeof(stored))) {
+		return CLOCK_NVM_FAIL;
+	}
+	return CLOCK_OK;
+}
+
+enum ClockStatus clockLoad(struct clockProfile *profile) {
+
+	struct storedClock stored;
+
+	if (!nvmGetReserved(NVM_RESERVED_CLOCK, &stored, sizeof(stored))) {
+		clockDefaults(profile);
+		return CLOCK_NVM_FAIL;
+	}
+
+	if (stored.magic != CLOCK_MAGIC || stored.version != CLOCK_VERSION ||
+		stored.checksum != clockChecksum(&stored.profile)) {
+		clockDefaults(profile);
+		return CLOCK_NVM_EMPTY;
+	}
+
+	*profile = stored.profile;
+	return CLOCK_OK;
+}
+
+enum ClockStatus clockBegin(void) {
+
+	struct clockProfile profile;
+	enum ClockStatus status = clockLoad(&profile);
+	if (status != CLOCK_OK) {
+		return status;
+	}
+	return clockApply(&profile);
+}
\ No newline at end of file
@@ -0,0 +1,252 @@
+/*
+	board_pico_clock.h - clock configuration for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_CLOCK_H
+#define BOARD_PICO_CLOCK_H
+
+#include "board_pico.h"
+#include "board_pico_cycles.h"
+
+#include <hardware/vreg.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Clock Config
+ * 
+ * clockApply changes clk_sys, clk_peri and clk_adc together,
+ * then reprograms ADC and PIO dividers set through this API
+ * and calls listeners so UART and delays follow the new clocks
+ * 
+ * Divider maths is integer only so it costs
+ * nothing extra on the M0+ without an FPU
+ * 
+ * clk_sys stops at the rated 133 MHz unless CLOCK_SYS_MAX_KHZ
+ * is raised, above it core voltage steps up before the PLL
+ * speeds up and flash SCK divider grows so flash stays at
+ * its rated speed, both step back down after the PLL slows
+ * 
+ * Pico W rescales the CYW43 SPI state machine from a listener
+****************************/
+
+#ifndef CLOCK_DEFAULT_SYS_KHZ
+	#ifdef SYS_CLK_KHZ
+		#define CLOCK_DEFAULT_SYS_KHZ SYS_CLK_KHZ // clk_sys of default profile
+	#else
+		#define CLOCK_DEFAULT_SYS_KHZ 125000u
+	#endif
+#endif
+
+#ifndef CLOCK_LISTENERS_MAX
+	#define CLOCK_LISTENERS_MAX 8u // functions notified of clock changes
+#endif
+
+#ifndef CLOCK_PIO_MAX
+	#define CLOCK_PIO_MAX 8u // PIO state machines kept at a set rate
+#endif
+
+#define CLOCK_SYS_MIN_KHZ 48000u // slowest supported clk_sys
+#define CLOCK_SYS_RATED_KHZ 133000u // fastest clk_sys at default core voltage
+#define CLOCK_SYS_LIMIT_KHZ 300000u // fastest clk_sys with a core voltage step
+
+#ifndef CLOCK_SYS_MAX_KHZ
+	#define CLOCK_SYS_MAX_KHZ CLOCK_SYS_RATED_KHZ // fastest clk_sys clockApply accepts, up to CLOCK_SYS_LIMIT_KHZ
+#endif
+
+#ifdef PICO_FLASH_SPI_CLKDIV
+	#define CLOCK_FLASH_DIV_DEFAULT PICO_FLASH_SPI_CLKDIV // flash SCK divider boot2 sets
+#else
+	#define CLOCK_FLASH_DIV_DEFAULT 2u
+#endif
+
+#define CLOCK_FLASH_MAX_KHZ (CLOCK_SYS_RATED_KHZ / CLOCK_FLASH_DIV_DEFAULT) // fastest flash SCK
+#define CLOCK_VREG_SETTLE_US 10u // wait after raising core voltage
+#define CLOCK_USB_KHZ 48000u // USB PLL output
+#define CLOCK_ADC_MAX_KHZ 48000u // fastest clk_adc
+#define CLOCK_ADC_MIN_CYCLES 96u // clk_adc cycles per ADC conversion
+#define CLOCK_DIV_FRAC_BITS 8u // fraction bits of ADC and PIO dividers
+#define CLOCK_PIO_DIV_MAX ((65536u << CLOCK_DIV_FRAC_BITS) - 1u) // largest PIO divider
+
+enum ClockSource {
+	CLOCK_SOURCE_SYS, // runs from system PLL
+	CLOCK_SOURCE_USB, // runs from 48 MHz USB PLL, unaffected by clk_sys
+};
+
+struct clockProfile {
+	uint32_t sysKHz; // clk_sys in kHz
+	uint8_t periSource; // enum ClockSource of clk_peri (UART and SPI)
+	uint8_t adcSource; // enum ClockSource of clk_adc
+	uint16_t reserved; // keeps stored profile aligned
+};
+
+enum ClockStatus {
+	CLOCK_OK, // clocks changed
+	CLOCK_BAD_FREQ, // clk_sys can't be made by system PLL or is out of range
+	CLOCK_NVM_FAIL, // unable to read or write NVM
+	CLOCK_NVM_EMPTY, // NVM has no valid profile
+	CLOCK_BAD_CORE, // called from core 1, which can't pause core 0 to change flash clock
+};
+
+typedef void (*clock_listener_t)(void); // called after clocks change
+
+extern uint32_t clockNSFactor; // CLOCK_NS_FACTOR of clk_sys set by clockApply
+
+/**
+ * Sets profile to SDK default clocks
+ * 
+ * @param profile profile to reset
+ */
+void clockDefaults(struct clockProfile *profile);
+
+/**
+ * Changes clocks and rescales dependent peripherals
+ * 
+ * @param profile clocks to use
+ * 
+ * @return result of changing clocks
+ * 
+ * @note peripherals may glitch while clocks change, flush serial first
+ * @warning only call from core 0
+ */
+enum ClockStatus clockApply(const struct clockProfile *profile);
+
+/**
+ * Gets profile in use
+ * 
+ * @param profile pointer to profile
+ */
+void clockGetProfile(struct clockProfile *profile);
+
+/**
+ * Adds function called after clocks change
+ * 
+ * @param listener function to call
+ * 
+ * @return whether listener was added
+ */
+bool clockAddListener(clock_listener_t listener);
+
+/**
+ * Writes profile to NVM
+ * 
+ * @param profile profile to save
+ * 
+ * @return result of saving
+ */
+enum ClockStatus clockSave(const struct clockProfile *profile);
+
+/**
+ * Gets profile from NVM
+ * 
+ * @param profile pointer to profile
+ * 
+ * @return result of loading
+ * 
+ * @note profile is set to defaults if NVM has no valid profile
+ */
+enum ClockStatus clockLoad(struct clockProfile *profile);
+
+/**
+ * Applies profile saved in NVM
+ * 
+ * @return result of applying profile
+ * 
+ * @note call as early in boot as possible
+ */
+enum ClockStatus clockBegin(void);
+
+/**
+ * Keeps ADC sample rate as clocks change
+ * 
+ * @param sampleRate samples per second, 0 for fastest
+ * 
+ * @return actual sample rate
+ */
+uint32_t clockSetADCRate(uint32_t sampleRate);
+
+/**
+ * Keeps PIO state machine clock as clocks change
+ * 
+ * @param pio PIO block number
+ * @param sm state machine
+ * @param hz state machine clock
+ * 
+ * @return whether state machine was set
+ */
+bool clockSetPIORate(uint8_t pio, uint8_t sm, uint32_t hz);
+
+/**
+ * Calculates ADC divider
+ * 
+ * @param adcHz clk_adc in Hz
+ * @param sampleRate samples per second, 0 for fastest
+ * 
+ * @return divider in 16.8 fixed point, 0 for back to back conversions
+ */
+uint32_t clockADCDivider(uint32_t adcHz, uint32_t sampleRate);
+
+/**
+ * Calculates ADC sample rate of divider
+ * 
+ * @param adcHz clk_adc in Hz
+ * @param divider divider in 16.8 fixed point
+ * 
+ * @return samples per second
+ */
+uint32_t clockADCRate(uint32_t adcHz, uint32_t divider);
+
+/**
+ * Calculates PIO clock divider
+ * 
+ * @param sysHz clk_sys in Hz
+ * @param hz state machine clock
+ * 
+ * @return divider in 16.8 fixed point, 1.0 to 65535.996
+ */
+uint32_t clockPIODivider(uint32_t sysHz, uint32_t hz);
+
+/**
+ * Calculates clk_adc divider when running from system PLL
+ * 
+ * @param sysHz system PLL output in Hz
+ * 
+ * @return smallest whole divider keeping clk_adc at or below CLOCK_ADC_MAX_KHZ
+ */
+uint32_t clockADCSourceDivider(uint32_t sysHz);
+
+/**
+ * Gets core voltage clk_sys needs
+ * 
+ * @param sysKHz clk_sys in kHz
+ * 
+ * @return default voltage up to CLOCK_SYS_RATED_KHZ, higher above it
+ */
+enum vreg_voltage clockVoltage(uint32_t sysKHz);
+
+/**
+ * Calculates flash SCK divider
+ * 
+ * @param sysHz clk_sys in Hz
+ * 
+ * @return smallest even divider from CLOCK_FLASH_DIV_DEFAULT keeping
+ * @return flash SCK at or below CLOCK_FLASH_MAX_KHZ
+ */
+uint32_t clockFlashDivider(uint32_t sysHz);
+
+#endif
\ No newline at end of file
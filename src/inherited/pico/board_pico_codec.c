@@ -0,0 +1,309 @@
+/*
+	board_pico_codec.c - capture compression for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "board_pico_codec.h"
+
+#include <stddef.h>
+
+#define SAMPLE_MASK ((uint32_t)SAMPLE_MAX)
+#define ZIGZAG_BITS (SAMPLE_BITS + 1) // bits in largest zig zag delta
+
+#define VARINT_MAX_BYTES 2u // bytes of largest zig zag delta
+#define VARINT_MORE 0x80u // set when another 7 bit group follows
+#define VARINT_GROUP 0x7Fu // bits in each group
+
+#define RICE_ESCAPE 20u // unary length that marks raw delta
+#define RICE_MAX_BITS (RICE_ESCAPE + ZIGZAG_BITS) // bits of escaped delta
+#define RICE_WINDOW_SHIFT 4 // running sum covers 16 deltas
+#define RICE_START_SUM (4u << RICE_WINDOW_SHIFT) // starts k near 2
+#define RICE_MAX_K ZIGZAG_BITS
+
+struct bitWriter {
+	uint8_t *out; // next byte written
+	uint8_t *end; // end of output
+	uint32_t bits; // bits waiting to be written, first bit lowest
+	uint32_t count; // amount of waiting bits
+};
+
+struct bitReader {
+	const uint8_t *in; // next byte read
+	const uint8_t *end; // end of input
+	uint32_t bits; // bits read ahead, first bit lowest
+	uint32_t count; // amount of read ahead bits
+};
+
+/**
+ * Maps signed delta to unsigned so small deltas stay small
+ */
+static inline uint32_t zigzag(int32_t delta) {
+	return ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+}
+
+/**
+ * Reverses zigzag
+ */
+static inline int32_t unzigzag(uint32_t value) {
+	return (int32_t)(value >> 1) ^ -(int32_t)(value & 1u);
+}
+
+/**
+ * Gets rice parameter from running sum of deltas
+ */
+static inline uint32_t riceK(uint32_t sum) {
+	uint32_t k = 0u;
+	while (((uint32_t)1 << (k + RICE_WINDOW_SHIFT)) < sum && k < RICE_MAX_K) {
+		k++;
+	}
+	return k;
+}
+
+/**
+ * Adds bits to writer
+ * 
+ * @return false if output is full
+ * 
+ * @note length must be 25 or less
+ */
+static inline bool writeBits(struct bitWriter *writer, uint32_t value, uint32_t length) {
+	writer->bits |= value << writer->count;
+	writer->count += length;
+	while (writer->count >= 8u) {
+		if (writer->out == writer->end) {
+			return false;
+		}
+		*writer->out++ = (uint8_t)writer->bits;
+		writer->bits >>= 8;
+		writer->count -= 8u;
+	}
+	return true;
+}
+
+/**
+ * Gets bits from reader
+ * 
+ * @return false if input ran out
+ */
+static inline bool readBits(struct bitReader *reader, uint32_t length, uint32_t *value) {
+	while (reader->count < length) {
+		if (reader->in == reader->end) {
+			return false;
+		}
+		reader->bits |= (uint32_t)*reader->in++ << reader->count;
+		reader->count += 8u;
+	}
+	*value = reader->bits & (((uint32_t)1 << length) - 1u);
+	reader->bits >>= length;
+	reader->count -= length;
+	return true;
+}
+
+uint32_t codecMaxBytes(enum CodecFormat format, uint32_t count) {
+	if (count == 0u) {
+		return 0u;
+	}
+	if (format == CODEC_RICE) {
+		return CODEC_HEADER_BYTES + ((count - 1u) * RICE_MAX_BITS + 7u) / 8u;
+	}
+	return CODEC_HEADER_BYTES + (count - 1u) * VARINT_MAX_BYTES;
+}
+
+/**
+ * Encodes deltas in 7 bit groups
+ * 
+ * @return end of encoded data, NULL if it doesn't fit
+ */
+static uint8_t* RUN_IN_RAM(encodeVarint) encodeVarint(const sample_t *samples, uint32_t count, uint8_t *out, uint8_t *end) {
+
+	int32_t previous = samples[0] & SAMPLE_MASK;
+
+	for (uint32_t i = 1; i < count; i++) {
+
+		if (end - out < (ptrdiff_t)VARINT_MAX_BYTES) {
+			return NULL;
+		}
+
+		int32_t sample = samples[i] & SAMPLE_MASK;
+		uint32_t value = zigzag(sample - previous);
+		previous = sample;
+
+		if (value > VARINT_GROUP) {
+			*out++ = (uint8_t)((value & VARINT_GROUP) | VARINT_MORE);
+			value >>= 7;
+		}
+		*out++ = (uint8_t)value;
+	}
+
+	return out;
+}
+
+/**
+ * Encodes deltas as adaptive rice codes
+ * 
+ * @return end of encoded data, NULL if it doesn't fit
+ */
+static uint8_t* RUN_IN_RAM(encodeRice) encodeRice(const sample_t *samples, uint32_t count, uint8_t *out, uint8_t *end) {
+
+	struct bitWriter writer = {out, end, 0u, 0u};
+	int32_t previous = samples[0] & SAMPLE_MASK;
+	uint32_t sum = RICE_START_SUM;
+
+	for (uint32_t i = 1; i < count; i++) {
+
+		int32_t sample = samples[i] & SAMPLE_MASK;
+		uint32_t value = zigzag(sample - previous);
+		previous = sample;
+
+		uint32_t k = riceK(sum);
+		uint32_t quotient = value >> k;
+		bool fits;
+
+		if (quotient < RICE_ESCAPE) {
+			// quotient ones then a zero
+			fits = writeBits(&writer, ((uint32_t)1 << quotient) - 1u, quotient + 1u);
+			fits = fits && writeBits(&writer, value & (((uint32_t)1 << k) - 1u), k);
+		}
+		else {
+			fits = writeBits(&writer, ((uint32_t)1 << RICE_ESCAPE) - 1u, RICE_ESCAPE);
+			fits = fits && writeBits(&writer, value, ZIGZAG_BITS);
+		}
+		if (!fits) {
+			return NULL;
+		}
+
+		sum += value - (sum >> RICE_WINDOW_SHIFT);
+	}
+
+	if (writer.count > 0u) {
+		if (writer.out == writer.end) {
+			return NULL;
+		}
+		*writer.out++ = (uint8_t)writer.bits;
+	}
+
+	return writer.out;
+}
+
+uint32_t codecEncode(enum CodecFormat format, const sample_t *samples, uint32_t count, uint8_t *out, uint32_t outSize) {
+
+	if (samples == NULL || out == NULL || count == 0u || count > CODEC_BLOCK_MAX) {
+		return 0u;
+	}
+	if (outSize < CODEC_HEADER_BYTES) {
+		return 0u;
+	}
+
+	uint32_t first = samples[0] & SAMPLE_MASK;
+	out[0] = (uint8_t)format;
+	out[1] = (uint8_t)count;
+	out[2] = (uint8_t)(count >> 8);
+	out[3] = (uint8_t)first;
+	out[4] = (uint8_t)(first >> 8);
+
+	uint8_t *end = out + outSize;
+	uint8_t *written;
+	if (format == CODEC_RICE) {
+		written = encodeRice(samples, count, out + CODEC_HEADER_BYTES, end);
+	}
+	else {
+		written = encodeVarint(samples, count, out + CODEC_HEADER_BYTES, end);
+	}
+
+	if (written == NULL) {
+		return 0u;
+	}
+	return (uint32_t)(written - out);
+}
+
+uint32_t codecDecode(const uint8_t *in, uint32_t inSize, sample_t *samples, uint32_t maxSamples, uint32_t *consumed) {
+
+	if (in == NULL || samples == NULL || inSize < CODEC_HEADER_BYTES) {
+		return 0u;
+	}
+
+	enum CodecFormat format = (enum CodecFormat)in[0];
+	uint32_t count = in[1] | ((uint32_t)in[2] << 8);
+	int32_t previous = (in[3] | ((uint32_t)in[4] << 8)) & SAMPLE_MASK;
+
+	if (count == 0u || count > maxSamples || (format != CODEC_VARINT && format != CODEC_RICE)) {
+		return 0u;
+	}
+
+	samples[0] = (sample_t)previous;
+	const uint8_t *end = in + inSize;
+	const uint8_t *read = in + CODEC_HEADER_BYTES;
+
+	if (format == CODEC_VARINT) {
+		for (uint32_t i = 1; i < count; i++) {
+			if (read == end) {
+				return 0u;
+			}
+			uint32_t value = *read & VARINT_GROUP;
+			if (*read++ & VARINT_MORE) {
+				if (read == end) {
+					return 0u;
+				}
+				value |= (uint32_t)*read++ << 7;
+			}
+			previous = (previous + unzigzag(value)) & SAMPLE_MASK;
+			samples[i] = (sample_t)previous;
+		}
+	}
+	else {
+		struct bitReader reader = {read, end, 0u, 0u};
+		uint32_t sum = RICE_START_SUM;
+
+		for (uint32_t i = 1; i < count; i++) {
+
+			uint32_t k = riceK(sum);
+			uint32_t quotient = 0u;
+			uint32_t bit;
+			uint32_t value;
+
+			do {
+				if (!readBits(&reader, 1u, &bit)) {
+					return 0u;
+				}
+				quotient += bit;
+			} while (bit != 0u && quotient < RICE_ESCAPE);
+
+			if (quotient == RICE_ESCAPE) {
+				if (!readBits(&reader, ZIGZAG_BITS, &value)) {
+					return 0u;
+				}
+			}
+			else {
+				if (!readBits(&reader, k, &value)) {
+					return 0u;
+				}
+				value |= quotient << k;
+			}
+
+			previous = (previous + unzigzag(value)) & SAMPLE_MASK;
+			samples[i] = (sample_t)previous;
+			sum += value - (sum >> RICE_WINDOW_SHIFT);
+		}
+
+		// unused bits of last byte belong to block
+		read = reader.in;
+	}
+
+	if (consumed != NULL) {
+		*consumed = (uint32_t)(read - in);
+	}
+	return count;
+}
\ No newline at end of file
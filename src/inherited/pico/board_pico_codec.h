@@ -0,0 +1,87 @@
+/*
+	board_pico_codec.h - capture compression for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_CODEC_H
+#define BOARD_PICO_CODEC_H
+
+#include "board_pico.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Codec Config
+ * 
+ * Each capture buffer is encoded as one block:
+ * 	byte 0: format
+ * 	bytes 1-2: sample count (little endian)
+ * 	bytes 3-4: first sample (little endian)
+ * 	rest: zig zag deltas between samples
+ * 
+ * CODEC_VARINT stores deltas in 7 bit groups,
+ * CODEC_RICE stores them as adaptive rice codes
+ * 
+ * Decoder has no SDK dependencies so host tools
+ * can build this file with PICO defined
+****************************/
+
+#define CODEC_HEADER_BYTES 5u // bytes before encoded deltas
+#define CODEC_BLOCK_MAX 65535u // max samples per block
+
+enum CodecFormat {
+	CODEC_VARINT, // deltas in 7 bit groups, 1 byte per small delta
+	CODEC_RICE, // adaptive rice codes, a few bits per small delta
+};
+
+/**
+ * Gets largest possible block size
+ * 
+ * @param format block format
+ * @param count amount of samples
+ * 
+ * @return max bytes block can take
+ */
+uint32_t codecMaxBytes(enum CodecFormat format, uint32_t count);
+
+/**
+ * Encodes samples into block
+ * 
+ * @param format block format
+ * @param samples samples to encode
+ * @param count amount of samples (1 to CODEC_BLOCK_MAX)
+ * @param out pointer to block
+ * @param outSize size of out in bytes
+ * 
+ * @return bytes written, 0 if block doesn't fit
+ */
+uint32_t codecEncode(enum CodecFormat format, const sample_t *samples, uint32_t count, uint8_t *out, uint32_t outSize);
+
+/**
+ * Decodes block into samples
+ * 
+ * @param in block to decode
+ * @param inSize bytes available in in
+ * @param samples pointer to decoded samples
+ * @param maxSamples size of samples
+ * @param consumed pointer to bytes used by block, can be NULL
+ * 
+ * @return samples decoded, 0 if block is invalid or doesn't fit
+ */
+uint32_t codecDecode(const uint8_t *in, uint32_t inSize, sample_t *samples, uint32_t maxSamples, uint32_t *consumed);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,40 @@
+/*
+	board_pico_cycles.h - ns to clk_sys cycle maths for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_CYCLES_H
+#define BOARD_PICO_CYCLES_H
+
+#include <stdint.h>
+
+/****************************
+ * Cycle Config
+ * 
+ * Factor is worked out once per clock change so converting
+ * is one 32 x 32 multiply, shared by delays and one shot timers
+ * 
+ * Kept apart from board_pico_clock.h since board delay headers
+ * are included ahead of board_pico.h
+****************************/
+
+#define CLOCK_NS_PER_S 1000000000ull
+
+// ns to clk_sys cycles in Q32, rounded up so waits are never short
+#define CLOCK_NS_FACTOR(clockHz) ((uint32_t)((((uint64_t)(clockHz) << 32) + CLOCK_NS_PER_S - 1u) / CLOCK_NS_PER_S))
+#define CLOCK_NS_TO_CYCLES(ns, factor) ((uint32_t)(((uint64_t)(ns) * (factor) + 0xFFFFFFFFull) >> 32))
+
+#endif
\ No newline at end of file
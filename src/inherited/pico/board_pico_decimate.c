@@ -0,0 +1,144 @@
+/*
+	board_pico_decimate.c - peak detect decimation for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "board_pico_decimate.h"
+
+#include <stddef.h>
+
+/**
+ * Starts new empty bucket
+ * 
+ * @param dec decimator
+ */
+static inline void startBucket(struct decimator *dec) {
+	dec->left = dec->ratio;
+	dec->min = (sample_t)SAMPLE_MAX;
+	dec->max = 0;
+	dec->sum = 0u;
+}
+
+/**
+ * Writes current bucket to output
+ * 
+ * @param dec decimator
+ * @param taken amount of samples in bucket
+ */
+static void RUN_IN_RAM(writeBucket) writeBucket(struct decimator *dec, uint32_t taken) {
+
+	struct decimateBucket *bucket = &dec->buckets[dec->written];
+	bucket->min = dec->min;
+	bucket->max = dec->max;
+
+	if (dec->averages != NULL) {
+		// once per bucket, 32 bit divide runs on SIO divider in 8 cycles
+		dec->averages[dec->written] = (sample_t)((dec->sum + (taken >> 1)) / taken);
+	}
+
+	dec->written++;
+}
+
+bool decimateBegin(struct decimator *dec, uint32_t ratio, struct decimateBucket *buckets, sample_t *averages, uint32_t capacity) {
+
+	if (dec == NULL || buckets == NULL) {
+		return false;
+	}
+	if (ratio == 0u || ratio > DECIMATE_RATIO_MAX) {
+		return false;
+	}
+
+	dec->ratio = ratio;
+	dec->buckets = buckets;
+	dec->averages = averages;
+	dec->capacity = capacity;
+	decimateReset(dec);
+
+	return true;
+}
+
+void decimateReset(struct decimator *dec) {
+	dec->written = 0u;
+	startBucket(dec);
+}
+
+uint32_t RUN_IN_RAM(decimateFeed) decimateFeed(struct decimator *dec, const sample_t *samples, uint32_t count) {
+
+	uint32_t startWritten = dec->written;
+	const sample_t *end = samples + count;
+
+	while (samples < end && dec->written < dec->capacity) {
+
+		uint32_t run = (uint32_t)(end - samples);
+		if (run > dec->left) {
+			run = dec->left;
+		}
+
+		// keeps bucket in registers for inner loop
+		const sample_t *runEnd = samples + run;
+		uint32_t min = dec->min;
+		uint32_t max = dec->max;
+		uint32_t sum = dec->sum;
+
+		if (dec->averages != NULL) {
+			while (samples < runEnd) {
+				uint32_t sample = *samples++;
+				if (sample < min) {
+					min = sample;
+				}
+				if (sample > max) {
+					max = sample;
+				}
+				sum += sample;
+			}
+		}
+		else {
+			while (samples < runEnd) {
+				uint32_t sample = *samples++;
+				if (sample < min) {
+					min = sample;
+				}
+				if (sample > max) {
+					max = sample;
+				}
+			}
+		}
+
+		dec->min = (sample_t)min;
+		dec->max = (sample_t)max;
+		dec->sum = sum;
+		dec->left -= run;
+
+		if (dec->left == 0u) {
+			writeBucket(dec, dec->ratio);
+			startBucket(dec);
+		}
+	}
+
+	return dec->written - startWritten;
+}
+
+bool decimateFlush(struct decimator *dec) {
+
+	uint32_t taken = dec->ratio - dec->left;
+	if (taken == 0u || dec->written >= dec->capacity) {
+		return false;
+	}
+
+	writeBucket(dec, taken);
+	startBucket(dec);
+	return true;
+}
\ No newline at end of file
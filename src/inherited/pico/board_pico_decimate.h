@@ -0,0 +1,98 @@
+/*
+	board_pico_decimate.h - peak detect decimation for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_DECIMATE_H
+#define BOARD_PICO_DECIMATE_H
+
+#include "board_pico.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Decimation Config
+ * 
+ * Every bucket of ratio samples is reduced to
+ * its min and max so single sample spikes stay visible
+****************************/
+
+#define DECIMATE_RATIO_MAX 65535u // largest samples per bucket, keeps bucket sum in 32 bits
+
+struct decimateBucket {
+	sample_t min; // smallest sample in bucket
+	sample_t max; // largest sample in bucket
+};
+
+struct decimator {
+	uint32_t ratio; // samples per bucket
+	uint32_t left; // samples left in current bucket
+	sample_t min; // smallest sample in current bucket
+	sample_t max; // largest sample in current bucket
+	uint32_t sum; // sum of current bucket
+	struct decimateBucket *buckets; // output buckets
+	sample_t *averages; // output averages, NULL to skip averaging
+	uint32_t capacity; // amount of output buckets available
+	uint32_t written; // amount of output buckets written
+};
+
+/**
+ * Sets up decimator
+ * 
+ * @param dec decimator to set up
+ * @param ratio samples per bucket
+ * @param buckets output buckets
+ * @param averages output averages, NULL to skip averaging
+ * @param capacity amount of output buckets available
+ * 
+ * @return whether decimator was set up
+ */
+bool decimateBegin(struct decimator *dec, uint32_t ratio, struct decimateBucket *buckets, sample_t *averages, uint32_t capacity);
+
+/**
+ * Starts writing buckets to start of output again
+ * 
+ * @param dec decimator to reset
+ * 
+ * @note partially filled bucket is discarded
+ */
+void decimateReset(struct decimator *dec);
+
+/**
+ * Reduces samples into buckets
+ * 
+ * @param dec decimator
+ * @param samples samples to reduce
+ * @param count amount of samples
+ * 
+ * @return amount of buckets completed by samples
+ * 
+ * @note partial bucket carries into next call so DMA buffers can be fed as they complete
+ * @note samples past a full output are dropped
+ */
+uint32_t decimateFeed(struct decimator *dec, const sample_t *samples, uint32_t count);
+
+/**
+ * Writes partially filled bucket
+ * 
+ * @param dec decimator
+ * 
+ * @return whether a bucket was written
+ */
+bool decimateFlush(struct decimator *dec);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,130 @@
+/*
+	board_pico_ets.c - equivalent time sampling for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "board_pico_ets.h"
+#include "board_pico_timer.h"
+
+#include <stddef.h>
+
+bool etsBegin(struct etsRecord *ets, sample_t *record, uint32_t *sums, uint32_t length, uint32_t interleave, uint32_t samplePeriodNs, uint32_t samples) {
+
+	if (ets == NULL || record == NULL || sums == NULL || samples == 0u) {
+		return false;
+	}
+	if (interleave < ETS_INTERLEAVE_MIN || interleave > ETS_INTERLEAVE_MAX || samplePeriodNs < interleave) {
+		return false;
+	}
+	if (length / interleave < samples) {
+		return false;
+	}
+
+	ets->record = record;
+	ets->sums = sums;
+	ets->length = samples * interleave;
+	ets->interleave = interleave;
+	ets->stepNs = (samplePeriodNs + (interleave >> 1)) / interleave;
+	ets->samples = samples;
+	etsReset(ets);
+	return true;
+}
+
+void etsReset(struct etsRecord *ets) {
+	ets->phase = 0u;
+	ets->nextPhase = 0u;
+	ets->covered = 0u;
+	ets->captures = 0u;
+	ets->rejected = 0u;
+	for (uint32_t i = 0; i < ETS_INTERLEAVE_MAX; i++) {
+		ets->hits[i] = 0u;
+	}
+}
+
+uint32_t etsNextShiftNs(struct etsRecord *ets) {
+
+	const uint32_t interleave = ets->interleave;
+	uint32_t phase = ets->nextPhase;
+
+	// skips phases already covered unless all are
+	if (!etsComplete(ets)) {
+		while (ets->covered & (((uint64_t)1) << phase)) {
+			phase = phase + 1u < interleave ? phase + 1u : 0u;
+		}
+	}
+
+	ets->phase = phase;
+	ets->nextPhase = phase + 1u < interleave ? phase + 1u : 0u;
+	return phase * ets->stepNs;
+}
+
+bool etsRestart(struct etsRecord *ets, ets_start_t start, void *context) {
+	if (start == NULL) {
+		return false;
+	}
+	return setHardTimerOneShotNS(etsNextShiftNs(ets), start, context);
+}
+
+bool etsAddCapture(struct etsRecord *ets, const sample_t *samples, uint32_t count) {
+
+	const uint32_t phase = ets->phase;
+
+	// sums of 12 bit samples would overflow past this many
+	if (count < ets->samples || ets->hits[phase] == UINT16_MAX) {
+		ets->rejected++;
+		return false;
+	}
+	count = ets->samples;
+
+	const uint32_t interleave = ets->interleave;
+	const uint32_t hits = (uint32_t)ets->hits[phase] + 1u; // captures in phase with this one
+	sample_t *slot = ets->record + phase;
+	uint32_t *sum = ets->sums + phase;
+
+	for (uint32_t i = 0; i < count; i++) {
+		if (hits == 1u) {
+			*sum = samples[i];
+			*slot = samples[i];
+		}
+		else {
+			*sum += samples[i];
+			*slot = (sample_t)((*sum + (hits >> 1)) / hits);
+		}
+		slot += interleave;
+		sum += interleave;
+	}
+
+	ets->hits[phase] = (uint16_t)hits;
+	ets->covered |= ((uint64_t)1) << phase;
+	ets->captures++;
+	return true;
+}
+
+uint32_t etsCoverage(const struct etsRecord *ets) {
+	uint32_t count = 0u;
+	for (uint64_t covered = ets->covered; covered != 0u; covered &= covered - 1u) {
+		count++;
+	}
+	return count;
+}
+
+bool etsComplete(const struct etsRecord *ets) {
+	return etsCoverage(ets) == ets->interleave;
+}
+
+uint32_t etsEffectiveRate(const struct etsRecord *ets, uint32_t sampleRate) {
+	return sampleRate * ets->interleave;
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+/*
+	board_pico_ets.h - equivalent time sampling for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_ETS_H
+#define BOARD_PICO_ETS_H
+
+#include "board_pico.h"
+#include "board_pico_timer.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Equivalent Time Sampling Config
+ * 
+ * A repetitive signal is captured many times, each capture
+ * started a further step of sample period / interleave after
+ * trigger event, so ADC samples land on a different phase
+ * 
+ * Phase comes from the shift, so acquisition must start from
+ * an event locked to signal (GPIO edge interrupt or period of
+ * a waveform the Pico generates) with fixed latency
+ * 
+ * Sample domain trigger can't place edges of a signal faster
+ * than the ADC, so it isn't used to align captures
+ * 
+ * Record slot = sample * interleave + phase
+****************************/
+
+#define ETS_INTERLEAVE_MIN 2u // fewest phases per sample period
+#define ETS_INTERLEAVE_MAX 64u // most phases per sample period
+
+typedef hard_timer_oneshot_function_t ets_start_t; // starts acquisition
+
+struct etsRecord {
+	sample_t *record; // interleaved record
+	uint32_t *sums; // sum of captures in each slot of record
+	uint32_t length; // slots in record
+	uint32_t interleave; // phases per sample period
+	uint32_t stepNs; // time between phases in ns
+	uint32_t samples; // samples per capture
+	uint32_t phase; // phase of capture in flight
+	uint32_t nextPhase; // phase of next shift
+	uint64_t covered; // bit per phase holding samples
+	uint16_t hits[ETS_INTERLEAVE_MAX]; // captures added to each phase
+	uint32_t captures; // captures added
+	uint32_t rejected; // captures too short to add
+};
+
+/**
+ * Sets up interleaved record
+ * 
+ * @param ets record to set up
+ * @param record storage for interleaved samples
+ * @param sums storage for sums behind the mean of each slot, length slots
+ * @param length slots in record, at least samples * interleave
+ * @param interleave phases per sample period (ETS_INTERLEAVE_MIN to ETS_INTERLEAVE_MAX)
+ * @param samplePeriodNs time between ADC samples in ns
+ * @param samples samples per capture
+ * 
+ * @return whether record was set up
+ */
+bool etsBegin(struct etsRecord *ets, sample_t *record, uint32_t *sums, uint32_t length, uint32_t interleave, uint32_t samplePeriodNs, uint32_t samples);
+
+/**
+ * Empties record and coverage
+ * 
+ * @param ets record to reset
+ */
+void etsReset(struct etsRecord *ets);
+
+/**
+ * Gets delay of next capture and marks its phase in flight
+ * 
+ * @param ets record
+ * 
+ * @return delay after trigger event in ns, steps through uncovered phases
+ */
+uint32_t etsNextShiftNs(struct etsRecord *ets);
+
+/**
+ * Starts acquisition after next shift
+ * 
+ * @param ets record
+ * @param start starts acquisition
+ * @param context passed to start
+ * 
+ * @return whether start was scheduled
+ * 
+ * @note call from trigger event, start is called before
+ * @note returning if sample period is within HARD_TIMER_SPIN_MAX_NS
+ */
+bool etsRestart(struct etsRecord *ets, ets_start_t start, void *context);
+
+/**
+ * Adds capture started by last shift to record
+ * 
+ * @param ets record
+ * @param samples samples from start of acquisition
+ * @param count amount of samples, extra past samples per capture are ignored
+ * 
+ * @return whether capture was added
+ * 
+ * @note each slot is the mean of every capture of its phase, rounded,
+ * @note a phase stops taking captures after UINT16_MAX of them
+ */
+bool etsAddCapture(struct etsRecord *ets, const sample_t *samples, uint32_t count);
+
+/**
+ * Gets amount of phases holding samples
+ * 
+ * @param ets record
+ * 
+ * @return covered phases, record is complete once equal to interleave
+ */
+uint32_t etsCoverage(const struct etsRecord *ets);
+
+/**
+ * Gets whether every phase holds samples
+ * 
+ * @param ets record
+ * 
+ * @return whether record is complete
+ */
+bool etsComplete(const struct etsRecord *ets);
+
+/**
+ * Gets sample rate of record
+ * 
+ * @param ets record
+ * @param sampleRate ADC sample rate in Hz
+ * 
+ * @return effective sample rate in Hz
+ */
+uint32_t etsEffectiveRate(const struct etsRecord *ets, uint32_t sampleRate);
+
+#endif
\ No newline at end of file
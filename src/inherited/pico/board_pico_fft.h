@@ -0,0 +1,94 @@
+/*
+	board_pico_fft.h - fixed point spectrum for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_FFT_H
+#define BOARD_PICO_FFT_H
+
+#include "board_pico.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * FFT Config
+ * 
+ * Q15 real FFT computed in place over capture buffer, no FPU needed
+ * 
+ * Samples load as Q14 so packed pairs stay under magnitude 1.0,
+ * every stage halves values so they stay there, magnitudes
+ * are scaled back to Q15 at the end
+****************************/
+
+#define FFT_POINTS_MIN 256u // smallest FFT size
+#define FFT_POINTS_MAX 4096u // largest FFT size
+
+enum FFTWindow {
+	FFT_WINDOW_RECTANGLE, // no window
+	FFT_WINDOW_HANN, // hann window
+};
+
+struct fftJob {
+	sample_t *buffer; // capture buffer, replaced by magnitudes
+	uint32_t points; // amount of samples in buffer
+	enum FFTWindow window; // window applied before FFT
+	volatile bool done; // set once magnitudes are ready
+	bool result; // whether FFT succeeded
+};
+
+/**
+ * Checks FFT size
+ * 
+ * @param points amount of samples
+ * 
+ * @return whether size is a power of 2 between FFT_POINTS_MIN and FFT_POINTS_MAX
+ */
+bool fftValidPoints(uint32_t points);
+
+/**
+ * Calculates magnitude spectrum in place
+ * 
+ * @param buffer capture buffer of points samples, 32 bit aligned
+ * @param points amount of samples (power of 2, 256 to 4096)
+ * @param window window applied before FFT
+ * 
+ * @return whether spectrum was calculated
+ * 
+ * @note buffer[0 to points / 2 - 1] holds magnitude of each bin afterwards
+ * @note full scale sine centered on a bin gives magnitude near 32767 without window
+ */
+bool fftSpectrum(sample_t *buffer, uint32_t points, enum FFTWindow window);
+
+/**
+ * Runs FFT job, can be queued to core 1 with core1Queue
+ * 
+ * @param job pointer to struct fftJob
+ */
+void fftRunJob(void *job);
+
+/**
+ * Queues FFT job on core 1
+ * 
+ * @param job job to queue
+ * 
+ * @return whether job was queued
+ * 
+ * @note job->done is set once magnitudes are ready
+ */
+bool fftQueueCore1(struct fftJob *job);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,168 @@
+/*
+	board_pico_frame.h - binary capture framing for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_FRAME_H
+#define BOARD_PICO_FRAME_H
+
+#include "board_pico.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Frame Config
+ * 
+ * Frame on the wire: COBS(header | payload | crc32) 0x00
+ * 
+ * Header (little endian):
+ * 	byte 0: version
+ * 	byte 1: payload type
+ * 	byte 2: channel
+ * 	byte 3: reserved
+ * 	bytes 4-5: sequence number
+ * 	bytes 6-7: reserved
+ * 	bytes 8-11: sample period in ns
+ * 	bytes 12-15: index of first sample in capture
+ * 
+ * crc32 (IEEE) covers header and payload, 0x00 only appears
+ * between frames so a receiver resyncs at the next 0x00
+ * 
+ * Decoder has no SDK dependencies so host tools
+ * can build this file with PICO defined
+****************************/
+
+#define FRAME_VERSION 1u // framing version
+#define FRAME_HEADER_BYTES 16u // bytes in header
+#define FRAME_CRC_BYTES 4u // bytes in crc
+#define FRAME_DELIMITER 0x00u // byte between frames
+#define FRAME_COBS_BLOCK 254u // data bytes per COBS code byte
+#define FRAME_RESYNC_GAP 1024u // sequence jumps this far or backwards are a restart, not loss
+
+enum FrameType {
+	FRAME_RAW_SAMPLES, // payload is sample_t samples
+	FRAME_PACKED_SAMPLES, // payload is packed samples
+	FRAME_CODEC_BLOCK, // payload is codec block
+	FRAME_LOG, // payload is deferred log records
+	FRAME_TRACE, // payload is trace records
+};
+
+struct frameHeader {
+	uint8_t version; // framing version
+	uint8_t type; // payload type
+	uint8_t channel; // channel payload came from
+	uint16_t sequence; // frame number, wraps
+	uint32_t samplePeriodNs; // time between samples in ns
+	uint32_t firstSample; // index of first sample in capture
+};
+
+typedef void (*frame_sink_t)(const uint8_t *data, uint32_t length, void *context); // receives encoded bytes
+typedef void (*frame_handler_t)(const struct frameHeader *header, const uint8_t *payload, uint32_t length, void *context); // receives decoded frames
+
+struct frameEncoder {
+	frame_sink_t sink; // receives encoded bytes
+	void *context; // passed to sink
+	uint16_t sequence; // sequence of next frame
+};
+
+struct frameDecoderStats {
+	uint32_t frames; // valid frames
+	uint32_t crcErrors; // frames with bad crc or cobs
+	uint32_t overruns; // frames too big for buffer
+	uint32_t lostFrames; // frames missing from sequence
+	uint32_t resyncs; // sequence jumps too far to count as loss
+};
+
+struct frameDecoder {
+	uint8_t *buffer; // encoded frame being received
+	uint32_t size; // size of buffer
+	uint32_t length; // bytes in buffer
+	bool overrun; // frame outgrew buffer, dropped at next delimiter
+	bool synced; // sequence of a frame is known
+	uint16_t nextSequence; // expected sequence
+	frame_handler_t handler; // receives decoded frames
+	void *context; // passed to handler
+	struct frameDecoderStats stats; // decoder statistics
+};
+
+/**
+ * Calculates crc32 (IEEE)
+ * 
+ * @param crc crc of previous data, 0 to start
+ * @param data data to add
+ * @param length amount of bytes
+ * 
+ * @return updated crc
+ */
+uint32_t frameCRC32(uint32_t crc, const uint8_t *data, uint32_t length);
+
+/**
+ * Gets largest possible encoded frame
+ * 
+ * @param payloadLength bytes of payload
+ * 
+ * @return max bytes on the wire including delimiter
+ */
+uint32_t frameMaxEncoded(uint32_t payloadLength);
+
+/**
+ * Sets up frame encoder
+ * 
+ * @param encoder encoder to set up
+ * @param sink receives encoded bytes, such as a wrapper around serialWrite
+ * @param context passed to sink
+ */
+void frameEncoderBegin(struct frameEncoder *encoder, frame_sink_t sink, void *context);
+
+/**
+ * Encodes and sends frame
+ * 
+ * @param encoder encoder
+ * @param header frame header, version and sequence are filled in
+ * @param payload payload, read straight from capture buffer
+ * @param length bytes of payload
+ * 
+ * @return sequence number of frame
+ * 
+ * @note payload is never copied, sink gets each COBS code byte on its own
+ * then spans of up to 254 bytes pointing into header, payload or crc
+ */
+uint16_t frameSend(struct frameEncoder *encoder, const struct frameHeader *header, const void *payload, uint32_t length);
+
+/**
+ * Sets up frame decoder
+ * 
+ * @param decoder decoder to set up
+ * @param buffer holds one encoded frame
+ * @param size size of buffer (frameMaxEncoded of largest payload)
+ * @param handler receives decoded frames
+ * @param context passed to handler
+ */
+void frameDecoderBegin(struct frameDecoder *decoder, uint8_t *buffer, uint32_t size, frame_handler_t handler, void *context);
+
+/**
+ * Feeds received bytes to decoder
+ * 
+ * @param decoder decoder
+ * @param data received bytes
+ * @param length amount of bytes
+ * 
+ * @note handler is called for each valid frame, damaged frames are skipped
+ */
+void frameDecoderFeed(struct frameDecoder *decoder, const uint8_t *data, uint32_t length);
+
+#endif
\ No newline at end of file
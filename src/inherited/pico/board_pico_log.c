@@ -0,0 +1,133 @@
+/*
+	board_pico_log.c - deferred logging for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <hardware/sync.h>
+#include <hardware/timer.h>
+#include <pico/platform.h>
+
+#include "board_pico_log.h"
+
+#include <stddef.h>
+
+#define LOG_CORES 2u
+#define LOG_MASK (LOG_BUFFER_WORDS - 1u)
+#define LOG_FLUSH_WORDS 64u // words sent per frame
+
+// start of format strings, made by linker from section name when log_strings
+// is allocated, board_pico_log.ld puts them at address 0 and leaves it undefined
+extern const char __start_log_strings[] __attribute__((weak));
+
+struct logRing {
+	uint32_t words[LOG_BUFFER_WORDS]; // records
+	volatile uint32_t head; // words ever written
+	volatile uint32_t tail; // words ever read
+	struct logStats stats; // ring statistics
+};
+
+// each core only writes its own ring so cores never wait on each other
+struct logRing logRings[LOG_CORES];
+
+void RUN_IN_RAM(logWrite) logWrite(const char *format, uint32_t count, const uint32_t *args) {
+
+	if (count > LOG_MAX_ARGS) {
+		count = LOG_MAX_ARGS;
+	}
+
+	struct logRing *ring = &logRings[get_core_num()];
+	const uint32_t words = LOG_HEADER_WORDS + count;
+	const uint32_t header = (count << LOG_COUNT_SHIFT) | ((uint32_t)((uintptr_t)format - (uintptr_t)__start_log_strings) & LOG_OFFSET_MASK);
+	const uint32_t now = time_us_32();
+
+	// only masks this core for the few stores of one record
+	uint32_t status = save_and_disable_interrupts();
+
+	uint32_t head = ring->head;
+	if (LOG_BUFFER_WORDS - (head - ring->tail) < words) {
+		ring->stats.dropped++;
+		restore_interrupts(status);
+		return;
+	}
+
+	ring->words[head & LOG_MASK] = header;
+	ring->words[(head + 1u) & LOG_MASK] = now;
+	for (uint32_t i = 0; i < count; i++) {
+		ring->words[(head + LOG_HEADER_WORDS + i) & LOG_MASK] = args[i];
+	}
+	__dmb();
+	ring->head = head + words;
+	ring->stats.records++;
+
+	restore_interrupts(status);
+}
+
+uint32_t logRead(uint8_t core, uint32_t *words, uint32_t maxWords) {
+
+	if (core >= LOG_CORES || words == NULL) {
+		return 0u;
+	}
+
+	struct logRing *ring = &logRings[core];
+	uint32_t tail = ring->tail;
+	const uint32_t head = ring->head;
+	__dmb();
+
+	uint32_t read = 0u;
+	while (tail != head) {
+		uint32_t length = LOG_HEADER_WORDS + (ring->words[tail & LOG_MASK] >> LOG_COUNT_SHIFT);
+		if (read + length > maxWords) {
+			break;
+		}
+		for (uint32_t i = 0; i < length; i++) {
+			words[read++] = ring->words[(tail + i) & LOG_MASK];
+		}
+		tail += length;
+	}
+
+	__dmb();
+	ring->tail = tail;
+	return read;
+}
+
+uint32_t logFlush(struct frameEncoder *encoder) {
+
+	uint32_t words[LOG_FLUSH_WORDS];
+	uint32_t sent = 0u;
+
+	struct frameHeader header = {
+		.type = FRAME_LOG,
+		.samplePeriodNs = 0u,
+		.firstSample = 0u,
+	};
+
+	for (uint8_t core = 0; core < LOG_CORES; core++) {
+		header.channel = core;
+		uint32_t read;
+		while ((read = logRead(core, words, LOG_FLUSH_WORDS)) != 0u) {
+			frameSend(encoder, &header, words, read * sizeof(uint32_t));
+			sent += read;
+		}
+	}
+
+	return sent;
+}
+
+void logGetStats(uint8_t core, struct logStats *stats) {
+	if (core < LOG_CORES) {
+		*stats = logRings[core].stats;
+	}
+}
\ No newline at end of file
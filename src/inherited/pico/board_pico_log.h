@@ -0,0 +1,138 @@
+/*
+	board_pico_log.h - deferred logging for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_LOG_H
+#define BOARD_PICO_LOG_H
+
+#include "board_pico.h"
+#include "board_pico_frame.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Deferred Log Config
+ * 
+ * LOG_DEFERRED stores the format string in the log_strings
+ * section and only writes its offset plus raw arguments,
+ * formatting is done on the host by tools/log_decode.py
+ * 
+ * Linking board_pico_log.ld makes log_strings a non allocated
+ * section at address 0, so strings stay in the ELF for the
+ * decoder but take no flash, without it they're kept in flash
+ * 
+ * Record (32 bit words, little endian):
+ * 	word 0: argument count << 24 | format offset
+ * 	word 1: time in us
+ * 	words 2+: arguments
+ * 
+ * Arguments are stored as 32 bit integers, so
+ * %d %u %x %c %p work but %s and %f don't
+ * 
+ * Define LOG_DEFERRED_DISABLED to compile every call site out
+****************************/
+
+#ifndef LOG_BUFFER_WORDS
+	#define LOG_BUFFER_WORDS 512u // words in each core's log buffer (power of 2)
+#endif
+
+#define LOG_MAX_ARGS 6u // most arguments per record
+#define LOG_HEADER_WORDS 2u // words before arguments
+#define LOG_COUNT_SHIFT 24u // shift of argument count in word 0
+#define LOG_OFFSET_MASK 0x00FFFFFFu // format offset bits of word 0
+
+struct logStats {
+	uint32_t records; // records written
+	uint32_t dropped; // records dropped because buffer was full
+};
+
+/**
+ * Stores log record
+ * 
+ * @param format format string in log_strings section
+ * @param count amount of arguments
+ * @param args arguments
+ * 
+ * @note use LOG_DEFERRED instead of calling directly
+ */
+void logWrite(const char *format, uint32_t count, const uint32_t *args);
+
+/**
+ * Reads whole records from a core's log buffer
+ * 
+ * @param core core that wrote records
+ * @param words pointer to record words
+ * @param maxWords size of words
+ * 
+ * @return amount of words read
+ */
+uint32_t logRead(uint8_t core, uint32_t *words, uint32_t maxWords);
+
+/**
+ * Sends all waiting records as FRAME_LOG frames
+ * 
+ * @param encoder frame encoder, channel of each frame is core
+ * 
+ * @return amount of words sent
+ */
+uint32_t logFlush(struct frameEncoder *encoder);
+
+/**
+ * Gets log statistics
+ * 
+ * @param core core to get statistics of
+ * @param stats pointer to statistics
+ */
+void logGetStats(uint8_t core, struct logStats *stats);
+
+#define LOG_ARG(value) ((uint32_t)(uintptr_t)(value)) // stores argument as 32 bits
+
+#define LOG_NARGS(...) LOG_NARGS_PICK(0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_PICK(_0, _1, _2, _3, _4, _5, _6, count, ...) count
+
+#define LOG_ARGS_0()
+#define LOG_ARGS_1(a) LOG_ARG(a)
+#define LOG_ARGS_2(a, b) LOG_ARG(a), LOG_ARG(b)
+#define LOG_ARGS_3(a, b, c) LOG_ARG(a), LOG_ARG(b), LOG_ARG(c)
+#define LOG_ARGS_4(a, b, c, d) LOG_ARG(a), LOG_ARG(b), LOG_ARG(c), LOG_ARG(d)
+#define LOG_ARGS_5(a, b, c, d, e) LOG_ARG(a), LOG_ARG(b), LOG_ARG(c), LOG_ARG(d), LOG_ARG(e)
+#define LOG_ARGS_6(a, b, c, d, e, f) LOG_ARG(a), LOG_ARG(b), LOG_ARG(c), LOG_ARG(d), LOG_ARG(e), LOG_ARG(f)
+#define LOG_ARGS_SELECT(count) LOG_ARGS_##count
+#define LOG_ARGS_EXPAND(count) LOG_ARGS_SELECT(count)
+
+#ifndef LOG_DEFERRED_DISABLED
+
+	/**
+	 * Logs message without formatting it on device
+	 * 
+	 * @param format string literal printf format
+	 * @param ... up to 6 integer or pointer arguments
+	 */
+	#define LOG_DEFERRED(format, ...) do { \
+		static const char logFormat[] __attribute__((section("log_strings"), used)) = format; \
+		const uint32_t logArgs[LOG_MAX_ARGS + 1u] = {0, LOG_ARGS_EXPAND(LOG_NARGS(__VA_ARGS__))(__VA_ARGS__)}; \
+		logWrite(logFormat, LOG_NARGS(__VA_ARGS__), &logArgs[1]); \
+	} while (0)
+
+#else
+
+	#define LOG_DEFERRED(format, ...) do {} while (0)
+
+#endif
+
+#endif
\ No newline at end of file
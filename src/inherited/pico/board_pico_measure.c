@@ -0,0 +1,187 @@
+/*
+	board_pico_measure.c - waveform measurements for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "board_pico_measure.h"
+
+#include <stddef.h>
+
+// squares of 12 bit samples fit 32 bits for this many samples
+#define SQUARE_BLOCK 255u
+
+#define NS_PER_S 1000000000ull
+#define MILLI_PER_UNIT 1000ull
+
+/**
+ * Integer square root
+ * 
+ * @param value value to take root of
+ * 
+ * @return floor of square root
+ */
+static uint32_t isqrt64(uint64_t value) {
+
+	uint64_t root = 0u;
+	uint64_t bit = ((uint64_t)1) << 62;
+
+	while (bit > value) {
+		bit >>= 2;
+	}
+	while (bit != 0u) {
+		if (value >= root + bit) {
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (uint32_t)root;
+}
+
+void measureBegin(struct measureState *state, sample_t level, sample_t hysteresis) {
+	state->level = level;
+	state->hysteresis = hysteresis < level ? hysteresis : level;
+	state->armed = false;
+	state->min = (sample_t)SAMPLE_MAX;
+	state->max = 0;
+	state->count = 0u;
+	state->sum = 0u;
+	state->sumSquares = 0u;
+	state->high = 0u;
+	state->crossings = 0u;
+	state->firstCrossing = 0u;
+	state->lastCrossing = 0u;
+	state->highSinceFirst = 0u;
+	state->highAtLast = 0u;
+}
+
+void measureRestartAuto(struct measureState *state, sample_t hysteresis) {
+	sample_t level = state->level;
+	if (state->count != 0u) {
+		level = (sample_t)(((uint32_t)state->min + state->max) >> 1);
+	}
+	measureBegin(state, level, hysteresis);
+}
+
+void RUN_IN_RAM(measureFeed) measureFeed(struct measureState *state, const sample_t *samples, uint32_t count) {
+
+	const uint32_t level = state->level;
+	const uint32_t armLevel = state->level - state->hysteresis;
+
+	uint32_t min = state->min;
+	uint32_t max = state->max;
+	uint32_t position = state->count;
+	uint32_t high = 0u;
+	uint32_t highSinceFirst = state->highSinceFirst;
+	bool armed = state->armed;
+
+	while (count > 0u) {
+
+		uint32_t block = count < SQUARE_BLOCK ? count : SQUARE_BLOCK;
+		uint32_t sum = 0u;
+		uint32_t sumSquares = 0u;
+
+		for (uint32_t i = 0; i < block; i++) {
+
+			uint32_t sample = samples[i];
+			if (sample < min) {
+				min = sample;
+			}
+			if (sample > max) {
+				max = sample;
+			}
+			sum += sample;
+			sumSquares += sample * sample;
+
+			uint32_t isHigh = sample >= level;
+			high += isHigh;
+			highSinceFirst += isHigh;
+
+			if (!armed) {
+				armed = sample < armLevel;
+			}
+			else if (isHigh) {
+				armed = false;
+				if (state->crossings == 0u) {
+					state->firstCrossing = position + i;
+					highSinceFirst = 1u;
+				}
+				// crossing sample belongs to next period
+				state->highAtLast = highSinceFirst - 1u;
+				state->lastCrossing = position + i;
+				state->crossings++;
+			}
+		}
+
+		state->sum += sum;
+		state->sumSquares += sumSquares;
+		position += block;
+		samples += block;
+		count -= block;
+	}
+
+	state->min = (sample_t)min;
+	state->max = (sample_t)max;
+	state->count = position;
+	state->high += high;
+	state->highSinceFirst = highSinceFirst;
+	state->armed = armed;
+}
+
+bool measureGetResults(const struct measureState *state, uint32_t sampleRate, struct measureResults *results) {
+
+	if (state->count == 0u) {
+		return false;
+	}
+
+	const uint64_t count = state->count;
+
+	results->min = state->min;
+	results->max = state->max;
+	results->peakToPeak = (sample_t)(state->max - state->min);
+	results->mean = (sample_t)((state->sum + (count >> 1)) / count);
+
+	// mean square in Q16 and mean in Q8 keep fractions without overflowing 64 bits
+	uint64_t meanSquare = ((state->sumSquares / count) << 16) + (((state->sumSquares % count) << 16) / count);
+	uint64_t meanQ8 = (state->sum << 8) / count;
+	uint64_t variance = meanSquare - meanQ8 * meanQ8;
+	if (meanQ8 * meanQ8 > meanSquare) {
+		variance = 0u;
+	}
+	results->rms = (sample_t)((isqrt64(meanSquare) + 0x80u) >> 8);
+	results->acRms = (sample_t)((isqrt64(variance) + 0x80u) >> 8);
+
+	results->frequencyMilliHz = 0u;
+	results->periodNs = 0u;
+	results->duty = 0u;
+
+	if (state->crossings >= 2u && sampleRate != 0u) {
+		uint64_t periods = state->crossings - 1u;
+		uint64_t span = state->lastCrossing - state->firstCrossing;
+		results->frequencyMilliHz = (uint32_t)((periods * sampleRate * MILLI_PER_UNIT + (span >> 1)) / span);
+		results->periodNs = (uint32_t)((span * NS_PER_S + ((periods * sampleRate) >> 1)) / (periods * sampleRate));
+		results->duty = (uint16_t)(((uint64_t)state->highAtLast * MEASURE_DUTY_SCALE + (span >> 1)) / span);
+	}
+
+	return true;
+}
+
+uint32_t measureCodeToMV(uint32_t code) {
+	return (code * ADC_REF_MV + (SAMPLE_MAX >> 1)) / SAMPLE_MAX;
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+/*
+	board_pico_measure.h - waveform measurements for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_MEASURE_H
+#define BOARD_PICO_MEASURE_H
+
+#include "board_pico.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Measurement Config
+ * 
+ * Statistics are updated as each buffer arrives
+ * so results never need another pass over a capture
+****************************/
+
+#ifndef ADC_REF_MV
+	#define ADC_REF_MV 3300u // ADC reference voltage in mV
+#endif
+
+#define MEASURE_DUTY_SCALE 10000u // duty cycle units per 100%
+
+struct measureState {
+	sample_t level; // crossing level
+	sample_t hysteresis; // distance below level signal falls before next crossing
+	bool armed; // signal fell below level - hysteresis since last crossing
+	sample_t min; // smallest sample
+	sample_t max; // largest sample
+	uint32_t count; // amount of samples measured
+	uint64_t sum; // sum of samples
+	uint64_t sumSquares; // sum of squared samples
+	uint32_t high; // samples at or above level
+	uint32_t crossings; // rising crossings through level
+	uint32_t firstCrossing; // sample number of first crossing
+	uint32_t lastCrossing; // sample number of last crossing
+	uint32_t highSinceFirst; // samples at or above level since first crossing
+	uint32_t highAtLast; // highSinceFirst at last crossing
+};
+
+struct measureResults {
+	sample_t min; // smallest sample
+	sample_t max; // largest sample
+	sample_t peakToPeak; // max - min
+	sample_t mean; // average sample
+	sample_t rms; // root mean square including DC
+	sample_t acRms; // root mean square without DC
+	uint32_t frequencyMilliHz; // frequency in mHz, 0 if less than one period
+	uint32_t periodNs; // period in ns, 0 if less than one period
+	uint16_t duty; // duty cycle in MEASURE_DUTY_SCALE units
+};
+
+/**
+ * Starts new measurement
+ * 
+ * @param state measurement to start
+ * @param level crossing level for frequency and duty
+ * @param hysteresis distance below level signal falls before next crossing
+ */
+void measureBegin(struct measureState *state, sample_t level, sample_t hysteresis);
+
+/**
+ * Starts new measurement with level in middle of previous measurement
+ * 
+ * @param state measurement to restart
+ * @param hysteresis distance below level signal falls before next crossing
+ * 
+ * @note keeps previous level if previous measurement is empty
+ */
+void measureRestartAuto(struct measureState *state, sample_t hysteresis);
+
+/**
+ * Updates measurement with samples
+ * 
+ * @param state measurement to update
+ * @param samples samples to measure
+ * @param count amount of samples
+ */
+void measureFeed(struct measureState *state, const sample_t *samples, uint32_t count);
+
+/**
+ * Gets results of measurement
+ * 
+ * @param state measurement
+ * @param sampleRate sample rate in Hz
+ * @param results pointer to results
+ * 
+ * @return whether any samples were measured
+ * 
+ * @note frequency, period and duty only use whole periods between crossings
+ */
+bool measureGetResults(const struct measureState *state, uint32_t sampleRate, struct measureResults *results);
+
+/**
+ * Converts ADC codes to mV
+ * 
+ * @param code ADC code or code difference
+ * 
+ * @return voltage in mV
+ */
+uint32_t measureCodeToMV(uint32_t code);
+
+#endif
\ No newline at end of file
@@ -23,6 +23,11 @@
 #include <hardware/flash.h>
 #include <hardware/sync.h>
 #include <pico/multicore.h>
+#include <pico/time.h>
+
+#include "board_pico_arena.h"
+#include "board_pico_nvm.h"
+#include "board_pico_trace.h"
 
 #ifndef NVM_SIZE
 	#define NVM_SIZE FLASH_NVM_SIZE // size in bytes of NVM
@@ -35,10 +40,15 @@ bool chainLock = false; // prevents multiple erease/write of flash
 #define PAGE_SIZE 256u
 
 #define FLASH_START (uint32_t)PICO_FLASH_SIZE_BYTES - SECTOR_SIZE
+#define RESERVED_START (SECTOR_SIZE - NVM_RESERVED_SIZE) // start of board data
 
-uint8_t memoryNVM[SECTOR_SIZE];
+uint8_t *memoryNVM = NULL; // shadow of NVM sector, persistent in boardArena
 nvm_size_t internalSize;
 
+struct nvmStats nvmStatistics;
+volatile bool nvmQueued = false; // core 1 commit waiting for core 0
+bool nvmCommitting = false; // core 0 is between pages of a commit
+
 enum NVMStartCode nvmInit(nvm_size_t setNVMSize) {
 
 	if (nvmBegan) {
@@ -49,13 +59,21 @@ enum NVMStartCode nvmInit(nvm_size_t setNVMSize) {
 		return NVM_INVALID_SIZE;
 	}
 
-	if (setNVMSize > SECTOR_SIZE) {
+	if (setNVMSize > RESERVED_START) {
 		return NVM_INVALID_SIZE;
 	}
 
+	if (memoryNVM == NULL) {
+		memoryNVM = (uint8_t*)arenaAllocPersistent(&boardArena, SECTOR_SIZE, 0u);
+		if (memoryNVM == NULL) {
+			return NVM_FAILED;
+		}
+	}
+
 	internalSize = setNVMSize;
 
-	memcpy((void*)memoryNVM, (const void*)XIP_BASE + FLASH_START, internalSize);
+	// whole sector is loaded so reserved data survives commits
+	memcpy((void*)memoryNVM, (const void*)XIP_BASE + FLASH_START, SECTOR_SIZE);
 
 	nvmBegan = true;
 
@@ -68,7 +86,7 @@ enum NVMStartCode nvmInit(nvm_size_t setNVMSize) {
 
 bool nvmMaxSize(nvm_size_t *size) {
 	if (nvmBegan) {
-		*size = SECTOR_SIZE;
+		*size = RESERVED_START;
 		return true;
 	}
 
@@ -76,20 +94,75 @@ bool nvmMaxSize(nvm_size_t *size) {
 	return false;
 }
 
-void nvmCommit() {
+bool nvmStarted(void) {
+	return nvmBegan;
+}
+
+/**
+ * Commits on core 0 for core 1
+ * 
+ * @return 0 once committed, else us to try again in
+ */
+int64_t nvmCommitAlarm(alarm_id_t id, void *param) {
+	(void)id;
+	(void)param;
+
+	// interrupted commit would be erased under it, so wait for it to end
+	if (nvmCommitting) {
+		return NVM_QUEUE_DELAY_US;
+	}
+	nvmQueued = false;
+	nvmCommit();
+	return 0;
+}
+
+void RUN_IN_RAM(nvmCommit) nvmCommit() {
 
-	if (!chainLock) {
+	// shadow sector is only there once started,
+	// chained writes commit once they're all done
+	if (!nvmBegan || chainLock) {
+		return;
+	}
 
+	// core 1 can't pause core 0, which runs from flash,
+	// so the default alarm pool runs commit on core 0
+	if (get_core_num() != 0u) {
+		if (!nvmQueued) {
+			nvmQueued = true;
+			if (add_alarm_in_us(NVM_QUEUE_DELAY_US, nvmCommitAlarm, NULL, false) <= 0) {
+				nvmQueued = false;
+				nvmStatistics.failed++;
+				return;
+			}
+			nvmStatistics.queued++;
+		}
+		return;
+	}
+
+	TRACE_BEGIN(TRACE_NVM_COMMIT);
+	nvmCommitting = true;
+
+	startThreadSafety();
+	flash_range_erase(FLASH_START, SECTOR_SIZE);
+	endThreadSafety();
+	
+	for (int16_t page = 0; page < SECTOR_SIZE / PAGE_SIZE; page++) {
 		startThreadSafety();
-		flash_range_erase(FLASH_START, SECTOR_SIZE);
+		flash_range_program(FLASH_START + (page*PAGE_SIZE), (uint8_t*)(memoryNVM + page*PAGE_SIZE), PAGE_SIZE);
 		endThreadSafety();
-		
-		for (int16_t page = 0; page < SECTOR_SIZE / PAGE_SIZE; page++) {
-			startThreadSafety();
-			flash_range_program(FLASH_START + (page*PAGE_SIZE), (uint8_t*)(memoryNVM + page*PAGE_SIZE), PAGE_SIZE);
-			endThreadSafety();
-		}
 	}
+
+	nvmCommitting = false;
+	nvmStatistics.commits++;
+	TRACE_END(TRACE_NVM_COMMIT);
+}
+
+bool nvmCommitPending(void) {
+	return nvmQueued;
+}
+
+void nvmGetStats(struct nvmStats *stats) {
+	*stats = nvmStatistics;
 }
 
 enum NVMDefaultCode nvmSetDefaults(void) {
@@ -176,6 +249,39 @@ bool nvmGetCharArray(nvm_size_t key, char* value, uint8_t maxLength) {
 	return false;
 }
 
+bool nvmWriteReserved(uint16_t offset, const void *data, uint16_t length) {
+
+	if (!nvmBegan || data == NULL) {
+		return false;
+	}
+	if ((uint32_t)offset + length > NVM_RESERVED_SIZE) {
+		return false;
+	}
+
+	memcpy((void*)(memoryNVM + RESERVED_START + offset), data, length);
+	nvmCommit();
+	return true;
+}
+
+bool nvmGetReserved(uint16_t offset, void *data, uint16_t length) {
+
+	if (data == NULL) {
+		return false;
+	}
+	if ((uint32_t)offset + length > NVM_RESERVED_SIZE) {
+		return false;
+	}
+
+	// reads flash directly so board data is available before nvmInit
+	if (!nvmBegan) {
+		memcpy(data, (const void*)(XIP_BASE + FLASH_START + RESERVED_START + offset), length);
+		return true;
+	}
+
+	memcpy(data, (const void*)(memoryNVM + RESERVED_START + offset), length);
+	return true;
+}
+
 #define WRITE_NVM(key, value) \
 	if (!nvmBegan) { \
 		return false; \
@@ -205,39 +311,39 @@ bool nvmGetCharArray(nvm_size_t key, char* value, uint8_t maxLength) {
 	} \
 	return true; \
 
-bool nvmWriteBool(nvm_size_t key, bool value) {
+bool RUN_IN_RAM(nvmWriteBool) nvmWriteBool(nvm_size_t key, bool value) {
 	WRITE_NVM(key, value);
 }
 
-bool nvmWriteI8(nvm_size_t key, int8_t value) {
+bool RUN_IN_RAM(nvmWriteI8) nvmWriteI8(nvm_size_t key, int8_t value) {
 	WRITE_NVM(key, value);
 }
 
-bool nvmWriteUI8(nvm_size_t key, uint8_t value) {
+bool RUN_IN_RAM(nvmWriteUI8) nvmWriteUI8(nvm_size_t key, uint8_t value) {
 	WRITE_NVM(key, value);
 }
 
-bool nvmWriteI16(nvm_size_t key, int16_t value) {
+bool RUN_IN_RAM(nvmWriteI16) nvmWriteI16(nvm_size_t key, int16_t value) {
 	WRITE_NVM(key, value);
 }
 
-bool nvmWriteUI16(nvm_size_t key, uint16_t value) {
+bool RUN_IN_RAM(nvmWriteUI16) nvmWriteUI16(nvm_size_t key, uint16_t value) {
 	WRITE_NVM(key, value);
 }
 
-bool nvmWriteI32(nvm_size_t key, int32_t value) {
+bool RUN_IN_RAM(nvmWriteI32) nvmWriteI32(nvm_size_t key, int32_t value) {
 	WRITE_NVM(key, value);
 }
 
-bool nvmWriteUI32(nvm_size_t key, uint32_t value) {
+bool RUN_IN_RAM(nvmWriteUI32) nvmWriteUI32(nvm_size_t key, uint32_t value) {
 	WRITE_NVM(key, value);
 }
 
-bool nvmWriteI64(nvm_size_t key, int64_t value) {
+bool RUN_IN_RAM(nvmWriteI64) nvmWriteI64(nvm_size_t key, int64_t value) {
 	WRITE_NVM(key, value);
 }
 
-bool nvmWriteUI64(nvm_size_t key, uint64_t value) {
+bool RUN_IN_RAM(nvmWriteUI64) nvmWriteUI64(nvm_size_t key, uint64_t value) {
 	WRITE_NVM(key, value);
 }
 
@@ -277,39 +383,39 @@ bool nvmWriteDouble(nvm_size_t key, double value) {
 	}
 }
 
-bool nvmGetBool(nvm_size_t key, bool *value, bool canDefault) {
+bool RUN_IN_RAM(nvmGetBool) nvmGetBool(nvm_size_t key, bool *value, bool canDefault) {
 	GET_NVM(key, value, bool, canDefault, DEFAULT_BOOL);
 }
 
-bool nvmGetI8(nvm_size_t key, int8_t *value, bool canDefault) {
+bool RUN_IN_RAM(nvmGetI8) nvmGetI8(nvm_size_t key, int8_t *value, bool canDefault) {
 	GET_NVM(key, value, int8_t, canDefault, (int8_t)DEFAULT_INT);
 }
 
-bool nvmGetUI8(nvm_size_t key, uint8_t *value, bool canDefault) {
+bool RUN_IN_RAM(nvmGetUI8) nvmGetUI8(nvm_size_t key, uint8_t *value, bool canDefault) {
 	GET_NVM(key, value, uint8_t, canDefault, (uint8_t)DEFAULT_INT);
 }
 
-bool nvmGetI16(nvm_size_t key, int16_t *value, bool canDefault) {
+bool RUN_IN_RAM(nvmGetI16) nvmGetI16(nvm_size_t key, int16_t *value, bool canDefault) {
 	GET_NVM(key, value, int16_t, canDefault, (int16_t)DEFAULT_INT);
 }
 
-bool nvmGetUI16(nvm_size_t key, uint16_t *value, bool canDefault) {
+bool RUN_IN_RAM(nvmGetUI16) nvmGetUI16(nvm_size_t key, uint16_t *value, bool canDefault) {
 	GET_NVM(key, value, uint16_t, canDefault, (uint16_t)DEFAULT_INT);
 }
 
-bool nvmGetI32(nvm_size_t key, int32_t *value, bool canDefault) {
+bool RUN_IN_RAM(nvmGetI32) nvmGetI32(nvm_size_t key, int32_t *value, bool canDefault) {
 	GET_NVM(key, value, int32_t, canDefault, (int32_t)DEFAULT_INT);
 }
 
-bool nvmGetUI32(nvm_size_t key, uint32_t *value, bool canDefault) {
+bool RUN_IN_RAM(nvmGetUI32) nvmGetUI32(nvm_size_t key, uint32_t *value, bool canDefault) {
 	GET_NVM(key, value, uint32_t, canDefault, (uint32_t)DEFAULT_INT);
 }
 
-bool nvmGetI64(nvm_size_t key, int64_t *value, bool canDefault) {
+bool RUN_IN_RAM(nvmGetI64) nvmGetI64(nvm_size_t key, int64_t *value, bool canDefault) {
 	GET_NVM(key, value, int64_t, canDefault, (int64_t)DEFAULT_INT);
 }
 
-bool nvmGetUI64(nvm_size_t key, uint64_t *value, bool canDefault) {
+bool RUN_IN_RAM(nvmGetUI64) nvmGetUI64(nvm_size_t key, uint64_t *value, bool canDefault) {
 	GET_NVM(key, value, uint64_t, canDefault, (uint64_t)DEFAULT_INT);
 }
 
@@ -0,0 +1,113 @@
+/*
+	board_pico_nvm.h - nvm configuration for Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_NVM_H
+#define BOARD_PICO_NVM_H
+
+#include "board_pico.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Commit Config
+ * 
+ * Flash can only be written from core 0 since core 1
+ * can't pause core 0 while it runs from flash, nvmCommit
+ * on core 1 queues the commit to core 0 through the
+ * default alarm pool and returns straight away
+ * 
+ * Writes on core 1 report success once the shadow sector
+ * holds them, nvmCommitPending tells when flash has them too
+ * and nvmGetStats counts commits that couldn't be queued
+****************************/
+
+#ifndef NVM_QUEUE_DELAY_US
+	#define NVM_QUEUE_DELAY_US 100u // delay before core 0 runs a queued commit
+#endif
+
+struct nvmStats {
+	uint32_t commits; // sectors written to flash
+	uint32_t queued; // commits core 1 handed to core 0
+	uint32_t failed; // commits core 1 couldn't queue, data is only in shadow sector
+};
+
+/****************************
+ * Reserved NVM Config
+ * 
+ * End of NVM sector is kept for board data
+ * and isn't part of the size given to nvmInit,
+ * nvmMaxSize reports what's left for user keys,
+ * 3840 bytes with the default NVM_RESERVED_SIZE
+****************************/
+
+#ifndef NVM_RESERVED_SIZE
+	#define NVM_RESERVED_SIZE 256u // bytes kept at end of sector for board data
+#endif
+
+#define NVM_RESERVED_CALIBRATION 0u // offset of ADC calibration
+#define NVM_RESERVED_CALIBRATION_SIZE 192u // bytes kept for ADC calibration
+#define NVM_RESERVED_CLOCK 192u // offset of clock profile
+#define NVM_RESERVED_CLOCK_SIZE 16u // bytes kept for clock profile
+
+/**
+ * Checks if NVM is started
+ * 
+ * @return whether nvmInit succeeded
+ */
+bool nvmStarted(void);
+
+/**
+ * Checks if a commit queued from core 1 hasn't reached flash yet
+ * 
+ * @return whether commit is waiting on core 0
+ */
+bool nvmCommitPending(void);
+
+/**
+ * Gets NVM commit statistics
+ * 
+ * @param stats pointer to statistics
+ */
+void nvmGetStats(struct nvmStats *stats);
+
+/**
+ * Writes board data to reserved NVM and commits once
+ * 
+ * @param offset offset into reserved NVM
+ * @param data data to write
+ * @param length amount of bytes
+ * 
+ * @return whether data was written
+ */
+bool nvmWriteReserved(uint16_t offset, const void *data, uint16_t length);
+
+/**
+ * Gets board data from reserved NVM
+ * 
+ * @param offset offset into reserved NVM
+ * @param data pointer to data
+ * @param length amount of bytes
+ * 
+ * @return whether data was read
+ * 
+ * @note reads flash directly if NVM isn't started
+ */
+bool nvmGetReserved(uint16_t offset, void *data, uint16_t length);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,243 @@
+/*
+	board_pico_pack.c - packed sample storage for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "board_pico_pack.h"
+
+#include <stddef.h>
+
+#define PAIR_BYTES 3u // bytes per two 12 bit samples
+#define BLOCK_SAMPLES 8u // 12 bit samples per three words
+#define SAMPLE_MASK ((uint32_t)SAMPLE_MAX)
+#define BYTE_SHIFT (SAMPLE_BITS - 8) // shift between 12 bit and 8 bit samples
+
+typedef uint32_t __attribute__((__may_alias__)) pack_word_t; // word of packed bytes
+
+/**
+ * Packs two samples into 24 bits
+ */
+static inline uint32_t packPair(const sample_t *samples) {
+	return (samples[0] & SAMPLE_MASK) | ((samples[1] & SAMPLE_MASK) << SAMPLE_BITS);
+}
+
+/**
+ * Checks if pointer can be read and written as words
+ */
+static inline bool wordAligned(const void *pointer) {
+	return ((uintptr_t)pointer & 3u) == 0u;
+}
+
+uint32_t packBytes(enum PackMode mode, uint32_t samples) {
+	if (mode == PACK_8_BIT) {
+		return samples;
+	}
+	return (samples / 2u) * PAIR_BYTES + (samples & 1u) * 2u;
+}
+
+bool packBegin(struct packedSamples *packed, uint8_t *data, uint32_t bytes, enum PackMode mode) {
+
+	if (packed == NULL || data == NULL) {
+		return false;
+	}
+
+	packed->data = data;
+	packed->mode = mode;
+	packed->count = 0u;
+	if (mode == PACK_8_BIT) {
+		packed->capacity = bytes;
+	}
+	else {
+		packed->capacity = (bytes / PAIR_BYTES) * 2u + (bytes % PAIR_BYTES == 2u ? 1u : 0u);
+	}
+	return true;
+}
+
+void packClear(struct packedSamples *packed) {
+	packed->count = 0u;
+}
+
+/**
+ * Appends 12 bit samples
+ */
+static uint32_t RUN_IN_RAM(pack12) pack12(struct packedSamples *packed, const sample_t *samples, uint32_t count) {
+
+	uint32_t index = packed->count;
+	const sample_t *end = samples + count;
+
+	// finishes pair left half written by last call
+	if ((index & 1u) && samples < end) {
+		uint8_t *pair = packed->data + (index / 2u) * PAIR_BYTES;
+		uint32_t sample = *samples++ & SAMPLE_MASK;
+		pair[1] = (uint8_t)((pair[1] & 0x0Fu) | (sample << 4));
+		pair[2] = (uint8_t)(sample >> 4);
+		index++;
+	}
+
+	uint8_t *bytes = packed->data + (index / 2u) * PAIR_BYTES;
+
+	// 8 samples fill three words exactly
+	if (wordAligned(bytes)) {
+		pack_word_t *words = (pack_word_t*)bytes;
+		while (end - samples >= (ptrdiff_t)BLOCK_SAMPLES) {
+			uint32_t pair0 = packPair(samples);
+			uint32_t pair1 = packPair(samples + 2);
+			uint32_t pair2 = packPair(samples + 4);
+			uint32_t pair3 = packPair(samples + 6);
+			words[0] = pair0 | (pair1 << 24);
+			words[1] = (pair1 >> 8) | (pair2 << 16);
+			words[2] = (pair2 >> 16) | (pair3 << 8);
+			words += 3;
+			samples += BLOCK_SAMPLES;
+			index += BLOCK_SAMPLES;
+		}
+		bytes = (uint8_t*)words;
+	}
+
+	while (end - samples >= 2) {
+		uint32_t pair = packPair(samples);
+		bytes[0] = (uint8_t)pair;
+		bytes[1] = (uint8_t)(pair >> 8);
+		bytes[2] = (uint8_t)(pair >> 16);
+		bytes += PAIR_BYTES;
+		samples += 2;
+		index += 2u;
+	}
+
+	if (samples < end) {
+		uint32_t sample = *samples & SAMPLE_MASK;
+		bytes[0] = (uint8_t)sample;
+		bytes[1] = (uint8_t)(sample >> 8);
+		index++;
+	}
+
+	return index - packed->count;
+}
+
+/**
+ * Appends 8 bit samples
+ */
+static uint32_t RUN_IN_RAM(pack8) pack8(struct packedSamples *packed, const sample_t *samples, uint32_t count) {
+
+	uint8_t *bytes = packed->data + packed->count;
+	uint32_t i = 0;
+
+	while (i < count && !wordAligned(bytes + i)) {
+		bytes[i] = (uint8_t)((samples[i] & SAMPLE_MASK) >> BYTE_SHIFT);
+		i++;
+	}
+	for (; i + 4u <= count; i += 4u) {
+		*(pack_word_t*)(bytes + i) = ((samples[i] & SAMPLE_MASK) >> BYTE_SHIFT)
+			| (((samples[i + 1u] & SAMPLE_MASK) >> BYTE_SHIFT) << 8)
+			| (((samples[i + 2u] & SAMPLE_MASK) >> BYTE_SHIFT) << 16)
+			| (((samples[i + 3u] & SAMPLE_MASK) >> BYTE_SHIFT) << 24);
+	}
+	for (; i < count; i++) {
+		bytes[i] = (uint8_t)((samples[i] & SAMPLE_MASK) >> BYTE_SHIFT);
+	}
+
+	return count;
+}
+
+uint32_t packAppend(struct packedSamples *packed, const sample_t *samples, uint32_t count) {
+
+	if (count > packed->capacity - packed->count) {
+		count = packed->capacity - packed->count;
+	}
+	if (count == 0u) {
+		return 0u;
+	}
+
+	uint32_t stored;
+	if (packed->mode == PACK_8_BIT) {
+		stored = pack8(packed, samples, count);
+	}
+	else {
+		stored = pack12(packed, samples, count);
+	}
+	packed->count += stored;
+	return stored;
+}
+
+sample_t RUN_IN_RAM(packGet) packGet(const struct packedSamples *packed, uint32_t index) {
+
+	if (index >= packed->count) {
+		return 0;
+	}
+
+	if (packed->mode == PACK_8_BIT) {
+		uint32_t byte = packed->data[index];
+		return (sample_t)((byte << BYTE_SHIFT) | (byte >> (8 - BYTE_SHIFT)));
+	}
+
+	const uint8_t *pair = packed->data + (index / 2u) * PAIR_BYTES;
+	if (index & 1u) {
+		return (sample_t)((pair[1] >> 4) | ((uint32_t)pair[2] << 4));
+	}
+	return (sample_t)(pair[0] | (((uint32_t)pair[1] & 0x0Fu) << 8));
+}
+
+uint32_t RUN_IN_RAM(packRead) packRead(const struct packedSamples *packed, uint32_t start, sample_t *samples, uint32_t count) {
+
+	if (start >= packed->count) {
+		return 0u;
+	}
+	if (count > packed->count - start) {
+		count = packed->count - start;
+	}
+
+	uint32_t i = 0;
+
+	if (packed->mode == PACK_8_BIT) {
+		const uint8_t *bytes = packed->data + start;
+		for (; i < count; i++) {
+			uint32_t byte = bytes[i];
+			samples[i] = (sample_t)((byte << BYTE_SHIFT) | (byte >> (8 - BYTE_SHIFT)));
+		}
+		return count;
+	}
+
+	// reads single samples until start of three word block
+	while (i < count && ((start + i) % BLOCK_SAMPLES) != 0u) {
+		samples[i] = packGet(packed, start + i);
+		i++;
+	}
+
+	const uint8_t *bytes = packed->data + ((start + i) / 2u) * PAIR_BYTES;
+	if (wordAligned(bytes)) {
+		const pack_word_t *words = (const pack_word_t*)bytes;
+		for (; i + BLOCK_SAMPLES <= count; i += BLOCK_SAMPLES) {
+			uint32_t word0 = words[0];
+			uint32_t word1 = words[1];
+			uint32_t word2 = words[2];
+			samples[i] = (sample_t)(word0 & SAMPLE_MASK);
+			samples[i + 1u] = (sample_t)((word0 >> 12) & SAMPLE_MASK);
+			samples[i + 2u] = (sample_t)(((word0 >> 24) | (word1 << 8)) & SAMPLE_MASK);
+			samples[i + 3u] = (sample_t)((word1 >> 4) & SAMPLE_MASK);
+			samples[i + 4u] = (sample_t)((word1 >> 16) & SAMPLE_MASK);
+			samples[i + 5u] = (sample_t)(((word1 >> 28) | (word2 << 4)) & SAMPLE_MASK);
+			samples[i + 6u] = (sample_t)((word2 >> 8) & SAMPLE_MASK);
+			samples[i + 7u] = (sample_t)(word2 >> 20);
+			words += 3;
+		}
+	}
+
+	for (; i < count; i++) {
+		samples[i] = packGet(packed, start + i);
+	}
+
+	return count;
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+/*
+	board_pico_pack.h - packed sample storage for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_PACK_H
+#define BOARD_PICO_PACK_H
+
+#include "board_pico.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Packed Sample Config
+ * 
+ * 12 bit mode stores two samples in three bytes:
+ * 	byte 0: sample 0 bits 0-7
+ * 	byte 1: sample 0 bits 8-11, sample 1 bits 0-3
+ * 	byte 2: sample 1 bits 4-11
+ * 
+ * 8 bit mode stores top 8 bits of each sample
+****************************/
+
+enum PackMode {
+	PACK_12_BIT, // 2 samples in 3 bytes
+	PACK_8_BIT, // 1 sample in 1 byte, low 4 bits dropped
+};
+
+struct packedSamples {
+	uint8_t *data; // packed storage
+	uint32_t capacity; // max samples that fit in data
+	uint32_t count; // samples stored
+	enum PackMode mode; // storage format
+};
+
+/**
+ * Gets bytes needed to store samples
+ * 
+ * @param mode storage format
+ * @param samples amount of samples
+ * 
+ * @return amount of bytes
+ */
+uint32_t packBytes(enum PackMode mode, uint32_t samples);
+
+/**
+ * Sets up packed storage
+ * 
+ * @param packed storage to set up
+ * @param data storage space
+ * @param bytes size of storage space
+ * @param mode storage format
+ * 
+ * @return whether storage was set up
+ */
+bool packBegin(struct packedSamples *packed, uint8_t *data, uint32_t bytes, enum PackMode mode);
+
+/**
+ * Appends samples to packed storage
+ * 
+ * @param packed storage to append to
+ * @param samples samples to pack
+ * @param count amount of samples
+ * 
+ * @return amount of samples stored
+ * 
+ * @note meant to run as each DMA buffer completes, odd counts carry into next call
+ */
+uint32_t packAppend(struct packedSamples *packed, const sample_t *samples, uint32_t count);
+
+/**
+ * Unpacks run of samples
+ * 
+ * @param packed storage to read
+ * @param start index of first sample
+ * @param samples pointer to unpacked samples
+ * @param count amount of samples
+ * 
+ * @return amount of samples unpacked
+ * 
+ * @note 8 bit samples are scaled back to 12 bits
+ */
+uint32_t packRead(const struct packedSamples *packed, uint32_t start, sample_t *samples, uint32_t count);
+
+/**
+ * Gets single sample
+ * 
+ * @param packed storage to read
+ * @param index index of sample
+ * 
+ * @return sample, 0 if index isn't stored
+ */
+sample_t packGet(const struct packedSamples *packed, uint32_t index);
+
+/**
+ * Empties packed storage
+ * 
+ * @param packed storage to empty
+ */
+void packClear(struct packedSamples *packed);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,297 @@
+/*
+	board_pico_perf.c - performance benchmarks for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+#include <nvm/nvm.h>
+
+#include <stdio.h>
+#include <hardware/structs/systick.h>
+#include <hardware/timer.h>
+#include <pico/platform.h>
+
+#include "board_pico_nvm.h"
+#include "board_pico_perf.h"
+#include "board_pico_serial.h"
+#include "board_pico_timer.h"
+
+#include <stddef.h>
+
+#define PERF_OVERHEAD_RUNS 8u // empty counts overhead is taken from
+
+struct perfSysTick perfSaved; // SysTick before perfBegin
+uint32_t perfOverhead = 0u; // cycles perfStart and perfStop add
+
+struct perfTimerState {
+	volatile uint32_t fired; // ticks that ran
+	volatile uint32_t late; // ticks that ran a period or more late
+	volatile uint32_t worstLateUS; // most time a tick ran after it was due
+	volatile uint64_t totalLateUS; // time every tick ran after it was due
+	uint32_t periodUS; // time between ticks
+};
+
+struct perfTimerState perfTimer;
+
+void perfCyclesReset(struct perfCycles *cycles) {
+	cycles->count = 0u;
+	cycles->total = 0u;
+	cycles->min = UINT32_MAX;
+	cycles->max = 0u;
+}
+
+void perfSysTickBorrow(struct perfSysTick *saved, uint32_t span) {
+
+	const uint32_t counting = PERF_SYSTICK_PROCESSOR | PERF_SYSTICK_ENABLE;
+
+	saved->csr = systick_hw->csr;
+	saved->rvr = systick_hw->rvr & PERF_CYCLES_MAX;
+	saved->taken = (saved->csr & counting) != counting || saved->rvr < span;
+	if (!saved->taken) {
+		return;
+	}
+
+	// free running from processor clock, no interrupt
+	systick_hw->rvr = PERF_CYCLES_MAX;
+	systick_hw->cvr = 0u;
+	systick_hw->csr = counting;
+}
+
+void perfSysTickReturn(const struct perfSysTick *saved) {
+	if (!saved->taken) {
+		return;
+	}
+
+	// clearing makes it reload from its own period instead of ours
+	systick_hw->csr = saved->csr & ~PERF_SYSTICK_ENABLE;
+	systick_hw->rvr = saved->rvr;
+	systick_hw->cvr = 0u;
+	systick_hw->csr = saved->csr;
+}
+
+uint32_t perfSysTickCycles(const struct perfSysTick *saved, uint32_t start, uint32_t end) {
+
+	const uint32_t reload = saved->taken ? PERF_CYCLES_MAX : saved->rvr;
+
+	// SysTick counts down
+	return start >= end ? start - end : start + reload + 1u - end;
+}
+
+void perfBegin(void) {
+
+	perfSysTickBorrow(&perfSaved, PERF_CYCLES_MAX);
+
+	perfOverhead = 0u;
+	struct perfCycles empty;
+	perfCyclesReset(&empty);
+	for (uint32_t i = 0; i < PERF_OVERHEAD_RUNS; i++) {
+		perfStop(&empty, perfStart());
+	}
+	perfOverhead = empty.min;
+}
+
+void perfEnd(void) {
+	perfSysTickReturn(&perfSaved);
+}
+
+uint32_t RUN_IN_RAM(perfStart) perfStart(void) {
+	return systick_hw->cvr;
+}
+
+void RUN_IN_RAM(perfStop) perfStop(struct perfCycles *cycles, uint32_t start) {
+
+	// SysTick counts down
+	uint32_t taken = (start - systick_hw->cvr) & PERF_CYCLES_MAX;
+	taken = taken > perfOverhead ? taken - perfOverhead : 0u;
+
+	cycles->count++;
+	cycles->total += taken;
+	if (taken < cycles->min) {
+		cycles->min = taken;
+	}
+	if (taken > cycles->max) {
+		cycles->max = taken;
+	}
+}
+
+uint32_t perfAverage(const struct perfCycles *cycles) {
+	if (cycles->count == 0u) {
+		return 0u;
+	}
+	return (uint32_t)((cycles->total + (cycles->count >> 1)) / cycles->count);
+}
+
+/**
+ * Records how late tick ran
+ * 
+ * @param batch block of one period
+ * 
+ * @return whether timer keeps going
+ */
+bool RUN_IN_RAM(perfTimerTick) perfTimerTick(const struct hardTimerBatch *batch) {
+
+	const uint32_t lateUS = batch->lateUS;
+
+	perfTimer.fired++;
+	perfTimer.totalLateUS += lateUS;
+	if (lateUS > perfTimer.worstLateUS) {
+		perfTimer.worstLateUS = lateUS;
+	}
+	if (lateUS >= perfTimer.periodUS) {
+		perfTimer.late++;
+	}
+	return true;
+}
+
+bool perfTimerScenario(struct perfTimerResult *result, freq_t freq, uint32_t durationMS, uint32_t commits) {
+
+	hard_timer_t timer = HARD_TIMER_INVALID;
+
+	perfTimer.fired = 0u;
+	perfTimer.late = 0u;
+	perfTimer.worstLateUS = 0u;
+	perfTimer.totalLateUS = 0u;
+
+	result->freq = freq;
+	result->expected = 0u;
+	result->fired = 0u;
+	result->dropped = 0u;
+	result->worstLateUS = 0u;
+	result->averageLateUS = 0u;
+	result->commits = 0u;
+	result->commitMaxUS = 0u;
+
+	if (freq == 0u || freq > FREQ_MAX) {
+		return false;
+	}
+
+	// tick reads period so it's set before timer can fire, same rounding timer uses
+	perfTimer.periodUS = FREQ_MAX / freq;
+
+	// block of one period gives lateness of every tick
+	if (!setHardTimerBatched(&timer, &result->freq, 1u, perfTimerTick, NULL)) {
+		return false;
+	}
+
+	const uint64_t start = time_us_64();
+	const uint64_t durationUS = (uint64_t)durationMS * 1000u;
+	const uint64_t spacingUS = durationUS / (commits + 1u);
+
+	// commits are spread out so timer settles between them
+	uint64_t now;
+	while ((now = time_us_64()) - start < durationUS) {
+		if (nvmStarted() && result->commits < commits && now - start >= spacingUS * (result->commits + 1u)) {
+			uint32_t commitStart = time_us_32();
+			nvmCommit();
+			uint32_t commitUS = time_us_32() - commitStart;
+			if (commitUS > result->commitMaxUS) {
+				result->commitMaxUS = commitUS;
+			}
+			result->commits++;
+		}
+		tight_loop_contents();
+	}
+
+	const uint64_t elapsedUS = time_us_64() - start;
+	cancelHardTimer(timer);
+
+	result->fired = perfTimer.fired;
+	result->expected = (uint32_t)(elapsedUS / perfTimer.periodUS);
+
+	// last tick due may still be on its way when timer is cancelled
+	const uint32_t due = result->expected > 0u ? result->expected - 1u : 0u;
+	result->dropped = perfTimer.late + (due > result->fired ? due - result->fired : 0u);
+	result->worstLateUS = perfTimer.worstLateUS;
+	if (result->fired > 0u) {
+		result->averageLateUS = (uint32_t)(perfTimer.totalLateUS / result->fired);
+	}
+	return true;
+}
+
+void perfGPIOScenario(struct perfCycles *cycles, uint8_t pin, uint32_t writes) {
+
+	perfCyclesReset(cycles);
+	perfBegin();
+	for (uint32_t i = 0; i < writes; i++) {
+		uint32_t start = perfStart();
+		hardDigitalWrite(pin, (enum digitalState)(i & 1u));
+		perfStop(cycles, start);
+	}
+	perfEnd();
+}
+
+void perfSerialScenario(struct perfSerialResult *result, uint32_t writes, uint32_t length) {
+
+	uint8_t line[PERF_SERIAL_LENGTH_MAX];
+	struct serialStats before;
+	struct serialStats after;
+
+	if (length > PERF_SERIAL_LENGTH_MAX) {
+		length = PERF_SERIAL_LENGTH_MAX;
+	}
+	for (uint32_t i = 0; i < length; i++) {
+		line[i] = i + 1u < length ? '.' : '\n';
+	}
+
+	perfCyclesReset(&result->cycles);
+	serialFlush();
+	serialGetStats(&before);
+
+	perfBegin();
+	for (uint32_t i = 0; i < writes && length > 0u; i++) {
+		uint32_t start = perfStart();
+		serialWrite(line, length);
+		perfStop(&result->cycles, start);
+	}
+	perfEnd();
+
+	serialFlush();
+	serialGetStats(&after);
+	result->dropped = after.dropped - before.dropped;
+}
+
+void perfPrint(const char *scenario, const char *metric, uint32_t value) {
+	printf("{\"scenario\":\"%s\",\"metric\":\"%s\",\"value\":%lu}\n", scenario, metric, (unsigned long)value);
+}
+
+bool perfRunAll(uint8_t pin) {
+
+	struct perfTimerResult timer;
+	struct perfCycles gpio;
+	struct perfSerialResult serial;
+	bool result = true;
+
+	if (perfTimerScenario(&timer, TEST_FAST_FREQ, PERF_TIMER_MS, PERF_TIMER_COMMITS)) {
+		perfPrint("timer", "dropped", timer.dropped);
+		perfPrint("timer", "worst_late_us", timer.worstLateUS);
+		perfPrint("timer", "average_late_us", timer.averageLateUS);
+		perfPrint("timer", "commit_max_us", timer.commitMaxUS);
+	}
+	else {
+		result = false;
+	}
+
+	perfGPIOScenario(&gpio, pin, PERF_GPIO_WRITES);
+	perfPrint("gpio", "cycles_average", perfAverage(&gpio));
+	perfPrint("gpio", "cycles_max", gpio.max);
+
+	perfSerialScenario(&serial, PERF_SERIAL_WRITES, PERF_SERIAL_LENGTH);
+	perfPrint("serial", "cycles_average", perfAverage(&serial.cycles));
+	perfPrint("serial", "cycles_max", serial.cycles.max);
+	perfPrint("serial", "dropped", serial.dropped);
+
+	return result;
+}
\ No newline at end of file
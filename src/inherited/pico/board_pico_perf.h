@@ -0,0 +1,211 @@
+/*
+	board_pico_perf.h - performance benchmarks for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_PERF_H
+#define BOARD_PICO_PERF_H
+
+#include "board_pico.h"
+
+#include <hard_timer.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Perf Config
+ * 
+ * Standard scenarios run on the board and print each
+ * metric as one JSON line:
+ * 	{"scenario":"timer","metric":"dropped","value":0}
+ * 
+ * tools/perf_compare.py checks a captured run against a
+ * stored baseline and flags metrics that got worse
+ * 
+ * Cycles are counted by SysTick, which is borrowed for the
+ * scenario and restored after, every metric is lower is better
+****************************/
+
+#define PERF_TIMER_MS 1000u // time timer scenario runs for
+#define PERF_TIMER_COMMITS 4u // NVM commits during timer scenario
+#define PERF_GPIO_WRITES 1000u // writes in GPIO scenario
+#define PERF_SERIAL_WRITES 64u // writes in serial scenario
+#define PERF_SERIAL_LENGTH 32u // bytes per write in serial scenario
+#define PERF_SERIAL_LENGTH_MAX 64u // most bytes per write in serial scenario
+#define PERF_CYCLES_MAX 0xFFFFFFu // longest operation SysTick can count
+#define PERF_SYSTICK_ENABLE 0x1u // SysTick CSR counter enable
+#define PERF_SYSTICK_PROCESSOR 0x4u // SysTick CSR counts clk_sys
+
+struct perfSysTick {
+	uint32_t csr; // control before borrowing
+	uint32_t rvr; // reload before borrowing
+	bool taken; // whether SysTick was reprogrammed
+};
+
+struct perfCycles {
+	uint32_t count; // operations counted
+	uint64_t total; // cycles of every operation
+	uint32_t min; // fewest cycles of an operation
+	uint32_t max; // most cycles of an operation
+};
+
+struct perfTimerResult {
+	freq_t freq; // frequency timer ran at
+	uint32_t expected; // ticks that were due
+	uint32_t fired; // ticks that ran
+	uint32_t dropped; // ticks due that never ran plus ticks that ran a period or more late
+	uint32_t worstLateUS; // most time a tick ran after it was due
+	uint32_t averageLateUS; // mean time a tick ran after it was due
+	uint32_t commits; // NVM commits made meanwhile
+	uint32_t commitMaxUS; // longest NVM commit
+};
+
+struct perfSerialResult {
+	struct perfCycles cycles; // cycles of each serialWrite
+	uint32_t dropped; // bytes that didn't fit in ring buffer
+};
+
+/**
+ * Clears cycle counts
+ * 
+ * @param cycles counts to clear
+ */
+void perfCyclesReset(struct perfCycles *cycles);
+
+/**
+ * Borrows SysTick to count clk_sys cycles
+ * 
+ * @param saved pointer to state to restore
+ * @param span most cycles that will be counted
+ * 
+ * @note left untouched when already counting clk_sys with a reload of
+ * at least span, the current value can't be written back, only cleared
+ */
+void perfSysTickBorrow(struct perfSysTick *saved, uint32_t span);
+
+/**
+ * Gives SysTick back as it was before perfSysTickBorrow
+ * 
+ * @param saved state from perfSysTickBorrow
+ * 
+ * @note a reprogrammed SysTick restarts from its own reload
+ */
+void perfSysTickReturn(const struct perfSysTick *saved);
+
+/**
+ * Gets cycles between two SysTick values
+ * 
+ * @param saved state from perfSysTickBorrow
+ * @param start earlier value
+ * @param end later value
+ * 
+ * @return cycles counted, wraps at reload
+ */
+uint32_t perfSysTickCycles(const struct perfSysTick *saved, uint32_t start, uint32_t end);
+
+/**
+ * Takes over SysTick to count cycles
+ * 
+ * @note counting overhead is measured here and taken off every operation
+ */
+void perfBegin(void);
+
+/**
+ * Gives SysTick back as it was before perfBegin
+ */
+void perfEnd(void);
+
+/**
+ * Gets cycle count at start of an operation
+ * 
+ * @return SysTick value
+ */
+uint32_t perfStart(void);
+
+/**
+ * Adds operation to counts
+ * 
+ * @param cycles counts to add to
+ * @param start value from perfStart
+ * 
+ * @note operations over PERF_CYCLES_MAX cycles wrap
+ */
+void perfStop(struct perfCycles *cycles, uint32_t start);
+
+/**
+ * Gets average cycles of an operation
+ * 
+ * @param cycles counts
+ * 
+ * @return cycles rounded, 0 if nothing was counted
+ */
+uint32_t perfAverage(const struct perfCycles *cycles);
+
+/**
+ * Runs hard timer while committing NVM
+ * 
+ * @param result pointer to result
+ * @param freq frequency to run timer at
+ * @param durationMS time to run for
+ * @param commits NVM commits to make meanwhile
+ * 
+ * @return whether timer started
+ * 
+ * @note NVM must be set up for commits to be made
+ */
+bool perfTimerScenario(struct perfTimerResult *result, freq_t freq, uint32_t durationMS, uint32_t commits);
+
+/**
+ * Toggles pin with hardDigitalWrite
+ * 
+ * @param cycles pointer to counts of each write
+ * @param pin output pin to toggle
+ * @param writes amount of writes
+ */
+void perfGPIOScenario(struct perfCycles *cycles, uint8_t pin, uint32_t writes);
+
+/**
+ * Queues bytes with serialWrite
+ * 
+ * @param result pointer to result
+ * @param writes amount of writes
+ * @param length bytes per write, up to PERF_SERIAL_LENGTH_MAX
+ * 
+ * @note each write is a line of dots so metric lines stay readable
+ * @note waits for ring buffer to empty before and after
+ */
+void perfSerialScenario(struct perfSerialResult *result, uint32_t writes, uint32_t length);
+
+/**
+ * Prints metric as a JSON line
+ * 
+ * @param scenario scenario name
+ * @param metric metric name
+ * @param value metric value
+ */
+void perfPrint(const char *scenario, const char *metric, uint32_t value);
+
+/**
+ * Runs every scenario and prints metrics
+ * 
+ * @param pin output pin GPIO scenario toggles
+ * 
+ * @return whether every scenario ran
+ */
+bool perfRunAll(uint8_t pin);
+
+#endif
\ No newline at end of file
@@ -18,16 +18,216 @@
 
 #include <comm/hard_serial/hard_serial.h>
 
+#include "board_pico_arena.h"
+#include "board_pico_clock.h"
+#include "board_pico_serial.h"
+
+#include <string.h>
+
+struct serialStats serialStatistics;
+
 #ifdef PLATFORMIO
 
-	void hardPrintBegin(uint32_t baud) {}
+	#include <stdio.h>
+
+	void hardPrintBegin(uint32_t baud) {
+		serialStatistics.baud = baud;
+	}
+
+	uint32_t serialWrite(const uint8_t *data, uint32_t length) {
+		uint32_t written = (uint32_t)fwrite(data, 1, length, stdout);
+		serialStatistics.queued += written;
+		serialStatistics.sent += written;
+		return written;
+	}
+
+	uint32_t serialPending(void) {
+		return 0U;
+	}
+
+	uint32_t serialFree(void) {
+		return SERIAL_TX_BUFFER_SIZE;
+	}
+
+	void serialFlush(void) {
+		fflush(stdout);
+	}
 
 #else
 
 	#include <pico/stdio_uart.h>
+	#include <pico/stdio/driver.h>
+	#include <hardware/dma.h>
+	#include <hardware/gpio.h>
+	#include <hardware/irq.h>
+	#include <hardware/sync.h>
+	#include <hardware/uart.h>
+
+	#define SERIAL_UART uart0 // UART used for serial
+	#define TX_MASK (SERIAL_TX_BUFFER_SIZE - 1U)
+
+	// persistent in boardArena, aligned to its size so DMA can wrap reads around it
+	uint8_t *serialRing = NULL;
+	volatile uint32_t serialHead = 0U; // bytes ever queued and copied
+	volatile uint32_t serialReserved = 0U; // bytes ever queued, copies may be running
+	volatile uint32_t serialWriters = 0U; // writes copying into their span
+	volatile uint32_t serialTail = 0U; // bytes ever sent
+	volatile uint32_t serialInFlight = 0U; // bytes in current DMA transfer
+	int serialDMA = -1; // DMA channel feeding UART
+	uint32_t serialBaud = 0U; // baud rate asked for
+
+	/**
+	 * Starts DMA transfer of all queued bytes if DMA is idle
+	 * 
+	 * @note interrupts must be disabled
+	 */
+	void RUN_IN_RAM(serialStartTransfer) serialStartTransfer(void) {
+
+		if (serialInFlight != 0U) {
+			return;
+		}
+
+		uint32_t pending = serialHead - serialTail;
+		if (pending == 0U) {
+			return;
+		}
+
+		serialInFlight = pending;
+		dma_channel_set_read_addr(serialDMA, &serialRing[serialTail & TX_MASK], false);
+		dma_channel_set_trans_count(serialDMA, pending, true);
+	}
+
+	/**
+	 * Frees sent bytes and sends anything queued meanwhile
+	 */
+	void RUN_IN_RAM(serialDMAHandler) serialDMAHandler(void) {
+
+		if (!dma_channel_get_irq0_status(serialDMA)) {
+			return;
+		}
+		dma_channel_acknowledge_irq0(serialDMA);
+
+		serialTail += serialInFlight;
+		serialStatistics.sent += serialInFlight;
+		serialInFlight = 0U;
+		serialStartTransfer();
+	}
+
+	/**
+	 * Sends printf output through ring buffer
+	 */
+	void serialStdioOut(const char *buffer, int length) {
+		serialWrite((const uint8_t*)buffer, (uint32_t)length);
+	}
+
+	stdio_driver_t serialStdio = {
+		.out_chars = serialStdioOut,
+	};
+
+	/**
+	 * Recalculates UART divider for new clk_peri
+	 */
+	void serialClockChanged(void) {
+		serialStatistics.baud = uart_set_baudrate(SERIAL_UART, serialBaud);
+	}
 
 	void hardPrintBegin(uint32_t baud) {
-		uart_init(uart0, BAUD_RATE);
+
+		serialBaud = baud;
+		serialStatistics.baud = uart_init(SERIAL_UART, baud);
+		gpio_set_function(PICO_DEFAULT_UART_TX_PIN, GPIO_FUNC_UART);
+		gpio_set_function(PICO_DEFAULT_UART_RX_PIN, GPIO_FUNC_UART);
+
+		if (serialDMA >= 0) {
+			return;
+		}
+
+		serialRing = (uint8_t*)arenaAllocPersistent(&boardArena, SERIAL_TX_BUFFER_SIZE, SERIAL_TX_BUFFER_SIZE);
+		if (serialRing == NULL) {
+			return;
+		}
+
+		serialDMA = dma_claim_unused_channel(true);
+
+		dma_channel_config config = dma_channel_get_default_config(serialDMA);
+		channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+		channel_config_set_read_increment(&config, true);
+		channel_config_set_write_increment(&config, false);
+		channel_config_set_ring(&config, false, SERIAL_TX_BUFFER_BITS);
+		channel_config_set_dreq(&config, uart_get_dreq(SERIAL_UART, true));
+		dma_channel_configure(serialDMA, &config, &uart_get_hw(SERIAL_UART)->dr, serialRing, 0, false);
+
+		dma_channel_set_irq0_enabled(serialDMA, true);
+		irq_add_shared_handler(DMA_IRQ_0, serialDMAHandler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+		irq_set_enabled(DMA_IRQ_0, true);
+
+		stdio_set_driver_enabled(&serialStdio, true);
+		clockAddListener(serialClockChanged);
+	}
+
+	uint32_t serialWrite(const uint8_t *data, uint32_t length) {
+
+		if (serialDMA < 0 || data == NULL) {
+			return 0U;
+		}
+
+		// span is claimed with interrupts off so an interrupt writing
+		// meanwhile gets the span after it instead of the same one
+		uint32_t status = save_and_disable_interrupts();
+		uint32_t head = serialReserved;
+		uint32_t space = SERIAL_TX_BUFFER_SIZE - (head - serialTail);
+		uint32_t take = length < space ? length : space;
+
+		if (take < length) {
+			serialStatistics.overflows++;
+			serialStatistics.dropped += length - take;
+		}
+		serialReserved = head + take;
+		serialWriters++;
+		restore_interrupts(status);
+
+		// copies in two parts when queue wraps
+		uint32_t start = head & TX_MASK;
+		uint32_t first = SERIAL_TX_BUFFER_SIZE - start;
+		if (first > take) {
+			first = take;
+		}
+		memcpy(&serialRing[start], data, first);
+		memcpy(serialRing, data + first, take - first);
+
+		// last write to finish copying hands every span to DMA
+		status = save_and_disable_interrupts();
+		serialStatistics.queued += take;
+		if (--serialWriters == 0U) {
+			serialHead = serialReserved;
+			uint32_t pending = serialHead - serialTail;
+			if (pending > serialStatistics.highWater) {
+				serialStatistics.highWater = pending;
+			}
+			serialStartTransfer();
+		}
+		restore_interrupts(status);
+
+		return take;
 	}
 
-#endif
\ No newline at end of file
+	uint32_t serialPending(void) {
+		return serialHead - serialTail;
+	}
+
+	uint32_t serialFree(void) {
+		return SERIAL_TX_BUFFER_SIZE - (serialReserved - serialTail);
+	}
+
+	void serialFlush(void) {
+		while (serialPending() != 0U) {
+			tight_loop_contents();
+		}
+		uart_tx_wait_blocking(SERIAL_UART);
+	}
+
+#endif
+
+void serialGetStats(struct serialStats *stats) {
+	*stats = serialStatistics;
+}
\ No newline at end of file
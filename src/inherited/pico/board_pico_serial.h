@@ -0,0 +1,89 @@
+/*
+	board_pico_serial.h - serial configuration for Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_SERIAL_H
+#define BOARD_PICO_SERIAL_H
+
+#include "board_pico.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Serial Config
+ * 
+ * Transmit bytes are queued in a ring buffer
+ * and sent by DMA so callers never wait on the UART
+****************************/
+
+#ifndef SERIAL_TX_BUFFER_BITS
+	#define SERIAL_TX_BUFFER_BITS 12 // ring buffer holds 2 ^ bits bytes
+#endif
+
+#define SERIAL_TX_BUFFER_SIZE (1u << SERIAL_TX_BUFFER_BITS) // bytes in ring buffer
+
+struct serialStats {
+	uint32_t baud; // baud rate UART achieved
+	uint32_t queued; // bytes accepted into ring buffer
+	uint32_t sent; // bytes handed to UART by DMA
+	uint32_t overflows; // writes that didn't fully fit
+	uint32_t dropped; // bytes dropped by overflows
+	uint32_t highWater; // most bytes waiting in ring buffer
+};
+
+/**
+ * Queues bytes to send without waiting
+ * 
+ * @param data bytes to send
+ * @param length amount of bytes
+ * 
+ * @return amount of bytes queued, less than length if ring buffer is full
+ * 
+ * @note safe to call from interrupts, bytes of each write stay together
+ * 
+ * @warning only one core should write at a time
+ */
+uint32_t serialWrite(const uint8_t *data, uint32_t length);
+
+/**
+ * Gets bytes waiting to be sent
+ * 
+ * @return amount of bytes in ring buffer
+ */
+uint32_t serialPending(void);
+
+/**
+ * Gets space left in ring buffer
+ * 
+ * @return amount of bytes that can be queued
+ */
+uint32_t serialFree(void);
+
+/**
+ * Waits until ring buffer is empty
+ */
+void serialFlush(void);
+
+/**
+ * Gets serial statistics
+ * 
+ * @param stats pointer to statistics
+ */
+void serialGetStats(struct serialStats *stats);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,70 @@
+/*
+	board_pico_sram.h - SRAM bank placement for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_SRAM_H
+#define BOARD_PICO_SRAM_H
+
+#include "board_pico.h"
+
+/****************************
+ * SRAM Bank Config
+ * 
+ * Striped SRAM spreads every buffer over all four main banks,
+ * so DMA filling a capture buffer competes with whatever
+ * the CPUs are reading, placing DMA targets and core 1
+ * processing buffers in their own banks stops that
+ * 
+ * Define SRAM_BANKS and link board_pico_banks.ld with a memmap
+ * whose RAM region is non striped banks 0 and 1 only:
+ * 	RAM(rwx) : ORIGIN = 0x21000000, LENGTH = 128k
+ * 
+ * Placement:
+ * 	SRAM_DMA: bank 3, only DMA and the final read touch it
+ * 	SRAM_CORE1: bank 2, buffers core 1 processes
+ * 	SRAM_CORE0_HOT: scratch Y, next to core 0's stack
+ * 	SRAM_CORE1_HOT: scratch X, next to core 1's stack
+ * 
+ * Without SRAM_BANKS every attribute is empty and
+ * buffers stay in striped SRAM as before
+ * 
+ * tools/sram_layout.py reports where large objects
+ * landed and fails if DMA and core 1 buffers share a bank
+****************************/
+
+#define SRAM_BANK_SIZE 0x10000u // bytes in each main bank
+#define SRAM_BANK_BASE 0x21000000u // non striped alias of bank 0
+#define SRAM_SCRATCH_X_BASE 0x20040000u // scratch bank X
+#define SRAM_SCRATCH_Y_BASE 0x20041000u // scratch bank Y
+
+#ifdef SRAM_BANKS
+
+	#define SRAM_DMA __attribute__((section(".sram_dma"))) // DMA target or source buffer
+	#define SRAM_CORE1 __attribute__((section(".sram_core1"))) // buffer processed by core 1
+	#define SRAM_CORE0_HOT __attribute__((section(".scratch_y.core0_hot"))) // small data hot on core 0
+	#define SRAM_CORE1_HOT __attribute__((section(".scratch_x.core1_hot"))) // small data hot on core 1
+
+#else
+
+	#define SRAM_DMA
+	#define SRAM_CORE1
+	#define SRAM_CORE0_HOT
+	#define SRAM_CORE1_HOT
+
+#endif
+
+#endif
\ No newline at end of file
@@ -21,26 +21,126 @@
 
 #include <board_common.h>
 
-bool locked = false;
+#include "board_pico_threads.h"
+#include "board_pico_trace.h"
+
+spin_lock_t *threadLock = NULL; // keeps cores out of each other's thread safety once core 1 runs
+volatile uint8_t lockedCore = 0U; // core holding thread safety + 1, 0 when free
 uint32_t intrruptStatus;
 
-bool startThreadSafety(void) {
+bool core1Running = false;
+
+struct core1Job {
+	core1_function_t function; // job to run
+	void *param; // parameter passed to job
+};
+
+struct core1Job core1Jobs[CORE1_QUEUE_SIZE];
+volatile uint8_t core1Head = 0U; // next job written by core 0
+volatile uint8_t core1Tail = 0U; // next job read by core 1
+
+/**
+ * Runs queued jobs on core 1
+ */
+void core1Loop(void) {
 
-	if (!locked) {
-		intrruptStatus = save_and_disable_interrupts();
-		//multicore_lockout_start_blocking();
-		locked = true;
-		return true;
+	// lets core 0 pause core 1 while flash is written
+	multicore_lockout_victim_init();
+
+	while (true) {
+		while (core1Tail == core1Head) {
+			__wfe();
+		}
+		__dmb();
+		struct core1Job job = core1Jobs[core1Tail];
+		__dmb();
+		core1Tail = (core1Tail + 1U) % CORE1_QUEUE_SIZE;
+		job.function(job.param);
 	}
+}
+
+bool core1Begin(void) {
+
+#ifdef PLATFORMIO
+	// Arduino core already runs setup1 and loop1 on core 1
 	return false;
+#else
+	if (core1Running || lockedCore != 0U) {
+		return false;
+	}
+
+	// claimed before core 1 can run so both cores see it set
+	threadLock = spin_lock_init((uint)spin_lock_claim_unused(true));
+	multicore_launch_core1(core1Loop);
+	core1Running = true;
+	return true;
+#endif
 }
 
-bool endThreadSafety(void) {
-	if (locked) {
-		//multicore_lockout_end_blocking();
-		restore_interrupts(intrruptStatus);
-		locked = false;
-		return true;
+bool core1Queue(core1_function_t function, void *param) {
+
+	if (!core1Running || function == NULL) {
+		return false;
 	}
-	return false;
+
+	uint8_t next = (core1Head + 1U) % CORE1_QUEUE_SIZE;
+	if (next == core1Tail) {
+		return false;
+	}
+
+	core1Jobs[core1Head].function = function;
+	core1Jobs[core1Head].param = param;
+	__dmb();
+	core1Head = next;
+	__sev();
+	return true;
+}
+
+bool core1Started(void) {
+	return core1Running;
+}
+
+bool RUN_IN_RAM(startThreadSafety) startThreadSafety(void) {
+
+	const uint8_t core = (uint8_t)get_core_num() + 1U;
+
+	// only holding core writes its own number, so other core can't race this check
+	if (lockedCore == core) {
+		return false;
+	}
+
+	uint32_t status = save_and_disable_interrupts();
+	if (threadLock != NULL) {
+		// core 1 answers lockout from an interrupt, so it can't be paused
+		// while holding lock and lockout never waits on lock
+		if (core == 1U) {
+			multicore_lockout_start_blocking();
+		}
+		spin_lock_unsafe_blocking(threadLock);
+	}
+	intrruptStatus = status;
+	lockedCore = core;
+	TRACE_BEGIN(TRACE_THREAD_SAFETY);
+	return true;
+}
+
+bool RUN_IN_RAM(endThreadSafety) endThreadSafety(void) {
+
+	const uint8_t core = (uint8_t)get_core_num() + 1U;
+
+	if (lockedCore != core) {
+		return false;
+	}
+
+	TRACE_END(TRACE_THREAD_SAFETY);
+	uint32_t status = intrruptStatus;
+	lockedCore = 0U;
+	if (threadLock != NULL) {
+		spin_unlock_unsafe(threadLock);
+		if (core == 1U) {
+			multicore_lockout_end_blocking();
+		}
+	}
+	restore_interrupts(status);
+	return true;
 }
\ No newline at end of file
@@ -0,0 +1,74 @@
+/*
+	board_pico_threads.h - thread configuration for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_THREADS_H
+#define BOARD_PICO_THREADS_H
+
+#include "board_pico.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Core 1 Config
+ * 
+ * Core 1 runs queued jobs so long processing
+ * doesn't stall acquisition on core 0
+ * 
+ * Thread safety on core 0 pauses core 1 so flash can be
+ * written, on core 1 it masks interrupts and waits out core 0,
+ * flash is only written from core 0
+****************************/
+
+#ifndef CORE1_QUEUE_SIZE
+	#define CORE1_QUEUE_SIZE 8 // max jobs waiting for core 1
+#endif
+
+typedef void (*core1_function_t)(void *param); // job run on core 1
+
+/**
+ * Launches core 1 job loop
+ * 
+ * @return whether core 1 was launched
+ * 
+ * @note thread safety pauses core 1 once launched so flash can be written
+ * @note always false on Arduino core (PLATFORMIO), which runs setup1 and loop1 on core 1
+ * @warning don't call while holding thread safety
+ */
+bool core1Begin(void);
+
+/**
+ * Queues job to run on core 1
+ * 
+ * @param function job to run
+ * @param param parameter passed to job
+ * 
+ * @return whether job was queued
+ * 
+ * @warning only call from core 0 outside of interrupts
+ */
+bool core1Queue(core1_function_t function, void *param);
+
+/**
+ * Checks if core 1 job loop is running
+ * 
+ * @return whether core 1 was launched
+ */
+bool core1Started(void);
+
+#endif
@@ -17,8 +17,14 @@
 */
 
 #include <pico/time.h>
+#include <pico/platform.h>
+#include <hardware/clocks.h>
 #include <hard_timer.h>
 
+#include "board_pico_clock.h"
+#include "board_pico_timer.h"
+#include "board_pico_trace.h"
+
 #define THOUSAND 1000
 
 typedef enum {
@@ -39,6 +45,27 @@ struct repeating_timer timers[NUM_TIMERS];
 storage_t timersStarted = 0U; // stores timer started state
 storage_t timersClaimed = 0U; // stores timer claimed state
 
+#ifdef TRACE_ENABLED
+
+	hard_timer_function_ptr_t timerFunctions[NUM_TIMERS]; // callbacks wrapped for tracing
+
+	/**
+	 * Traces timer callback
+	 * 
+	 * @param rt timer that fired
+	 * 
+	 * @return whether timer keeps repeating
+	 */
+	bool RUN_IN_RAM(traceTimerCallback) traceTimerCallback(struct repeating_timer *rt) {
+		uint16_t timer = (uint16_t)(rt - timers);
+		TRACE_BEGIN(TRACE_TIMER + timer);
+		bool result = timerFunctions[timer](rt);
+		TRACE_END(TRACE_TIMER + timer);
+		return result;
+	}
+
+#endif
+
 /**
  * Gets timer based on desired timer
  * 
@@ -46,7 +73,7 @@ storage_t timersClaimed = 0U; // stores timer claimed state
  * 
  * @return pointer to timer selected
  */
-struct repeating_timer* getTimer(hard_timer_t timer) {
+struct repeating_timer* RUN_IN_RAM(getTimer) getTimer(hard_timer_t timer) {
 	if (timer >= 0 && timer < NUM_TIMERS) {
 		return &timers[timer];
 	}
@@ -59,7 +86,7 @@ struct repeating_timer* getTimer(hard_timer_t timer) {
  * @param timer timer to set
  * @param state whether or not timer is started
  */
-void setTimerStarted(hard_timer_t timer, bool state) {
+void RUN_IN_RAM(setTimerStarted) setTimerStarted(hard_timer_t timer, bool state) {
 
 	if (timer == HARD_TIMER_INVALID) {
 		return;
@@ -78,7 +105,7 @@ void setTimerStarted(hard_timer_t timer, bool state) {
  * @param timer timer to set
  * @param state whether or not timer is claimed
  */
-void setTimerClaimed(hard_timer_t timer, bool state) {
+void RUN_IN_RAM(setTimerClaimed) setTimerClaimed(hard_timer_t timer, bool state) {
 
 	if (timer == HARD_TIMER_INVALID) {
 		return;
@@ -96,7 +123,7 @@ void setTimerClaimed(hard_timer_t timer, bool state) {
  * 
  * @return available timer
  */
-hard_timer_t getNextTimer(void) {
+hard_timer_t RUN_IN_RAM(getNextTimer) getNextTimer(void) {
 	for (uint8_t i = 0; i < NUM_TIMERS; i++) {
 		if (!hardTimerStarted(i) && !hardTimerClaimed(i)) {
 			return (hard_timer_t)i;
@@ -105,7 +132,7 @@ hard_timer_t getNextTimer(void) {
 	return HARD_TIMER_INVALID;
 }
 
-hard_timer_t claimTimer(struct hardTimerPriority *priority) {
+hard_timer_t RUN_IN_RAM(claimTimer) claimTimer(struct hardTimerPriority *priority) {
 
 	hard_timer_t timer = getNextTimer();
 	if (timer != HARD_TIMER_INVALID) {
@@ -114,7 +141,7 @@ hard_timer_t claimTimer(struct hardTimerPriority *priority) {
 	return timer;
 }
 
-bool unclaimTimer(hard_timer_t timer) {
+bool RUN_IN_RAM(unclaimTimer) unclaimTimer(hard_timer_t timer) {
 	if (hardTimerClaimed(timer)) {
 		setTimerClaimed(timer, false);
 		return true;
@@ -122,7 +149,7 @@ bool unclaimTimer(hard_timer_t timer) {
 	return false;
 }
 
-bool hardTimerClaimed(hard_timer_t timer) {
+bool RUN_IN_RAM(hardTimerClaimed) hardTimerClaimed(hard_timer_t timer) {
 
 	if (timer == HARD_TIMER_INVALID) {
 		return false;
@@ -181,7 +208,7 @@ enum HardTimerStatusReturn getHardTimerStats(freq_t *freq, hard_timer_t *timer,
 	return status;
 }
 
-bool hardTimerStarted(hard_timer_t timer) {
+bool RUN_IN_RAM(hardTimerStarted) hardTimerStarted(hard_timer_t timer) {
 
 	if (timer == HARD_TIMER_INVALID) {
 		return false;
@@ -189,7 +216,7 @@ bool hardTimerStarted(hard_timer_t timer) {
 	return !!((((storage_t)1) << timer) & timersStarted);
 }
 
-bool cancelHardTimer(hard_timer_t timer) {
+bool RUN_IN_RAM(cancelHardTimer) cancelHardTimer(hard_timer_t timer) {
 
 	if (hardTimerStarted(timer)) {
 		struct repeating_timer* timerPtr = getTimer(timer);
@@ -221,6 +248,10 @@ bool setHardTimer(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t f
 
 	if (!hardTimerStarted(*timer)) {
 		struct repeating_timer* timerPtr = getTimer(*timer);
+		#ifdef TRACE_ENABLED
+			timerFunctions[*timer] = function;
+			function = traceTimerCallback;
+		#endif
 		if (scalar == SCALAR_MS) {
 			if (add_repeating_timer_ms(-timerTicks, function, NULL, timerPtr)) {
 				setTimerStarted(*timer, true);
@@ -236,4 +267,134 @@ bool setHardTimer(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t f
 	}
 
 	return false;
+}
+
+struct timerBatchState {
+	hard_timer_batch_function_t function; // called at end of each block
+	struct hardTimerBatch batch; // block passed to function
+	uint64_t blockUS; // time of whole block in us
+};
+
+struct timerBatchState timerBatches[NUM_TIMERS];
+
+/**
+ * Hands block of periods to batched timer callback
+ * 
+ * @param rt timer that fired
+ * 
+ * @return whether timer keeps repeating
+ */
+bool RUN_IN_RAM(timerBatchCallback) timerBatchCallback(struct repeating_timer *rt) {
+
+	uint16_t timer = (uint16_t)(rt - timers);
+	struct timerBatchState *state = &timerBatches[timer];
+	struct hardTimerBatch *batch = &state->batch;
+
+	const uint64_t end = batch->first + state->blockUS;
+
+	// 32 bit time is read inline so this stays out of flash
+	int32_t late = (int32_t)(time_us_32() - (uint32_t)end);
+	batch->lateUS = late > 0 ? (uint32_t)late : 0u;
+
+	TRACE_BEGIN(TRACE_TIMER + timer);
+	bool result = state->function(batch);
+	TRACE_END(TRACE_TIMER + timer);
+
+	batch->first = end;
+	return result;
+}
+
+bool setHardTimerBatched(hard_timer_t *timer, freq_t *freq, uint32_t count, hard_timer_batch_function_t function, void *param) {
+
+	if (function == NULL || freq == NULL || timer == NULL) {
+		return false;
+	}
+	if (*freq == (freq_t)0 || *freq > FREQ_MAX || count == 0u || count > HARD_TIMER_BATCH_MAX) {
+		return false;
+	}
+
+	prescalar_t scalar;
+	timertick_t timerTicks;
+
+	if (getHardTimerStats(freq, timer, &scalar, &timerTicks) == HARD_TIMER_FAIL) {
+		return false;
+	}
+	if (hardTimerStarted(*timer)) {
+		return false;
+	}
+
+	uint32_t periodUS = (uint32_t)(scalar == SCALAR_MS ? timerTicks * THOUSAND : timerTicks);
+
+	struct timerBatchState *state = &timerBatches[*timer];
+	state->function = function;
+	state->batch.periodUS = periodUS;
+	state->batch.count = count;
+	state->batch.lateUS = 0u;
+	state->batch.param = param;
+	state->blockUS = (uint64_t)periodUS * count;
+	// alarm pool schedules from a moment later, within call overhead
+	state->batch.first = time_us_64();
+
+	// negative delay keeps alarms on schedule from the previous target
+	if (add_repeating_timer_us(-(int64_t)state->blockUS, timerBatchCallback, NULL, getTimer(*timer))) {
+		setTimerStarted(*timer, true);
+		return true;
+	}
+	return false;
+}
+
+#define NS_PER_US 1000u
+
+struct timerOneShotState {
+	hard_timer_oneshot_function_t function; // called once delay passes
+	void *param; // passed to function
+	uint32_t cycles; // cycles spun after alarm fires
+	volatile bool pending; // shot is waiting to fire
+};
+
+struct timerOneShotState timerOneShot;
+
+/**
+ * Finishes one shot delay and calls its function
+ * 
+ * @param id alarm that fired
+ * @param userData unused
+ * 
+ * @return 0 so alarm doesn't repeat
+ */
+int64_t RUN_IN_RAM(timerOneShotCallback) timerOneShotCallback(alarm_id_t id, void *userData) {
+	(void)id;
+	(void)userData;
+	busy_wait_at_least_cycles(timerOneShot.cycles);
+	timerOneShot.pending = false;
+	timerOneShot.function(timerOneShot.param);
+	return 0;
+}
+
+bool setHardTimerOneShotNS(uint32_t delayNS, hard_timer_oneshot_function_t function, void *param) {
+
+	if (function == NULL) {
+		return false;
+	}
+
+	if (delayNS <= HARD_TIMER_SPIN_MAX_NS) {
+		busy_wait_at_least_cycles(CLOCK_NS_TO_CYCLES(delayNS, clockNSFactor));
+		function(param);
+		return true;
+	}
+
+	if (timerOneShot.pending) {
+		return false;
+	}
+
+	timerOneShot.function = function;
+	timerOneShot.param = param;
+	timerOneShot.cycles = CLOCK_NS_TO_CYCLES(delayNS % NS_PER_US, clockNSFactor);
+	timerOneShot.pending = true;
+
+	if (add_alarm_in_us(delayNS / NS_PER_US, timerOneShotCallback, NULL, true) < 0) {
+		timerOneShot.pending = false;
+		return false;
+	}
+	return true;
 }
\ No newline at end of file
@@ -0,0 +1,110 @@
+/*
+	board_pico_timer.h - batched timers for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_TIMER_H
+#define BOARD_PICO_TIMER_H
+
+#include "board_pico.h"
+
+#include <hard_timer.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Batched Timer Config
+ * 
+ * A batched timer fires once per block of periods instead of
+ * once per period, so alarm and dispatch overhead is paid once
+ * per block, the callback gets the exact time of every period
+ * 
+ * Block times come from a running schedule, not from when
+ * the alarm fired, so they never drift
+****************************/
+
+#define HARD_TIMER_BATCH_MAX 1024u // most periods per block
+
+struct hardTimerBatch {
+	uint64_t first; // time of first period in block in us since boot
+	uint32_t periodUS; // time between periods in us
+	uint32_t count; // periods in block
+	uint32_t lateUS; // time alarm fired after end of block
+	void *param; // parameter given to setHardTimerBatched
+};
+
+typedef bool (*hard_timer_batch_function_t)(const struct hardTimerBatch *batch); // returns whether timer keeps going
+
+/**
+ * Starts timer that fires once per block of periods
+ * 
+ * @param timer pointer to timer ID, same rules as setHardTimer
+ * @param freq pointer to frequency of periods in Hz, changed to actual frequency
+ * @param count periods per block (1 to HARD_TIMER_BATCH_MAX)
+ * @param function called at end of each block
+ * @param param passed to function
+ * 
+ * @return whether timer started
+ * 
+ * @note period i of block happened at batch->first + i * batch->periodUS
+ * @note stop with cancelHardTimer
+ */
+bool setHardTimerBatched(hard_timer_t *timer, freq_t *freq, uint32_t count, hard_timer_batch_function_t function, void *param);
+
+/**
+ * Gets time of a period in block
+ * 
+ * @param batch block passed to callback
+ * @param index period in block
+ * 
+ * @return time in us since boot
+ */
+static inline uint64_t hardTimerBatchTime(const struct hardTimerBatch *batch, uint32_t index) {
+	return batch->first + (uint64_t)index * batch->periodUS;
+}
+
+/****************************
+ * One Shot Timer Config
+ * 
+ * Short delays are spun out in cycles straight from the call
+ * so they're exact, longer delays start with an alarm which
+ * lands anywhere in its us, then spin out remaining ns
+****************************/
+
+#ifndef HARD_TIMER_SPIN_MAX_NS
+	#define HARD_TIMER_SPIN_MAX_NS 20000u // longest delay spun without alarm
+#endif
+
+typedef void (*hard_timer_oneshot_function_t)(void *param); // called once delay passes
+
+/**
+ * Calls function once after delay with sub us resolution
+ * 
+ * @param delayNS delay in ns
+ * @param function called once delay passes
+ * @param param passed to function
+ * 
+ * @return whether function was scheduled
+ * 
+ * @note delays up to HARD_TIMER_SPIN_MAX_NS call function before returning,
+ * @note accurate to 3 cycles, longer delays call it from alarm interrupt
+ * @note with up to 1 us jitter, only one of those can be pending at a time
+ * @note cycles follow clk_sys set through clockApply
+ */
+bool setHardTimerOneShotNS(uint32_t delayNS, hard_timer_oneshot_function_t function, void *param);
+
+#endif
\ No newline at end of file
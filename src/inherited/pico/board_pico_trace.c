@@ -0,0 +1,116 @@
+/*
+	board_pico_trace.c - tracepoints for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <hardware/sync.h>
+#include <hardware/timer.h>
+#include <pico/platform.h>
+
+#include "board_pico_trace.h"
+
+#include <stddef.h>
+
+#define TRACE_CORES 2u
+#define TRACE_MASK (TRACE_BUFFER_RECORDS - 1u)
+#define TRACE_FLUSH_RECORDS 32u // records sent per frame
+
+struct traceRing {
+	struct traceRecord records[TRACE_BUFFER_RECORDS]; // records
+	volatile uint32_t head; // records ever written
+	volatile uint32_t tail; // records ever read
+	struct traceStats stats; // ring statistics
+};
+
+// each core only writes its own ring so cores never wait on each other
+struct traceRing traceRings[TRACE_CORES];
+
+void RUN_IN_RAM(traceWrite) traceWrite(uint16_t id, enum TracePhase phase) {
+
+	const uint32_t core = get_core_num();
+	struct traceRing *ring = &traceRings[core];
+	const uint32_t event = ((uint32_t)phase << TRACE_PHASE_SHIFT) | (core << TRACE_CORE_SHIFT) | ((uint32_t)id << TRACE_ID_SHIFT);
+
+	// only masks this core for the two stores of one record
+	uint32_t status = save_and_disable_interrupts();
+
+	uint32_t head = ring->head;
+	if (head - ring->tail >= TRACE_BUFFER_RECORDS) {
+		ring->stats.dropped++;
+		restore_interrupts(status);
+		return;
+	}
+
+	struct traceRecord *record = &ring->records[head & TRACE_MASK];
+	record->time = time_us_32();
+	record->event = event;
+	__dmb();
+	ring->head = head + 1u;
+	ring->stats.records++;
+
+	restore_interrupts(status);
+}
+
+uint32_t traceRead(uint8_t core, struct traceRecord *records, uint32_t maxRecords) {
+
+	if (core >= TRACE_CORES || records == NULL) {
+		return 0u;
+	}
+
+	struct traceRing *ring = &traceRings[core];
+	uint32_t tail = ring->tail;
+	const uint32_t head = ring->head;
+	__dmb();
+
+	uint32_t read = 0u;
+	while (tail != head && read < maxRecords) {
+		records[read++] = ring->records[tail & TRACE_MASK];
+		tail++;
+	}
+
+	__dmb();
+	ring->tail = tail;
+	return read;
+}
+
+uint32_t traceFlush(struct frameEncoder *encoder) {
+
+	struct traceRecord records[TRACE_FLUSH_RECORDS];
+	uint32_t sent = 0u;
+
+	struct frameHeader header = {
+		.type = FRAME_TRACE,
+		.samplePeriodNs = 0u,
+		.firstSample = 0u,
+	};
+
+	for (uint8_t core = 0; core < TRACE_CORES; core++) {
+		header.channel = core;
+		uint32_t read;
+		while ((read = traceRead(core, records, TRACE_FLUSH_RECORDS)) != 0u) {
+			frameSend(encoder, &header, records, read * sizeof(struct traceRecord));
+			sent += read;
+		}
+	}
+
+	return sent;
+}
+
+void traceGetStats(uint8_t core, struct traceStats *stats) {
+	if (core < TRACE_CORES) {
+		*stats = traceRings[core].stats;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+/*
+	board_pico_trace.h - tracepoints for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_TRACE_H
+#define BOARD_PICO_TRACE_H
+
+#include "board_pico.h"
+#include "board_pico_frame.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Trace Config
+ * 
+ * Define TRACE_ENABLED to build tracepoints in,
+ * otherwise TRACE_BEGIN and TRACE_END compile to nothing
+ * 
+ * Record (32 bit words, little endian):
+ * 	word 0: time in us
+ * 	word 1: phase << 24 | core << 16 | event ID
+ * 
+ * tools/trace_to_json.py turns FRAME_TRACE frames
+ * into Chrome trace JSON, which Perfetto also opens
+****************************/
+
+#ifndef TRACE_BUFFER_RECORDS
+	#define TRACE_BUFFER_RECORDS 256u // records in each core's trace buffer (power of 2)
+#endif
+
+#define TRACE_ID_SHIFT 0u // shift of event ID in word 1
+#define TRACE_CORE_SHIFT 16u // shift of core in word 1
+#define TRACE_PHASE_SHIFT 24u // shift of phase in word 1
+
+enum TracePhase {
+	TRACE_PHASE_BEGIN, // event started
+	TRACE_PHASE_END, // event finished
+};
+
+enum TraceEvent {
+	TRACE_TIMER = 0, // hard timer callback, plus timer number
+	TRACE_NVM_COMMIT = 32, // NVM written to flash
+	TRACE_THREAD_SAFETY = 33, // interrupts and core 1 held off
+	TRACE_USER = 256, // first ID free for sketches
+};
+
+struct traceRecord {
+	uint32_t time; // time in us
+	uint32_t event; // phase, core and event ID
+};
+
+struct traceStats {
+	uint32_t records; // records written
+	uint32_t dropped; // records dropped because buffer was full
+};
+
+/**
+ * Stores trace record
+ * 
+ * @param id event ID
+ * @param phase whether event is starting or finishing
+ * 
+ * @note use TRACE_BEGIN and TRACE_END instead of calling directly
+ */
+void traceWrite(uint16_t id, enum TracePhase phase);
+
+/**
+ * Reads records from a core's trace buffer
+ * 
+ * @param core core that wrote records
+ * @param records pointer to records
+ * @param maxRecords size of records
+ * 
+ * @return amount of records read
+ */
+uint32_t traceRead(uint8_t core, struct traceRecord *records, uint32_t maxRecords);
+
+/**
+ * Sends all waiting records as FRAME_TRACE frames
+ * 
+ * @param encoder frame encoder, channel of each frame is core
+ * 
+ * @return amount of records sent
+ */
+uint32_t traceFlush(struct frameEncoder *encoder);
+
+/**
+ * Gets trace statistics
+ * 
+ * @param core core to get statistics of
+ * @param stats pointer to statistics
+ */
+void traceGetStats(uint8_t core, struct traceStats *stats);
+
+#ifdef TRACE_ENABLED
+
+	#define TRACE_BEGIN(id) traceWrite((uint16_t)(id), TRACE_PHASE_BEGIN) // marks start of event
+	#define TRACE_END(id) traceWrite((uint16_t)(id), TRACE_PHASE_END) // marks end of event
+
+#else
+
+	#define TRACE_BEGIN(id) do {} while (0)
+	#define TRACE_END(id) do {} while (0)
+
+#endif
+
+#endif
\ No newline at end of file
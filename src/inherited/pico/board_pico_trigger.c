@@ -0,0 +1,395 @@
+/*
+	board_pico_trigger.c - trigger configuration for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "board_pico_trigger.h"
+
+#include <stddef.h>
+
+#define PHASE_ARM 0u // waiting for signal to pass hysteresis
+#define PHASE_READY 1u // armed, waiting for trigger condition
+#define PHASE_PULSE 2u // inside pulse, counting width
+
+#define LANE_HIGH 0x80008000u // top bit of each 16 bit lane
+#define LANE_SPLAT(value) ((uint32_t)(value) * 0x00010001u) // copies value into both lanes
+
+typedef uint32_t __attribute__((__may_alias__)) trigger_word_t; // two packed samples
+
+/**
+ * Compares both samples in word against threshold
+ * 
+ * @param word two packed samples
+ * @param splat threshold copied into both lanes
+ * 
+ * @return top bit of each lane set when sample >= threshold
+ * 
+ * @note samples and threshold must be <= 0x8000 so lanes never borrow
+ */
+static inline uint32_t lanesAtOrAbove(uint32_t word, uint32_t splat) {
+	return ((word | LANE_HIGH) - splat) & LANE_HIGH;
+}
+
+/**
+ * Searches samples a word at a time until word matches,
+ * then finds matching sample within word
+ * 
+ * @param wordMatch expression on word, true when a sample in word matches
+ * @param sampleMatch expression on sample, true when sample matches
+ */
+#define SCAN_WORDS(wordMatch, sampleMatch) \
+	uint32_t i = 0; \
+	if (count > 0 && ((uintptr_t)samples & 2u)) { \
+		trigger_sample_t sample = samples[0]; \
+		if (sampleMatch) { \
+			return 0; \
+		} \
+		i = 1; \
+	} \
+	for (; i + 4 <= count; i += 4) { \
+		const trigger_word_t *words = (const trigger_word_t*)(samples + i); \
+		uint32_t word = words[0]; \
+		uint32_t found = (wordMatch); \
+		word = words[1]; \
+		found |= (wordMatch); \
+		if (found) { \
+			break; \
+		} \
+	} \
+	for (; i < count; i++) { \
+		trigger_sample_t sample = samples[i]; \
+		if (sampleMatch) { \
+			return i; \
+		} \
+	} \
+	return count;
+
+/**
+ * Finds first sample at or above threshold
+ * 
+ * @return index of sample, count if not found
+ */
+static uint32_t RUN_IN_RAM(scanAtOrAbove) scanAtOrAbove(const trigger_sample_t *samples, uint32_t count, uint32_t threshold) {
+	const uint32_t splat = LANE_SPLAT(threshold);
+	SCAN_WORDS(lanesAtOrAbove(word, splat), sample >= threshold);
+}
+
+/**
+ * Finds first sample below threshold
+ * 
+ * @return index of sample, count if not found
+ */
+static uint32_t RUN_IN_RAM(scanBelow) scanBelow(const trigger_sample_t *samples, uint32_t count, uint32_t threshold) {
+	const uint32_t splat = LANE_SPLAT(threshold);
+	SCAN_WORDS(lanesAtOrAbove(word, splat) ^ LANE_HIGH, sample < threshold);
+}
+
+/**
+ * Finds first sample between low and high (inclusive)
+ * 
+ * @return index of sample, count if not found
+ */
+static uint32_t RUN_IN_RAM(scanInside) scanInside(const trigger_sample_t *samples, uint32_t count, uint32_t low, uint32_t high) {
+	const uint32_t lowSplat = LANE_SPLAT(low);
+	const uint32_t highSplat = LANE_SPLAT(high + 1u);
+	SCAN_WORDS(lanesAtOrAbove(word, lowSplat) & ~lanesAtOrAbove(word, highSplat), sample >= low && sample <= high);
+}
+
+/**
+ * Finds first sample below low or above high
+ * 
+ * @return index of sample, count if not found
+ */
+static uint32_t RUN_IN_RAM(scanOutside) scanOutside(const trigger_sample_t *samples, uint32_t count, uint32_t low, uint32_t high) {
+	const uint32_t lowSplat = LANE_SPLAT(low);
+	const uint32_t highSplat = LANE_SPLAT(high + 1u);
+	SCAN_WORDS((lanesAtOrAbove(word, lowSplat) ^ LANE_HIGH) | lanesAtOrAbove(word, highSplat), sample < low || sample > high);
+}
+
+/**
+ * Gets phase search starts in after arming or triggering
+ * 
+ * @param mode trigger mode
+ * 
+ * @return starting phase
+ */
+static uint8_t startPhase(enum TriggerMode mode) {
+	if (mode == TRIGGER_LEVEL) {
+		return PHASE_READY;
+	}
+	return PHASE_ARM;
+}
+
+/**
+ * Checks whether trigger arms on high samples
+ * 
+ * @param config trigger configuration
+ * 
+ * @return true if signal has to be high before trigger arms
+ */
+static bool armsHigh(const struct triggerConfig *config) {
+	return config->mode == TRIGGER_FALLING || (config->mode == TRIGGER_PULSE_WIDTH && !config->pulsePositive);
+}
+
+/**
+ * Finds sample that arms trigger
+ * 
+ * @return index of sample, count if not found
+ */
+static uint32_t scanArm(const struct triggerConfig *config, const trigger_sample_t *samples, uint32_t count) {
+	if (config->mode == TRIGGER_WINDOW) {
+		return scanInside(samples, count, config->windowLow + config->hysteresis, config->windowHigh - config->hysteresis);
+	}
+	if (armsHigh(config)) {
+		return scanAtOrAbove(samples, count, config->level + config->hysteresis + 1u);
+	}
+	return scanBelow(samples, count, config->level - config->hysteresis);
+}
+
+/**
+ * Finds sample that meets trigger condition (or starts pulse)
+ * 
+ * @return index of sample, count if not found
+ */
+static uint32_t scanReady(const struct triggerConfig *config, const trigger_sample_t *samples, uint32_t count) {
+	if (config->mode == TRIGGER_WINDOW) {
+		return scanOutside(samples, count, config->windowLow, config->windowHigh);
+	}
+	if (armsHigh(config)) {
+		return scanBelow(samples, count, config->level + 1u);
+	}
+	return scanAtOrAbove(samples, count, config->level);
+}
+
+bool triggerConfigValid(const struct triggerConfig *config, uint32_t bufferSize) {
+
+	if (config == NULL) {
+		return false;
+	}
+	if (bufferSize < 2u || (bufferSize & (bufferSize - 1u)) != 0u) {
+		return false;
+	}
+	if (config->postTrigger == 0u || config->preTrigger > bufferSize || config->postTrigger > bufferSize - config->preTrigger) {
+		return false;
+	}
+	if (config->level > TRIGGER_SAMPLE_MAX || config->hysteresis > TRIGGER_SAMPLE_MAX) {
+		return false;
+	}
+
+	switch (config->mode) {
+		case TRIGGER_LEVEL:
+			return true;
+		case TRIGGER_RISING:
+			return config->hysteresis < config->level;
+		case TRIGGER_FALLING:
+			return config->level + config->hysteresis < TRIGGER_SAMPLE_MAX;
+		case TRIGGER_PULSE_WIDTH:
+			if (config->pulseMin > config->pulseMax) {
+				return false;
+			}
+			if (config->pulsePositive) {
+				return config->hysteresis < config->level;
+			}
+			return config->level + config->hysteresis < TRIGGER_SAMPLE_MAX;
+		case TRIGGER_WINDOW:
+			if (config->windowHigh > TRIGGER_SAMPLE_MAX || config->windowLow > config->windowHigh) {
+				return false;
+			}
+			return (uint32_t)config->windowLow + 2u * config->hysteresis <= config->windowHigh;
+	}
+	return false;
+}
+
+void triggerSearchReset(struct triggerSearch *search) {
+	search->phase = PHASE_ARM;
+	search->holdoffLeft = 0u;
+	search->pulseLength = 0u;
+}
+
+void RUN_IN_RAM(triggerSkip) triggerSkip(struct triggerSearch *search, uint32_t count) {
+	if (search->holdoffLeft > count) {
+		search->holdoffLeft -= count;
+	}
+	else {
+		search->holdoffLeft = 0u;
+	}
+}
+
+uint32_t RUN_IN_RAM(triggerScan) triggerScan(const struct triggerConfig *config, struct triggerSearch *search, const trigger_sample_t *samples, uint32_t count) {
+
+	uint32_t index = 0u;
+
+	if (search->phase == PHASE_ARM && config->mode == TRIGGER_LEVEL) {
+		search->phase = PHASE_READY;
+	}
+
+	while (index < count) {
+
+		uint32_t left = count - index;
+
+		if (search->holdoffLeft > 0u) {
+			uint32_t skip = search->holdoffLeft < left ? search->holdoffLeft : left;
+			search->holdoffLeft -= skip;
+			index += skip;
+			continue;
+		}
+
+		uint32_t found;
+		if (search->phase == PHASE_ARM) {
+			found = scanArm(config, samples + index, left);
+			index += found;
+			if (found != left) {
+				search->phase = PHASE_READY;
+			}
+			continue;
+		}
+		else if (search->phase == PHASE_READY) {
+			found = scanReady(config, samples + index, left);
+			index += found;
+			if (found == left) {
+				continue;
+			}
+			if (config->mode != TRIGGER_PULSE_WIDTH) {
+				break;
+			}
+			search->phase = PHASE_PULSE;
+			search->pulseLength = 0u;
+			continue;
+		}
+
+		// pulse ends once signal passes back through hysteresis
+		found = scanArm(config, samples + index, left);
+		index += found;
+		search->pulseLength += found;
+		if (found == left) {
+			continue;
+		}
+		if (search->pulseLength >= config->pulseMin && search->pulseLength <= config->pulseMax) {
+			break;
+		}
+		search->phase = PHASE_READY;
+	}
+
+	if (index < count) {
+		search->phase = startPhase(config->mode);
+		search->holdoffLeft = config->holdoff;
+	}
+
+	return index;
+}
+
+bool triggerBegin(struct triggerCapture *capture, trigger_sample_t *buffer, uint32_t bufferSize, const struct triggerConfig *config) {
+
+	if (capture == NULL || buffer == NULL) {
+		return false;
+	}
+	if (!triggerConfigValid(config, bufferSize)) {
+		capture->status = TRIGGER_INVALID;
+		return false;
+	}
+
+	capture->buffer = buffer;
+	capture->mask = bufferSize - 1u;
+	capture->head = 0u;
+	capture->config = *config;
+	triggerSearchReset(&capture->search);
+	capture->search.phase = startPhase(config->mode);
+	triggerRearm(capture);
+
+	return true;
+}
+
+void triggerRearm(struct triggerCapture *capture) {
+	capture->filled = 0u;
+	capture->triggerIndex = 0u;
+	capture->postLeft = 0u;
+	capture->status = TRIGGER_WAITING;
+}
+
+enum TriggerStatus RUN_IN_RAM(triggerFeed) triggerFeed(struct triggerCapture *capture, uint32_t newSamples) {
+
+	if (capture->status == TRIGGER_COMPLETE || capture->status == TRIGGER_INVALID) {
+		return capture->status;
+	}
+
+	const uint32_t bufferSize = capture->mask + 1u;
+	uint32_t index = 0u;
+
+	while (index < newSamples && capture->status != TRIGGER_COMPLETE) {
+
+		// splits search where buffer wraps
+		uint32_t position = (capture->head + index) & capture->mask;
+		uint32_t span = newSamples - index;
+		if (span > bufferSize - position) {
+			span = bufferSize - position;
+		}
+
+		if (capture->status == TRIGGER_FIRED) {
+			uint32_t take = span < capture->postLeft ? span : capture->postLeft;
+			triggerSkip(&capture->search, take);
+			capture->postLeft -= take;
+			index += take;
+			if (capture->postLeft == 0u) {
+				capture->status = TRIGGER_COMPLETE;
+			}
+			continue;
+		}
+
+		// trigger can't fire until pre trigger samples are valid, they're still
+		// searched so an edge can arm, a trigger found in them is dropped
+		if (capture->filled < capture->config.preTrigger) {
+			uint32_t take = capture->config.preTrigger - capture->filled;
+			if (take > span) {
+				take = span;
+			}
+			uint32_t searched = triggerScan(&capture->config, &capture->search, capture->buffer + position, take);
+			while (searched < take) {
+				capture->search.holdoffLeft = 0u;
+				searched++;
+				searched += triggerScan(&capture->config, &capture->search, capture->buffer + position + searched, take - searched);
+			}
+			capture->filled += take;
+			index += take;
+			continue;
+		}
+
+		uint32_t found = triggerScan(&capture->config, &capture->search, capture->buffer + position, span);
+		index += found;
+		if (found == span) {
+			continue;
+		}
+
+		capture->triggerIndex = position + found;
+		capture->postLeft = capture->config.postTrigger - 1u;
+		capture->status = capture->postLeft == 0u ? TRIGGER_COMPLETE : TRIGGER_FIRED;
+		index++;
+	}
+
+	capture->head = (capture->head + newSamples) & capture->mask;
+
+	return capture->status;
+}
+
+bool triggerGetCapture(const struct triggerCapture *capture, uint32_t *start, uint32_t *length) {
+
+	if (capture->status != TRIGGER_COMPLETE) {
+		return false;
+	}
+
+	*start = (capture->triggerIndex - capture->config.preTrigger) & capture->mask;
+	*length = capture->config.preTrigger + capture->config.postTrigger;
+	return true;
+}
\ No newline at end of file
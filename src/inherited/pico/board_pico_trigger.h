@@ -0,0 +1,175 @@
+/*
+	board_pico_trigger.h - trigger configuration for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_TRIGGER_H
+#define BOARD_PICO_TRIGGER_H
+
+#include "board_pico.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Trigger Config
+ * 
+ * Samples are 12 bit ADC values stored in
+ * 16 bits, two samples are searched per 32 bit word
+****************************/
+
+#define TRIGGER_SAMPLE_MAX ((uint32_t)SAMPLE_MAX) // largest sample value the trigger accepts
+
+typedef sample_t trigger_sample_t; // sample type searched by trigger
+
+enum TriggerMode {
+	TRIGGER_RISING, // sample rises through level
+	TRIGGER_FALLING, // sample falls through level
+	TRIGGER_LEVEL, // sample is at or above level
+	TRIGGER_PULSE_WIDTH, // pulse width is within min and max
+	TRIGGER_WINDOW, // sample leaves window between low and high
+};
+
+enum TriggerStatus {
+	TRIGGER_WAITING, // waiting for trigger condition
+	TRIGGER_FIRED, // triggered, collecting post trigger samples
+	TRIGGER_COMPLETE, // capture is complete
+	TRIGGER_INVALID, // configuration is invalid
+};
+
+struct triggerConfig {
+	enum TriggerMode mode; // trigger condition
+	trigger_sample_t level; // edge, level and pulse threshold
+	trigger_sample_t hysteresis; // distance signal travels past level before rearming
+	trigger_sample_t windowLow; // lower window bound
+	trigger_sample_t windowHigh; // upper window bound
+	uint32_t pulseMin; // min pulse width in samples
+	uint32_t pulseMax; // max pulse width in samples
+	bool pulsePositive; // true for high pulses, false for low pulses
+	uint32_t holdoff; // samples ignored after trigger before arming again
+	uint32_t preTrigger; // samples kept before trigger point
+	uint32_t postTrigger; // samples kept after and including trigger point
+};
+
+struct triggerSearch {
+	uint8_t phase; // current search phase
+	uint32_t holdoffLeft; // samples left before search continues
+	uint32_t pulseLength; // samples counted in current pulse
+};
+
+struct triggerCapture {
+	trigger_sample_t *buffer; // circular capture buffer
+	uint32_t mask; // buffer size - 1
+	uint32_t head; // next index written by acquisition
+	uint32_t filled; // pre trigger samples acquired since arming
+	uint32_t triggerIndex; // buffer index of trigger sample
+	uint32_t postLeft; // post trigger samples left to acquire
+	enum TriggerStatus status; // capture status
+	struct triggerConfig config; // trigger configuration
+	struct triggerSearch search; // search state carried between buffers
+};
+
+/**
+ * Checks trigger configuration
+ * 
+ * @param config configuration to check
+ * @param bufferSize size of capture buffer in samples
+ * 
+ * @return whether configuration can be used
+ */
+bool triggerConfigValid(const struct triggerConfig *config, uint32_t bufferSize);
+
+/**
+ * Resets search state
+ * 
+ * @param search search state to reset
+ */
+void triggerSearchReset(struct triggerSearch *search);
+
+/**
+ * Searches samples for trigger condition
+ * 
+ * @param config trigger configuration
+ * @param search search state carried between calls
+ * @param samples samples to search
+ * @param count amount of samples
+ * 
+ * @return index of trigger sample, count if not found
+ * 
+ * @note samples are searched two at a time when 32 bit aligned
+ * @note search continues from sample after trigger, holdoff counts from there
+ */
+uint32_t triggerScan(const struct triggerConfig *config, struct triggerSearch *search, const trigger_sample_t *samples, uint32_t count);
+
+/**
+ * Skips samples without searching them
+ * 
+ * @param search search state
+ * @param count amount of samples skipped
+ * 
+ * @note holdoff keeps counting down while skipped
+ */
+void triggerSkip(struct triggerSearch *search, uint32_t count);
+
+/**
+ * Sets up capture over circular buffer
+ * 
+ * @param capture capture to set up
+ * @param buffer circular buffer filled by acquisition
+ * @param bufferSize size of buffer in samples (power of 2)
+ * @param config trigger configuration
+ * 
+ * @return whether capture was set up
+ */
+bool triggerBegin(struct triggerCapture *capture, trigger_sample_t *buffer, uint32_t bufferSize, const struct triggerConfig *config);
+
+/**
+ * Arms capture for next trigger
+ * 
+ * @param capture capture to arm
+ * 
+ * @note holdoff from previous trigger is kept
+ */
+void triggerRearm(struct triggerCapture *capture);
+
+/**
+ * Processes samples acquisition wrote at head of buffer
+ * 
+ * @param capture capture to update
+ * @param newSamples amount of samples written since last call
+ * 
+ * @return capture status
+ * 
+ * @note samples before pre trigger is full arm search but can't fire,
+ * an edge in them has to arm again
+ * @warning acquisition must not overwrite buffer once complete
+ */
+enum TriggerStatus triggerFeed(struct triggerCapture *capture, uint32_t newSamples);
+
+/**
+ * Gets location of completed capture
+ * 
+ * @param capture completed capture
+ * @param start pointer to index of first sample
+ * @param length pointer to amount of samples
+ * 
+ * @return whether capture is complete
+ * 
+ * @note samples wrap around end of buffer
+ */
+bool triggerGetCapture(const struct triggerCapture *capture, uint32_t *start, uint32_t *length);
+
+#endif
\ No newline at end of file
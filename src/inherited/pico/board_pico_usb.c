@@ -0,0 +1,259 @@
+/*
+	board_pico_usb.c - USB streaming for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "board_pico_usb.h"
+
+#include <stddef.h>
+
+struct usbStats usbStatistics;
+
+#ifdef PLATFORMIO
+
+	// Arduino core owns USB so streaming isn't available
+
+	bool usbBegin(void) {
+		return false;
+	}
+
+	bool usbConnected(void) {
+		return false;
+	}
+
+	bool usbStreamReady(void) {
+		return false;
+	}
+
+	bool usbStreamSubmit(const void *buffer, uint32_t length, usb_release_t release, void *context) {
+		(void)buffer;
+		(void)length;
+		(void)release;
+		(void)context;
+		usbStatistics.rejected++;
+		return false;
+	}
+
+	uint32_t usbTask(void) {
+		return 0u;
+	}
+
+	uint32_t usbWrite(const uint8_t *data, uint32_t length) {
+		(void)data;
+		if (length != 0u) {
+			usbStatistics.overflows++;
+			usbStatistics.dropped += length;
+		}
+		return 0u;
+	}
+
+	uint32_t usbFree(void) {
+		return 0u;
+	}
+
+	uint32_t usbPending(void) {
+		return 0u;
+	}
+
+	bool usbFlush(uint32_t timeoutUS) {
+		(void)timeoutUS;
+		return true;
+	}
+
+#else
+
+	#include <hardware/sync.h>
+	#include <pico/stdlib.h>
+	#include <tusb.h>
+
+	struct usbSlot {
+		const uint8_t *buffer; // capture buffer being sent
+		uint32_t length; // bytes in buffer
+		uint32_t sent; // bytes already in endpoint
+		usb_release_t release; // called once buffer is sent
+		void *context; // passed to release
+	};
+
+	struct usbSlot usbSlots[USB_STREAM_SLOTS];
+	volatile uint32_t usbHead = 0u; // buffers ever submitted
+	volatile uint32_t usbTail = 0u; // buffers ever released
+	bool usbStalled = false; // host stopped taking bytes
+
+	bool usbBegin(void) {
+		#ifndef LIB_PICO_STDIO_USB
+			return tusb_init();
+		#else
+			return true;
+		#endif
+	}
+
+	bool usbConnected(void) {
+		return tud_cdc_connected();
+	}
+
+	bool usbStreamReady(void) {
+		return usbHead - usbTail < USB_STREAM_SLOTS;
+	}
+
+	bool usbStreamSubmit(const void *buffer, uint32_t length, usb_release_t release, void *context) {
+
+		if (buffer == NULL || length == 0u) {
+			return false;
+		}
+
+		uint32_t status = save_and_disable_interrupts();
+
+		uint32_t head = usbHead;
+		if (head - usbTail >= USB_STREAM_SLOTS) {
+			usbStatistics.rejected++;
+			restore_interrupts(status);
+			return false;
+		}
+
+		struct usbSlot *slot = &usbSlots[head % USB_STREAM_SLOTS];
+		slot->buffer = (const uint8_t*)buffer;
+		slot->length = length;
+		slot->sent = 0u;
+		slot->release = release;
+		slot->context = context;
+		usbHead = head + 1u;
+		usbStatistics.submitted++;
+
+		restore_interrupts(status);
+		return true;
+	}
+
+	/**
+	 * Hands slot back to acquisition
+	 * 
+	 * @param slot slot to release
+	 */
+	void usbRelease(struct usbSlot *slot) {
+		usb_release_t release = slot->release;
+		const void *buffer = slot->buffer;
+		void *context = slot->context;
+		__dmb();
+		usbTail++;
+		if (release != NULL) {
+			release(buffer, context);
+		}
+	}
+
+	uint32_t usbTask(void) {
+
+		// stdio USB already runs device stack from its own interrupt
+		#ifndef LIB_PICO_STDIO_USB
+			tud_task();
+		#endif
+
+		if (!tud_cdc_connected()) {
+			while (usbTail != usbHead) {
+				usbStatistics.abandoned++;
+				usbRelease(&usbSlots[usbTail % USB_STREAM_SLOTS]);
+			}
+			return 0u;
+		}
+
+		uint32_t moved = 0u;
+		while (usbTail != usbHead) {
+
+			struct usbSlot *slot = &usbSlots[usbTail % USB_STREAM_SLOTS];
+			uint32_t space = tud_cdc_write_available();
+			if (space == 0u) {
+				if (!usbStalled) {
+					usbStatistics.stalls++;
+					usbStalled = true;
+				}
+				break;
+			}
+			usbStalled = false;
+
+			uint32_t take = slot->length - slot->sent;
+			if (take > space) {
+				take = space;
+			}
+			take = tud_cdc_write(slot->buffer + slot->sent, take);
+			slot->sent += take;
+			moved += take;
+
+			if (slot->sent == slot->length) {
+				usbStatistics.released++;
+				usbRelease(slot);
+			}
+		}
+
+		if (moved != 0u) {
+			tud_cdc_write_flush();
+			usbStatistics.sent += moved;
+		}
+		return moved;
+	}
+
+	uint32_t usbFree(void) {
+
+		usbTask();
+
+		// submitted buffers go first
+		if (!tud_cdc_connected() || usbTail != usbHead) {
+			return 0u;
+		}
+		return tud_cdc_write_available();
+	}
+
+	uint32_t usbWrite(const uint8_t *data, uint32_t length) {
+
+		if (data == NULL) {
+			return 0u;
+		}
+
+		uint32_t take = length;
+		uint32_t space = usbFree();
+		if (take > space) {
+			take = space;
+		}
+		if (take != 0u) {
+			take = tud_cdc_write(data, take);
+			tud_cdc_write_flush();
+			usbStatistics.sent += take;
+		}
+
+		if (take < length) {
+			usbStatistics.overflows++;
+			usbStatistics.dropped += length - take;
+		}
+		return take;
+	}
+
+	uint32_t usbPending(void) {
+		return usbHead - usbTail;
+	}
+
+	bool usbFlush(uint32_t timeoutUS) {
+		absolute_time_t end = make_timeout_time_us(timeoutUS);
+		while (usbPending() != 0u) {
+			if (time_reached(end)) {
+				return false;
+			}
+			usbTask();
+		}
+		return true;
+	}
+
+#endif
+
+void usbGetStats(struct usbStats *stats) {
+	*stats = usbStatistics;
+}
\ No newline at end of file
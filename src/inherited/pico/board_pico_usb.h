@@ -0,0 +1,151 @@
+/*
+	board_pico_usb.h - USB streaming for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_USB_H
+#define BOARD_PICO_USB_H
+
+#include "board_pico.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * USB Config
+ * 
+ * Capture buffers are submitted by reference and streamed
+ * over USB CDC from usbTask, which copies them into the CDC
+ * FIFO as space frees up, the buffer is only handed back
+ * through its release callback once every byte is copied
+ * 
+ * USB_STREAM_SLOTS buffers can be in flight so acquisition
+ * fills one while the other streams, usbStreamReady is the
+ * flow control check before acquisition reuses a buffer
+ * 
+ * usbWrite matches serialWrite so anything built
+ * on the serial path can switch to USB, it never waits
+ * and counts bytes that don't fit as dropped, usbFree
+ * gives the room a write has
+****************************/
+
+#ifndef USB_STREAM_SLOTS
+	#define USB_STREAM_SLOTS 2u // capture buffers in flight
+#endif
+
+typedef void (*usb_release_t)(const void *buffer, void *context); // called once buffer is sent
+
+struct usbStats {
+	uint32_t submitted; // buffers accepted
+	uint32_t rejected; // buffers refused because every slot was busy
+	uint32_t released; // buffers fully sent
+	uint32_t abandoned; // buffers released unsent because host disconnected
+	uint32_t sent; // bytes handed to endpoint
+	uint32_t stalls; // times host stopped taking bytes while data was waiting
+	uint32_t overflows; // writes that didn't fully fit
+	uint32_t dropped; // bytes usbWrite couldn't queue
+};
+
+/**
+ * Starts USB device stack
+ * 
+ * @return whether USB started
+ */
+bool usbBegin(void);
+
+/**
+ * Checks if host has the CDC port open
+ * 
+ * @return whether host is connected
+ */
+bool usbConnected(void);
+
+/**
+ * Checks if a capture buffer can be submitted
+ * 
+ * @return whether a slot is free
+ */
+bool usbStreamReady(void);
+
+/**
+ * Submits capture buffer to stream by reference
+ * 
+ * @param buffer bytes to send, must stay untouched until released
+ * @param length amount of bytes
+ * @param release called once buffer is sent, can be NULL
+ * @param context passed to release
+ * 
+ * @return whether buffer was accepted
+ * 
+ * @note safe to call from interrupts, such as DMA completion
+ */
+bool usbStreamSubmit(const void *buffer, uint32_t length, usb_release_t release, void *context);
+
+/**
+ * Moves submitted buffers into USB endpoint
+ * 
+ * @return amount of bytes moved
+ * 
+ * @note call often from main loop, also runs USB stack unless stdio USB does
+ */
+uint32_t usbTask(void);
+
+/**
+ * Queues bytes to send without waiting
+ * 
+ * @param data bytes to send
+ * @param length amount of bytes
+ * 
+ * @return amount of bytes queued, less than length if CDC FIFO
+ * is full, submitted buffers are still sending or host is disconnected
+ * 
+ * @note bytes only go once submitted buffers are sent so frames are never split
+ */
+uint32_t usbWrite(const uint8_t *data, uint32_t length);
+
+/**
+ * Gets room usbWrite has without dropping bytes
+ * 
+ * @return amount of bytes
+ */
+uint32_t usbFree(void);
+
+/**
+ * Gets submitted buffers still being sent
+ * 
+ * @return amount of busy slots
+ */
+uint32_t usbPending(void);
+
+/**
+ * Waits until every submitted buffer is sent
+ * 
+ * @param timeoutUS longest time to wait in us
+ * 
+ * @return whether every buffer was sent or released
+ * 
+ * @note buffers are released unsent if host disconnects
+ */
+bool usbFlush(uint32_t timeoutUS);
+
+/**
+ * Gets USB statistics
+ * 
+ * @param stats pointer to statistics
+ */
+void usbGetStats(struct usbStats *stats);
+
+#endif
\ No newline at end of file
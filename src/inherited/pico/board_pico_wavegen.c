@@ -0,0 +1,378 @@
+/*
+	board_pico_wavegen.c - PWM waveform generator for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#include <hardware/pwm.h>
+
+#include "board_pico_clock.h"
+#include "board_pico_wavegen.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define SINE_QUARTER (WAVEGEN_SINE_POINTS / 4u) // sine angle steps per quarter period
+#define SINE_MASK (WAVEGEN_SINE_POINTS - 1u)
+#define MILLI_PER_UNIT 1000ull
+
+// sin(2 * pi * i / 4096) in Q15 for first quarter period, shared with FFT
+extern const int16_t fftQuarterSine[SINE_QUARTER + 1u];
+
+struct wavegen *wavegens[WAVEGEN_MAX]; // generators kept at their frequency
+uint8_t wavegenCount = 0u; // generators set up
+bool wavegenListening = false; // clock listener added
+
+/**
+ * Gets sine from FFT quarter table
+ * 
+ * @param index angle in 1/4096 of a period
+ * 
+ * @return sine in Q15
+ */
+static int32_t wavegenSineQ15(uint32_t index) {
+	index &= SINE_MASK;
+	if (index < SINE_QUARTER) {
+		return fftQuarterSine[index];
+	}
+	if (index < 2u * SINE_QUARTER) {
+		return fftQuarterSine[2u * SINE_QUARTER - index];
+	}
+	if (index < 3u * SINE_QUARTER) {
+		return -fftQuarterSine[index - 2u * SINE_QUARTER];
+	}
+	return -fftQuarterSine[WAVEGEN_SINE_POINTS - index];
+}
+
+bool wavegenTimerFraction(uint32_t sysHz, uint32_t rateHz, uint16_t *x, uint16_t *y) {
+
+	if (rateHz == 0u || rateHz > sysHz || (uint64_t)rateHz * WAVEGEN_FRACTION_MAX < sysHz) {
+		return false;
+	}
+
+	// continued fraction convergents of rate / sys
+	uint64_t num = rateHz;
+	uint64_t den = sysHz;
+	uint64_t p0 = 0u, q0 = 1u;
+	uint64_t p1 = 1u, q1 = 0u;
+
+	while (den != 0u) {
+
+		uint64_t a = num / den;
+		uint64_t p2 = a * p1 + p0;
+		uint64_t q2 = a * q1 + q0;
+
+		if (p2 > WAVEGEN_FRACTION_MAX || q2 > WAVEGEN_FRACTION_MAX) {
+
+			// largest semiconvergent that fits may beat last convergent
+			uint64_t k = (WAVEGEN_FRACTION_MAX - q0) / q1;
+			if (p1 != 0u && (WAVEGEN_FRACTION_MAX - p0) / p1 < k) {
+				k = (WAVEGEN_FRACTION_MAX - p0) / p1;
+			}
+			uint64_t ps = k * p1 + p0;
+			uint64_t qs = k * q1 + q0;
+
+			// compares |ps / qs - r| with |p1 / q1 - r| without dividing
+			uint64_t errorS = ps * sysHz > qs * rateHz ? ps * sysHz - qs * rateHz : qs * rateHz - ps * sysHz;
+			uint64_t errorC = p1 * sysHz > q1 * rateHz ? p1 * sysHz - q1 * rateHz : q1 * rateHz - p1 * sysHz;
+			if (k != 0u && errorS * q1 < errorC * qs) {
+				p1 = ps;
+				q1 = qs;
+			}
+			break;
+		}
+
+		p0 = p1;
+		q0 = q1;
+		p1 = p2;
+		q1 = q2;
+
+		uint64_t rest = num - a * den;
+		num = den;
+		den = rest;
+	}
+
+	*x = (uint16_t)p1;
+	*y = (uint16_t)q1;
+	return true;
+}
+
+uint64_t wavegenTimerRateMilliHz(uint32_t sysHz, uint16_t x, uint16_t y) {
+	if (y == 0u) {
+		return 0u;
+	}
+	return ((uint64_t)sysHz * x * MILLI_PER_UNIT + (y >> 1)) / y;
+}
+
+void wavegenSine(uint32_t *table, uint32_t length, uint16_t top) {
+	const uint32_t step = WAVEGEN_SINE_POINTS / length;
+	for (uint32_t i = 0; i < length; i++) {
+		// maps -1 to 1 onto 0 to top with rounding
+		uint32_t level = ((uint32_t)top * (uint32_t)(32768 + wavegenSineQ15(i * step)) + 32768u) >> 16;
+		table[i] = WAVEGEN_WORD(level);
+	}
+}
+
+void wavegenSquare(uint32_t *table, uint32_t length, uint16_t top, uint32_t duty) {
+	if (duty > WAVEGEN_DUTY_SCALE) {
+		duty = WAVEGEN_DUTY_SCALE;
+	}
+	const uint32_t high = (uint32_t)(((uint64_t)length * duty + (WAVEGEN_DUTY_SCALE >> 1)) / WAVEGEN_DUTY_SCALE);
+	for (uint32_t i = 0; i < length; i++) {
+		table[i] = i < high ? WAVEGEN_WORD(top) : WAVEGEN_WORD(0u);
+	}
+}
+
+void wavegenTriangle(uint32_t *table, uint32_t length, uint16_t top) {
+	const uint32_t half = length >> 1;
+	for (uint32_t i = 0; i < length; i++) {
+		uint32_t distance = i <= half ? i : length - i;
+		uint32_t level = (2u * top * distance + half) / length;
+		table[i] = WAVEGEN_WORD(level);
+	}
+}
+
+void wavegenArbitrary(uint32_t *table, uint32_t length, uint16_t top, const sample_t *samples, uint32_t count) {
+
+	if (count == 0u) {
+		wavegenSquare(table, length, top, 0u);
+		return;
+	}
+
+	for (uint32_t i = 0; i < length; i++) {
+
+		// position in samples as 16.16
+		uint64_t position = (((uint64_t)i * count) << 16) / length;
+		uint32_t index = (uint32_t)(position >> 16);
+		uint32_t fraction = (uint32_t)position & 0xFFFFu;
+		uint32_t next = index + 1u < count ? index + 1u : 0u;
+
+		uint32_t value = ((uint32_t)samples[index] * (65536u - fraction) + (uint32_t)samples[next] * fraction + 32768u) >> 16;
+		uint32_t level = (value * top + (SAMPLE_MAX >> 1)) / SAMPLE_MAX;
+		table[i] = WAVEGEN_WORD(level);
+	}
+}
+
+/**
+ * Programs DMA timer for frequency of generator at current clk_sys
+ * 
+ * @param gen generator
+ * 
+ * @return whether frequency can be made
+ */
+static bool wavegenApplyFrequency(struct wavegen *gen) {
+
+	const uint32_t sysHz = clock_get_hz(clk_sys);
+	const uint64_t rateHz = (uint64_t)gen->freqHz * gen->length;
+
+	// compare register only latches once per PWM period
+	if (rateHz > sysHz / ((uint32_t)gen->top + 1u)) {
+		return false;
+	}
+
+	uint16_t x;
+	uint16_t y;
+	if (!wavegenTimerFraction(sysHz, (uint32_t)rateHz, &x, &y)) {
+		return false;
+	}
+
+	gen->fracX = x;
+	gen->fracY = y;
+	dma_timer_set_fraction((uint)gen->timer, x, y);
+	return true;
+}
+
+/**
+ * Keeps generators at their frequency after clocks change
+ */
+void wavegenClockChanged(void) {
+	for (uint8_t i = 0; i < wavegenCount; i++) {
+		if (wavegens[i]->freqHz != 0u) {
+			wavegenApplyFrequency(wavegens[i]);
+		}
+	}
+}
+
+/**
+ * Sets up DMA channel playing one table
+ * 
+ * @param gen generator
+ * @param index table to play
+ */
+static void wavegenConfigureChannel(struct wavegen *gen, uint8_t index) {
+
+	// ring size in bytes is 2 ^ ringBits
+	uint32_t ringBits = 2u;
+	while ((1u << ringBits) < gen->length * sizeof(uint32_t)) {
+		ringBits++;
+	}
+
+	dma_channel_config config = dma_channel_get_default_config((uint)gen->dma[index]);
+	channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+	channel_config_set_read_increment(&config, true);
+	channel_config_set_write_increment(&config, false);
+	channel_config_set_ring(&config, false, ringBits);
+	channel_config_set_dreq(&config, dma_get_timer_dreq((uint)gen->timer));
+	channel_config_set_chain_to(&config, (uint)gen->dma[index ^ 1u]);
+	dma_channel_configure((uint)gen->dma[index], &config, &pwm_hw->slice[gen->slice].cc,
+		gen->buffers + index * gen->length, gen->length, false);
+}
+
+bool wavegenBegin(struct wavegen *gen, uint8_t pin, uint32_t *buffers, uint32_t length, uint16_t top) {
+
+	if (gen == NULL || buffers == NULL || top == 0u) {
+		return false;
+	}
+	if (length < WAVEGEN_LENGTH_MIN || length > WAVEGEN_LENGTH_MAX || (length & (length - 1u)) != 0u) {
+		return false;
+	}
+	// ring wraps on address bits, so table must be aligned to its size
+	if (((uintptr_t)buffers & (length * sizeof(uint32_t) - 1u)) != 0u) {
+		return false;
+	}
+	if (wavegenCount >= WAVEGEN_MAX) {
+		return false;
+	}
+
+	int timer = dma_claim_unused_timer(false);
+	if (timer < 0) {
+		return false;
+	}
+	int dma0 = dma_claim_unused_channel(false);
+	int dma1 = dma_claim_unused_channel(false);
+	if (dma0 < 0 || dma1 < 0) {
+		if (dma0 >= 0) {
+			dma_channel_unclaim((uint)dma0);
+		}
+		if (dma1 >= 0) {
+			dma_channel_unclaim((uint)dma1);
+		}
+		dma_timer_unclaim((uint)timer);
+		return false;
+	}
+
+	gen->buffers = buffers;
+	gen->length = length;
+	gen->top = top;
+	gen->slice = (uint8_t)pwm_gpio_to_slice_num(pin);
+	gen->dma[0] = dma0;
+	gen->dma[1] = dma1;
+	gen->timer = timer;
+	gen->freqHz = 0u;
+	gen->fracX = 0u;
+	gen->fracY = 0u;
+	gen->running = false;
+	gen->filling = WAVEGEN_NOT_FILLING;
+
+	// idles at mid level
+	for (uint32_t i = 0; i < 2u * length; i++) {
+		buffers[i] = WAVEGEN_WORD(((uint32_t)top + 1u) >> 1);
+	}
+
+	pwm_config config = pwm_get_default_config();
+	pwm_config_set_clkdiv_int(&config, 1u);
+	pwm_config_set_wrap(&config, top);
+	pwm_init(gen->slice, &config, false);
+	pwm_hw->slice[gen->slice].cc = buffers[0];
+	gpio_set_function(pin, GPIO_FUNC_PWM);
+
+	wavegenConfigureChannel(gen, 0u);
+	wavegenConfigureChannel(gen, 1u);
+
+	wavegens[wavegenCount++] = gen;
+	if (!wavegenListening) {
+		wavegenListening = clockAddListener(wavegenClockChanged);
+	}
+	return true;
+}
+
+bool wavegenSetFrequency(struct wavegen *gen, uint32_t freqHz) {
+
+	uint32_t previous = gen->freqHz;
+	gen->freqHz = freqHz;
+	if (freqHz == 0u || !wavegenApplyFrequency(gen)) {
+		gen->freqHz = previous;
+		return false;
+	}
+	return true;
+}
+
+uint32_t wavegenGetFrequencyMilliHz(const struct wavegen *gen) {
+	return (uint32_t)(wavegenTimerRateMilliHz(clock_get_hz(clk_sys), gen->fracX, gen->fracY) / gen->length);
+}
+
+uint32_t* wavegenNextTable(struct wavegen *gen) {
+	// table 0 plays first, so stopped generators fill it
+	gen->filling = gen->running && dma_channel_is_busy((uint)gen->dma[0]) ? 1u : 0u;
+	return gen->buffers + gen->filling * gen->length;
+}
+
+bool wavegenSwap(struct wavegen *gen) {
+
+	// table handed out, channels may have moved on since
+	const uint8_t index = gen->filling;
+	if (index > 1u) {
+		return false;
+	}
+	gen->filling = WAVEGEN_NOT_FILLING;
+
+	if (gen->running) {
+		// other table finishes its period first
+		while (!dma_channel_is_busy((uint)gen->dma[index])) {
+			tight_loop_contents();
+		}
+	}
+
+	memcpy(gen->buffers + (index ^ 1u) * gen->length, gen->buffers + index * gen->length, gen->length * sizeof(uint32_t));
+	return true;
+}
+
+bool wavegenStart(struct wavegen *gen) {
+
+	if (gen->running || gen->freqHz == 0u) {
+		return false;
+	}
+
+	dma_channel_set_read_addr((uint)gen->dma[1], gen->buffers + gen->length, false);
+	dma_channel_set_trans_count((uint)gen->dma[1], gen->length, false);
+	dma_channel_set_read_addr((uint)gen->dma[0], gen->buffers, false);
+	dma_channel_set_trans_count((uint)gen->dma[0], gen->length, true);
+	pwm_set_enabled(gen->slice, true);
+	gen->running = true;
+	return true;
+}
+
+void wavegenStop(struct wavegen *gen) {
+
+	if (!gen->running) {
+		return;
+	}
+
+	// chain to self first so abort can't start other channel
+	for (uint8_t i = 0; i < 2u; i++) {
+		dma_channel_config config = dma_get_channel_config((uint)gen->dma[i]);
+		channel_config_set_chain_to(&config, (uint)gen->dma[i]);
+		dma_channel_set_config((uint)gen->dma[i], &config, false);
+	}
+	dma_channel_abort((uint)gen->dma[0]);
+	dma_channel_abort((uint)gen->dma[1]);
+
+	wavegenConfigureChannel(gen, 0u);
+	wavegenConfigureChannel(gen, 1u);
+	gen->running = false;
+}
\ No newline at end of file
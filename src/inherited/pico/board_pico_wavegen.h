@@ -0,0 +1,218 @@
+/*
+	board_pico_wavegen.h - PWM waveform generator for all Raspberry Pi Picos
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO_WAVEGEN_H
+#define BOARD_PICO_WAVEGEN_H
+
+#include "board_pico.h"
+#include "board_pico_sram.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Waveform Generator Config
+ * 
+ * Two DMA channels chained to each other each play a copy
+ * of the table into the PWM compare register, paced by a DMA
+ * timer, read ring wraps each channel back to the start of its
+ * table so nothing needs reloading, no CPU once started
+ * 
+ * Compare register holds both channels of slice, each table
+ * word sets both, so whole slice belongs to generator
+ * 
+ * Table is filtered to an analog signal by an RC on the pin,
+ * PWM carrier is clk_sys / (top + 1)
+****************************/
+
+#define WAVEGEN_MAX 4u // generators, one per DMA timer
+#define WAVEGEN_LENGTH_MIN 4u // fewest words in table
+#define WAVEGEN_LENGTH_MAX 4096u // most words in table, limited by DMA ring size
+#define WAVEGEN_FRACTION_MAX 65535u // largest DMA timer numerator and denominator
+#define WAVEGEN_DUTY_SCALE 10000u // square duty units per 100%
+#define WAVEGEN_SINE_POINTS 4096u // sine angle steps per period
+#define WAVEGEN_NOT_FILLING 0xFFu // no table handed out by wavegenNextTable
+
+#define WAVEGEN_WORD(level) ((uint32_t)(level) * 0x10001u) // table word setting both compare channels
+
+/**
+ * Declares double buffer for a generator
+ * 
+ * @param name buffer name
+ * @param length words in table (power of 2)
+ */
+#define WAVEGEN_BUFFERS(name, length) uint32_t name[2u * (length)] SRAM_DMA __attribute__((aligned((length) * 4u)))
+
+struct wavegen {
+	uint32_t *buffers; // two tables of length words, aligned to table size
+	uint32_t length; // words in table
+	uint16_t top; // PWM wrap, table levels run from 0 to top
+	uint8_t slice; // PWM slice of pin
+	int dma[2]; // DMA channel playing each table
+	int timer; // DMA timer pacing both channels
+	uint32_t freqHz; // waveform frequency asked for
+	uint16_t fracX; // DMA timer numerator
+	uint16_t fracY; // DMA timer denominator
+	bool running; // generator is outputting
+	uint8_t filling; // table handed out by wavegenNextTable
+};
+
+/**
+ * Gets best DMA timer fraction for a rate
+ * 
+ * @param sysHz clk_sys in Hz
+ * @param rateHz transfers per second
+ * @param x pointer to numerator
+ * @param y pointer to denominator
+ * 
+ * @return whether rate is within sysHz / WAVEGEN_FRACTION_MAX and sysHz
+ * 
+ * @note rate is sysHz * x / y, closest fraction with 16 bit terms
+ */
+bool wavegenTimerFraction(uint32_t sysHz, uint32_t rateHz, uint16_t *x, uint16_t *y);
+
+/**
+ * Gets transfer rate of DMA timer fraction
+ * 
+ * @param sysHz clk_sys in Hz
+ * @param x numerator
+ * @param y denominator
+ * 
+ * @return rate in mHz
+ */
+uint64_t wavegenTimerRateMilliHz(uint32_t sysHz, uint16_t x, uint16_t y);
+
+/**
+ * Fills table with sine
+ * 
+ * @param table words to fill
+ * @param length words in table (power of 2, up to WAVEGEN_SINE_POINTS)
+ * @param top PWM wrap, sine runs from 0 to top
+ */
+void wavegenSine(uint32_t *table, uint32_t length, uint16_t top);
+
+/**
+ * Fills table with square
+ * 
+ * @param table words to fill
+ * @param length words in table
+ * @param top PWM wrap, level of high part
+ * @param duty high part in WAVEGEN_DUTY_SCALE units
+ */
+void wavegenSquare(uint32_t *table, uint32_t length, uint16_t top, uint32_t duty);
+
+/**
+ * Fills table with triangle
+ * 
+ * @param table words to fill
+ * @param length words in table
+ * @param top PWM wrap, level of peak
+ */
+void wavegenTriangle(uint32_t *table, uint32_t length, uint16_t top);
+
+/**
+ * Fills table by resampling one period of samples
+ * 
+ * @param table words to fill
+ * @param length words in table
+ * @param top PWM wrap, level of SAMPLE_MAX
+ * @param samples one period of samples, such as a capture to replay
+ * @param count amount of samples
+ * 
+ * @note samples are interpolated, period wraps from last sample to first
+ */
+void wavegenArbitrary(uint32_t *table, uint32_t length, uint16_t top, const sample_t *samples, uint32_t count);
+
+/**
+ * Sets up generator on pin
+ * 
+ * @param gen generator to set up
+ * @param pin pin to output on
+ * @param buffers double buffer from WAVEGEN_BUFFERS
+ * @param length words in table (power of 2, WAVEGEN_LENGTH_MIN to WAVEGEN_LENGTH_MAX)
+ * @param top PWM wrap, sets resolution and carrier
+ * 
+ * @return whether generator was set up
+ * 
+ * @note claims 2 DMA channels, a DMA timer and slice of pin
+ */
+bool wavegenBegin(struct wavegen *gen, uint8_t pin, uint32_t *buffers, uint32_t length, uint16_t top);
+
+/**
+ * Sets waveform frequency
+ * 
+ * @param gen generator
+ * @param freqHz periods of table per second
+ * 
+ * @return whether frequency can be made
+ * 
+ * @note table can't be stepped faster than PWM carrier
+ * @note kept when clocks change
+ */
+bool wavegenSetFrequency(struct wavegen *gen, uint32_t freqHz);
+
+/**
+ * Gets waveform frequency made
+ * 
+ * @param gen generator
+ * 
+ * @return frequency in mHz
+ */
+uint32_t wavegenGetFrequencyMilliHz(const struct wavegen *gen);
+
+/**
+ * Gets table that isn't playing to fill with next waveform
+ * 
+ * @param gen generator
+ * 
+ * @return table of gen->length words
+ * 
+ * @note fill it before the playing table finishes its period,
+ * @note or part of the new waveform plays once early
+ */
+uint32_t* wavegenNextTable(struct wavegen *gen);
+
+/**
+ * Plays table from wavegenNextTable
+ * 
+ * @param gen generator
+ * 
+ * @return whether a table from wavegenNextTable was waiting
+ * 
+ * @note waits up to one period for table to start playing, then
+ * @note copies it over other table
+ */
+bool wavegenSwap(struct wavegen *gen);
+
+/**
+ * Starts output
+ * 
+ * @param gen generator
+ * 
+ * @return whether output started
+ */
+bool wavegenStart(struct wavegen *gen);
+
+/**
+ * Stops output, pin holds last level
+ * 
+ * @param gen generator
+ */
+void wavegenStop(struct wavegen *gen);
+
+#endif
\ No newline at end of file
@@ -30,6 +30,7 @@
 #ifdef PICO1W
 
 	#include "board_pico1w_pins.h"
+	#include "board_pico1w_delay.h"
 
 	#include "../inherited/pico/board_pico.h"
 
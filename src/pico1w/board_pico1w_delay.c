@@ -19,6 +19,69 @@
 #include <board_common.h>
 
 #include <pico/stdlib.h>
+#include <hardware/clocks.h>
+#include <hardware/structs/systick.h>
+#include <hardware/sync.h>
+
+#include "../inherited/pico/board_pico_perf.h"
+#include "board_pico1w_delay.h"
+
+#include <stddef.h>
+
+#define DELAY_CALIBRATE_CYCLES 300u // cycles waited while measuring overhead
+#define DELAY_CALIBRATE_SPAN 1024u // SysTick reload needed to measure
+
+uint32_t delayFactor = DELAY_FACTOR(DELAY_DEFAULT_CLOCK_HZ);
+uint32_t delayOverhead = 12u; // estimate until calibrated
+
+delay_background_t delayBackground[DELAY_BACKGROUND_MAX];
+uint8_t delayBackgroundCount = 0u;
+
+void RUN_IN_RAM(delayCyclesRuntime) delayCyclesRuntime(uint32_t cycles) {
+	if (cycles > delayOverhead) {
+		delayLoop(cycles - delayOverhead);
+	}
+}
+
+void delayCalibrate(void) {
+
+	delayFactor = DELAY_FACTOR(clock_get_hz(clk_sys));
+
+	struct perfSysTick saved;
+	uint32_t status = save_and_disable_interrupts();
+
+	// systick may belong to someone else, a running one is only read
+	perfSysTickBorrow(&saved, DELAY_CALIBRATE_SPAN);
+
+	uint32_t savedOverhead = delayOverhead;
+	delayOverhead = 0u;
+
+	// first run loads code into cache, second is measured
+	delayCyclesRuntime(DELAY_CALIBRATE_CYCLES);
+	uint32_t start = systick_hw->cvr;
+	delayCyclesRuntime(DELAY_CALIBRATE_CYCLES);
+	uint32_t end = systick_hw->cvr;
+	uint32_t emptyStart = systick_hw->cvr;
+	uint32_t emptyEnd = systick_hw->cvr;
+
+	// reading SysTick isn't part of a delay, loop rounds up to whole loops
+	uint32_t reading = perfSysTickCycles(&saved, emptyStart, emptyEnd);
+	uint32_t measured = perfSysTickCycles(&saved, start, end) - reading;
+	uint32_t loops = DELAY_LOOP_CYCLES * ((DELAY_CALIBRATE_CYCLES + DELAY_LOOP_CYCLES - 1u) / DELAY_LOOP_CYCLES);
+	delayOverhead = measured >= loops ? measured - loops : savedOverhead;
+
+	perfSysTickReturn(&saved);
+
+	restore_interrupts(status);
+}
+
+bool delayAddBackground(delay_background_t function) {
+	if (function == NULL || delayBackgroundCount >= DELAY_BACKGROUND_MAX) {
+		return false;
+	}
+	delayBackground[delayBackgroundCount++] = function;
+	return true;
+}
 
 void hardDelayMS(uint32_t delayAmount) {
 	sleep_ms(delayAmount);
@@ -26,4 +89,20 @@ void hardDelayMS(uint32_t delayAmount) {
 
 void hardDelayUS(uint32_t delayAmount) {
 	sleep_us(delayAmount);
+}
+
+void hardDelayYieldMS(uint32_t delayAmount) {
+
+	absolute_time_t end = make_timeout_time_ms(delayAmount);
+
+	if (delayBackgroundCount == 0u) {
+		sleep_until(end);
+		return;
+	}
+
+	while (!time_reached(end)) {
+		for (uint8_t i = 0; i < delayBackgroundCount; i++) {
+			delayBackground[i]();
+		}
+	}
 }
\ No newline at end of file
@@ -0,0 +1,151 @@
+/*
+	board_pico1w_delay.h - delay configuration for Raspberry Pi Pico W
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO1W_DELAY_H
+#define BOARD_PICO1W_DELAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef __arm__
+	#include <pico/platform.h>
+#endif
+
+#include "../inherited/pico/board_pico_cycles.h"
+
+/****************************
+ * Delay Config
+ * 
+ * hardDelayCycles spins on a 3 cycle loop so it is
+ * within 2 cycles of the request plus call overhead
+ * 
+ * hardDelayNS converts ns to cycles with delayFactor,
+ * call delayCalibrate after changing clk_sys
+ * 
+ * Define DELAY_FIXED_CLOCK_HZ when clk_sys never changes so
+ * constant delays fold to a constant loop count at compile time
+****************************/
+
+#ifndef DELAY_DEFAULT_CLOCK_HZ
+	#if defined(F_CPU)
+		#define DELAY_DEFAULT_CLOCK_HZ F_CPU // clk_sys before calibration
+	#elif defined(SYS_CLK_KHZ)
+		#define DELAY_DEFAULT_CLOCK_HZ (SYS_CLK_KHZ * 1000u)
+	#else
+		#define DELAY_DEFAULT_CLOCK_HZ 125000000u
+	#endif
+#endif
+
+#ifndef DELAY_BACKGROUND_MAX
+	#define DELAY_BACKGROUND_MAX 4u // functions hardDelayYieldMS can run
+#endif
+
+#define DELAY_LOOP_CYCLES 3u // cycles per delay loop
+#define DELAY_NS_PER_S CLOCK_NS_PER_S
+#define DELAY_FACTOR(clockHz) CLOCK_NS_FACTOR(clockHz) // ns to cycles in Q32
+#define DELAY_NS_TO_CYCLES(ns, factor) CLOCK_NS_TO_CYCLES(ns, factor)
+
+typedef void (*delay_background_t)(void); // work run while yielding
+
+extern uint32_t delayFactor; // ns to cycles of current clk_sys in Q32
+extern uint32_t delayOverhead; // cycles spent calling delayCyclesRuntime
+
+/**
+ * Measures clk_sys and call overhead for delays
+ * 
+ * @note call after clk_sys changes
+ */
+void delayCalibrate(void);
+
+/**
+ * Waits cycles not known at compile time
+ * 
+ * @param cycles amount of clk_sys cycles
+ * 
+ * @note use hardDelayCycles instead of calling directly
+ */
+void delayCyclesRuntime(uint32_t cycles);
+
+/**
+ * Adds work run by hardDelayYieldMS
+ * 
+ * @param function work to run, must return quickly
+ * 
+ * @return whether function was added
+ */
+bool delayAddBackground(delay_background_t function);
+
+/**
+ * Waits while running background work instead of sleeping
+ * 
+ * @param delayAmount amount of ms
+ */
+void hardDelayYieldMS(uint32_t delayAmount);
+
+/**
+ * Spins for loop count
+ * 
+ * @param cycles amount of cycles, loops ceil(cycles / 3) times
+ */
+static inline void delayLoop(uint32_t cycles) {
+	#ifdef __arm__
+		__asm volatile (
+			"1: subs %0, #3\n"
+			"bhi 1b\n"
+			: "+l" (cycles) : : "cc"
+		);
+	#else
+		// host builds charge the loop to the simulated clock
+		busy_wait_at_least_cycles(DELAY_LOOP_CYCLES * ((cycles + DELAY_LOOP_CYCLES - 1u) / DELAY_LOOP_CYCLES));
+	#endif
+}
+
+/**
+ * Waits clk_sys cycles
+ * 
+ * @param cycles amount of cycles
+ * 
+ * @note constant cycles are inlined without call overhead
+ */
+static inline void hardDelayCycles(uint32_t cycles) {
+	if (__builtin_constant_p(cycles)) {
+		if (cycles != 0u) {
+			delayLoop(cycles);
+		}
+	}
+	else {
+		delayCyclesRuntime(cycles);
+	}
+}
+
+/**
+ * Waits ns
+ * 
+ * @param ns amount of ns, rounded up to whole cycles
+ */
+static inline void hardDelayNS(uint32_t ns) {
+	#ifdef DELAY_FIXED_CLOCK_HZ
+		if (__builtin_constant_p(ns)) {
+			hardDelayCycles(DELAY_NS_TO_CYCLES(ns, DELAY_FACTOR(DELAY_FIXED_CLOCK_HZ)));
+			return;
+		}
+	#endif
+	delayCyclesRuntime(DELAY_NS_TO_CYCLES(ns, delayFactor));
+}
+
+#endif
\ No newline at end of file
@@ -22,15 +22,103 @@
 #include <stdio.h>
 #include <pico/stdlib.h>
 #include <pico/cyw43_arch.h>
+#include <hardware/adc.h>
 
-bool initBoard() {
+#include "../inherited/pico/board_pico_boot.h"
+#include "../inherited/pico/board_pico_calibration.h"
+#include "../inherited/pico/board_pico_clock.h"
+#include "../inherited/pico/board_pico_usb.h"
+#include "board_pico1w_delay.h"
+#include "board_pico1w_wifi.h"
+
+/**
+ * Applies saved clocks before anything measures time
+ * 
+ * @param param unused
+ * 
+ * @return whether clocks are usable
+ */
+static bool bootClock(void *param) {
+	(void)param;
+	clockAddListener(delayCalibrate);
+	// finds no state machine until wireless stage starts driver
+	clockAddListener(wifiClockChanged);
+	return clockBegin() != CLOCK_BAD_FREQ;
+}
+
+/**
+ * Loads and verifies ADC calibration
+ * 
+ * @param param unused
+ * 
+ * @return whether NVM could be read, missing calibration uses defaults
+ */
+static bool bootNVM(void *param) {
+	(void)param;
+	return calibrationLoad(&boardCalibration) != CALIBRATION_NVM_FAIL;
+}
 
-	//stdio_init_all();
-	//cyw43_arch_init();
+/**
+ * Starts ADC once clk_adc is set
+ * 
+ * @param param unused
+ * 
+ * @return true
+ */
+static bool bootADC(void *param) {
+	(void)param;
+	adc_init();
+	return true;
+}
 
+/**
+ * Starts wireless chip, loads its firmware so it's slowest stage
+ * 
+ * @param param unused
+ * 
+ * @return whether chip started
+ * 
+ * @note driver GPIO and async context interrupts are enabled on core
+ * @note that calls cyw43_arch_init, so they run on core 1 from here on,
+ * @note core 1 jobs that mask interrupts hold off wireless traffic
+ * @note and core 0 captures aren't interrupted by it
+ * @note under PlatformIO core 1 belongs to the Arduino core, stage
+ * @note runs on core 0 and interrupts stay there
+ */
+static bool bootWireless(void *param) {
+	(void)param;
+	// Arduino core or wifiBegin may have already started driver
+	if (!cyw43_is_initialized(&cyw43_state) && cyw43_arch_init() != 0) {
+		return false;
+	}
+	wifiClockChanged();
 	return true;
 }
 
+/**
+ * Starts USB device stack
+ * 
+ * @param param unused
+ * 
+ * @return whether USB started
+ */
+static bool bootUSB(void *param) {
+	(void)param;
+	return usbBegin();
+}
+
+bool initBoard() {
+
+	// wireless chip SPI runs from PIO, so clocks are set first
+	uint8_t clock = bootAddStage("clock", bootClock, NULL, 0u, BOOT_CORE0);
+	bootAddStage("wireless", bootWireless, NULL, BOOT_DEPENDS(clock), BOOT_CORE1);
+	bootAddStage("nvm", bootNVM, NULL, 0u, BOOT_CORE0);
+	bootAddStage("adc", bootADC, NULL, BOOT_DEPENDS(clock), BOOT_CORE0);
+	bootAddStage("usb", bootUSB, NULL, 0u, BOOT_CORE0);
+
+	return bootRun();
+}
+
 void hardPinMode(pin_t pin, enum pinModeState mode) {
 	if (mode == PIN_MODE_DISABLED) {
 		gpio_deinit(pin);
@@ -53,7 +141,7 @@ void hardPinMode(pin_t pin, enum pinModeState mode) {
 	}
 }
 
-void hardDigitalWrite(pin_t pin, enum digitalState value) {
+void RUN_IN_RAM(hardDigitalWrite) hardDigitalWrite(pin_t pin, enum digitalState value) {
 
 	if (pin == STATUS_LED_PIN) {
 		cyw43_arch_gpio_put(pin, value);
@@ -0,0 +1,327 @@
+/*
+	board_pico1w_wifi.c - Wi-Fi streaming for Raspberry Pi Pico W
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+
+#include <hardware/clocks.h>
+#include <hardware/pio.h>
+#include <hardware/sync.h>
+#include <pico/cyw43_arch.h>
+#include <lwip/pbuf.h>
+#include <lwip/udp.h>
+
+#include "board_pico1w_wifi.h"
+#include "../inherited/pico/board_pico_clock.h"
+
+#include <stddef.h>
+
+struct wifiSlot {
+	const uint8_t *buffer; // capture buffer being sent
+	uint32_t length; // bytes in buffer
+	uint32_t sent; // bytes already in datagrams
+	uint32_t references; // datagrams lwIP still holds
+	uint16_t number; // buffer number sent in header
+	wifi_release_t release; // called once buffer is sent
+	void *context; // passed to release
+};
+
+struct wifiDatagram {
+	struct pbuf_custom pbuf; // payload pointing into capture buffer, must be first
+	struct wifiSlot *slot; // slot payload belongs to
+	bool busy; // held by lwIP
+};
+
+struct wifiSlot wifiSlots[WIFI_STREAM_SLOTS];
+volatile uint32_t wifiHead = 0u; // buffers ever submitted
+uint32_t wifiNext = 0u; // buffer being split into datagrams
+uint32_t wifiTail = 0u; // buffers ever released
+uint16_t wifiNumber = 0u; // number of next buffer
+
+struct wifiDatagram wifiDatagrams[WIFI_WINDOW];
+uint32_t wifiInFlight = 0u; // datagrams held by lwIP
+bool wifiWaiting = false; // window was full on last send
+
+struct udp_pcb *wifiPCB = NULL;
+ip_addr_t wifiTarget;
+uint16_t wifiPort = 0u;
+uint32_t wifiSequence = 0u;
+
+struct wifiStats wifiStatistics;
+
+bool wifiBegin(const char *ssid, const char *password, uint32_t timeoutMS) {
+
+	// Arduino core may have already started driver
+	if (!cyw43_is_initialized(&cyw43_state) && cyw43_arch_init() != 0) {
+		return false;
+	}
+	clockAddListener(wifiClockChanged);
+	wifiClockChanged();
+	cyw43_arch_enable_sta_mode();
+
+	uint32_t auth = password == NULL ? CYW43_AUTH_OPEN : CYW43_AUTH_WPA2_AES_PSK;
+	return cyw43_arch_wifi_connect_timeout_ms(ssid, password, auth, timeoutMS) == 0;
+}
+
+void wifiClockChanged(void) {
+
+	uint32_t divider = (clock_get_hz(clk_sys) + WIFI_SPI_MAX_KHZ * 1000u - 1u) / (WIFI_SPI_MAX_KHZ * 1000u);
+	if (divider < WIFI_SPI_DIV_DEFAULT) {
+		divider = WIFI_SPI_DIV_DEFAULT;
+	}
+
+	// driver claims whichever state machine is free, found by its pins
+	for (uint8_t block = 0; block < 2u; block++) {
+		PIO pio = block == 0u ? pio0 : pio1;
+		for (uint8_t sm = 0; sm < 4u; sm++) {
+			const uint32_t pinctrl = pio->sm[sm].pinctrl;
+			const uint32_t out = (pinctrl & PIO_SM0_PINCTRL_OUT_BASE_BITS) >> PIO_SM0_PINCTRL_OUT_BASE_LSB;
+			const uint32_t sideset = (pinctrl & PIO_SM0_PINCTRL_SIDESET_BASE_BITS) >> PIO_SM0_PINCTRL_SIDESET_BASE_LSB;
+			if (out == WIFI_SPI_DATA_PIN && sideset == WIFI_SPI_CLOCK_PIN) {
+				pio_sm_set_clkdiv_int_frac(pio, sm, (uint16_t)divider, 0u);
+			}
+		}
+	}
+}
+
+bool wifiStreamBegin(const char *address, uint16_t port) {
+
+	ip_addr_t target;
+	if (!ipaddr_aton(address, &target)) {
+		return false;
+	}
+
+	cyw43_arch_lwip_begin();
+	if (wifiPCB == NULL) {
+		wifiPCB = udp_new_ip_type(IPADDR_TYPE_V4);
+	}
+	wifiTarget = target;
+	wifiPort = port;
+	cyw43_arch_lwip_end();
+
+	return wifiPCB != NULL;
+}
+
+bool wifiStreamReady(void) {
+	return wifiHead - wifiTail < WIFI_STREAM_SLOTS;
+}
+
+bool wifiStreamSubmit(const void *buffer, uint32_t length, wifi_release_t release, void *context) {
+
+	if (buffer == NULL || length == 0u) {
+		return false;
+	}
+
+	uint32_t status = save_and_disable_interrupts();
+
+	uint32_t head = wifiHead;
+	if (head - wifiTail >= WIFI_STREAM_SLOTS) {
+		wifiStatistics.rejected++;
+		restore_interrupts(status);
+		return false;
+	}
+
+	struct wifiSlot *slot = &wifiSlots[head % WIFI_STREAM_SLOTS];
+	slot->buffer = (const uint8_t*)buffer;
+	slot->length = length;
+	slot->sent = 0u;
+	slot->references = 0u;
+	slot->number = wifiNumber++;
+	slot->release = release;
+	slot->context = context;
+	__dmb();
+	wifiHead = head + 1u;
+	wifiStatistics.submitted++;
+
+	restore_interrupts(status);
+	return true;
+}
+
+/**
+ * Drops reference to capture buffer once lwIP is done with datagram
+ * 
+ * @param p payload pbuf of datagram
+ */
+void wifiDatagramFree(struct pbuf *p) {
+	struct wifiDatagram *datagram = (struct wifiDatagram*)p;
+	datagram->slot->references--;
+	datagram->busy = false;
+	wifiInFlight--;
+}
+
+/**
+ * Gets free datagram
+ * 
+ * @return free datagram, NULL if window is full
+ */
+struct wifiDatagram* wifiGetDatagram(void) {
+	for (uint32_t i = 0; i < WIFI_WINDOW; i++) {
+		if (!wifiDatagrams[i].busy) {
+			return &wifiDatagrams[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Writes 32 bit value into header
+ * 
+ * @param header header bytes
+ * @param value value to write
+ */
+void wifiPut32(uint8_t *header, uint32_t value) {
+	header[0] = (uint8_t)value;
+	header[1] = (uint8_t)(value >> 8);
+	header[2] = (uint8_t)(value >> 16);
+	header[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * Sends next datagram of slot
+ * 
+ * @param slot slot being sent
+ * 
+ * @return whether datagram was sent
+ * 
+ * @note lwIP must be locked
+ */
+bool wifiSendDatagram(struct wifiSlot *slot) {
+
+	struct wifiDatagram *datagram = wifiGetDatagram();
+	if (datagram == NULL) {
+		if (!wifiWaiting) {
+			wifiStatistics.windowFull++;
+			wifiWaiting = true;
+		}
+		return false;
+	}
+	wifiWaiting = false;
+
+	struct pbuf *header = pbuf_alloc(PBUF_TRANSPORT, WIFI_HEADER_BYTES, PBUF_RAM);
+	if (header == NULL) {
+		wifiStatistics.allocFailures++;
+		return false;
+	}
+
+	uint32_t length = slot->length - slot->sent;
+	if (length > WIFI_PAYLOAD_BYTES) {
+		length = WIFI_PAYLOAD_BYTES;
+	}
+
+	uint8_t *bytes = (uint8_t*)header->payload;
+	wifiPut32(&bytes[0], wifiSequence);
+	wifiPut32(&bytes[4], slot->sent);
+	wifiPut32(&bytes[8], slot->length);
+	bytes[12] = (uint8_t)slot->number;
+	bytes[13] = (uint8_t)(slot->number >> 8);
+	bytes[14] = 0u;
+	bytes[15] = 0u;
+
+	// payload references capture buffer instead of copying it
+	datagram->pbuf.custom_free_function = wifiDatagramFree;
+	datagram->slot = slot;
+	datagram->busy = true;
+	struct pbuf *payload = pbuf_alloced_custom(PBUF_RAW, (u16_t)length, PBUF_REF, &datagram->pbuf,
+		(void*)(slot->buffer + slot->sent), (u16_t)length);
+	slot->references++;
+	wifiInFlight++;
+	if (wifiInFlight > wifiStatistics.inFlightMax) {
+		wifiStatistics.inFlightMax = wifiInFlight;
+	}
+	pbuf_cat(header, payload);
+
+	// driver queue full, same datagram goes again on next task
+	err_t result = udp_sendto(wifiPCB, header, &wifiTarget, wifiPort);
+	if (result == ERR_MEM) {
+		wifiStatistics.queueFull++;
+		pbuf_free(header);
+		return false;
+	}
+	if (result == ERR_OK) {
+		wifiStatistics.datagrams++;
+		wifiStatistics.sent += length;
+	}
+	else {
+		wifiStatistics.sendErrors++;
+	}
+
+	// sequence moves on either way so receiver sees failed sends as loss
+	wifiSequence++;
+	slot->sent += length;
+	pbuf_free(header);
+	return true;
+}
+
+uint32_t wifiTask(void) {
+
+	// only does anything with the polling driver
+	cyw43_arch_poll();
+
+	if (wifiPCB == NULL) {
+		return 0u;
+	}
+
+	uint32_t datagrams = 0u;
+	struct wifiSlot *done[WIFI_STREAM_SLOTS];
+	uint32_t doneCount = 0u;
+
+	cyw43_arch_lwip_begin();
+
+	const uint32_t head = wifiHead;
+	__dmb();
+
+	while (wifiNext != head) {
+		struct wifiSlot *slot = &wifiSlots[wifiNext % WIFI_STREAM_SLOTS];
+		if (slot->sent == slot->length) {
+			wifiNext++;
+		}
+		else if (wifiSendDatagram(slot)) {
+			datagrams++;
+		}
+		else {
+			break;
+		}
+	}
+
+	// releases in order once lwIP has freed every datagram of a buffer
+	while (wifiTail + doneCount != wifiNext) {
+		struct wifiSlot *slot = &wifiSlots[(wifiTail + doneCount) % WIFI_STREAM_SLOTS];
+		if (slot->references != 0u) {
+			break;
+		}
+		done[doneCount++] = slot;
+	}
+
+	cyw43_arch_lwip_end();
+
+	for (uint32_t i = 0; i < doneCount; i++) {
+		wifi_release_t release = done[i]->release;
+		const void *buffer = done[i]->buffer;
+		void *context = done[i]->context;
+		wifiStatistics.released++;
+		wifiTail++;
+		if (release != NULL) {
+			release(buffer, context);
+		}
+	}
+
+	return datagrams;
+}
+
+void wifiGetStats(struct wifiStats *stats) {
+	*stats = wifiStatistics;
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+/*
+	board_pico1w_wifi.h - Wi-Fi streaming for Raspberry Pi Pico W
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_PICO1W_WIFI_H
+#define BOARD_PICO1W_WIFI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************
+ * Wi-Fi Config
+ * 
+ * Capture buffers are submitted by reference and sent as
+ * UDP datagrams whose payload pbufs point straight at the buffer,
+ * the buffer is handed back through its release callback once
+ * lwIP frees the last datagram referencing it
+ * 
+ * Datagram (little endian):
+ * 	bytes 0-3: datagram sequence number
+ * 	bytes 4-7: byte offset of payload in buffer
+ * 	bytes 8-11: length of whole buffer
+ * 	bytes 12-13: buffer number, wraps
+ * 	bytes 14-15: reserved
+ * 	bytes 16+: payload
+ * 
+ * A gap in sequence numbers is a lost datagram
+ * 
+ * SDK sets the gSPI state machine divider for the rated
+ * clk_sys, wifiClockChanged keeps it in range once overclocked
+****************************/
+
+#ifndef WIFI_STREAM_SLOTS
+	#define WIFI_STREAM_SLOTS 2u // capture buffers in flight
+#endif
+
+#ifndef WIFI_WINDOW
+	#define WIFI_WINDOW 8u // datagrams lwIP can hold at once
+#endif
+
+#ifndef WIFI_PAYLOAD_BYTES
+	#define WIFI_PAYLOAD_BYTES 1440u // capture bytes per datagram
+#endif
+
+#define WIFI_HEADER_BYTES 16u // bytes before payload
+
+#ifdef CYW43_PIO_CLOCK_DIV_INT
+	#define WIFI_SPI_DIV_DEFAULT CYW43_PIO_CLOCK_DIV_INT // gSPI state machine divider SDK sets
+#else
+	#define WIFI_SPI_DIV_DEFAULT 2u
+#endif
+
+#define WIFI_SPI_MAX_KHZ (133000u / WIFI_SPI_DIV_DEFAULT) // fastest gSPI state machine clock, SDK divider at rated clk_sys
+#define WIFI_SPI_DATA_PIN 24u // GPIO gSPI program drives data on
+#define WIFI_SPI_CLOCK_PIN 29u // GPIO gSPI program side sets clock on
+
+typedef void (*wifi_release_t)(const void *buffer, void *context); // called once buffer is sent
+
+struct wifiStats {
+	uint32_t submitted; // buffers accepted
+	uint32_t rejected; // buffers refused because every slot was busy
+	uint32_t released; // buffers fully sent
+	uint32_t datagrams; // datagrams sent
+	uint32_t sent; // capture bytes sent
+	uint32_t windowFull; // times sending waited on window
+	uint32_t allocFailures; // times lwIP had no header pbuf
+	uint32_t queueFull; // sends retried because driver had no room
+	uint32_t sendErrors; // datagrams lwIP refused
+	uint32_t inFlightMax; // most datagrams held by lwIP at once
+};
+
+/**
+ * Starts Wi-Fi and joins network
+ * 
+ * @param ssid network name
+ * @param password network password, NULL for open network
+ * @param timeoutMS longest time to wait for connection
+ * 
+ * @return whether network was joined
+ */
+bool wifiBegin(const char *ssid, const char *password, uint32_t timeoutMS);
+
+/**
+ * Keeps wireless chip gSPI clock in range after clk_sys changes
+ * 
+ * @note added as clock listener once wireless driver starts
+ */
+void wifiClockChanged(void);
+
+/**
+ * Sets where datagrams are sent
+ * 
+ * @param address IPv4 address such as "192.168.1.20"
+ * @param port UDP port
+ * 
+ * @return whether target was set
+ */
+bool wifiStreamBegin(const char *address, uint16_t port);
+
+/**
+ * Checks if a capture buffer can be submitted
+ * 
+ * @return whether a slot is free
+ */
+bool wifiStreamReady(void);
+
+/**
+ * Submits capture buffer to stream without copying
+ * 
+ * @param buffer bytes to send, must stay untouched until released
+ * @param length amount of bytes
+ * @param release called once buffer is sent, can be NULL
+ * @param context passed to release
+ * 
+ * @return whether buffer was accepted
+ * 
+ * @note safe to call from interrupts, such as DMA completion
+ */
+bool wifiStreamSubmit(const void *buffer, uint32_t length, wifi_release_t release, void *context);
+
+/**
+ * Sends datagrams of submitted buffers while window allows
+ * 
+ * @return amount of datagrams sent
+ * 
+ * @note call often from main loop, also polls Wi-Fi driver when needed
+ */
+uint32_t wifiTask(void);
+
+/**
+ * Gets Wi-Fi statistics
+ * 
+ * @param stats pointer to statistics
+ */
+void wifiGetStats(struct wifiStats *stats);
+
+#endif
\ No newline at end of file
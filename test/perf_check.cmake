@@ -0,0 +1,24 @@
+# Runs every test, gathers metric lines and checks them against the
+# stored baseline with tools/perf_compare.py
+#
+# pass -DUPDATE=ON to store the run as the new baseline instead
+
+string(REPLACE "," ";" TESTS "${TESTS}")
+
+file(WRITE ${CAPTURE} "")
+foreach(test ${TESTS})
+	execute_process(COMMAND ${test} OUTPUT_VARIABLE output RESULT_VARIABLE result)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "${test} failed, metrics aren't checked")
+	endif()
+	file(APPEND ${CAPTURE} "${output}")
+endforeach()
+
+if(UPDATE)
+	execute_process(COMMAND ${PYTHON} ${COMPARE} --update ${CAPTURE} ${BASELINE} RESULT_VARIABLE result)
+else()
+	execute_process(COMMAND ${PYTHON} ${COMPARE} ${CAPTURE} ${BASELINE} RESULT_VARIABLE result)
+endif()
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "metrics regressed against ${BASELINE}")
+endif()
\ No newline at end of file
@@ -0,0 +1,60 @@
+/*
+	ram_fixture.c - call graph in and out of RAM for ram_callgraph.py to check
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stdint.h>
+
+// sections the SDK's __not_in_flash gives, sim leaves RUN_IN_RAM empty
+#define FIXTURE_RAM(function) __attribute__((noinline, section(".time_critical." #function)))
+
+uint32_t __aeabi_uidiv(uint32_t numerator, uint32_t denominator);
+uint32_t fixtureRAMDivide(uint32_t numerator, uint32_t denominator);
+uint32_t fixtureStatic(uint32_t value);
+uint32_t fixtureExternal(uint32_t value);
+
+// defined outside the objects given, so can't be checked
+uint32_t fixtureMissing(uint32_t value);
+
+// stands in for a helper the SDK left in flash
+uint32_t __attribute__((noinline)) __aeabi_uidiv(uint32_t numerator, uint32_t denominator) {
+	return denominator == 0u ? 0u : numerator / denominator;
+}
+
+uint32_t FIXTURE_RAM(fixtureRAMDivide) fixtureRAMDivide(uint32_t numerator, uint32_t denominator) {
+	return denominator == 0u ? 0u : numerator / denominator;
+}
+
+uint32_t FIXTURE_RAM(fixtureClean) fixtureClean(uint32_t value) {
+	return fixtureRAMDivide(value, 3u);
+}
+
+uint32_t FIXTURE_RAM(fixtureFlash) fixtureFlash(uint32_t value) {
+	return fixtureClean(value) + __aeabi_uidiv(value, 5u);
+}
+
+// static helpers are relocated against their section, not their name
+static uint32_t __attribute__((noinline)) fixtureScale(uint32_t value) {
+	return (value * 7u) ^ (value >> 3);
+}
+
+uint32_t FIXTURE_RAM(fixtureStatic) fixtureStatic(uint32_t value) {
+	return fixtureScale(value) + fixtureScale(value + 1u);
+}
+
+uint32_t FIXTURE_RAM(fixtureExternal) fixtureExternal(uint32_t value) {
+	return fixtureMissing(value) + 1u;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+/*
+	framework.c - framework calls lib_pico uses but doesn't implement, for host builds
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+#include <nvm/nvm.h>
+
+uint8_t charArraySize(char *value) {
+	if (value == NULL) {
+		return CHAR_LEN_ERROR;
+	}
+	for (uint8_t i = 0; i < CHAR_LEN_ERROR; i++) {
+		if (value[i] == END_OF_CHAR) {
+			return i + 1u;
+		}
+	}
+	return CHAR_LEN_ERROR;
+}
+
+bool validCharPointer(char *value) {
+	return value != NULL;
+}
+
+enum NVMDefaultCode nvmSetCritDefaults(nvm_size_t maxSize) {
+	(void)maxSize;
+	return NVM_DEFAULT_OK;
+}
+
+enum NVMDefaultCode nvmSetEnvDefaults(void) {
+	return NVM_DEFAULT_OK;
+}
\ No newline at end of file
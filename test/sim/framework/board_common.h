@@ -0,0 +1,55 @@
+/*
+	board_common.h - framework calls the library implements or uses on host
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_COMMON_H
+#define BOARD_COMMON_H
+
+#include "board_generic.h"
+
+#include <string.h>
+
+#define CHAR_LEN_ERROR 0xFFu // length of a string without terminator
+#define END_OF_CHAR '\0' // string terminator
+
+bool initBoard(void);
+void hardPinMode(pin_t pin, enum pinModeState mode);
+void hardDigitalWrite(pin_t pin, enum digitalState value);
+bool startThreadSafety(void);
+bool endThreadSafety(void);
+void hardDelayMS(uint32_t ms);
+void hardDelayUS(uint32_t us);
+
+/**
+ * Gets length of string including terminator
+ *
+ * @param value string
+ *
+ * @return length, CHAR_LEN_ERROR if no terminator in 254 bytes
+ */
+uint8_t charArraySize(char *value);
+
+/**
+ * Checks string can be written to
+ *
+ * @param value string
+ *
+ * @return whether pointer is usable
+ */
+bool validCharPointer(char *value);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+/*
+	board_generic.h - framework board types the library builds against on host
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_GENERIC_H
+#define BOARD_GENERIC_H
+
+/****************************
+ * Framework Stand-in
+ *
+ * Host builds have only the parts of the framework
+ * lib_pico implements or calls, board is always Pico W
+****************************/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <pico/platform.h> // Arduino.h brings in the SDK on the board
+
+typedef uint8_t pin_t; // pin number
+
+enum pinModeState {
+	PIN_MODE_DISABLED,
+	PIN_MODE_OUTPUT,
+	PIN_MODE_INPUT,
+	PIN_MODE_INPUT_PULL_UP,
+};
+
+enum digitalState {
+	DIGITAL_LOW,
+	DIGITAL_HIGH,
+};
+
+#include <pico1w/board_pico1w.h>
+
+#endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+/*
+	hard_serial.h - framework serial calls the library implements on host
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HARD_SERIAL_H
+#define HARD_SERIAL_H
+
+#include "../../board_common.h"
+
+void hardPrintBegin(uint32_t baud);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+/*
+	hard_timer.h - framework hard timer types the library implements on host
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HARD_TIMER_H
+#define HARD_TIMER_H
+
+#include "board_common.h"
+
+typedef int8_t hard_timer_t; // timer handle
+typedef uint32_t freq_t; // frequency in Hz
+typedef uint8_t timer_priority_t; // timer priority
+
+#define HARD_TIMER_INVALID -1 // handle of no timer
+
+struct hardTimerPriority {
+	timer_priority_t priority; // priority of timer
+};
+
+enum HardTimerStatusReturn {
+	HARD_TIMER_OK, // timer runs at frequency asked for
+	HARD_TIMER_SLIGHTLY_OFF, // timer runs close to frequency asked for
+	HARD_TIMER_FAIL, // timer didn't start
+};
+
+typedef hard_timer_return_t (*hard_timer_function_ptr_t)(hard_timer_param_t); // timer callback
+
+bool setHardTimer(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t function, timer_priority_t priority);
+bool cancelHardTimer(hard_timer_t timer);
+bool hardTimerStarted(hard_timer_t timer);
+hard_timer_t claimTimer(struct hardTimerPriority *priority);
+bool unclaimTimer(hard_timer_t timer);
+bool hardTimerClaimed(hard_timer_t timer);
+
+#endif
\ No newline at end of file
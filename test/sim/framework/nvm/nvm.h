@@ -0,0 +1,77 @@
+/*
+	nvm.h - framework NVM calls the library implements on host
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef NVM_H
+#define NVM_H
+
+#include "../board_common.h"
+
+typedef uint16_t nvm_size_t; // NVM key or size
+
+#define DEFAULT_NVM_SIZE 0u // size of NVM that isn't set
+#define FLASH_NVM_SIZE 1024u // NVM size boards using flash default to
+#define CAN_DEFAULT true // value read may be a default
+#define DEFAULT_BOOL false // default of bools
+#define DEFAULT_INT 0 // default of integers
+
+enum NVMStartCode {
+	NVM_OK,
+	NVM_STARTED,
+	NVM_INVALID_SIZE,
+	NVM_FAILED,
+};
+
+enum NVMDefaultCode {
+	NVM_DEFAULT_OK,
+	NVM_DEFAULT_SIZE_TOO_BIG,
+	NVM_DEFAULT_FAIL_MAX_SIZE,
+};
+
+enum NVMStartCode nvmInit(nvm_size_t setNVMSize);
+bool nvmMaxSize(nvm_size_t *size);
+void nvmCommit(void);
+enum NVMDefaultCode nvmSetDefaults(void);
+enum NVMDefaultCode nvmSetCritDefaults(nvm_size_t maxSize);
+enum NVMDefaultCode nvmSetEnvDefaults(void);
+
+bool nvmWriteCharArray(nvm_size_t key, char *value, uint8_t maxLength);
+bool nvmGetCharArray(nvm_size_t key, char *value, uint8_t maxLength);
+bool nvmWriteBool(nvm_size_t key, bool value);
+bool nvmWriteI8(nvm_size_t key, int8_t value);
+bool nvmWriteUI8(nvm_size_t key, uint8_t value);
+bool nvmWriteI16(nvm_size_t key, int16_t value);
+bool nvmWriteUI16(nvm_size_t key, uint16_t value);
+bool nvmWriteI32(nvm_size_t key, int32_t value);
+bool nvmWriteUI32(nvm_size_t key, uint32_t value);
+bool nvmWriteI64(nvm_size_t key, int64_t value);
+bool nvmWriteUI64(nvm_size_t key, uint64_t value);
+bool nvmWriteFloat(nvm_size_t key, float value);
+bool nvmWriteDouble(nvm_size_t key, double value);
+bool nvmGetBool(nvm_size_t key, bool *value, bool canDefault);
+bool nvmGetI8(nvm_size_t key, int8_t *value, bool canDefault);
+bool nvmGetUI8(nvm_size_t key, uint8_t *value, bool canDefault);
+bool nvmGetI16(nvm_size_t key, int16_t *value, bool canDefault);
+bool nvmGetUI16(nvm_size_t key, uint16_t *value, bool canDefault);
+bool nvmGetI32(nvm_size_t key, int32_t *value, bool canDefault);
+bool nvmGetUI32(nvm_size_t key, uint32_t *value, bool canDefault);
+bool nvmGetI64(nvm_size_t key, int64_t *value, bool canDefault);
+bool nvmGetUI64(nvm_size_t key, uint64_t *value, bool canDefault);
+bool nvmGetFloat(nvm_size_t key, float *value, bool canDefault);
+bool nvmGetDouble(nvm_size_t key, double *value, bool canDefault);
+
+#endif
\ No newline at end of file
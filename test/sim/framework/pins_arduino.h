@@ -0,0 +1,24 @@
+/*
+	pins_arduino.h - Arduino-pico pin names on host
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PINS_ARDUINO_H
+#define PINS_ARDUINO_H
+
+#define LED_BUILTIN 64u // CYW43 LED as Arduino-pico numbers it
+
+#endif
\ No newline at end of file
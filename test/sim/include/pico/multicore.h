@@ -0,0 +1,2 @@
+// stands in for SDK header of the same name, see sim_sdk.h
+#include "sim_sdk.h"
\ No newline at end of file
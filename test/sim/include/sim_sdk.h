@@ -0,0 +1,563 @@
+/*
+	sim_sdk.h - simulated Raspberry Pi Pico SDK for host builds
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SIM_SDK_H
+#define SIM_SDK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/cdefs.h>
+
+/****************************
+ * Simulated SDK
+ *
+ * Every SDK header the library includes maps to this file
+ *
+ * Time is virtual: each core has its own clock that only moves
+ * when an SDK call charges the cycles it would take on the board,
+ * C code between calls takes no time at all
+ *
+ * Alarms and DMA completion interrupts run on core 0 at the time
+ * they're due once interrupts are enabled, core 1 is a coroutine
+ * that runs whenever core 0 waits or falls behind it
+ *
+ * sim.h has the calls tests use to steer and inspect the board
+****************************/
+
+typedef unsigned int uint;
+
+/****************************
+ * Platform
+****************************/
+
+#define __not_in_flash(group)
+#define __not_in_flash_func(function) function
+#define __time_critical_func(function) function
+#define __scratch_x(group)
+#define __scratch_y(group)
+
+#define XIP_BASE ((uintptr_t)simFlash) // flash is a host array
+#define PICO_FLASH_SIZE_BYTES (2u * 1024u * 1024u)
+#define PICO_DEFAULT_UART_TX_PIN 0
+#define PICO_DEFAULT_UART_RX_PIN 1
+#define NUM_BANK0_GPIOS 30u
+
+extern uint8_t simFlash[PICO_FLASH_SIZE_BYTES];
+
+void tight_loop_contents(void);
+uint get_core_num(void);
+
+/****************************
+ * Sync
+****************************/
+
+typedef volatile uint32_t spin_lock_t;
+
+#define PICO_SPINLOCK_ID_STRIPED_FIRST 16u
+#define NUM_SPIN_LOCKS 32u
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+void __dmb(void);
+void __sev(void);
+void __wfe(void);
+void __wfi(void);
+
+int spin_lock_claim_unused(bool required);
+void spin_lock_unclaim(uint lock);
+spin_lock_t* spin_lock_init(uint lock);
+uint32_t spin_lock_blocking(spin_lock_t *lock);
+void spin_unlock(spin_lock_t *lock, uint32_t status);
+void spin_lock_unsafe_blocking(spin_lock_t *lock);
+void spin_unlock_unsafe(spin_lock_t *lock);
+bool is_spin_locked(spin_lock_t *lock);
+
+/****************************
+ * Clocks
+****************************/
+
+enum clock_index {
+	clk_gpout0,
+	clk_gpout1,
+	clk_gpout2,
+	clk_gpout3,
+	clk_ref,
+	clk_sys,
+	clk_peri,
+	clk_usb,
+	clk_adc,
+	clk_rtc,
+	CLK_COUNT,
+};
+
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS 0x0u
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS 0x1u
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB 0x2u
+#define CLOCKS_CLK_ADC_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB 0x0u
+#define CLOCKS_CLK_ADC_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS 0x1u
+
+uint32_t clock_get_hz(enum clock_index clock);
+bool clock_configure(enum clock_index clock, uint32_t src, uint32_t auxsrc, uint32_t srcFreq, uint32_t freq);
+bool check_sys_clock_khz(uint32_t freqKHz, uint *vcoOut, uint *postDiv1Out, uint *postDiv2Out);
+void set_sys_clock_pll(uint32_t vcoFreq, uint postDiv1, uint postDiv2);
+bool set_sys_clock_khz(uint32_t freqKHz, bool required);
+
+enum vreg_voltage {
+	VREG_VOLTAGE_1_05 = 0xA,
+	VREG_VOLTAGE_1_10 = 0xB,
+	VREG_VOLTAGE_1_15 = 0xC,
+	VREG_VOLTAGE_1_20 = 0xD,
+	VREG_VOLTAGE_1_25 = 0xE,
+	VREG_VOLTAGE_1_30 = 0xF,
+	VREG_VOLTAGE_DEFAULT = VREG_VOLTAGE_1_10,
+};
+
+void vreg_set_voltage(enum vreg_voltage voltage);
+
+/****************************
+ * SysTick
+****************************/
+
+typedef struct {
+	volatile uint32_t csr; // control and status
+	volatile uint32_t rvr; // reload value
+	volatile uint32_t cvr; // current value, any write clears it
+	volatile uint32_t calib; // calibration
+} systick_hw_t;
+
+#define systick_hw simSysTick() // refreshes counter on every access
+
+systick_hw_t* simSysTick(void);
+
+/****************************
+ * Timer
+****************************/
+
+typedef uint64_t absolute_time_t;
+typedef int32_t alarm_id_t;
+typedef struct alarm_pool alarm_pool_t;
+
+struct repeating_timer;
+
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *userData);
+typedef bool (*repeating_timer_callback_t)(struct repeating_timer *rt);
+
+struct repeating_timer {
+	int64_t delay_us; // negative keeps schedule from previous target
+	alarm_pool_t *pool; // pool alarm belongs to
+	alarm_id_t alarm_id; // alarm firing timer
+	repeating_timer_callback_t callback; // called each period
+	void *user_data; // passed to callback
+};
+
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+absolute_time_t get_absolute_time(void);
+absolute_time_t make_timeout_time_us(uint64_t us);
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+bool time_reached(absolute_time_t time);
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to);
+void busy_wait_us(uint64_t us);
+void busy_wait_us_32(uint32_t us);
+void busy_wait_ms(uint32_t ms);
+void busy_wait_at_least_cycles(uint32_t cycles);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void sleep_until(absolute_time_t time);
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *userData, bool fireIfPast);
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *userData, bool fireIfPast);
+bool cancel_alarm(alarm_id_t id);
+bool add_repeating_timer_us(int64_t delayUS, repeating_timer_callback_t callback, void *userData, struct repeating_timer *out);
+bool add_repeating_timer_ms(int32_t delayMS, repeating_timer_callback_t callback, void *userData, struct repeating_timer *out);
+bool cancel_repeating_timer(struct repeating_timer *timer);
+
+/****************************
+ * IRQ
+****************************/
+
+typedef void (*irq_handler_t)(void);
+
+#define DMA_IRQ_0 11u
+#define DMA_IRQ_1 12u
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80u
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t orderPriority);
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+
+/****************************
+ * GPIO
+****************************/
+
+enum gpio_function {
+	GPIO_FUNC_XIP = 0,
+	GPIO_FUNC_SPI = 1,
+	GPIO_FUNC_UART = 2,
+	GPIO_FUNC_I2C = 3,
+	GPIO_FUNC_PWM = 4,
+	GPIO_FUNC_SIO = 5,
+	GPIO_FUNC_PIO0 = 6,
+	GPIO_FUNC_PIO1 = 7,
+	GPIO_FUNC_GPCK = 8,
+	GPIO_FUNC_USB = 9,
+	GPIO_FUNC_NULL = 0x1f,
+};
+
+enum gpio_drive_strength {
+	GPIO_DRIVE_STRENGTH_2MA,
+	GPIO_DRIVE_STRENGTH_4MA,
+	GPIO_DRIVE_STRENGTH_8MA,
+	GPIO_DRIVE_STRENGTH_12MA,
+};
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+void gpio_init(uint gpio);
+void gpio_deinit(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function function);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_disable_pulls(uint gpio);
+void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive);
+
+/****************************
+ * DMA
+****************************/
+
+enum dma_channel_transfer_size {
+	DMA_SIZE_8 = 0,
+	DMA_SIZE_16 = 1,
+	DMA_SIZE_32 = 2,
+};
+
+typedef struct {
+	uint32_t ctrl; // CTRL register value
+} dma_channel_config;
+
+typedef struct {
+	volatile const void *read_addr; // next read
+	volatile void *write_addr; // next write
+	volatile uint32_t transfer_count; // transfers left
+	volatile uint32_t ctrl_trig; // control
+} dma_channel_hw_t;
+
+#define NUM_DMA_CHANNELS 12u
+#define NUM_DMA_TIMERS 4u
+#define DREQ_UART0_TX 20u
+#define DREQ_UART1_TX 22u
+#define DREQ_DMA_TIMER0 0x3bu
+#define DREQ_FORCE 0x3fu
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(uint channel);
+bool dma_channel_is_claimed(uint channel);
+dma_channel_config dma_channel_get_default_config(uint channel);
+dma_channel_config dma_get_channel_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config *config, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *config, bool increment);
+void channel_config_set_write_increment(dma_channel_config *config, bool increment);
+void channel_config_set_ring(dma_channel_config *config, bool write, uint sizeBits);
+void channel_config_set_dreq(dma_channel_config *config, uint dreq);
+void channel_config_set_chain_to(dma_channel_config *config, uint channel);
+void channel_config_set_irq_quiet(dma_channel_config *config, bool quiet);
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger);
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write, const volatile void *read, uint transferCount, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void *read, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void *write, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t count, bool trigger);
+void dma_channel_start(uint channel);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+dma_channel_hw_t* dma_channel_hw_addr(uint channel);
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
+int dma_claim_unused_timer(bool required);
+void dma_timer_unclaim(uint timer);
+void dma_timer_set_fraction(uint timer, uint16_t numerator, uint16_t denominator);
+uint dma_get_timer_dreq(uint timer);
+
+/****************************
+ * UART
+****************************/
+
+typedef struct {
+	volatile uint32_t dr; // data, DMA writes land here
+	volatile uint32_t rsr; // receive status
+	uint32_t reserved[4];
+	volatile uint32_t fr; // flags
+} uart_hw_t;
+
+typedef struct uart_inst uart_inst_t;
+
+#define uart0 simUART(0u)
+#define uart1 simUART(1u)
+
+uart_inst_t* simUART(uint index);
+uart_hw_t* uart_get_hw(uart_inst_t *uart);
+uint uart_get_index(uart_inst_t *uart);
+uint uart_init(uart_inst_t *uart, uint baud);
+uint uart_set_baudrate(uart_inst_t *uart, uint baud);
+uint uart_get_dreq(uart_inst_t *uart, bool tx);
+bool uart_is_writable(uart_inst_t *uart);
+void uart_putc_raw(uart_inst_t *uart, char c);
+void uart_tx_wait_blocking(uart_inst_t *uart);
+
+/****************************
+ * Stdio
+****************************/
+
+typedef struct stdio_driver {
+	void (*out_chars)(const char *buffer, int length); // prints bytes
+	void (*out_flush)(void); // waits for bytes to go out
+	int (*in_chars)(char *buffer, int length); // reads bytes
+	struct stdio_driver *next; // next driver
+} stdio_driver_t;
+
+void stdio_set_driver_enabled(stdio_driver_t *driver, bool enabled);
+
+/****************************
+ * PWM
+****************************/
+
+typedef struct {
+	uint32_t csr; // control
+	uint32_t div; // clock divider
+	uint32_t top; // wrap
+} pwm_config;
+
+typedef struct {
+	volatile uint32_t csr; // control
+	volatile uint32_t div; // clock divider
+	volatile uint32_t ctr; // counter
+	volatile uint32_t cc; // compare of both channels
+	volatile uint32_t top; // wrap
+} pwm_slice_hw_t;
+
+typedef struct {
+	pwm_slice_hw_t slice[8]; // every slice
+} pwm_hw_t;
+
+#define NUM_PWM_SLICES 8u
+
+extern pwm_hw_t simPWM;
+#define pwm_hw (&simPWM)
+
+pwm_config pwm_get_default_config(void);
+void pwm_config_set_clkdiv_int(pwm_config *config, uint div);
+void pwm_config_set_wrap(pwm_config *config, uint16_t wrap);
+void pwm_init(uint slice, pwm_config *config, bool start);
+void pwm_set_enabled(uint slice, bool enabled);
+uint pwm_gpio_to_slice_num(uint gpio);
+
+/****************************
+ * PIO
+****************************/
+
+typedef struct {
+	volatile uint32_t clkdiv; // 16.8 clock divider in bits 31:8
+	volatile uint32_t pinctrl; // pin bases
+} pio_sm_hw_t;
+
+typedef struct {
+	volatile uint32_t ctrl; // state machine enables
+	pio_sm_hw_t sm[4]; // state machines
+} pio_hw_t;
+
+typedef pio_hw_t* PIO;
+
+#define pio0 simPIO(0u)
+#define pio1 simPIO(1u)
+
+#define PIO_SM0_CLKDIV_INT_LSB 16u
+#define PIO_SM0_CLKDIV_FRAC_LSB 8u
+#define PIO_SM0_PINCTRL_OUT_BASE_LSB 0u
+#define PIO_SM0_PINCTRL_OUT_BASE_BITS 0x0000001Fu
+#define PIO_SM0_PINCTRL_SIDESET_BASE_LSB 10u
+#define PIO_SM0_PINCTRL_SIDESET_BASE_BITS 0x00007C00u
+
+PIO simPIO(uint index);
+void pio_sm_set_clkdiv_int_frac(PIO pio, uint sm, uint16_t divInt, uint8_t divFrac);
+
+/****************************
+ * ADC
+****************************/
+
+typedef struct {
+	volatile uint32_t cs; // control and status
+	volatile uint32_t result; // last conversion
+	volatile uint32_t fcs; // FIFO control
+	volatile uint32_t fifo; // FIFO
+	volatile uint32_t div; // clock divider in 16.8
+} adc_hw_t;
+
+extern adc_hw_t simADC;
+#define adc_hw (&simADC)
+
+void adc_init(void);
+void adc_select_input(uint input);
+uint16_t adc_read(void);
+
+/****************************
+ * Flash
+****************************/
+
+#define FLASH_PAGE_SIZE 256u
+#define FLASH_SECTOR_SIZE 4096u
+
+void flash_range_erase(uint32_t offset, size_t count);
+void flash_range_program(uint32_t offset, const uint8_t *data, size_t count);
+
+typedef struct {
+	volatile uint32_t ctrlr0; // frame format
+	volatile uint32_t ctrlr1; // frames per read
+	volatile uint32_t ssienr; // SSI enable, XIP stops while clear
+	volatile uint32_t mwcr; // microwire control
+	volatile uint32_t ser; // slave select
+	volatile uint32_t baudr; // flash SCK divider of clk_sys, even
+} ssi_hw_t;
+
+#define ssi_hw simSSI() // checks nothing can run from flash on every access
+
+ssi_hw_t* simSSI(void);
+
+/****************************
+ * Multicore
+****************************/
+
+void multicore_launch_core1(void (*entry)(void));
+void multicore_reset_core1(void);
+void multicore_lockout_victim_init(void);
+bool multicore_lockout_victim_is_initialized(uint core);
+void multicore_lockout_start_blocking(void);
+void multicore_lockout_end_blocking(void);
+bool multicore_fifo_rvalid(void);
+bool multicore_fifo_wready(void);
+void multicore_fifo_push_blocking(uint32_t data);
+uint32_t multicore_fifo_pop_blocking(void);
+void multicore_fifo_drain(void);
+
+/****************************
+ * CYW43
+****************************/
+
+typedef struct {
+	bool initialized; // driver is running
+	uint8_t core; // core driver interrupts are bound to
+} cyw43_t;
+
+#define CYW43_WL_GPIO_LED_PIN 0u
+#define CYW43_AUTH_OPEN 0u
+#define CYW43_AUTH_WPA2_AES_PSK 0x00400004u
+
+extern cyw43_t cyw43_state;
+
+int cyw43_arch_init(void);
+void cyw43_arch_deinit(void);
+bool cyw43_is_initialized(cyw43_t *self);
+void cyw43_arch_poll(void);
+void cyw43_arch_gpio_put(uint pin, bool value);
+void cyw43_arch_lwip_begin(void);
+void cyw43_arch_lwip_end(void);
+void cyw43_arch_enable_sta_mode(void);
+int cyw43_arch_wifi_connect_timeout_ms(const char *ssid, const char *password, uint32_t auth, uint32_t timeoutMS);
+
+/****************************
+ * lwIP
+****************************/
+
+typedef uint8_t u8_t;
+typedef uint16_t u16_t;
+typedef uint32_t u32_t;
+typedef int8_t s8_t;
+typedef s8_t err_t;
+
+#define ERR_OK 0
+#define ERR_MEM -1
+#define ERR_BUF -2
+#define ERR_VAL -6
+
+#define IPADDR_TYPE_V4 0u
+
+typedef struct {
+	uint32_t addr; // address in network order
+} ip_addr_t;
+
+typedef enum {
+	PBUF_TRANSPORT,
+	PBUF_IP,
+	PBUF_LINK,
+	PBUF_RAW_TX,
+	PBUF_RAW,
+} pbuf_layer;
+
+typedef enum {
+	PBUF_RAM,
+	PBUF_ROM,
+	PBUF_REF,
+	PBUF_POOL,
+} pbuf_type;
+
+struct pbuf {
+	struct pbuf *next; // next pbuf in chain
+	void *payload; // bytes of this pbuf
+	u16_t tot_len; // bytes in this and following pbufs
+	u16_t len; // bytes in this pbuf
+	u8_t type; // enum pbuf_type
+	u8_t flags; // PBUF_FLAG_IS_CUSTOM when custom
+	u16_t ref; // references held
+};
+
+typedef void (*pbuf_free_custom_fn)(struct pbuf *p);
+
+struct pbuf_custom {
+	struct pbuf pbuf; // pbuf handed to lwIP
+	pbuf_free_custom_fn custom_free_function; // frees pbuf
+};
+
+struct udp_pcb;
+
+struct pbuf* pbuf_alloc(pbuf_layer layer, u16_t length, pbuf_type type);
+struct pbuf* pbuf_alloced_custom(pbuf_layer layer, u16_t length, pbuf_type type, struct pbuf_custom *p, void *payload, u16_t payloadLength);
+void pbuf_cat(struct pbuf *head, struct pbuf *tail);
+void pbuf_ref(struct pbuf *p);
+u8_t pbuf_free(struct pbuf *p);
+int ipaddr_aton(const char *text, ip_addr_t *address);
+struct udp_pcb* udp_new_ip_type(u8_t type);
+void udp_remove(struct udp_pcb *pcb);
+err_t udp_sendto(struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *address, u16_t port);
+
+/****************************
+ * TinyUSB
+****************************/
+
+bool tusb_init(void);
+void tud_task(void);
+bool tud_cdc_connected(void);
+uint32_t tud_cdc_write_available(void);
+uint32_t tud_cdc_write(const void *buffer, uint32_t length);
+uint32_t tud_cdc_write_flush(void);
+
+#endif
\ No newline at end of file
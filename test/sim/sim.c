@@ -0,0 +1,2242 @@
+/*
+	sim.c - simulated Raspberry Pi Pico for host builds
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include "sim.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#define SIM_NS_PER_S 1000000000ull
+#define SIM_NS_PER_US 1000ull
+#define SIM_NEVER UINT64_MAX
+#define SIM_CORE1_STACK (512u * 1024u)
+#define SIM_ALARMS 16u // default alarm pool size
+#define SIM_IRQ_HANDLERS 4u // shared handlers on one IRQ
+#define SIM_FIFO_DEPTH 8u // entries each way between cores
+#define SIM_UART_FIFO 32u // UART transmit FIFO
+#define SIM_UART_BITS 10u // start, 8 data and stop bit
+#define SIM_SPIN_CYCLES 6u // one spin checking a lock
+#define SIM_DATAGRAM_MAX 1472u // UDP payload in one Ethernet frame
+
+// DMA CTRL_TRIG fields
+#define SIM_DMA_EN (1u << 0)
+#define SIM_DMA_SIZE_LSB 2u
+#define SIM_DMA_INCR_READ (1u << 4)
+#define SIM_DMA_INCR_WRITE (1u << 5)
+#define SIM_DMA_RING_LSB 6u
+#define SIM_DMA_RING_SEL (1u << 10)
+#define SIM_DMA_CHAIN_LSB 11u
+#define SIM_DMA_TREQ_LSB 15u
+#define SIM_DMA_IRQ_QUIET (1u << 21)
+
+// SysTick CSR fields
+#define SIM_TICK_ENABLE 0x1u
+#define SIM_TICK_PROCESSOR 0x4u
+#define SIM_TICK_MAX 0xFFFFFFu
+
+enum simCoreState {
+	SIM_CORE_OFF, // not launched
+	SIM_CORE_RUN, // runs when behind other core
+	SIM_CORE_WAIT, // in WFE until an event
+	SIM_CORE_LOCKED, // paused by multicore lockout
+};
+
+struct simTick {
+	systick_hw_t hw; // registers code sees
+	uint32_t csr; // control at last access
+	uint32_t rvr; // reload at last access
+	uint32_t cvr; // value at last access
+	uint64_t baseCycles; // cycles when counting restarted
+	uint64_t baseNS; // time when counting restarted
+	uint32_t baseValue; // value when counting restarted
+	uint32_t writes; // writes to current value
+};
+
+struct simCore {
+	uint64_t ns; // virtual time
+	uint64_t remainder; // part of a ns left over from cycles
+	uint64_t cycles; // cycles spent
+	bool masked; // interrupts disabled
+	uint64_t maskedSince; // time interrupts were disabled
+	bool event; // event register
+	uint64_t eventNS; // time event was sent
+	enum simCoreState state; // scheduling state
+	enum simCoreState lockedFrom; // state before lockout
+	bool victim; // answers lockout
+	ucontext_t context; // registers while switched out
+	struct simTick tick; // SysTick of core
+};
+
+struct simAlarm {
+	bool active; // waiting to fire
+	alarm_id_t id; // id handed out
+	uint64_t dueNS; // time alarm fires
+	alarm_callback_t callback; // one shot callback
+	void *userData; // passed to callback
+	struct repeating_timer *timer; // repeating timer, NULL for one shot
+};
+
+struct simDMAChannel {
+	dma_channel_hw_t hw; // registers code sees
+	uint32_t reload; // count loaded on trigger
+	bool claimed; // handed out
+	bool busy; // transferring
+	bool irqEnabled; // raises DMA_IRQ_0
+	bool irqStatus; // completion pending
+	uint64_t startNS; // time channel was triggered
+	uint64_t nextNS; // time of next transfer
+	uint64_t done; // transfers since trigger
+};
+
+struct simDMATimer {
+	bool claimed; // handed out
+	uint16_t x; // numerator
+	uint16_t y; // denominator
+};
+
+struct uart_inst {
+	uart_hw_t hw; // registers, DMA writes to dr
+	uint32_t divisor; // 16.6 baud divisor
+	uint64_t freeNS; // time line finishes last byte
+};
+
+struct simBuffer {
+	uint8_t *data; // bytes
+	uint32_t length; // bytes used
+	uint32_t size; // bytes allocated
+};
+
+struct udp_pcb {
+	int fd; // host socket
+};
+
+struct simDatagram {
+	uint64_t doneNS; // time last bit leaves antenna
+	bool lost; // dropped by loss injection
+	int fd; // socket sent on
+	struct sockaddr_in to; // target
+	uint16_t length; // payload bytes
+	uint8_t data[SIM_DATAGRAM_MAX]; // payload
+};
+
+uint8_t simFlash[PICO_FLASH_SIZE_BYTES];
+pwm_hw_t simPWM;
+adc_hw_t simADC;
+cyw43_t cyw43_state;
+
+struct simCore simCores[2];
+uint8_t simCurrent = 0u; // core running now
+bool simInIRQ = false; // core 0 runs a handler
+uint32_t simInterruptCount = 0u;
+uint64_t simInterruptCycles = 0u; // core 0 cycles spent in interrupts
+uint64_t simMaskedMax = 0u;
+uint8_t *simCore1Stack = NULL;
+void (*simCore1Entry)(void) = NULL;
+
+uint32_t simHz[CLK_COUNT];
+enum vreg_voltage simVoltage = VREG_VOLTAGE_DEFAULT;
+ssi_hw_t simSSIRegs = {.ssienr = 1u, .baudr = 2u}; // as boot2 leaves it
+struct simPLLChange simPLLLast;
+
+struct simAlarm simAlarms[SIM_ALARMS];
+alarm_id_t simNextAlarmID = 1;
+
+irq_handler_t simDMAHandlers[SIM_IRQ_HANDLERS];
+uint8_t simDMAHandlerCount = 0u;
+bool simDMAIRQEnabled = false;
+struct simDMAChannel simDMA[NUM_DMA_CHANNELS];
+struct simDMATimer simDMATimers[NUM_DMA_TIMERS];
+sim_dma_hook_t simDMAHook = NULL;
+
+struct uart_inst simUARTs[2];
+struct simBuffer simUARTCapture;
+int simPtyFD = -1;
+
+pio_hw_t simPIOs[2];
+
+bool simGPIOLevels[NUM_BANK0_GPIOS];
+uint32_t simGPIOChangeCounts[NUM_BANK0_GPIOS];
+
+spin_lock_t simSpinLocks[NUM_SPIN_LOCKS];
+uint32_t simSpinClaimed = 0u;
+
+uint32_t simFIFO[2][SIM_FIFO_DEPTH]; // [0] core 0 to core 1, [1] core 1 to core 0
+uint8_t simFIFOHead[2];
+uint8_t simFIFOCount[2];
+
+struct simFlashStats simFlashStatistics;
+
+stdio_driver_t *simStdio = NULL;
+
+bool simUSBStarted = false;
+bool simUSBConnected = true;
+bool simUSBReading = true;
+uint32_t simUSBFIFO = 0u; // bytes waiting in CDC FIFO
+uint8_t simUSBPending[SIM_USB_FIFO_BYTES];
+uint64_t simUSBDrainedNS = 0u;
+struct simBuffer simUSBCapture;
+int simUSBPtyFD = -1;
+
+struct simDatagram simWifiQueue[SIM_WIFI_QUEUE];
+uint8_t simWifiHead = 0u;
+uint8_t simWifiCount = 0u;
+uint64_t simWifiFreeNS = 0u;
+uint32_t simWifiLoss = 0u;
+uint32_t simWifiLossSpread = 0u;
+struct simWifiStats simWifiStatistics;
+
+/**
+ * Stops the test run with a message
+ *
+ * @param format printf format
+ */
+static void simFail(const char *format, ...) {
+	va_list args;
+	va_start(args, format);
+	fprintf(stderr, "sim: core %u at %llu ns: ", simCurrent, (unsigned long long)simCores[simCurrent].ns);
+	vfprintf(stderr, format, args);
+	fputc('\n', stderr);
+	va_end(args);
+	abort();
+}
+
+__attribute__((constructor)) static void simBoot(void) {
+	memset(simFlash, 0xFF, sizeof(simFlash));
+	simHz[clk_ref] = 12000000u;
+	simHz[clk_sys] = SIM_STARTUP_HZ;
+	simHz[clk_peri] = SIM_STARTUP_HZ;
+	simHz[clk_usb] = 48000000u;
+	simHz[clk_adc] = 48000000u;
+	simHz[clk_rtc] = 46875u;
+	simCores[0].state = SIM_CORE_RUN;
+	for (uint i = 0; i < 2u; i++) {
+		for (uint sm = 0; sm < 4u; sm++) {
+			simPIOs[i].sm[sm].clkdiv = 1u << PIO_SM0_CLKDIV_INT_LSB;
+			simPIOs[i].sm[sm].pinctrl = 0x14000000u;
+		}
+	}
+	for (uint i = 0; i < NUM_SPIN_LOCKS; i++) {
+		simSpinLocks[i] = 0u;
+	}
+	// SDK reserves low spinlocks for its own use
+	simSpinClaimed = 0x0000FFFFu;
+}
+
+/****************************
+ * Time
+****************************/
+
+/**
+ * Adds cycles to a core without running anything
+ *
+ * @param core core to charge
+ * @param cycles amount of cycles
+ */
+static void simAddCycles(struct simCore *core, uint64_t cycles) {
+	unsigned __int128 scaled = (unsigned __int128)cycles * SIM_NS_PER_S + core->remainder;
+	core->cycles += cycles;
+	core->ns += (uint64_t)(scaled / simHz[clk_sys]);
+	core->remainder = (uint64_t)(scaled % simHz[clk_sys]);
+	if (core->ns > SIM_TIME_LIMIT_NS) {
+		simFail("virtual time passed its limit, something waits forever");
+	}
+}
+
+/**
+ * Moves a core forward to a time without running anything
+ *
+ * @param core core to move
+ * @param ns time to move to, earlier times are ignored
+ */
+static void simSetTime(struct simCore *core, uint64_t ns) {
+	if (ns <= core->ns) {
+		return;
+	}
+	core->cycles += (uint64_t)(((unsigned __int128)(ns - core->ns) * simHz[clk_sys]) / SIM_NS_PER_S);
+	core->ns = ns;
+	core->remainder = 0u;
+	if (core->ns > SIM_TIME_LIMIT_NS) {
+		simFail("virtual time passed its limit, something waits forever");
+	}
+}
+
+static void simSwitch(uint8_t core);
+static void simHardware(uint64_t now);
+static bool simDispatch(void);
+static uint64_t simNextEvent(void);
+
+/**
+ * Runs core 1 if it is behind the core running now
+ */
+static void simSchedule(void) {
+	struct simCore *core0 = &simCores[0];
+	struct simCore *core1 = &simCores[1];
+
+	if (simCurrent == 0u) {
+		if (core1->state == SIM_CORE_RUN && core1->ns < core0->ns) {
+			simSwitch(1u);
+		}
+	}
+	else if (core0->state == SIM_CORE_RUN && core0->ns < core1->ns) {
+		simSwitch(0u);
+	}
+	else if (core0->state == SIM_CORE_WAIT && simNextEvent() <= core1->ns) {
+		simSwitch(0u);
+	}
+}
+
+/**
+ * Moves core 0 to a time, running DMA, interrupts and core 1 on the way
+ *
+ * @param target time to reach
+ * @param wake whether to stop early once an event reaches core 0
+ */
+static void simRunTo(uint64_t target, bool wake) {
+	struct simCore *core0 = &simCores[0];
+	struct simCore *core1 = &simCores[1];
+
+	for (;;) {
+		if (wake && core0->event) {
+			return;
+		}
+		simHardware(core0->ns);
+		if (simDispatch()) {
+			continue;
+		}
+		uint64_t next = simNextEvent();
+		uint64_t step = next < target ? next : target;
+		if (core1->state == SIM_CORE_RUN && core1->ns < step) {
+			simSetTime(core0, core1->ns);
+			simSwitch(1u);
+			continue;
+		}
+		if (next > target) {
+			break;
+		}
+		simSetTime(core0, next);
+	}
+	simSetTime(core0, target);
+}
+
+/**
+ * Spends cycles on core running now
+ *
+ * @param cycles amount of cycles
+ */
+static void simSpend(uint64_t cycles) {
+	struct simCore *core = &simCores[simCurrent];
+
+	if (simCurrent == 0u) {
+		// long spends step through events so interrupts aren't late
+		unsigned __int128 scaled = (unsigned __int128)cycles * SIM_NS_PER_S + core->remainder;
+		uint64_t target = core->ns + (uint64_t)(scaled / simHz[clk_sys]);
+		if (simNextEvent() <= target) {
+			simRunTo(target, false);
+			return;
+		}
+		simAddCycles(core, cycles);
+		simHardware(core->ns);
+		while (simDispatch()) {
+			simHardware(core->ns);
+		}
+	}
+	else {
+		simAddCycles(core, cycles);
+	}
+	simSchedule();
+}
+
+/**
+ * Waits on core running now until a time
+ *
+ * @param ns time to wait for
+ */
+static void simWaitUntil(uint64_t ns) {
+	if (simCurrent == 0u) {
+		simRunTo(ns, false);
+	}
+	else {
+		simSetTime(&simCores[1], ns);
+	}
+	simSchedule();
+}
+
+uint64_t simNowNS(void) {
+	return simCores[simCurrent].ns;
+}
+
+uint64_t simCycles(void) {
+	return simCores[simCurrent].cycles;
+}
+
+void simRunUS(uint64_t us) {
+	simWaitUntil(simNowNS() + us * SIM_NS_PER_US);
+}
+
+void simCharge(uint32_t cycles) {
+	simSpend(cycles);
+}
+
+uint32_t simInterrupts(void) {
+	return simInterruptCount;
+}
+
+uint64_t simInterruptCyclesSpent(void) {
+	return simInterruptCycles;
+}
+
+uint64_t simMaskedMaxNS(void) {
+	return simMaskedMax;
+}
+
+void tight_loop_contents(void) {
+	simSpend(1u);
+}
+
+uint get_core_num(void) {
+	return simCurrent;
+}
+
+uint32_t time_us_32(void) {
+	simSpend(SIM_CYCLES_TIMER_32);
+	return (uint32_t)(simNowNS() / SIM_NS_PER_US);
+}
+
+uint64_t time_us_64(void) {
+	simSpend(SIM_CYCLES_TIMER_64);
+	return simNowNS() / SIM_NS_PER_US;
+}
+
+absolute_time_t get_absolute_time(void) {
+	return time_us_64();
+}
+
+absolute_time_t make_timeout_time_us(uint64_t us) {
+	return time_us_64() + us;
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t ms) {
+	return time_us_64() + (uint64_t)ms * 1000u;
+}
+
+bool time_reached(absolute_time_t time) {
+	return time_us_64() >= time;
+}
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+	return (int64_t)(to - from);
+}
+
+void busy_wait_us(uint64_t us) {
+	simWaitUntil(simNowNS() + us * SIM_NS_PER_US);
+}
+
+void busy_wait_us_32(uint32_t us) {
+	busy_wait_us(us);
+}
+
+void busy_wait_ms(uint32_t ms) {
+	busy_wait_us((uint64_t)ms * 1000u);
+}
+
+void busy_wait_at_least_cycles(uint32_t cycles) {
+	simSpend(cycles > 0u ? cycles : 1u);
+}
+
+void sleep_us(uint64_t us) {
+	busy_wait_us(us);
+}
+
+void sleep_ms(uint32_t ms) {
+	busy_wait_ms(ms);
+}
+
+void sleep_until(absolute_time_t time) {
+	simWaitUntil(time * SIM_NS_PER_US);
+}
+
+/****************************
+ * Cores
+****************************/
+
+/**
+ * Switches to other core
+ *
+ * @param core core to run
+ */
+static void simSwitch(uint8_t core) {
+	uint8_t from = simCurrent;
+	if (core == from) {
+		return;
+	}
+	simCurrent = core;
+	swapcontext(&simCores[from].context, &simCores[core].context);
+	simCurrent = from;
+}
+
+/**
+ * Runs core 1 entry and parks core 1 once it returns
+ */
+static void simCore1Main(void) {
+	simCore1Entry();
+	simCores[1].state = SIM_CORE_OFF;
+	for (;;) {
+		simSwitch(0u);
+	}
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+	if (simCurrent != 0u) {
+		simFail("core 1 launched from core 1");
+	}
+	if (simCores[1].state != SIM_CORE_OFF) {
+		simFail("core 1 launched twice without reset");
+	}
+	if (simCore1Stack == NULL) {
+		simCore1Stack = malloc(SIM_CORE1_STACK);
+	}
+	simCore1Entry = entry;
+	getcontext(&simCores[1].context);
+	simCores[1].context.uc_stack.ss_sp = simCore1Stack;
+	simCores[1].context.uc_stack.ss_size = SIM_CORE1_STACK;
+	simCores[1].context.uc_link = NULL;
+	makecontext(&simCores[1].context, simCore1Main, 0);
+	simCores[1].ns = simCores[0].ns;
+	simCores[1].cycles = 0u;
+	simCores[1].remainder = 0u;
+	simCores[1].masked = false;
+	simCores[1].event = false;
+	simCores[1].victim = false;
+	simCores[1].state = SIM_CORE_RUN;
+	simFIFOCount[0] = 0u;
+	simFIFOCount[1] = 0u;
+	simSpend(SIM_CYCLES_LOCKOUT);
+}
+
+void multicore_reset_core1(void) {
+	if (simCurrent != 0u) {
+		simFail("core 1 reset from core 1");
+	}
+	simCores[1].state = SIM_CORE_OFF;
+	simCores[1].victim = false;
+	simSpend(SIM_CYCLES_CALL);
+}
+
+void __dmb(void) {
+	simSpend(1u);
+}
+
+void __sev(void) {
+	struct simCore *core = &simCores[simCurrent];
+	struct simCore *other = &simCores[simCurrent ^ 1u];
+	simSpend(1u);
+	core->event = true;
+	core->eventNS = core->ns;
+	other->event = true;
+	other->eventNS = core->ns;
+	if (other->state == SIM_CORE_WAIT) {
+		other->state = SIM_CORE_RUN;
+	}
+	else if (other->state == SIM_CORE_LOCKED && other->lockedFrom == SIM_CORE_WAIT) {
+		other->lockedFrom = SIM_CORE_RUN;
+	}
+}
+
+void __wfe(void) {
+	struct simCore *core = &simCores[simCurrent];
+	struct simCore *core1 = &simCores[1];
+
+	simSpend(1u);
+	while (!core->event) {
+		core->state = SIM_CORE_WAIT;
+		if (simCurrent == 1u) {
+			simSwitch(0u);
+			continue;
+		}
+		// core 0 sleeps until core 1 or hardware wakes it
+		uint64_t next = simNextEvent();
+		if (core1->state == SIM_CORE_RUN && core1->ns < next) {
+			simSwitch(1u);
+			continue;
+		}
+		if (next == SIM_NEVER) {
+			simFail("both cores wait with nothing left to wake them");
+		}
+		simRunTo(next, true);
+	}
+	core->state = SIM_CORE_RUN;
+	core->event = false;
+	if (simCurrent == 0u) {
+		simRunTo(core->eventNS, false);
+	}
+	else {
+		simSetTime(core, core->eventNS);
+	}
+}
+
+void __wfi(void) {
+	__wfe();
+}
+
+uint32_t save_and_disable_interrupts(void) {
+	struct simCore *core = &simCores[simCurrent];
+	uint32_t status = core->masked ? 1u : 0u;
+	simSpend(SIM_CYCLES_INTERRUPTS);
+	if (!core->masked) {
+		core->masked = true;
+		core->maskedSince = core->ns;
+	}
+	return status;
+}
+
+void restore_interrupts(uint32_t status) {
+	struct simCore *core = &simCores[simCurrent];
+	if (status == 0u && core->masked) {
+		core->masked = false;
+		if (simCurrent == 0u && core->ns - core->maskedSince > simMaskedMax) {
+			simMaskedMax = core->ns - core->maskedSince;
+		}
+	}
+	// pending interrupts run as soon as they're unmasked
+	simSpend(SIM_CYCLES_INTERRUPTS);
+}
+
+int spin_lock_claim_unused(bool required) {
+	for (uint i = PICO_SPINLOCK_ID_STRIPED_FIRST; i < NUM_SPIN_LOCKS; i++) {
+		if (!(simSpinClaimed & (1u << i))) {
+			simSpinClaimed |= 1u << i;
+			return (int)i;
+		}
+	}
+	if (required) {
+		simFail("no spinlocks left");
+	}
+	return -1;
+}
+
+void spin_lock_unclaim(uint lock) {
+	simSpinClaimed &= ~(1u << lock);
+	simSpinLocks[lock] = 0u;
+}
+
+spin_lock_t* spin_lock_init(uint lock) {
+	if (lock >= NUM_SPIN_LOCKS) {
+		simFail("spinlock %u doesn't exist", lock);
+	}
+	simSpinLocks[lock] = 0u;
+	return &simSpinLocks[lock];
+}
+
+uint32_t spin_lock_blocking(spin_lock_t *lock) {
+	uint32_t status = save_and_disable_interrupts();
+	spin_lock_unsafe_blocking(lock);
+	return status;
+}
+
+void spin_lock_unsafe_blocking(spin_lock_t *lock) {
+	while (*lock != 0u) {
+		uint8_t owner = (uint8_t)(*lock - 1u);
+		if (owner == simCurrent) {
+			simFail("spinlock %d taken again by core holding it", (int)(lock - simSpinLocks));
+		}
+		if (simCores[owner].state != SIM_CORE_RUN) {
+			simFail("spinlock %d held by core %u which can't run", (int)(lock - simSpinLocks), owner);
+		}
+		simSpend(SIM_SPIN_CYCLES);
+	}
+	*lock = simCurrent + 1u;
+	simSpend(SIM_CYCLES_SPINLOCK);
+}
+
+void spin_unlock(spin_lock_t *lock, uint32_t status) {
+	spin_unlock_unsafe(lock);
+	restore_interrupts(status);
+}
+
+void spin_unlock_unsafe(spin_lock_t *lock) {
+	if (*lock != simCurrent + 1u) {
+		simFail("spinlock %d released by core not holding it", (int)(lock - simSpinLocks));
+	}
+	*lock = 0u;
+	simSpend(SIM_CYCLES_SPINLOCK);
+}
+
+bool is_spin_locked(spin_lock_t *lock) {
+	return *lock != 0u;
+}
+
+void multicore_lockout_victim_init(void) {
+	if (simCurrent != 1u) {
+		simFail("lockout victim set up outside core 1");
+	}
+	simCores[1].victim = true;
+	simSpend(SIM_CYCLES_CALL);
+}
+
+bool multicore_lockout_victim_is_initialized(uint core) {
+	return core < 2u && simCores[core].victim;
+}
+
+void multicore_lockout_start_blocking(void) {
+	struct simCore *core1 = &simCores[1];
+
+	if (simCurrent != 0u) {
+		simFail("lockout started from core 1, it would wait on itself");
+	}
+	if (core1->state == SIM_CORE_LOCKED) {
+		simFail("lockout started twice");
+	}
+	// core 1 answers from its FIFO interrupt once it is a victim and unmasks
+	while (core1->masked || !core1->victim) {
+		if (core1->state != SIM_CORE_RUN) {
+			simFail("lockout waits on core 1 which can't answer");
+		}
+		simSpend(SIM_SPIN_CYCLES);
+	}
+	simSpend(SIM_CYCLES_LOCKOUT);
+	simSetTime(core1, simCores[0].ns);
+	core1->lockedFrom = core1->state;
+	core1->state = SIM_CORE_LOCKED;
+}
+
+void multicore_lockout_end_blocking(void) {
+	struct simCore *core1 = &simCores[1];
+
+	if (core1->state != SIM_CORE_LOCKED) {
+		simFail("lockout ended without being started");
+	}
+	simSpend(SIM_CYCLES_LOCKOUT);
+	core1->state = core1->lockedFrom;
+	simSetTime(core1, simCores[0].ns);
+}
+
+bool multicore_fifo_rvalid(void) {
+	simSpend(1u);
+	return simFIFOCount[simCurrent ^ 1u] > 0u;
+}
+
+bool multicore_fifo_wready(void) {
+	simSpend(1u);
+	return simFIFOCount[simCurrent] < SIM_FIFO_DEPTH;
+}
+
+void multicore_fifo_push_blocking(uint32_t data) {
+	uint8_t fifo = simCurrent;
+	while (!multicore_fifo_wready()) {
+		tight_loop_contents();
+	}
+	simFIFO[fifo][(simFIFOHead[fifo] + simFIFOCount[fifo]) % SIM_FIFO_DEPTH] = data;
+	simFIFOCount[fifo]++;
+	__sev();
+}
+
+uint32_t multicore_fifo_pop_blocking(void) {
+	uint8_t fifo = simCurrent ^ 1u;
+	while (!multicore_fifo_rvalid()) {
+		__wfe();
+	}
+	uint32_t data = simFIFO[fifo][simFIFOHead[fifo]];
+	simFIFOHead[fifo] = (simFIFOHead[fifo] + 1u) % SIM_FIFO_DEPTH;
+	simFIFOCount[fifo]--;
+	return data;
+}
+
+void multicore_fifo_drain(void) {
+	simFIFOCount[simCurrent ^ 1u] = 0u;
+	simSpend(SIM_CYCLES_CALL);
+}
+
+/****************************
+ * Clocks
+****************************/
+
+uint32_t clock_get_hz(enum clock_index clock) {
+	return simHz[clock];
+}
+
+bool clock_configure(enum clock_index clock, uint32_t src, uint32_t auxsrc, uint32_t srcFreq, uint32_t freq) {
+	(void)src;
+	(void)auxsrc;
+	if (freq == 0u || freq > srcFreq) {
+		return false;
+	}
+	simHz[clock] = freq;
+	simSpend(SIM_CYCLES_CALL);
+	return true;
+}
+
+bool check_sys_clock_khz(uint32_t freqKHz, uint *vcoOut, uint *postDiv1Out, uint *postDiv2Out) {
+	// same search as the SDK, 12 MHz crystal and VCO between 750 and 1600 MHz
+	const uint referenceKHz = 12000u;
+	for (uint fbdiv = 320u; fbdiv >= 16u; fbdiv--) {
+		uint vcoKHz = fbdiv * referenceKHz;
+		if (vcoKHz < 750000u || vcoKHz > 1600000u) {
+			continue;
+		}
+		for (uint postDiv1 = 7u; postDiv1 >= 1u; postDiv1--) {
+			for (uint postDiv2 = postDiv1; postDiv2 >= 1u; postDiv2--) {
+				uint out = vcoKHz / (postDiv1 * postDiv2);
+				if (out == freqKHz && !(vcoKHz % (postDiv1 * postDiv2))) {
+					*vcoOut = vcoKHz * 1000u;
+					*postDiv1Out = postDiv1;
+					*postDiv2Out = postDiv2;
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+void set_sys_clock_pll(uint32_t vcoFreq, uint postDiv1, uint postDiv2) {
+	// flash keeps running through the switch, so the faster clock counts
+	const uint32_t sysHz = vcoFreq / (postDiv1 * postDiv2);
+	simPLLLast.sysHz = sysHz;
+	simPLLLast.voltage = simVoltage;
+	simPLLLast.flashHz = (sysHz > simHz[clk_sys] ? sysHz : simHz[clk_sys]) / simSSIRegs.baudr;
+	// clk_sys and clk_peri both follow the PLL, as the SDK sets them
+	simHz[clk_sys] = sysHz;
+	simHz[clk_peri] = simHz[clk_sys];
+	simCores[0].remainder = 0u;
+	simCores[1].remainder = 0u;
+	// PLL relock
+	simWaitUntil(simNowNS() + 100u * SIM_NS_PER_US);
+}
+
+bool set_sys_clock_khz(uint32_t freqKHz, bool required) {
+	uint vco;
+	uint postDiv1;
+	uint postDiv2;
+	if (!check_sys_clock_khz(freqKHz, &vco, &postDiv1, &postDiv2)) {
+		if (required) {
+			simFail("clk_sys of %u kHz can't be made", freqKHz);
+		}
+		return false;
+	}
+	set_sys_clock_pll(vco, postDiv1, postDiv2);
+	return true;
+}
+
+void vreg_set_voltage(enum vreg_voltage voltage) {
+	simVoltage = voltage;
+	simSpend(SIM_CYCLES_CALL);
+}
+
+enum vreg_voltage simVoltageGet(void) {
+	return simVoltage;
+}
+
+void simLastPLLChange(struct simPLLChange *change) {
+	*change = simPLLLast;
+}
+
+/****************************
+ * SysTick
+****************************/
+
+/**
+ * Gets SysTick value from settings at last access
+ *
+ * @param core core of SysTick
+ *
+ * @return current value
+ */
+static uint32_t simTickValue(struct simCore *core) {
+	struct simTick *tick = &core->tick;
+
+	if (!(tick->csr & SIM_TICK_ENABLE)) {
+		return tick->baseValue;
+	}
+	uint64_t elapsed = (tick->csr & SIM_TICK_PROCESSOR) ? core->cycles - tick->baseCycles
+		: (core->ns - tick->baseNS) / SIM_NS_PER_US;
+	if (elapsed <= tick->baseValue) {
+		return (uint32_t)(tick->baseValue - elapsed);
+	}
+	if (tick->rvr == 0u) {
+		return 0u;
+	}
+	return (uint32_t)(tick->rvr - ((elapsed - tick->baseValue - 1u) % ((uint64_t)tick->rvr + 1u)));
+}
+
+systick_hw_t* simSysTick(void) {
+	struct simCore *core = &simCores[simCurrent];
+	struct simTick *tick = &core->tick;
+	systick_hw_t *hw = &tick->hw;
+
+	simSpend(SIM_CYCLES_SYSTICK);
+
+	uint32_t value = simTickValue(core);
+	bool restart = false;
+
+	// registers written since last access take effect now
+	if (hw->cvr != tick->cvr) {
+		tick->writes++;
+		value = 0u;
+		restart = true;
+	}
+	if ((hw->csr ^ tick->csr) & (SIM_TICK_ENABLE | SIM_TICK_PROCESSOR)) {
+		restart = true;
+	}
+	if ((hw->rvr & SIM_TICK_MAX) != tick->rvr) {
+		restart = true;
+	}
+	if (restart) {
+		tick->baseCycles = core->cycles;
+		tick->baseNS = core->ns;
+		tick->baseValue = value;
+	}
+	tick->csr = hw->csr;
+	tick->rvr = hw->rvr & SIM_TICK_MAX;
+	tick->cvr = value;
+	hw->cvr = value;
+	return hw;
+}
+
+uint32_t simSysTickWrites(uint core) {
+	return simCores[core].tick.writes;
+}
+
+/****************************
+ * Alarms
+****************************/
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *userData, bool fireIfPast) {
+	simSpend(SIM_CYCLES_CALL * 8u);
+	if (us == 0u && fireIfPast) {
+		int64_t again = callback(0, userData);
+		if (again == 0) {
+			return 0;
+		}
+		us = (uint64_t)(again < 0 ? -again : again);
+	}
+	for (uint i = 0; i < SIM_ALARMS; i++) {
+		struct simAlarm *alarm = &simAlarms[i];
+		if (!alarm->active) {
+			alarm->active = true;
+			alarm->id = simNextAlarmID++;
+			alarm->dueNS = (simNowNS() / SIM_NS_PER_US + (us > 0u ? us : 1u)) * SIM_NS_PER_US;
+			alarm->callback = callback;
+			alarm->userData = userData;
+			alarm->timer = NULL;
+			return alarm->id;
+		}
+	}
+	return -1;
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *userData, bool fireIfPast) {
+	return add_alarm_in_us((uint64_t)ms * 1000u, callback, userData, fireIfPast);
+}
+
+/**
+ * Finds active alarm
+ *
+ * @param id alarm id
+ *
+ * @return alarm, NULL if not active
+ */
+static struct simAlarm* simFindAlarm(alarm_id_t id) {
+	for (uint i = 0; i < SIM_ALARMS; i++) {
+		if (simAlarms[i].active && simAlarms[i].id == id) {
+			return &simAlarms[i];
+		}
+	}
+	return NULL;
+}
+
+bool cancel_alarm(alarm_id_t id) {
+	struct simAlarm *alarm = simFindAlarm(id);
+	simSpend(SIM_CYCLES_CALL * 8u);
+	if (alarm == NULL) {
+		return false;
+	}
+	alarm->active = false;
+	return true;
+}
+
+bool add_repeating_timer_us(int64_t delayUS, repeating_timer_callback_t callback, void *userData, struct repeating_timer *out) {
+	if (delayUS == 0) {
+		simFail("repeating timer with no delay");
+	}
+	out->delay_us = delayUS;
+	out->pool = NULL;
+	out->callback = callback;
+	out->user_data = userData;
+	out->alarm_id = add_alarm_in_us((uint64_t)(delayUS < 0 ? -delayUS : delayUS), NULL, out, false);
+	if (out->alarm_id < 0) {
+		return false;
+	}
+	simFindAlarm(out->alarm_id)->timer = out;
+	return true;
+}
+
+bool add_repeating_timer_ms(int32_t delayMS, repeating_timer_callback_t callback, void *userData, struct repeating_timer *out) {
+	return add_repeating_timer_us((int64_t)delayMS * 1000, callback, userData, out);
+}
+
+bool cancel_repeating_timer(struct repeating_timer *timer) {
+	bool cancelled = timer->alarm_id > 0 && cancel_alarm(timer->alarm_id);
+	timer->alarm_id = 0;
+	return cancelled;
+}
+
+/**
+ * Runs alarm that is due as the alarm pool interrupt would
+ *
+ * @param alarm alarm to run
+ */
+static void simFireAlarm(struct simAlarm *alarm) {
+	const alarm_id_t id = alarm->id;
+	const uint64_t dueNS = alarm->dueNS;
+	int64_t again;
+
+	simSpend(SIM_CYCLES_ALARM_IRQ);
+	if (alarm->timer != NULL) {
+		struct repeating_timer *timer = alarm->timer;
+		again = timer->callback(timer) ? timer->delay_us : 0;
+	}
+	else {
+		again = alarm->callback(id, alarm->userData);
+	}
+	simSpend(SIM_CYCLES_ALARM_REARM);
+
+	// cancelled while running
+	if (!alarm->active || alarm->id != id) {
+		return;
+	}
+	if (again == 0) {
+		alarm->active = false;
+	}
+	else if (again < 0) {
+		alarm->dueNS = dueNS + (uint64_t)(-again) * SIM_NS_PER_US;
+	}
+	else {
+		alarm->dueNS = (simCores[0].ns / SIM_NS_PER_US + (uint64_t)again) * SIM_NS_PER_US;
+	}
+}
+
+/****************************
+ * IRQ
+****************************/
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t orderPriority) {
+	(void)orderPriority;
+	if (num != DMA_IRQ_0) {
+		simFail("IRQ %u isn't simulated", num);
+	}
+	if (simDMAHandlerCount >= SIM_IRQ_HANDLERS) {
+		simFail("too many shared handlers on IRQ %u", num);
+	}
+	simDMAHandlers[simDMAHandlerCount++] = handler;
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+	if (num != DMA_IRQ_0) {
+		simFail("IRQ %u isn't simulated", num);
+	}
+	simDMAHandlers[0] = handler;
+	simDMAHandlerCount = 1u;
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+	if (num == DMA_IRQ_0) {
+		simDMAIRQEnabled = enabled;
+	}
+	simSpend(SIM_CYCLES_CALL);
+}
+
+/**
+ * Checks whether a DMA channel raises DMA_IRQ_0
+ *
+ * @return whether IRQ is pending
+ */
+static bool simDMAIRQPending(void) {
+	for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+		if (simDMA[i].irqStatus && simDMA[i].irqEnabled) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Runs one pending interrupt on core 0 if it can take one
+ *
+ * @return whether an interrupt ran
+ */
+static bool simDispatch(void) {
+	struct simCore *core0 = &simCores[0];
+
+	if (simCurrent != 0u || core0->masked || simInIRQ) {
+		return false;
+	}
+
+	struct simAlarm *due = NULL;
+	for (uint i = 0; i < SIM_ALARMS; i++) {
+		struct simAlarm *alarm = &simAlarms[i];
+		if (alarm->active && alarm->dueNS <= core0->ns && (due == NULL || alarm->dueNS < due->dueNS)) {
+			due = alarm;
+		}
+	}
+	bool dma = due == NULL && simDMAIRQEnabled && simDMAHandlerCount > 0u && simDMAIRQPending();
+	if (due == NULL && !dma) {
+		return false;
+	}
+
+	// taking an exception wakes WFE
+	const uint64_t startCycles = core0->cycles;
+	simInIRQ = true;
+	simInterruptCount++;
+	core0->event = true;
+	core0->eventNS = core0->ns;
+	simSpend(SIM_CYCLES_IRQ);
+	if (due != NULL) {
+		simFireAlarm(due);
+	}
+	else {
+		for (uint8_t i = 0; i < simDMAHandlerCount; i++) {
+			simDMAHandlers[i]();
+		}
+		if (simDMAIRQPending()) {
+			simFail("DMA_IRQ_0 handlers returned without acknowledging");
+		}
+	}
+	simInIRQ = false;
+	simInterruptCycles += core0->cycles - startCycles;
+	return true;
+}
+
+/****************************
+ * GPIO
+****************************/
+
+/**
+ * Checks GPIO exists
+ *
+ * @param gpio pin
+ */
+static void simCheckGPIO(uint gpio) {
+	if (gpio >= NUM_BANK0_GPIOS) {
+		simFail("GPIO %u doesn't exist", gpio);
+	}
+}
+
+void gpio_init(uint gpio) {
+	simCheckGPIO(gpio);
+	simGPIOLevels[gpio] = false;
+	simSpend(SIM_CYCLES_CALL);
+}
+
+void gpio_deinit(uint gpio) {
+	simCheckGPIO(gpio);
+	simSpend(SIM_CYCLES_CALL);
+}
+
+void gpio_set_function(uint gpio, enum gpio_function function) {
+	(void)function;
+	simCheckGPIO(gpio);
+	simSpend(SIM_CYCLES_CALL);
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+	(void)out;
+	simCheckGPIO(gpio);
+	simSpend(SIM_CYCLES_GPIO);
+}
+
+void gpio_put(uint gpio, bool value) {
+	simCheckGPIO(gpio);
+	if (simGPIOLevels[gpio] != value) {
+		simGPIOLevels[gpio] = value;
+		simGPIOChangeCounts[gpio]++;
+	}
+	simSpend(SIM_CYCLES_GPIO);
+}
+
+bool gpio_get(uint gpio) {
+	simCheckGPIO(gpio);
+	simSpend(SIM_CYCLES_GPIO);
+	return simGPIOLevels[gpio];
+}
+
+void gpio_pull_up(uint gpio) {
+	simCheckGPIO(gpio);
+	simSpend(SIM_CYCLES_CALL);
+}
+
+void gpio_pull_down(uint gpio) {
+	simCheckGPIO(gpio);
+	simSpend(SIM_CYCLES_CALL);
+}
+
+void gpio_disable_pulls(uint gpio) {
+	simCheckGPIO(gpio);
+	simSpend(SIM_CYCLES_CALL);
+}
+
+void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive) {
+	(void)drive;
+	simCheckGPIO(gpio);
+	simSpend(SIM_CYCLES_CALL);
+}
+
+uint32_t simGPIOChanges(uint gpio) {
+	return gpio < NUM_BANK0_GPIOS ? simGPIOChangeCounts[gpio] : 0u;
+}
+
+/****************************
+ * UART
+****************************/
+
+uart_inst_t* simUART(uint index) {
+	return &simUARTs[index];
+}
+
+uart_hw_t* uart_get_hw(uart_inst_t *uart) {
+	return &uart->hw;
+}
+
+uint uart_get_index(uart_inst_t *uart) {
+	return (uint)(uart - simUARTs);
+}
+
+/**
+ * Gets time one byte takes on the line
+ *
+ * @param uart UART
+ *
+ * @return time in ns
+ */
+static uint64_t simUARTByteNS(const struct uart_inst *uart) {
+	if (uart->divisor == 0u) {
+		simFail("UART %u used before setting baud", (uint)(uart - simUARTs));
+	}
+	// baud is clk_peri / (16 * divisor), divisor in 16.6
+	return ((uint64_t)SIM_UART_BITS * 16u * uart->divisor * SIM_NS_PER_S) / ((uint64_t)simHz[clk_peri] * 64u);
+}
+
+uint uart_set_baudrate(uart_inst_t *uart, uint baud) {
+	// same divisor rounding as the SDK
+	uint32_t divisor = (8u * simHz[clk_peri] / baud) + 1u;
+	uint32_t integer = divisor >> 7;
+	uint32_t fraction;
+	if (integer == 0u) {
+		integer = 1u;
+		fraction = 0u;
+	}
+	else if (integer >= 65535u) {
+		integer = 65535u;
+		fraction = 0u;
+	}
+	else {
+		fraction = (divisor & 0x7Fu) >> 1;
+	}
+	uart->divisor = (integer << 6) | fraction;
+	simSpend(SIM_CYCLES_CALL * 4u);
+	return (4u * simHz[clk_peri]) / (64u * integer + fraction);
+}
+
+uint uart_init(uart_inst_t *uart, uint baud) {
+	uart->freeNS = simNowNS();
+	return uart_set_baudrate(uart, baud);
+}
+
+uint uart_get_dreq(uart_inst_t *uart, bool tx) {
+	if (!tx) {
+		simFail("UART receive isn't simulated");
+	}
+	return uart == &simUARTs[0] ? DREQ_UART0_TX : DREQ_UART1_TX;
+}
+
+/**
+ * Gets time the transmit FIFO has space for a byte
+ *
+ * @param uart UART
+ * @param after earliest time wanted
+ *
+ * @return time in ns
+ */
+static uint64_t simUARTSpaceNS(const struct uart_inst *uart, uint64_t after) {
+	uint64_t backlog = (uint64_t)SIM_UART_FIFO * simUARTByteNS(uart);
+	if (uart->freeNS <= after + backlog) {
+		return after;
+	}
+	return uart->freeNS - backlog;
+}
+
+/**
+ * Shifts byte out of UART
+ *
+ * @param uart UART
+ * @param byte byte written
+ * @param ns time byte entered FIFO
+ */
+static void simUARTPush(struct uart_inst *uart, uint8_t byte, uint64_t ns) {
+	uint64_t start = uart->freeNS > ns ? uart->freeNS : ns;
+	uart->freeNS = start + simUARTByteNS(uart);
+
+	if (uart != &simUARTs[0]) {
+		return;
+	}
+	if (simUARTCapture.length == simUARTCapture.size) {
+		simUARTCapture.size = simUARTCapture.size ? simUARTCapture.size * 2u : 4096u;
+		simUARTCapture.data = realloc(simUARTCapture.data, simUARTCapture.size);
+	}
+	simUARTCapture.data[simUARTCapture.length++] = byte;
+	if (simPtyFD >= 0 && write(simPtyFD, &byte, 1u) != 1) {
+		simFail("pseudo terminal is full, read it while writing");
+	}
+}
+
+bool uart_is_writable(uart_inst_t *uart) {
+	simSpend(1u);
+	return simUARTSpaceNS(uart, simNowNS()) <= simNowNS();
+}
+
+void uart_putc_raw(uart_inst_t *uart, char c) {
+	simWaitUntil(simUARTSpaceNS(uart, simNowNS()));
+	simUARTPush(uart, (uint8_t)c, simNowNS());
+	simSpend(SIM_CYCLES_CALL);
+}
+
+void uart_tx_wait_blocking(uart_inst_t *uart) {
+	// DMA still feeding the UART keeps it busy
+	for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+		uint treq = (simDMA[i].hw.ctrl_trig >> SIM_DMA_TREQ_LSB) & 0x3Fu;
+		while (simDMA[i].busy && treq == uart_get_dreq(uart, true)) {
+			simWaitUntil(simDMA[i].nextNS > simNowNS() ? simDMA[i].nextNS : simNowNS() + 1u);
+		}
+	}
+	simWaitUntil(uart->freeNS);
+}
+
+const uint8_t* simUARTOutput(uint32_t *length) {
+	*length = simUARTCapture.length;
+	return simUARTCapture.data;
+}
+
+void simUARTClear(void) {
+	simUARTCapture.length = 0u;
+}
+
+/**
+ * Makes raw pseudo terminal
+ *
+ * @return main side, -1 if it couldn't be made
+ */
+static int simOpenPty(char *name, uint32_t size) {
+	int fd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0 || ptsname_r(fd, name, size) != 0) {
+		if (fd >= 0) {
+			close(fd);
+		}
+		return -1;
+	}
+	struct termios mode;
+	if (tcgetattr(fd, &mode) == 0) {
+		cfmakeraw(&mode);
+		tcsetattr(fd, TCSANOW, &mode);
+	}
+	return fd;
+}
+
+bool simUARTOpenPty(char *name, uint32_t size) {
+	simPtyFD = simOpenPty(name, size);
+	return simPtyFD >= 0;
+}
+
+uint64_t simUARTIdleNS(void) {
+	return simUARTs[0].freeNS;
+}
+
+void stdio_set_driver_enabled(stdio_driver_t *driver, bool enabled) {
+	simStdio = enabled ? driver : NULL;
+}
+
+/****************************
+ * DMA
+****************************/
+
+/**
+ * Gets DMA channel
+ *
+ * @param channel channel number
+ *
+ * @return channel
+ */
+static struct simDMAChannel* simChannel(uint channel) {
+	if (channel >= NUM_DMA_CHANNELS) {
+		simFail("DMA channel %u doesn't exist", channel);
+	}
+	return &simDMA[channel];
+}
+
+int dma_claim_unused_channel(bool required) {
+	for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+		if (!simDMA[i].claimed) {
+			simDMA[i].claimed = true;
+			return (int)i;
+		}
+	}
+	if (required) {
+		simFail("no DMA channels left");
+	}
+	return -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+	simChannel(channel)->claimed = false;
+}
+
+bool dma_channel_is_claimed(uint channel) {
+	return simChannel(channel)->claimed;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+	dma_channel_config config = {
+		.ctrl = SIM_DMA_EN | SIM_DMA_INCR_READ | ((uint32_t)DMA_SIZE_32 << SIM_DMA_SIZE_LSB)
+			| (channel << SIM_DMA_CHAIN_LSB) | (DREQ_FORCE << SIM_DMA_TREQ_LSB),
+	};
+	return config;
+}
+
+dma_channel_config dma_get_channel_config(uint channel) {
+	dma_channel_config config = {
+		.ctrl = simChannel(channel)->hw.ctrl_trig,
+	};
+	return config;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *config, enum dma_channel_transfer_size size) {
+	config->ctrl = (config->ctrl & ~(0x3u << SIM_DMA_SIZE_LSB)) | ((uint32_t)size << SIM_DMA_SIZE_LSB);
+}
+
+void channel_config_set_read_increment(dma_channel_config *config, bool increment) {
+	config->ctrl = increment ? config->ctrl | SIM_DMA_INCR_READ : config->ctrl & ~SIM_DMA_INCR_READ;
+}
+
+void channel_config_set_write_increment(dma_channel_config *config, bool increment) {
+	config->ctrl = increment ? config->ctrl | SIM_DMA_INCR_WRITE : config->ctrl & ~SIM_DMA_INCR_WRITE;
+}
+
+void channel_config_set_ring(dma_channel_config *config, bool write, uint sizeBits) {
+	config->ctrl = (config->ctrl & ~((0xFu << SIM_DMA_RING_LSB) | SIM_DMA_RING_SEL))
+		| (sizeBits << SIM_DMA_RING_LSB) | (write ? SIM_DMA_RING_SEL : 0u);
+}
+
+void channel_config_set_dreq(dma_channel_config *config, uint dreq) {
+	config->ctrl = (config->ctrl & ~(0x3Fu << SIM_DMA_TREQ_LSB)) | (dreq << SIM_DMA_TREQ_LSB);
+}
+
+void channel_config_set_chain_to(dma_channel_config *config, uint channel) {
+	config->ctrl = (config->ctrl & ~(0xFu << SIM_DMA_CHAIN_LSB)) | (channel << SIM_DMA_CHAIN_LSB);
+}
+
+void channel_config_set_irq_quiet(dma_channel_config *config, bool quiet) {
+	config->ctrl = quiet ? config->ctrl | SIM_DMA_IRQ_QUIET : config->ctrl & ~SIM_DMA_IRQ_QUIET;
+}
+
+/**
+ * Gets time of next transfer of a running channel
+ *
+ * @param channel channel
+ * @param after time of previous transfer
+ *
+ * @return time in ns
+ */
+static uint64_t simDMANextNS(struct simDMAChannel *channel, uint64_t after) {
+	uint treq = (channel->hw.ctrl_trig >> SIM_DMA_TREQ_LSB) & 0x3Fu;
+
+	if (treq >= DREQ_DMA_TIMER0 && treq < DREQ_DMA_TIMER0 + NUM_DMA_TIMERS) {
+		struct simDMATimer *timer = &simDMATimers[treq - DREQ_DMA_TIMER0];
+		if (timer->x == 0u || timer->y == 0u) {
+			return SIM_NEVER;
+		}
+		// pacing timer fires at clk_sys * x / y, kept exact from trigger
+		unsigned __int128 offset = (unsigned __int128)(channel->done + 1u) * timer->y * SIM_NS_PER_S;
+		uint64_t due = channel->startNS + (uint64_t)(offset / ((uint64_t)simHz[clk_sys] * timer->x));
+		return due > after ? due : after;
+	}
+	if (treq == DREQ_UART0_TX || treq == DREQ_UART1_TX) {
+		return simUARTSpaceNS(&simUARTs[treq == DREQ_UART0_TX ? 0u : 1u], after);
+	}
+	// unpaced transfers take a cycle each
+	return after + SIM_NS_PER_S / simHz[clk_sys];
+}
+
+/**
+ * Loads count and starts channel
+ *
+ * @param channel channel
+ * @param ns time of trigger
+ */
+static void simDMATrigger(struct simDMAChannel *channel, uint64_t ns) {
+	if (!(channel->hw.ctrl_trig & SIM_DMA_EN)) {
+		return;
+	}
+	channel->hw.transfer_count = channel->reload;
+	channel->busy = channel->reload > 0u;
+	channel->startNS = ns;
+	channel->done = 0u;
+	if (channel->busy) {
+		channel->nextNS = simDMANextNS(channel, ns);
+	}
+}
+
+/**
+ * Moves a DMA address on after a transfer
+ *
+ * @param address address
+ * @param size bytes moved
+ * @param ringBits ring size in bits, 0 for none
+ *
+ * @return next address
+ */
+static uintptr_t simDMAStep(uintptr_t address, uint32_t size, uint32_t ringBits) {
+	if (ringBits == 0u) {
+		return address + size;
+	}
+	uintptr_t mask = ((uintptr_t)1 << ringBits) - 1u;
+	return (address & ~mask) | ((address + size) & mask);
+}
+
+/**
+ * Does next transfer of a channel
+ *
+ * @param index channel number
+ */
+static void simDMATransfer(uint index) {
+	struct simDMAChannel *channel = &simDMA[index];
+	const uint32_t ctrl = channel->hw.ctrl_trig;
+	const uint32_t size = 1u << ((ctrl >> SIM_DMA_SIZE_LSB) & 0x3u);
+	const uint32_t ringBits = (ctrl >> SIM_DMA_RING_LSB) & 0xFu;
+	const bool ringWrite = (ctrl & SIM_DMA_RING_SEL) != 0u;
+	const uint64_t ns = channel->nextNS;
+	uint32_t value = 0u;
+
+	memcpy(&value, (const void*)channel->hw.read_addr, size);
+
+	volatile void *write = channel->hw.write_addr;
+	if (write == &simUARTs[0].hw.dr || write == &simUARTs[1].hw.dr) {
+		simUARTPush(write == &simUARTs[0].hw.dr ? &simUARTs[0] : &simUARTs[1], (uint8_t)value, ns);
+	}
+	else {
+		memcpy((void*)write, &value, size);
+	}
+	if (simDMAHook != NULL) {
+		simDMAHook(write, value, ns);
+	}
+
+	if (ctrl & SIM_DMA_INCR_READ) {
+		channel->hw.read_addr = (const void*)simDMAStep((uintptr_t)channel->hw.read_addr, size, ringWrite ? 0u : ringBits);
+	}
+	if (ctrl & SIM_DMA_INCR_WRITE) {
+		channel->hw.write_addr = (void*)simDMAStep((uintptr_t)channel->hw.write_addr, size, ringWrite ? ringBits : 0u);
+	}
+
+	channel->done++;
+	channel->hw.transfer_count--;
+	if (channel->hw.transfer_count > 0u) {
+		channel->nextNS = simDMANextNS(channel, ns);
+		return;
+	}
+
+	channel->busy = false;
+	if (!(ctrl & SIM_DMA_IRQ_QUIET)) {
+		channel->irqStatus = true;
+	}
+	uint chain = (ctrl >> SIM_DMA_CHAIN_LSB) & 0xFu;
+	if (chain != index) {
+		simDMATrigger(&simDMA[chain], ns);
+	}
+}
+
+/**
+ * Runs DMA transfers due by a time in order
+ *
+ * @param now time to run to
+ */
+static void simHardware(uint64_t now) {
+	for (;;) {
+		int next = -1;
+		for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+			if (simDMA[i].busy && simDMA[i].nextNS <= now && (next < 0 || simDMA[i].nextNS < simDMA[next].nextNS)) {
+				next = (int)i;
+			}
+		}
+		if (next < 0) {
+			return;
+		}
+		simDMATransfer((uint)next);
+	}
+}
+
+/**
+ * Gets time of next alarm or DMA transfer after now on core 0
+ *
+ * @return time in ns, SIM_NEVER if nothing is coming
+ */
+static uint64_t simNextEvent(void) {
+	const uint64_t now = simCores[0].ns;
+	uint64_t next = SIM_NEVER;
+
+	for (uint i = 0; i < SIM_ALARMS; i++) {
+		if (simAlarms[i].active && simAlarms[i].dueNS > now && simAlarms[i].dueNS < next) {
+			next = simAlarms[i].dueNS;
+		}
+	}
+	for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+		if (simDMA[i].busy && simDMA[i].nextNS < next) {
+			next = simDMA[i].nextNS > now ? simDMA[i].nextNS : now + 1u;
+		}
+	}
+	return next;
+}
+
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger) {
+	struct simDMAChannel *ch = simChannel(channel);
+	ch->hw.ctrl_trig = config->ctrl;
+	simSpend(SIM_CYCLES_DMA_SETUP);
+	if (trigger) {
+		simDMATrigger(ch, simNowNS());
+	}
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write, const volatile void *read, uint transferCount, bool trigger) {
+	struct simDMAChannel *ch = simChannel(channel);
+	ch->hw.write_addr = write;
+	ch->hw.read_addr = read;
+	ch->reload = transferCount;
+	simSpend(SIM_CYCLES_DMA_SETUP * 3u);
+	dma_channel_set_config(channel, config, trigger);
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void *read, bool trigger) {
+	struct simDMAChannel *ch = simChannel(channel);
+	ch->hw.read_addr = read;
+	simSpend(SIM_CYCLES_DMA_SETUP);
+	if (trigger) {
+		simDMATrigger(ch, simNowNS());
+	}
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void *write, bool trigger) {
+	struct simDMAChannel *ch = simChannel(channel);
+	ch->hw.write_addr = write;
+	simSpend(SIM_CYCLES_DMA_SETUP);
+	if (trigger) {
+		simDMATrigger(ch, simNowNS());
+	}
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t count, bool trigger) {
+	struct simDMAChannel *ch = simChannel(channel);
+	ch->reload = count;
+	simSpend(SIM_CYCLES_DMA_SETUP);
+	if (trigger) {
+		simDMATrigger(ch, simNowNS());
+	}
+}
+
+void dma_channel_start(uint channel) {
+	simSpend(SIM_CYCLES_DMA_SETUP);
+	simDMATrigger(simChannel(channel), simNowNS());
+}
+
+void dma_channel_abort(uint channel) {
+	struct simDMAChannel *ch = simChannel(channel);
+	simSpend(SIM_CYCLES_DMA_SETUP);
+	ch->busy = false;
+	ch->hw.transfer_count = 0u;
+}
+
+bool dma_channel_is_busy(uint channel) {
+	simSpend(1u);
+	return simChannel(channel)->busy;
+}
+
+dma_channel_hw_t* dma_channel_hw_addr(uint channel) {
+	// reads see transfers due by now
+	if (simCurrent == 0u) {
+		simHardware(simNowNS());
+	}
+	return &simChannel(channel)->hw;
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+	simChannel(channel)->irqEnabled = enabled;
+	simSpend(SIM_CYCLES_DMA_SETUP);
+}
+
+bool dma_channel_get_irq0_status(uint channel) {
+	simSpend(1u);
+	return simChannel(channel)->irqStatus && simChannel(channel)->irqEnabled;
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {
+	simChannel(channel)->irqStatus = false;
+	simSpend(1u);
+}
+
+int dma_claim_unused_timer(bool required) {
+	for (uint i = 0; i < NUM_DMA_TIMERS; i++) {
+		if (!simDMATimers[i].claimed) {
+			simDMATimers[i].claimed = true;
+			return (int)i;
+		}
+	}
+	if (required) {
+		simFail("no DMA timers left");
+	}
+	return -1;
+}
+
+void dma_timer_unclaim(uint timer) {
+	simDMATimers[timer].claimed = false;
+}
+
+void dma_timer_set_fraction(uint timer, uint16_t numerator, uint16_t denominator) {
+	if (timer >= NUM_DMA_TIMERS) {
+		simFail("DMA timer %u doesn't exist", timer);
+	}
+	simDMATimers[timer].x = numerator;
+	simDMATimers[timer].y = denominator;
+	simSpend(SIM_CYCLES_DMA_SETUP);
+}
+
+uint dma_get_timer_dreq(uint timer) {
+	return DREQ_DMA_TIMER0 + timer;
+}
+
+void simSetDMAHook(sim_dma_hook_t hook) {
+	simDMAHook = hook;
+}
+
+/****************************
+ * PWM, PIO and ADC
+****************************/
+
+pwm_config pwm_get_default_config(void) {
+	pwm_config config = {
+		.csr = 0u,
+		.div = 1u << 4,
+		.top = 0xFFFFu,
+	};
+	return config;
+}
+
+void pwm_config_set_clkdiv_int(pwm_config *config, uint div) {
+	config->div = div << 4;
+}
+
+void pwm_config_set_wrap(pwm_config *config, uint16_t wrap) {
+	config->top = wrap;
+}
+
+void pwm_init(uint slice, pwm_config *config, bool start) {
+	if (slice >= NUM_PWM_SLICES) {
+		simFail("PWM slice %u doesn't exist", slice);
+	}
+	pwm_slice_hw_t *hw = &simPWM.slice[slice];
+	hw->csr = 0u;
+	hw->ctr = 0u;
+	hw->cc = 0u;
+	hw->top = config->top;
+	hw->div = config->div;
+	hw->csr = config->csr | (start ? 1u : 0u);
+	simSpend(SIM_CYCLES_CALL * 6u);
+}
+
+void pwm_set_enabled(uint slice, bool enabled) {
+	if (slice >= NUM_PWM_SLICES) {
+		simFail("PWM slice %u doesn't exist", slice);
+	}
+	simPWM.slice[slice].csr = (simPWM.slice[slice].csr & ~1u) | (enabled ? 1u : 0u);
+	simSpend(SIM_CYCLES_CALL);
+}
+
+uint pwm_gpio_to_slice_num(uint gpio) {
+	simCheckGPIO(gpio);
+	return (gpio >> 1) & 7u;
+}
+
+PIO simPIO(uint index) {
+	return &simPIOs[index];
+}
+
+void pio_sm_set_clkdiv_int_frac(PIO pio, uint sm, uint16_t divInt, uint8_t divFrac) {
+	if (sm >= 4u) {
+		simFail("PIO state machine %u doesn't exist", sm);
+	}
+	pio->sm[sm].clkdiv = ((uint32_t)divInt << PIO_SM0_CLKDIV_INT_LSB) | ((uint32_t)divFrac << PIO_SM0_CLKDIV_FRAC_LSB);
+	simSpend(SIM_CYCLES_CALL);
+}
+
+uint32_t simPIODivider(uint pio, uint sm) {
+	return simPIOs[pio].sm[sm].clkdiv >> PIO_SM0_CLKDIV_FRAC_LSB;
+}
+
+void adc_init(void) {
+	simADC.cs = 1u;
+	simADC.div = 0u;
+	simSpend(SIM_CYCLES_CALL * 4u);
+}
+
+void adc_select_input(uint input) {
+	if (input > 4u) {
+		simFail("ADC input %u doesn't exist", input);
+	}
+	simADC.cs = (simADC.cs & ~(0x7u << 12)) | (input << 12);
+	simSpend(SIM_CYCLES_CALL);
+}
+
+uint16_t adc_read(void) {
+	simWaitUntil(simNowNS() + SIM_ADC_US * SIM_NS_PER_US);
+	simADC.result = 1u << 11;
+	return (uint16_t)simADC.result;
+}
+
+/****************************
+ * Flash
+****************************/
+
+/**
+ * Checks nothing can run from flash while XIP is off
+ *
+ * @param what action reported on failure
+ */
+static void simCheckXIPOff(const char *what) {
+	// handlers may go on once they mask interrupts, like a commit queued from core 1
+	if (!simCores[simCurrent].masked) {
+		simFlashStatistics.unsafe++;
+		simFail("%s with interrupts enabled", what);
+	}
+	if (simCurrent != 0u) {
+		simFlashStatistics.unsafe++;
+		simFail("%s from core 1", what);
+	}
+	if (simCores[1].state != SIM_CORE_OFF && simCores[1].state != SIM_CORE_LOCKED) {
+		simFlashStatistics.unsafe++;
+		simFail("%s while core 1 runs", what);
+	}
+}
+
+ssi_hw_t* simSSI(void) {
+	// disabling SSI stops XIP
+	simCheckXIPOff("flash SSI accessed");
+	simSpend(SIM_CYCLES_CALL);
+	return &simSSIRegs;
+}
+
+/**
+ * Checks flash can be written now
+ *
+ * @param offset offset into flash
+ * @param count bytes written
+ * @param align alignment needed
+ */
+static void simCheckFlash(uint32_t offset, size_t count, uint32_t align) {
+	if (offset % align != 0u || count % align != 0u || offset + count > PICO_FLASH_SIZE_BYTES) {
+		simFail("flash write of %zu bytes at %u isn't aligned to %u", count, offset, align);
+	}
+	simCheckXIPOff("flash written");
+}
+
+void flash_range_erase(uint32_t offset, size_t count) {
+	simCheckFlash(offset, count, FLASH_SECTOR_SIZE);
+	memset(simFlash + offset, 0xFF, count);
+	simFlashStatistics.erases += (uint32_t)(count / FLASH_SECTOR_SIZE);
+	simWaitUntil(simNowNS() + (uint64_t)(count / FLASH_SECTOR_SIZE) * SIM_FLASH_ERASE_US * SIM_NS_PER_US);
+}
+
+void flash_range_program(uint32_t offset, const uint8_t *data, size_t count) {
+	simCheckFlash(offset, count, FLASH_PAGE_SIZE);
+	// programming only clears bits
+	for (size_t i = 0; i < count; i++) {
+		simFlash[offset + i] &= data[i];
+	}
+	simFlashStatistics.programs += (uint32_t)(count / FLASH_PAGE_SIZE);
+	simWaitUntil(simNowNS() + (uint64_t)(count / FLASH_PAGE_SIZE) * SIM_FLASH_PROGRAM_US * SIM_NS_PER_US);
+}
+
+void simFlashGetStats(struct simFlashStats *stats) {
+	*stats = simFlashStatistics;
+}
+
+/****************************
+ * CYW43
+****************************/
+
+int cyw43_arch_init(void) {
+	if (cyw43_state.initialized) {
+		simFail("cyw43_arch_init called twice");
+	}
+	// driver interrupts are bound to core that starts it
+	cyw43_state.core = (uint8_t)simCurrent;
+	// gSPI program drives data on GPIO 24 and side sets clock on GPIO 29, SDK divider of 2
+	pio_sm_hw_t *sm = &simPIOs[SIM_CYW43_PIO].sm[SIM_CYW43_SM];
+	sm->pinctrl = (24u << PIO_SM0_PINCTRL_OUT_BASE_LSB) | (29u << PIO_SM0_PINCTRL_SIDESET_BASE_LSB);
+	sm->clkdiv = 2u << PIO_SM0_CLKDIV_INT_LSB;
+	simWaitUntil(simNowNS() + SIM_CYW43_INIT_US * SIM_NS_PER_US);
+	cyw43_state.initialized = true;
+	return 0;
+}
+
+void cyw43_arch_deinit(void) {
+	cyw43_state.initialized = false;
+	simSpend(SIM_CYCLES_CALL);
+}
+
+bool cyw43_is_initialized(cyw43_t *self) {
+	return self->initialized;
+}
+
+void cyw43_arch_gpio_put(uint pin, bool value) {
+	(void)pin;
+	(void)value;
+	if (!cyw43_state.initialized) {
+		simFail("wireless chip GPIO used before cyw43_arch_init");
+	}
+	simWaitUntil(simNowNS() + SIM_CYW43_GPIO_US * SIM_NS_PER_US);
+}
+
+void cyw43_arch_lwip_begin(void) {
+	simSpend(SIM_CYCLES_CALL);
+}
+
+void cyw43_arch_lwip_end(void) {
+	simSpend(SIM_CYCLES_CALL);
+}
+
+void cyw43_arch_enable_sta_mode(void) {
+	if (!cyw43_state.initialized) {
+		simFail("station mode set before cyw43_arch_init");
+	}
+	simSpend(SIM_CYCLES_CALL);
+}
+
+int cyw43_arch_wifi_connect_timeout_ms(const char *ssid, const char *password, uint32_t auth, uint32_t timeoutMS) {
+	(void)ssid;
+	(void)password;
+	(void)auth;
+	if (!cyw43_state.initialized) {
+		simFail("wireless joined before cyw43_arch_init");
+	}
+	if (timeoutMS < SIM_WIFI_CONNECT_MS) {
+		busy_wait_ms(timeoutMS);
+		return -1;
+	}
+	busy_wait_ms(SIM_WIFI_CONNECT_MS);
+	return 0;
+}
+
+/**
+ * Hands datagrams that left the antenna to the host network
+ */
+static void simWifiRetire(void) {
+	const uint64_t now = simNowNS();
+	while (simWifiCount > 0u && simWifiQueue[simWifiHead].doneNS <= now) {
+		struct simDatagram *datagram = &simWifiQueue[simWifiHead];
+		if (!datagram->lost) {
+			sendto(datagram->fd, datagram->data, datagram->length, 0, (struct sockaddr*)&datagram->to, sizeof(datagram->to));
+		}
+		simWifiHead = (uint8_t)((simWifiHead + 1u) % SIM_WIFI_QUEUE);
+		simWifiCount--;
+	}
+}
+
+void cyw43_arch_poll(void) {
+	simSpend(SIM_CYCLES_CALL * 8u);
+	simWifiRetire();
+}
+
+void simWifiSetLoss(uint32_t permille) {
+	simWifiLoss = permille;
+	simWifiLossSpread = 0u;
+}
+
+void simWifiGetStats(struct simWifiStats *stats) {
+	*stats = simWifiStatistics;
+}
+
+/****************************
+ * lwIP
+****************************/
+
+#define SIM_PBUF_FLAG_CUSTOM 0x02u
+
+struct pbuf* pbuf_alloc(pbuf_layer layer, u16_t length, pbuf_type type) {
+	(void)layer;
+	if (type != PBUF_RAM) {
+		simFail("only PBUF_RAM is allocated");
+	}
+	struct pbuf *p = malloc(sizeof(struct pbuf) + length);
+	if (p == NULL) {
+		return NULL;
+	}
+	p->next = NULL;
+	p->payload = (uint8_t*)(p + 1);
+	p->tot_len = length;
+	p->len = length;
+	p->type = (u8_t)type;
+	p->flags = 0u;
+	p->ref = 1u;
+	simSpend(SIM_CYCLES_CALL * 16u);
+	return p;
+}
+
+struct pbuf* pbuf_alloced_custom(pbuf_layer layer, u16_t length, pbuf_type type, struct pbuf_custom *p, void *payload, u16_t payloadLength) {
+	(void)layer;
+	if (payloadLength < length) {
+		return NULL;
+	}
+	p->pbuf.next = NULL;
+	p->pbuf.payload = payload;
+	p->pbuf.tot_len = length;
+	p->pbuf.len = length;
+	p->pbuf.type = (u8_t)type;
+	p->pbuf.flags = SIM_PBUF_FLAG_CUSTOM;
+	p->pbuf.ref = 1u;
+	simSpend(SIM_CYCLES_CALL * 4u);
+	return &p->pbuf;
+}
+
+void pbuf_cat(struct pbuf *head, struct pbuf *tail) {
+	struct pbuf *p = head;
+	for (; p->next != NULL; p = p->next) {
+		p->tot_len = (u16_t)(p->tot_len + tail->tot_len);
+	}
+	p->tot_len = (u16_t)(p->tot_len + tail->tot_len);
+	p->next = tail;
+	simSpend(SIM_CYCLES_CALL);
+}
+
+void pbuf_ref(struct pbuf *p) {
+	p->ref++;
+}
+
+u8_t pbuf_free(struct pbuf *p) {
+	u8_t freed = 0u;
+	while (p != NULL) {
+		if (p->ref == 0u) {
+			simFail("pbuf freed twice");
+		}
+		if (--p->ref > 0u) {
+			break;
+		}
+		struct pbuf *next = p->next;
+		if (p->flags & SIM_PBUF_FLAG_CUSTOM) {
+			((struct pbuf_custom*)p)->custom_free_function(p);
+		}
+		else {
+			free(p);
+		}
+		freed++;
+		p = next;
+	}
+	simSpend(SIM_CYCLES_CALL * 4u);
+	return freed;
+}
+
+int ipaddr_aton(const char *text, ip_addr_t *address) {
+	struct in_addr parsed;
+	if (inet_aton(text, &parsed) == 0) {
+		return 0;
+	}
+	address->addr = parsed.s_addr;
+	return 1;
+}
+
+struct udp_pcb* udp_new_ip_type(u8_t type) {
+	(void)type;
+	struct udp_pcb *pcb = malloc(sizeof(struct udp_pcb));
+	if (pcb == NULL) {
+		return NULL;
+	}
+	pcb->fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (pcb->fd < 0) {
+		free(pcb);
+		return NULL;
+	}
+	return pcb;
+}
+
+void udp_remove(struct udp_pcb *pcb) {
+	close(pcb->fd);
+	free(pcb);
+}
+
+err_t udp_sendto(struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *address, u16_t port) {
+	if (p->tot_len > SIM_DATAGRAM_MAX) {
+		return ERR_VAL;
+	}
+	simWifiRetire();
+	if (simWifiCount >= SIM_WIFI_QUEUE) {
+		simWifiStatistics.queueFull++;
+		simSpend(SIM_CYCLES_CALL * 8u);
+		return ERR_MEM;
+	}
+
+	struct simDatagram *datagram = &simWifiQueue[(simWifiHead + simWifiCount) % SIM_WIFI_QUEUE];
+	datagram->length = 0u;
+	for (struct pbuf *q = p; q != NULL; q = q->next) {
+		memcpy(datagram->data + datagram->length, q->payload, q->len);
+		datagram->length = (uint16_t)(datagram->length + q->len);
+	}
+	datagram->fd = pcb->fd;
+	memset(&datagram->to, 0, sizeof(datagram->to));
+	datagram->to.sin_family = AF_INET;
+	datagram->to.sin_addr.s_addr = address->addr;
+	datagram->to.sin_port = htons(port);
+
+	// evenly spread loss so runs repeat exactly
+	simWifiLossSpread += simWifiLoss;
+	datagram->lost = simWifiLossSpread >= 1000u;
+	if (datagram->lost) {
+		simWifiLossSpread -= 1000u;
+		simWifiStatistics.lost++;
+	}
+
+	// poll driver copies frame to chip over gSPI before returning
+	const uint32_t frameBytes = datagram->length + SIM_WIFI_OVERHEAD_BYTES;
+	simWaitUntil(simNowNS() + (uint64_t)frameBytes * 8u * SIM_NS_PER_S / SIM_CYW43_SPI_HZ);
+
+	const uint64_t start = simWifiFreeNS > simNowNS() ? simWifiFreeNS : simNowNS();
+	datagram->doneNS = start + (uint64_t)frameBytes * 8u * SIM_NS_PER_S / SIM_WIFI_BITS_PER_S;
+	simWifiFreeNS = datagram->doneNS;
+	simWifiCount++;
+	simWifiStatistics.datagrams++;
+	simWifiStatistics.bytes += datagram->length;
+	return ERR_OK;
+}
+
+/****************************
+ * TinyUSB
+****************************/
+
+/**
+ * Moves bytes host has read out of CDC FIFO
+ */
+static void simUSBDrain(void) {
+	const uint64_t now = simNowNS();
+	uint64_t bytes = (now - simUSBDrainedNS) * SIM_USB_BYTES_PER_MS / (1000u * SIM_NS_PER_US);
+
+	if (!simUSBConnected || !simUSBReading) {
+		simUSBDrainedNS = now;
+		return;
+	}
+	if (bytes == 0u) {
+		return;
+	}
+	if (bytes > simUSBFIFO) {
+		bytes = simUSBFIFO;
+		simUSBDrainedNS = now;
+	}
+	else {
+		simUSBDrainedNS += bytes * 1000u * SIM_NS_PER_US / SIM_USB_BYTES_PER_MS;
+	}
+	if (simUSBCapture.length + bytes > simUSBCapture.size) {
+		while (simUSBCapture.length + bytes > simUSBCapture.size) {
+			simUSBCapture.size = simUSBCapture.size ? simUSBCapture.size * 2u : 4096u;
+		}
+		simUSBCapture.data = realloc(simUSBCapture.data, simUSBCapture.size);
+	}
+	memcpy(simUSBCapture.data + simUSBCapture.length, simUSBPending, (size_t)bytes);
+	simUSBCapture.length += (uint32_t)bytes;
+	if (simUSBPtyFD >= 0 && write(simUSBPtyFD, simUSBPending, (size_t)bytes) != (ssize_t)bytes) {
+		simFail("pseudo terminal is full, read it while writing");
+	}
+	memmove(simUSBPending, simUSBPending + bytes, (size_t)(simUSBFIFO - bytes));
+	simUSBFIFO -= (uint32_t)bytes;
+}
+
+bool tusb_init(void) {
+	simUSBStarted = true;
+	simUSBDrainedNS = simNowNS();
+	simSpend(SIM_CYCLES_CALL * 16u);
+	return true;
+}
+
+void tud_task(void) {
+	if (!simUSBStarted) {
+		simFail("tud_task called before tusb_init");
+	}
+	simSpend(SIM_CYCLES_CALL * 8u);
+	simUSBDrain();
+}
+
+bool tud_cdc_connected(void) {
+	simSpend(SIM_CYCLES_CALL);
+	return simUSBStarted && simUSBConnected;
+}
+
+uint32_t tud_cdc_write_available(void) {
+	simSpend(SIM_CYCLES_CALL);
+	return SIM_USB_FIFO_BYTES - simUSBFIFO;
+}
+
+uint32_t tud_cdc_write(const void *buffer, uint32_t length) {
+	uint32_t take = SIM_USB_FIFO_BYTES - simUSBFIFO;
+	if (take > length) {
+		take = length;
+	}
+	memcpy(simUSBPending + simUSBFIFO, buffer, take);
+	simUSBFIFO += take;
+	simSpend(SIM_CYCLES_CALL * 4u + take * SIM_CYCLES_USB_BYTE / 4u);
+	return take;
+}
+
+uint32_t tud_cdc_write_flush(void) {
+	simSpend(SIM_CYCLES_CALL * 4u);
+	simUSBDrain();
+	return simUSBFIFO;
+}
+
+void simUSBSetConnected(bool connected) {
+	simUSBDrain();
+	simUSBConnected = connected;
+}
+
+void simUSBSetReading(bool reading) {
+	simUSBDrain();
+	simUSBReading = reading;
+}
+
+const uint8_t* simUSBOutput(uint32_t *length) {
+	*length = simUSBCapture.length;
+	return simUSBCapture.data;
+}
+
+void simUSBClear(void) {
+	simUSBCapture.length = 0u;
+}
+
+bool simUSBOpenPty(char *name, uint32_t size) {
+	simUSBPtyFD = simOpenPty(name, size);
+	return simUSBPtyFD >= 0;
+}
\ No newline at end of file
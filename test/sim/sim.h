@@ -0,0 +1,279 @@
+/*
+	sim.h - controls the simulated Raspberry Pi Pico from host tests
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SIM_H
+#define SIM_H
+
+#include "sim_sdk.h"
+
+/****************************
+ * Cost Model
+ *
+ * Cycles each simulated call charges, taken from the
+ * RP2040 datasheet and SDK sources where they're known
+ * and rounded estimates where they depend on code paths
+ *
+ * Metrics measured on the simulation count these costs only,
+ * so they're stable run to run but aren't board cycle counts
+****************************/
+
+#define SIM_CYCLES_CALL 4u // any SDK call not listed
+#define SIM_CYCLES_TIMER_32 4u // time_us_32, one bus read
+#define SIM_CYCLES_TIMER_64 12u // time_us_64, latched read of both halves
+#define SIM_CYCLES_SYSTICK 2u // SysTick register access
+#define SIM_CYCLES_INTERRUPTS 2u // masking or unmasking interrupts
+#define SIM_CYCLES_GPIO 3u // SIO register write
+#define SIM_CYCLES_SPINLOCK 6u // spinlock claim or release
+#define SIM_CYCLES_IRQ 24u // exception entry and exit
+#define SIM_CYCLES_ALARM_IRQ 150u // alarm pool handler up to the callback
+#define SIM_CYCLES_ALARM_REARM 90u // alarm pool handler after the callback
+#define SIM_CYCLES_LOCKOUT 400u // FIFO handshake pausing core 1
+#define SIM_CYCLES_DMA_SETUP 8u // DMA channel register write
+#define SIM_CYCLES_USB_BYTE 1u // copy into CDC FIFO per 4 bytes
+
+#define SIM_FLASH_ERASE_US 45000u // 4 KiB sector erase, W25Q16JV typical
+#define SIM_FLASH_PROGRAM_US 400u // 256 byte page program, W25Q16JV typical
+#define SIM_CYW43_INIT_US 180000u // firmware download to wireless chip
+#define SIM_CYW43_GPIO_US 24u // wireless chip GPIO over SPI
+#define SIM_CYW43_SPI_HZ 50000000u // gSPI clock moving frames to wireless chip
+#define SIM_CYW43_PIO 0u // PIO block wireless driver claims
+#define SIM_CYW43_SM 0u // state machine wireless driver claims
+#define SIM_WIFI_CONNECT_MS 1500u // joining an access point
+#define SIM_USB_BYTES_PER_MS 1000u // full speed CDC bulk throughput
+#define SIM_USB_FIFO_BYTES 256u // CDC transmit FIFO
+#define SIM_WIFI_BITS_PER_S 20000000u // UDP goodput of wireless link
+#define SIM_WIFI_QUEUE 16u // datagrams wireless chip holds while sending
+#define SIM_WIFI_OVERHEAD_BYTES 64u // link, IP and UDP headers per datagram
+
+#define SIM_ADC_US 2u // one ADC conversion at 48 MHz
+
+#define SIM_STARTUP_HZ 125000000u // clk_sys at boot
+#define SIM_TIME_LIMIT_NS (3600ull * 1000000000ull) // virtual time a test may use
+
+struct simPLLChange {
+	uint32_t sysHz; // clk_sys after change
+	enum vreg_voltage voltage; // core voltage while PLL changed
+	uint32_t flashHz; // fastest flash SCK while PLL changed
+};
+
+typedef void (*sim_dma_hook_t)(volatile void *address, uint32_t value, uint64_t ns); // sees every DMA write
+
+struct simFlashStats {
+	uint32_t erases; // sectors erased
+	uint32_t programs; // pages programmed
+	uint32_t unsafe; // writes while interrupts or core 1 could touch flash
+};
+
+struct simWifiStats {
+	uint32_t datagrams; // datagrams handed to link
+	uint32_t bytes; // payload bytes handed to link
+	uint32_t lost; // datagrams dropped by loss injection
+	uint32_t queueFull; // sends refused because driver queue was full
+};
+
+/**
+ * Gets virtual time of calling core
+ *
+ * @return time in ns since boot
+ */
+uint64_t simNowNS(void);
+
+/**
+ * Gets cycles calling core has spent
+ *
+ * @return cycles since boot
+ */
+uint64_t simCycles(void);
+
+/**
+ * Lets time pass on calling core, running interrupts and DMA
+ *
+ * @param us amount of us
+ */
+void simRunUS(uint64_t us);
+
+/**
+ * Charges cycles to calling core
+ *
+ * @param cycles amount of cycles
+ *
+ * @note stands in for work the host does for free, such as a copy loop
+ */
+void simCharge(uint32_t cycles);
+
+/**
+ * Gets bytes the UART has shifted out
+ *
+ * @param length pointer to amount of bytes
+ *
+ * @return bytes, valid until next UART output
+ */
+const uint8_t* simUARTOutput(uint32_t *length);
+
+/**
+ * Forgets UART output seen so far
+ */
+void simUARTClear(void);
+
+/**
+ * Copies UART output to a pseudo terminal as it is shifted out
+ *
+ * @param name buffer for path of terminal to open
+ * @param size size of name
+ *
+ * @return whether terminal was made
+ */
+bool simUARTOpenPty(char *name, uint32_t size);
+
+/**
+ * Gets time last UART byte finishes shifting out
+ *
+ * @return time in ns
+ */
+uint64_t simUARTIdleNS(void);
+
+/**
+ * Sets whether host has CDC port open
+ *
+ * @param connected whether host is connected
+ */
+void simUSBSetConnected(bool connected);
+
+/**
+ * Sets whether host reads CDC port
+ *
+ * @param reading whether host takes bytes
+ */
+void simUSBSetReading(bool reading);
+
+/**
+ * Gets bytes host has read from CDC port
+ *
+ * @param length pointer to amount of bytes
+ *
+ * @return bytes, valid until next USB output
+ */
+const uint8_t* simUSBOutput(uint32_t *length);
+
+/**
+ * Forgets USB output seen so far
+ */
+void simUSBClear(void);
+
+/**
+ * Copies bytes host reads from CDC port to a pseudo terminal
+ *
+ * @param name buffer for path of terminal to open
+ * @param size size of name
+ *
+ * @return whether terminal was made
+ */
+bool simUSBOpenPty(char *name, uint32_t size);
+
+/**
+ * Drops datagrams on the wireless link
+ *
+ * @param permille datagrams in 1000 dropped, spread evenly
+ */
+void simWifiSetLoss(uint32_t permille);
+
+/**
+ * Gets wireless link statistics
+ *
+ * @param stats pointer to statistics
+ */
+void simWifiGetStats(struct simWifiStats *stats);
+
+/**
+ * Gets flash statistics
+ *
+ * @param stats pointer to statistics
+ */
+void simFlashGetStats(struct simFlashStats *stats);
+
+/**
+ * Gets times a GPIO changed level
+ *
+ * @param gpio pin
+ *
+ * @return amount of changes
+ */
+uint32_t simGPIOChanges(uint gpio);
+
+/**
+ * Gets times SysTick current value was written on a core
+ *
+ * @param core core of SysTick
+ *
+ * @return amount of writes
+ */
+uint32_t simSysTickWrites(uint core);
+
+/**
+ * Gets clock divider of a PIO state machine
+ *
+ * @param pio PIO block number
+ * @param sm state machine
+ *
+ * @return divider in 16.8 fixed point
+ */
+uint32_t simPIODivider(uint pio, uint sm);
+
+/**
+ * Gets core voltage last set
+ *
+ * @return voltage setting
+ */
+enum vreg_voltage simVoltageGet(void);
+
+/**
+ * Gets state of last system PLL change
+ *
+ * @param change pointer to state
+ */
+void simLastPLLChange(struct simPLLChange *change);
+
+/**
+ * Sets function seeing every DMA write
+ *
+ * @param hook function to call, NULL for none
+ */
+void simSetDMAHook(sim_dma_hook_t hook);
+
+/**
+ * Gets interrupts that ran on core 0
+ *
+ * @return amount of interrupts
+ */
+uint32_t simInterrupts(void);
+
+/**
+ * Gets cycles core 0 spent in interrupts, entry and exit included
+ *
+ * @return amount of cycles
+ */
+uint64_t simInterruptCyclesSpent(void);
+
+/**
+ * Gets longest time core 0 kept interrupts masked
+ *
+ * @return time in ns
+ */
+uint64_t simMaskedMaxNS(void);
+
+#endif
\ No newline at end of file
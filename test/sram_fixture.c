@@ -0,0 +1,32 @@
+/*
+	sram_fixture.c - objects in each SRAM section for sram_layout.py to check
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#define SRAM_BANKS
+
+#include <board_common.h>
+
+#include <inherited/pico/board_pico_sram.h>
+
+// CMakeLists.txt places the sections at board addresses, only the ELF is used
+SRAM_DMA uint8_t fixtureDMA[4096];
+SRAM_CORE1 uint8_t fixtureCore1[2048];
+uint8_t fixtureStriped[1024];
+
+int main(void) {
+	return fixtureDMA[0] + fixtureCore1[0] + fixtureStriped[0];
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+/*
+	test.h - checks and metric lines shared by host tests
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/****************************
+ * Test Config
+ *
+ * Each test is one executable, failed checks print and
+ * are counted, main returns testResult()
+ *
+ * testMetric prints the JSON lines perf_compare.py reads,
+ * only metrics counted on the simulated board are stable
+ * enough for the baseline, host timings use testHostMetric
+ * which perf_compare.py skips
+****************************/
+
+static uint32_t testFailures = 0u;
+
+#define TEST_CHECK(condition) do { \
+	if (!(condition)) { \
+		fprintf(stderr, "%s:%d: failed: %s\n", __FILE__, __LINE__, #condition); \
+		testFailures++; \
+	} \
+} while (0)
+
+#define TEST_EQUAL(expected, actual) do { \
+	long long testExpected = (long long)(expected); \
+	long long testActual = (long long)(actual); \
+	if (testExpected != testActual) { \
+		fprintf(stderr, "%s:%d: failed: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, testActual, testExpected); \
+		testFailures++; \
+	} \
+} while (0)
+
+#define TEST_NEAR(expected, actual, tolerance) do { \
+	double testExpected = (double)(expected); \
+	double testActual = (double)(actual); \
+	if (testActual < testExpected - (tolerance) || testActual > testExpected + (tolerance)) { \
+		fprintf(stderr, "%s:%d: failed: %s is %g, expected %g within %g\n", __FILE__, __LINE__, #actual, testActual, testExpected, (double)(tolerance)); \
+		testFailures++; \
+	} \
+} while (0)
+
+/**
+ * Gets next xorshift32 number so runs repeat exactly
+ *
+ * @param seed state of sequence, not 0, each test keeps its own
+ *
+ * @return next number
+ */
+static inline uint32_t testRandom(uint32_t *seed) {
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 17;
+	*seed ^= *seed << 5;
+	return *seed;
+}
+
+/**
+ * Prints metric counted on simulated board as a JSON line
+ *
+ * @param scenario scenario name
+ * @param metric metric name, lower is better
+ * @param value metric value
+ */
+static inline void testMetric(const char *scenario, const char *metric, uint64_t value) {
+	printf("{\"scenario\":\"%s\",\"metric\":\"%s\",\"value\":%" PRIu64 "}\n", scenario, metric, value);
+}
+
+/**
+ * Prints metric timed on host, kept out of the baseline
+ *
+ * @param scenario scenario name
+ * @param metric metric name
+ * @param value metric value
+ */
+static inline void testHostMetric(const char *scenario, const char *metric, uint64_t value) {
+	printf("host %s.%s %" PRIu64 "\n", scenario, metric, value);
+}
+
+/**
+ * Gets host monotonic time
+ *
+ * @return time in ns
+ */
+static inline uint64_t testHostNS(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * Gets exit code of test
+ *
+ * @param name test name
+ *
+ * @return 0 if every check passed
+ */
+static inline int testResult(const char *name) {
+	if (testFailures > 0u) {
+		fprintf(stderr, "%s: %" PRIu32 " checks failed\n", name, testFailures);
+		return 1;
+	}
+	printf("%s: passed\n", name);
+	return 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,295 @@
+/*
+	test_arena.c - checks arena and pool churn, bad frees and allocation speed
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+#include <nvm/nvm.h>
+#include <comm/hard_serial/hard_serial.h>
+
+#include <inherited/pico/board_pico_arena.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_ARENA 8192u // bytes in test arena
+#define TEST_PERSISTENT 1000u // bytes kept for good in test arena
+#define TEST_MODES 100000u // mode switches in arena churn
+#define TEST_BLOCK 48u // bytes in each pool block
+#define TEST_BLOCKS 64u // blocks in test pool
+#define TEST_POOL_OPS 200000u // allocs and frees in pool churn
+#define TEST_BENCH_PAIRS 1000000u // alloc and free pairs timed
+#define TEST_BENCH_RUNS 8u
+
+static uint8_t memory[TEST_ARENA] __attribute__((aligned(8)));
+static uint8_t *held[TEST_BLOCKS];
+
+static uint32_t testSeed = 0x5bd1e995u;
+
+/**
+ * Allocates mode buffers until arena is full, checking each lands after the last
+ *
+ * @return buffers allocated
+ */
+static uint32_t fillMode(struct arena *arena, const uint8_t *persistent) {
+
+	uint32_t count = 0u;
+	const uint8_t *end = arena->base + arenaMark(arena);
+
+	while (true) {
+		const uint32_t size = 1u + testRandom(&testSeed) % 700u;
+		const uint32_t align = 1u << (testRandom(&testSeed) % 7u);
+		uint8_t *buffer = (uint8_t*)arenaAlloc(arena, size, align);
+		if (buffer == NULL) {
+			return count;
+		}
+		if (((uintptr_t)buffer & (align - 1u)) != 0u || buffer < end || buffer + size > persistent) {
+			fprintf(stderr, "%u bytes aligned %u at offset %u overlaps\n", size, align, (uint32_t)(buffer - arena->base));
+			testFailures++;
+			return count;
+		}
+		end = buffer + size;
+		count++;
+	}
+}
+
+/**
+ * Switches modes over and over and checks each gets the whole free space back
+ */
+static void testArenaChurn(void) {
+
+	struct arena arena;
+
+	TEST_CHECK(!arenaBegin(&arena, NULL, TEST_ARENA));
+	TEST_CHECK(arenaBegin(&arena, memory, TEST_ARENA));
+	TEST_CHECK(arenaAlloc(&arena, 16u, 3u) == NULL);
+	TEST_EQUAL(1u, arena.failures);
+
+	const uint8_t *persistent = (const uint8_t*)arenaAllocPersistent(&arena, TEST_PERSISTENT, 64u);
+	TEST_CHECK(persistent != NULL);
+	TEST_EQUAL(0u, (uintptr_t)persistent & 63u);
+	const uint32_t freeBytes = arenaFree(&arena);
+	TEST_CHECK(freeBytes >= TEST_ARENA - TEST_PERSISTENT - 63u);
+
+	uint32_t fewest = UINT32_MAX;
+	for (uint32_t mode = 0; mode < TEST_MODES; mode++) {
+		// every few modes keep a shared part and only switch what follows
+		const bool nested = (mode & 3u) == 3u;
+		uint32_t mark = 0u;
+		if (nested) {
+			TEST_CHECK(arenaAlloc(&arena, 512u, 0u) != NULL);
+			mark = arenaMark(&arena);
+		}
+		const uint32_t count = fillMode(&arena, persistent);
+		fewest = count < fewest ? count : fewest;
+		if (nested) {
+			arenaRelease(&arena, mark);
+			TEST_EQUAL(mark, arenaMark(&arena));
+		}
+		arenaReset(&arena);
+		if (arenaFree(&arena) != freeBytes) {
+			fprintf(stderr, "mode %u left %u bytes free, had %u\n", mode, arenaFree(&arena), freeBytes);
+			testFailures++;
+			return;
+		}
+	}
+
+	TEST_CHECK(fewest > 0u);
+	TEST_CHECK(arena.highWater <= TEST_ARENA);
+	TEST_CHECK(arenaAllocPersistent(&arena, freeBytes + 1u, 0u) == NULL);
+	TEST_CHECK(arenaAlloc(&arena, freeBytes, 1u) != NULL);
+	TEST_EQUAL(0u, arenaFree(&arena));
+	TEST_EQUAL(TEST_ARENA, arena.highWater);
+}
+
+/**
+ * Fills block with pattern of its owner
+ */
+static void markBlock(uint8_t *block, uint32_t owner) {
+	memset(block, (int)(owner & 0xFFu), TEST_BLOCK);
+}
+
+/**
+ * Checks block still holds pattern of its owner
+ */
+static bool checkBlock(const uint8_t *block, uint32_t owner) {
+	for (uint32_t i = 0; i < TEST_BLOCK; i++) {
+		if (block[i] != (uint8_t)owner) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Allocates and frees at random, checking no block is handed out twice
+ */
+static void testPoolChurn(void) {
+
+	struct arena arena;
+	struct pool pool;
+	uint32_t heldCount = 0u;
+
+	arenaBegin(&arena, memory, TEST_ARENA);
+	TEST_CHECK(poolBeginArena(&pool, &arena, TEST_BLOCK, TEST_BLOCKS));
+	TEST_EQUAL(TEST_BLOCK * TEST_BLOCKS, arenaMark(&arena));
+
+	for (uint32_t op = 0; op < TEST_POOL_OPS; op++) {
+		const bool alloc = heldCount == 0u || (heldCount < TEST_BLOCKS + 2u && (testRandom(&testSeed) & 1u) != 0u);
+		if (alloc) {
+			uint8_t *block = (uint8_t*)poolAlloc(&pool);
+			if (heldCount >= TEST_BLOCKS) {
+				TEST_CHECK(block == NULL);
+				continue;
+			}
+			TEST_CHECK(block != NULL);
+			if (block == NULL) {
+				return;
+			}
+			held[heldCount] = block;
+			markBlock(block, heldCount);
+			heldCount++;
+		} else {
+			const uint32_t index = testRandom(&testSeed) % heldCount;
+			if (!checkBlock(held[index], index)) {
+				fprintf(stderr, "block %u changed while held\n", index);
+				testFailures++;
+				return;
+			}
+			TEST_CHECK(poolFree(&pool, held[index]));
+			heldCount--;
+			held[index] = held[heldCount];
+			if (index < heldCount) {
+				markBlock(held[index], index);
+			}
+		}
+		TEST_EQUAL(heldCount, pool.used);
+	}
+
+	TEST_EQUAL(TEST_BLOCKS, pool.highWater);
+	TEST_CHECK(pool.failures > 0u);
+	TEST_EQUAL(0u, pool.badFrees);
+	while (heldCount > 0u) {
+		TEST_CHECK(poolFree(&pool, held[--heldCount]));
+	}
+	TEST_EQUAL(0u, pool.used);
+}
+
+/**
+ * Checks frees of blocks pool didn't hand out are refused and leave it intact
+ */
+static void testBadFree(void) {
+
+	struct pool pool;
+	struct pool other;
+	static uint8_t otherMemory[TEST_BLOCK * 2u] __attribute__((aligned(8)));
+
+	TEST_CHECK(!poolBegin(&pool, memory + 1, TEST_BLOCK, TEST_BLOCKS));
+	TEST_CHECK(!poolBegin(&pool, memory, TEST_BLOCK, 0u));
+	TEST_CHECK(poolBegin(&pool, memory, TEST_BLOCK, 4u));
+	TEST_CHECK(poolBegin(&other, otherMemory, TEST_BLOCK, 2u));
+
+	uint8_t *first = (uint8_t*)poolAlloc(&pool);
+	uint8_t *second = (uint8_t*)poolAlloc(&pool);
+	uint8_t *foreign = (uint8_t*)poolAlloc(&other);
+
+	// not blocks of pool
+	TEST_CHECK(!poolFree(&pool, NULL));
+	TEST_CHECK(!poolFree(&pool, first + 4));
+	TEST_CHECK(!poolFree(&pool, memory + TEST_BLOCK * 4u));
+	TEST_CHECK(!poolFree(&pool, foreign));
+	TEST_CHECK(!poolFree(&pool, (void*)((uintptr_t)memory - TEST_BLOCK)));
+
+	// freed twice, or never handed out
+	TEST_CHECK(poolFree(&pool, first));
+	TEST_CHECK(!poolFree(&pool, first));
+	TEST_CHECK(!poolFree(&pool, memory + TEST_BLOCK * 3u));
+	TEST_EQUAL(7u, pool.badFrees);
+	TEST_EQUAL(1u, pool.used);
+
+	// data that happens to look like a free block is still freed
+	memcpy(second, second - TEST_BLOCK, TEST_BLOCK);
+	TEST_CHECK(poolFree(&pool, second));
+	TEST_EQUAL(7u, pool.badFrees);
+	TEST_EQUAL(0u, pool.used);
+
+	// list is intact, all four come back once
+	for (uint32_t i = 0; i < 4u; i++) {
+		held[i] = (uint8_t*)poolAlloc(&pool);
+		TEST_CHECK(held[i] != NULL);
+		for (uint32_t j = 0; j < i; j++) {
+			TEST_CHECK(held[i] != held[j]);
+		}
+	}
+	TEST_CHECK(poolAlloc(&pool) == NULL);
+	TEST_CHECK(poolFree(&other, foreign));
+}
+
+/**
+ * Checks board arena fits persistent buffers of every module built in
+ */
+static void testBoardArena(void) {
+	hardPrintBegin(115200u);
+	TEST_EQUAL(NVM_OK, nvmInit(FLASH_NVM_SIZE));
+	TEST_CHECK(arenaFree(&boardArena) >= BOARD_ARENA_USER_SIZE);
+	TEST_CHECK(arenaFree(&boardArena) < BOARD_ARENA_USER_SIZE + SERIAL_TX_BUFFER_SIZE);
+}
+
+/**
+ * Times pool against malloc for same sized blocks on host
+ */
+static void benchAlloc(void) {
+
+	struct pool pool;
+	uint64_t bestPool = UINT64_MAX;
+	uint64_t bestMalloc = UINT64_MAX;
+
+	poolBegin(&pool, memory, TEST_BLOCK, TEST_BLOCKS);
+	for (uint32_t run = 0; run < TEST_BENCH_RUNS; run++) {
+		uint64_t start = testHostNS();
+		for (uint32_t i = 0; i < TEST_BENCH_PAIRS; i++) {
+			void *volatile block = poolAlloc(&pool);
+			poolFree(&pool, block);
+		}
+		uint64_t taken = testHostNS() - start;
+		bestPool = taken < bestPool ? taken : bestPool;
+
+		start = testHostNS();
+		for (uint32_t i = 0; i < TEST_BENCH_PAIRS; i++) {
+			void *volatile block = malloc(TEST_BLOCK);
+			free(block);
+		}
+		taken = testHostNS() - start;
+		bestMalloc = taken < bestMalloc ? taken : bestMalloc;
+	}
+	TEST_EQUAL(0u, pool.used);
+	testHostMetric("pool_alloc", "ps_per_pair", bestPool * 1000u / TEST_BENCH_PAIRS);
+	testHostMetric("malloc", "ps_per_pair", bestMalloc * 1000u / TEST_BENCH_PAIRS);
+}
+
+int main(void) {
+
+	testArenaChurn();
+	testPoolChurn();
+	testBadFree();
+	testBoardArena();
+	benchAlloc();
+
+	return testResult("arena");
+}
\ No newline at end of file
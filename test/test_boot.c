@@ -0,0 +1,198 @@
+/*
+	test_boot.c - runs boot stage graph with injected latencies and checks order and boot time
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+#include <board.h>
+
+#include <pico/cyw43_arch.h>
+#include <inherited/pico/board_pico_boot.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_SLACK_US 1000u // boot overhead allowed past critical path
+
+struct testStage {
+	uint32_t latencyUS; // time stage takes
+	bool result; // returned by stage
+	int8_t core; // core stage ran on, -1 if it didn't run
+	uint8_t runs; // times stage ran
+};
+
+enum TestStages {
+	TEST_PLL,
+	TEST_RADIO,
+	TEST_LOAD,
+	TEST_SAMPLER,
+	TEST_HOST,
+	TEST_DMA,
+	TEST_FAIL,
+	TEST_AFTER_FAIL,
+	TEST_MISSING,
+	TEST_SELF,
+	TEST_STREAM,
+	TEST_STAGES,
+};
+
+static struct testStage stages[TEST_STAGES] = {
+	[TEST_PLL] = {2000u, true, -1, 0u},
+	[TEST_RADIO] = {SIM_CYW43_INIT_US, true, -1, 0u},
+	[TEST_LOAD] = {30000u, true, -1, 0u},
+	[TEST_SAMPLER] = {500u, true, -1, 0u},
+	[TEST_HOST] = {40000u, true, -1, 0u},
+	[TEST_DMA] = {200u, true, -1, 0u},
+	[TEST_FAIL] = {100u, false, -1, 0u},
+	[TEST_AFTER_FAIL] = {100u, true, -1, 0u},
+	[TEST_MISSING] = {100u, true, -1, 0u},
+	[TEST_SELF] = {100u, true, -1, 0u},
+	[TEST_STREAM] = {1000u, true, -1, 0u},
+};
+
+/**
+ * Stands in for an init stage taking its latency
+ */
+static bool runStage(void *param) {
+	struct testStage *stage = (struct testStage*)param;
+	stage->core = (int8_t)get_core_num();
+	stage->runs++;
+	busy_wait_us(stage->latencyUS);
+	return stage->result;
+}
+
+/**
+ * Adds test stage, checking it gets next number
+ */
+static void addStage(uint8_t number, const char *name, uint32_t depends, enum BootCore core) {
+	TEST_EQUAL(number, bootAddStage(name, runStage, &stages[number], depends, core));
+}
+
+/**
+ * Checks stage started only after everything it depends on ended
+ */
+static void checkOrder(uint8_t number) {
+
+	const struct bootStage *stage = bootGetStage(number);
+
+	if (stage->status != BOOT_DONE && stage->status != BOOT_FAILED) {
+		return;
+	}
+	TEST_CHECK(stage->readyUS <= stage->startUS);
+	TEST_CHECK(stage->endUS - stage->startUS >= ((struct testStage*)stage->param)->latencyUS);
+	for (uint8_t i = 0; i < BOOT_STAGES_MAX; i++) {
+		if ((stage->depends & BOOT_DEPENDS(i)) != 0u) {
+			const struct bootStage *depend = bootGetStage(i);
+			TEST_EQUAL(BOOT_DONE, depend->status);
+			TEST_CHECK(depend->endUS <= stage->readyUS);
+		}
+	}
+}
+
+/**
+ * Runs graph and checks order, failures and time against running it serially
+ */
+static void testGraph(void) {
+
+	struct bootSummary summary;
+
+	TEST_EQUAL(BOOT_STAGE_INVALID, bootAddStage("none", NULL, NULL, 0u, BOOT_CORE0));
+	addStage(TEST_PLL, "pll", 0u, BOOT_CORE0);
+	addStage(TEST_RADIO, "radio", BOOT_DEPENDS(TEST_PLL), BOOT_CORE1);
+	addStage(TEST_LOAD, "load", 0u, BOOT_CORE0);
+	addStage(TEST_SAMPLER, "sampler", BOOT_DEPENDS(TEST_PLL), BOOT_CORE0);
+	addStage(TEST_HOST, "host", 0u, BOOT_CORE0);
+	addStage(TEST_DMA, "dma", BOOT_DEPENDS(TEST_SAMPLER), BOOT_CORE0);
+	addStage(TEST_FAIL, "fail", 0u, BOOT_CORE0);
+	addStage(TEST_AFTER_FAIL, "after_fail", BOOT_DEPENDS(TEST_FAIL), BOOT_CORE1);
+	addStage(TEST_MISSING, "missing", BOOT_DEPENDS(BOOT_STAGES_MAX - 1u), BOOT_CORE0);
+	addStage(TEST_SELF, "self", BOOT_DEPENDS(TEST_SELF), BOOT_CORE0);
+	addStage(TEST_STREAM, "stream", BOOT_DEPENDS(TEST_RADIO) | BOOT_DEPENDS(TEST_LOAD), BOOT_CORE0);
+	TEST_EQUAL(TEST_HOST, bootFindStage("host"));
+	TEST_EQUAL(BOOT_STAGE_INVALID, bootFindStage("nothing"));
+	TEST_CHECK(bootGetStage(TEST_STAGES) == NULL);
+
+	// failures and stages that can't run don't hang boot
+	TEST_CHECK(!bootRun());
+
+	for (uint8_t i = 0; i < TEST_STAGES; i++) {
+		checkOrder(i);
+	}
+	TEST_EQUAL(BOOT_FAILED, bootGetStage(TEST_FAIL)->status);
+	TEST_EQUAL(BOOT_SKIPPED, bootGetStage(TEST_AFTER_FAIL)->status);
+	TEST_EQUAL(BOOT_SKIPPED, bootGetStage(TEST_MISSING)->status);
+	TEST_EQUAL(BOOT_SKIPPED, bootGetStage(TEST_SELF)->status);
+	TEST_EQUAL(BOOT_DONE, bootGetStage(TEST_STREAM)->status);
+	for (uint8_t i = 0; i < TEST_STAGES; i++) {
+		const bool skipped = bootGetStage(i)->status == BOOT_SKIPPED;
+		TEST_EQUAL(skipped ? 0u : 1u, stages[i].runs);
+		TEST_EQUAL(skipped ? -1 : (i == TEST_RADIO ? 1 : 0), stages[i].core);
+	}
+
+	// core 0 stages run while core 1 loads radio, so radio path sets boot time
+	bootGetSummary(&summary);
+	const uint32_t critical = stages[TEST_PLL].latencyUS + stages[TEST_RADIO].latencyUS + stages[TEST_STREAM].latencyUS;
+	const uint32_t span = summary.endUS - summary.startUS;
+	TEST_EQUAL(TEST_STAGES, summary.stages);
+	TEST_EQUAL(4u, summary.failed);
+	TEST_CHECK(span >= critical);
+	TEST_CHECK(span <= critical + TEST_SLACK_US);
+	TEST_CHECK(summary.serialUS >= critical + stages[TEST_LOAD].latencyUS + stages[TEST_HOST].latencyUS);
+	TEST_EQUAL(0u, summary.readyUS);
+	testMetric("boot_graph", "span_us", span);
+	testMetric("boot_graph", "serial_us", summary.serialUS);
+
+	// first call sticks
+	bootMarkReady();
+	bootGetSummary(&summary);
+	const uint32_t ready = summary.readyUS;
+	TEST_CHECK(ready >= summary.endUS);
+	simRunUS(100u);
+	bootMarkReady();
+	bootGetSummary(&summary);
+	TEST_EQUAL(ready, summary.readyUS);
+}
+
+/**
+ * Runs board stages after graph, wireless driver is started on core 1
+ */
+static void testBoard(void) {
+
+	TEST_CHECK(!cyw43_is_initialized(&cyw43_state));
+
+	// earlier skipped stages keep result false
+	TEST_CHECK(!initBoard());
+	const uint8_t clock = bootFindStage("clock");
+	const uint8_t wireless = bootFindStage("wireless");
+	TEST_CHECK(clock != BOOT_STAGE_INVALID);
+	TEST_CHECK(wireless != BOOT_STAGE_INVALID);
+	for (uint8_t i = TEST_STAGES; i < BOOT_STAGES_MAX; i++) {
+		TEST_EQUAL(BOOT_DONE, bootGetStage(i)->status);
+	}
+	TEST_CHECK(bootGetStage(clock)->endUS <= bootGetStage(wireless)->startUS);
+
+	// driver interrupts are bound to core 1
+	TEST_CHECK(cyw43_is_initialized(&cyw43_state));
+	TEST_EQUAL(1u, cyw43_state.core);
+}
+
+int main(void) {
+
+	testGraph();
+	testBoard();
+
+	return testResult("boot");
+}
\ No newline at end of file
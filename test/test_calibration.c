@@ -0,0 +1,307 @@
+/*
+	test_calibration.c - checks ADC calibration against a miscalibrated ADC model
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+#include <nvm/nvm.h>
+
+#include <inherited/pico/board_pico_calibration.h>
+#include <inherited/pico/board_pico_nvm.h>
+
+#include <math.h>
+#include <string.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_RAMP_STEPS 16u // ramp steps per LSB for code density
+#define TEST_REFERENCE_SAMPLES 1024u // samples of each gain reference
+#define TEST_LOW_REFERENCE 400u
+#define TEST_HIGH_REFERENCE 3700u
+#define TEST_BENCH_SAMPLES 65536u
+#define TEST_BENCH_RUNS 32u
+
+struct adcModel {
+	double offset; // LSB added to input
+	double gain; // input scale
+	double bow; // peak of smooth INL in LSB
+	uint32_t step; // codes each RP2040 segment edge skips
+};
+
+struct testError {
+	double rms; // RMS error in LSB
+	double max; // largest error in LSB
+};
+
+static uint32_t testSeed = 0xbb67ae85u;
+
+/**
+ * Converts input to code through miscalibrated ADC
+ *
+ * @param model ADC errors
+ * @param input input in ideal LSB
+ *
+ * @return ADC code
+ */
+static sample_t modelConvert(const struct adcModel *model, double input) {
+
+	double value = input * model->gain + model->offset;
+	value += model->bow * sin(M_PI * input / SAMPLE_MAX);
+	value = floor(value + 0.5);
+	// codes from 512, 1536, 2560 and 3584 are skipped like RP2040 capacitor array
+	for (uint32_t edge = 512u; edge < SAMPLE_MAX; edge += 1024u) {
+		if (value >= edge) {
+			value += model->step;
+		}
+	}
+	if (value < 0.0) {
+		return 0u;
+	}
+	return value > SAMPLE_MAX ? SAMPLE_MAX : (sample_t)value;
+}
+
+/**
+ * Runs whole calibration against model on a channel
+ */
+static void calibrateModel(struct adcCalibration *cal, uint8_t channel, const struct adcModel *model) {
+
+	static uint16_t histogram[SAMPLE_MAX + 1u];
+	sample_t low[TEST_REFERENCE_SAMPLES];
+	sample_t high[TEST_REFERENCE_SAMPLES];
+
+	// slow ramp far enough past both ends that every code is hit
+	memset(histogram, 0, sizeof(histogram));
+	for (uint32_t i = 0; i < (SAMPLE_MAX + 256u) * TEST_RAMP_STEPS; i++) {
+		histogram[modelConvert(model, (double)i / TEST_RAMP_STEPS - 128.0)]++;
+	}
+	TEST_EQUAL(CALIBRATION_OK, calibrationMeasureINL(cal, channel, histogram));
+
+	// references with a little noise
+	for (uint32_t i = 0; i < TEST_REFERENCE_SAMPLES; i++) {
+		double noise = (double)(testRandom(&testSeed) % 201u) / 100.0 - 1.0;
+		low[i] = modelConvert(model, TEST_LOW_REFERENCE + noise);
+		high[i] = modelConvert(model, TEST_HIGH_REFERENCE + noise);
+	}
+	TEST_EQUAL(CALIBRATION_OK, calibrationMeasureGain(cal, channel, low, TEST_REFERENCE_SAMPLES, TEST_LOW_REFERENCE,
+		high, TEST_REFERENCE_SAMPLES, TEST_HIGH_REFERENCE));
+}
+
+/**
+ * Measures error of every code in useful range with and without correction
+ */
+static void measureError(const struct adcCalibration *cal, uint8_t channel, const struct adcModel *model, struct testError *raw, struct testError *corrected) {
+
+	double rawSquares = 0.0;
+	double squares = 0.0;
+	uint32_t count = 0u;
+
+	memset(raw, 0, sizeof(*raw));
+	memset(corrected, 0, sizeof(*corrected));
+	for (uint32_t i = 64u * 4u; i < (SAMPLE_MAX - 64u) * 4u; i++) {
+		double input = i / 4.0;
+		sample_t code = modelConvert(model, input);
+		sample_t fixed = code;
+		calibrationApply(cal, channel, &fixed, 1u);
+
+		double rawError = fabs(code - input);
+		double error = fabs(fixed - input);
+		raw->max = fmax(raw->max, rawError);
+		corrected->max = fmax(corrected->max, error);
+		rawSquares += rawError * rawError;
+		squares += error * error;
+		count++;
+	}
+	raw->rms = sqrt(rawSquares / count);
+	corrected->rms = sqrt(squares / count);
+}
+
+static void testModels(void) {
+
+	static const struct adcModel models[] = {
+		{0.0, 1.0, 0.0, 0u}, // ideal
+		{12.0, 1.0, 0.0, 0u}, // offset only
+		{-7.5, 1.0, 0.0, 0u},
+		{0.0, 1.015, 0.0, 0u}, // gain only
+		{0.0, 0.985, 0.0, 0u},
+		{5.0, 1.01, 3.0, 0u}, // bowed
+		{-4.0, 0.99, 0.0, 2u}, // segment steps
+		{8.0, 1.012, -2.5, 1u}, // everything
+	};
+	struct adcCalibration cal;
+	struct testError raw;
+	struct testError corrected;
+	double worst = 0.0;
+
+	for (uint32_t m = 0; m < sizeof(models) / sizeof(models[0]); m++) {
+		const uint8_t channel = (uint8_t)(m % CALIBRATION_CHANNELS);
+		calibrationDefaults(&cal);
+		calibrateModel(&cal, channel, &models[m]);
+		measureError(&cal, channel, &models[m], &raw, &corrected);
+
+		// quantization alone is 0.5 LSB, segment average leaves a little INL
+		// and a half LSB offset rounds twice
+		TEST_CHECK(corrected.max <= 1.5);
+		TEST_CHECK(corrected.rms <= 0.7);
+		if (raw.max > 1.5) {
+			TEST_CHECK(corrected.rms < raw.rms / 2.0);
+		}
+		worst = fmax(worst, corrected.max);
+
+		// other channels are left alone
+		const uint8_t other = (uint8_t)((channel + 1u) % CALIBRATION_CHANNELS);
+		TEST_EQUAL(CALIBRATION_GAIN_ONE, cal.channels[other].gain);
+	}
+	testMetric("calibration", "worst_error_quarter_lsb", (uint64_t)lround(worst * 4.0));
+}
+
+static void testDefaults(void) {
+
+	struct adcCalibration cal;
+	sample_t samples[SAMPLE_MAX + 1u];
+
+	calibrationDefaults(&cal);
+	for (uint32_t i = 0; i <= SAMPLE_MAX; i++) {
+		samples[i] = (sample_t)i;
+	}
+	calibrationApply(&cal, 0u, samples, SAMPLE_MAX + 1u);
+	for (uint32_t i = 0; i <= SAMPLE_MAX; i++) {
+		if (samples[i] != i) {
+			TEST_EQUAL(i, samples[i]);
+			break;
+		}
+	}
+
+	// bad channel leaves samples alone
+	samples[0] = 123u;
+	cal.channels[0].offset = 100 << 16;
+	calibrationApply(&cal, CALIBRATION_CHANNELS, samples, 1u);
+	TEST_EQUAL(123u, samples[0]);
+
+	// clamps to range
+	samples[0] = SAMPLE_MAX;
+	calibrationApply(&cal, 0u, samples, 1u);
+	TEST_EQUAL(SAMPLE_MAX, samples[0]);
+}
+
+static void testBadInput(void) {
+
+	struct adcCalibration cal;
+	uint16_t histogram[SAMPLE_MAX + 1u];
+	sample_t low[4] = {1000u, 1000u, 1000u, 1000u};
+	sample_t high[4] = {1000u, 1000u, 1000u, 1000u};
+	sample_t close[4] = {1001u, 1001u, 1001u, 1001u};
+
+	calibrationDefaults(&cal);
+	memset(histogram, 0, sizeof(histogram));
+	TEST_EQUAL(CALIBRATION_NO_SAMPLES, calibrationMeasureINL(&cal, 0u, histogram));
+	TEST_EQUAL(CALIBRATION_NO_SAMPLES, calibrationMeasureINL(&cal, 0u, NULL));
+	TEST_EQUAL(CALIBRATION_BAD_CHANNEL, calibrationMeasureINL(&cal, CALIBRATION_CHANNELS, histogram));
+
+	TEST_EQUAL(CALIBRATION_NO_SAMPLES, calibrationMeasureGain(&cal, 0u, low, 0u, 100u, high, 4u, 3000u));
+	TEST_EQUAL(CALIBRATION_BAD_CHANNEL, calibrationMeasureGain(&cal, CALIBRATION_CHANNELS, low, 4u, 100u, high, 4u, 3000u));
+	// stuck input
+	TEST_EQUAL(CALIBRATION_BAD_POINTS, calibrationMeasureGain(&cal, 0u, low, 4u, 100u, high, 4u, 3000u));
+	// needs gain past Q14 range
+	TEST_EQUAL(CALIBRATION_BAD_POINTS, calibrationMeasureGain(&cal, 0u, low, 4u, 100u, close, 4u, 3000u));
+	// references swapped
+	TEST_EQUAL(CALIBRATION_BAD_POINTS, calibrationMeasureGain(&cal, 0u, close, 4u, 3000u, low, 4u, 100u));
+	TEST_EQUAL(CALIBRATION_GAIN_ONE, cal.channels[0].gain);
+}
+
+static void testStorage(void) {
+
+	struct adcCalibration cal;
+	struct adcCalibration loaded;
+	struct simFlashStats flash;
+	nvm_size_t size = 0u;
+	uint8_t byte;
+
+	// commit before start has no sector to write
+	nvmCommit();
+	simFlashGetStats(&flash);
+	TEST_EQUAL(0u, flash.erases);
+
+	calibrationDefaults(&cal);
+	cal.channels[1].gain = 17000u;
+	cal.channels[1].inl[3] = -5;
+	TEST_EQUAL(CALIBRATION_NVM_FAIL, calibrationSave(&cal));
+
+	// erased flash has no calibration, read before start
+	memset(&loaded, 0xA5, sizeof(loaded));
+	TEST_EQUAL(CALIBRATION_NVM_EMPTY, calibrationLoad(&loaded));
+	TEST_EQUAL(CALIBRATION_GAIN_ONE, loaded.channels[1].gain);
+
+	// user keys get sector less reserved board data
+	TEST_CHECK(!nvmMaxSize(&size));
+	TEST_EQUAL(NVM_INVALID_SIZE, nvmInit(3841u));
+	TEST_EQUAL(NVM_OK, nvmInit(FLASH_NVM_SIZE));
+	TEST_CHECK(nvmMaxSize(&size));
+	TEST_EQUAL(3840u, size);
+
+	TEST_EQUAL(CALIBRATION_OK, calibrationSave(&cal));
+	TEST_EQUAL(CALIBRATION_OK, calibrationLoad(&loaded));
+	TEST_CHECK(memcmp(&cal, &loaded, sizeof(cal)) == 0);
+
+	// stored copy survives in flash
+	TEST_CHECK(nvmGetReserved(NVM_RESERVED_CALIBRATION + 8u, &byte, 1u));
+	TEST_EQUAL(((const uint8_t*)&cal)[0], byte);
+	simFlashGetStats(&flash);
+	TEST_EQUAL(1u, flash.erases);
+	TEST_EQUAL(0u, flash.unsafe);
+
+	// corrupted byte fails checksum
+	byte ^= 0x40u;
+	TEST_CHECK(nvmWriteReserved(NVM_RESERVED_CALIBRATION + 8u, &byte, 1u));
+	TEST_EQUAL(CALIBRATION_NVM_EMPTY, calibrationLoad(&loaded));
+	TEST_EQUAL(CALIBRATION_GAIN_ONE, loaded.channels[1].gain);
+	TEST_CHECK(!nvmWriteReserved(NVM_RESERVED_SIZE - 1u, &byte, 2u));
+}
+
+/**
+ * Times correction pass over a DMA sized buffer
+ */
+static void benchApply(void) {
+
+	static sample_t samples[TEST_BENCH_SAMPLES];
+	struct adcCalibration cal;
+	const struct adcModel model = {8.0, 1.012, -2.5, 1u};
+	uint64_t best = UINT64_MAX;
+
+	calibrationDefaults(&cal);
+	calibrateModel(&cal, 0u, &model);
+	for (uint32_t run = 0; run < TEST_BENCH_RUNS; run++) {
+		for (uint32_t i = 0; i < TEST_BENCH_SAMPLES; i++) {
+			samples[i] = (sample_t)(i & SAMPLE_MAX);
+		}
+		uint64_t start = testHostNS();
+		calibrationApply(&cal, 0u, samples, TEST_BENCH_SAMPLES);
+		uint64_t taken = testHostNS() - start;
+		best = taken < best ? taken : best;
+	}
+	testHostMetric("calibration", "ps_per_sample", best * 1000u / TEST_BENCH_SAMPLES);
+}
+
+int main(void) {
+
+	testDefaults();
+	testBadInput();
+	testModels();
+	testStorage();
+	benchApply();
+
+	return testResult("calibration");
+}
\ No newline at end of file
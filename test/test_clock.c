@@ -0,0 +1,253 @@
+/*
+	test_clock.c - checks clock profiles and divider maths at each supported clock
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+
+#include <hardware/adc.h>
+#include <hardware/clocks.h>
+#include <inherited/pico/board_pico_clock.h>
+#include <pico1w/board_pico1w_wifi.h>
+#include <pico/cyw43_arch.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_PIO_HZ 1000000u // state machine clock kept across changes
+#define TEST_ADC_RATE 100000u // sample rate kept across changes
+
+// tests raise CLOCK_SYS_MAX_KHZ to 250 MHz
+static const uint32_t clocksKHz[] = {48000u, 100000u, 120000u, 125000u, 133000u, 200000u, 250000u};
+static const uint32_t tooFastKHz[] = {250001u, 252000u, 276000u, 300000u};
+static uint32_t listenerCalls = 0u;
+
+static void countListener(void) {
+	listenerCalls++;
+}
+
+/**
+ * Gets error of a rate in parts per million
+ */
+static uint32_t errorPPM(uint64_t actual, uint64_t wanted) {
+	uint64_t error = actual > wanted ? actual - wanted : wanted - actual;
+	return (uint32_t)(error * 1000000u / wanted);
+}
+
+/**
+ * Checks ADC divider gives back the rate asked for
+ *
+ * @return worst error in ppm
+ */
+static uint32_t testADCDivider(uint32_t adcHz) {
+
+	uint32_t worst = 0u;
+	const uint32_t fastest = (adcHz + CLOCK_ADC_MIN_CYCLES / 2u) / CLOCK_ADC_MIN_CYCLES;
+
+	TEST_EQUAL(0u, clockADCDivider(adcHz, 0u));
+	TEST_EQUAL(fastest, clockADCRate(adcHz, 0u));
+	TEST_EQUAL(0u, clockADCDivider(adcHz, fastest * 2u));
+	TEST_CHECK(clockADCRate(adcHz, clockADCDivider(adcHz, fastest + 1u)) <= fastest);
+
+	for (uint32_t rate = 1000u; rate <= fastest; rate += 997u) {
+		uint32_t divider = clockADCDivider(adcHz, rate);
+		uint32_t actual = clockADCRate(adcHz, divider);
+		TEST_CHECK(divider == 0u || divider >= (CLOCK_ADC_MIN_CYCLES - 1u) << CLOCK_DIV_FRAC_BITS);
+		uint32_t error = errorPPM(actual, rate);
+		worst = error > worst ? error : worst;
+	}
+
+	// slowest rate the 16.8 divider reaches
+	TEST_EQUAL(CLOCK_PIO_DIV_MAX, clockADCDivider(adcHz, 1u));
+	return worst;
+}
+
+/**
+ * Checks PIO divider gives back the clock asked for
+ *
+ * @return worst error in ppm
+ */
+static uint32_t testPIODivider(uint32_t sysHz) {
+
+	uint32_t worst = 0u;
+
+	TEST_EQUAL(1u << CLOCK_DIV_FRAC_BITS, clockPIODivider(sysHz, 0u));
+	TEST_EQUAL(1u << CLOCK_DIV_FRAC_BITS, clockPIODivider(sysHz, sysHz));
+	TEST_EQUAL(CLOCK_PIO_DIV_MAX, clockPIODivider(sysHz, 1u));
+
+	for (uint32_t hz = sysHz / 65536u + 1u; hz < sysHz; hz += hz / 7u + 1u) {
+		uint32_t divider = clockPIODivider(sysHz, hz);
+		// compared as sysHz / divider against hz, both scaled by divider
+		uint32_t error = errorPPM((uint64_t)sysHz << CLOCK_DIV_FRAC_BITS, (uint64_t)hz * divider);
+		// half a fraction step of divider at most
+		TEST_CHECK((uint64_t)error * divider * 2u <= 1000000u);
+		worst = error > worst ? error : worst;
+	}
+	return worst;
+}
+
+/**
+ * Checks clk_adc from system PLL stays at or under its limit with smallest divider
+ */
+static void testADCSource(uint32_t sysHz) {
+	uint32_t divider = clockADCSourceDivider(sysHz);
+	TEST_CHECK(sysHz / divider <= CLOCK_ADC_MAX_KHZ * 1000u);
+	TEST_CHECK(divider == 1u || sysHz / (divider - 1u) > CLOCK_ADC_MAX_KHZ * 1000u);
+}
+
+/**
+ * Checks core voltage and flash divider steps
+ */
+static void testOverclockSteps(void) {
+
+	TEST_EQUAL(VREG_VOLTAGE_DEFAULT, clockVoltage(CLOCK_SYS_MIN_KHZ));
+	TEST_EQUAL(VREG_VOLTAGE_DEFAULT, clockVoltage(CLOCK_SYS_RATED_KHZ));
+	TEST_EQUAL(VREG_VOLTAGE_1_15, clockVoltage(CLOCK_SYS_RATED_KHZ + 1u));
+	TEST_EQUAL(VREG_VOLTAGE_1_20, clockVoltage(250000u));
+	TEST_EQUAL(VREG_VOLTAGE_1_30, clockVoltage(CLOCK_SYS_LIMIT_KHZ + 1u));
+
+	TEST_EQUAL(CLOCK_FLASH_DIV_DEFAULT, clockFlashDivider(CLOCK_SYS_MIN_KHZ * 1000u));
+	TEST_EQUAL(CLOCK_FLASH_DIV_DEFAULT, clockFlashDivider(CLOCK_SYS_RATED_KHZ * 1000u));
+	TEST_EQUAL(4u, clockFlashDivider(200000000u));
+	TEST_EQUAL(4u, clockFlashDivider(250000000u));
+	for (uint32_t khz = CLOCK_SYS_MIN_KHZ; khz <= CLOCK_SYS_LIMIT_KHZ; khz += 1000u) {
+		const uint32_t divider = clockFlashDivider(khz * 1000u);
+		TEST_EQUAL(0u, divider & 1u);
+		TEST_CHECK(khz / divider <= CLOCK_FLASH_MAX_KHZ);
+		TEST_CHECK(divider == CLOCK_FLASH_DIV_DEFAULT || khz / (divider - 2u) > CLOCK_FLASH_MAX_KHZ);
+	}
+}
+
+/**
+ * Checks core voltage and flash clock were ready for clk_sys while PLL changed
+ */
+static void checkPLLChange(uint32_t fromKHz, uint32_t toKHz) {
+
+	struct simPLLChange change;
+
+	simLastPLLChange(&change);
+	TEST_EQUAL(toKHz * 1000u, change.sysHz);
+	// raised before a faster clock, lowered after a slower one
+	const uint32_t fastest = fromKHz > toKHz ? fromKHz : toKHz;
+	TEST_EQUAL(clockVoltage(fastest), change.voltage);
+	TEST_EQUAL(clockVoltage(toKHz), simVoltageGet());
+	TEST_CHECK(change.flashHz <= CLOCK_FLASH_MAX_KHZ * 1000u);
+
+	// gSPI state machine stays under what SDK runs it at
+	const uint32_t wireless = simPIODivider(SIM_CYW43_PIO, SIM_CYW43_SM);
+	TEST_CHECK(((uint64_t)toKHz << CLOCK_DIV_FRAC_BITS) / wireless <= WIFI_SPI_MAX_KHZ);
+	TEST_CHECK(wireless >= WIFI_SPI_DIV_DEFAULT << CLOCK_DIV_FRAC_BITS);
+}
+
+/**
+ * Changes clocks and checks kept rates follow
+ */
+static void testApply(void) {
+
+	struct clockProfile profile;
+	char scenario[32];
+
+	TEST_CHECK(clockAddListener(countListener));
+	TEST_CHECK(clockAddListener(countListener));
+	TEST_CHECK(!clockAddListener(NULL));
+	TEST_CHECK(clockSetPIORate(0u, 1u, TEST_PIO_HZ));
+	TEST_CHECK(!clockSetPIORate(2u, 0u, TEST_PIO_HZ));
+	TEST_CHECK(!clockSetPIORate(0u, 4u, TEST_PIO_HZ));
+	adc_init();
+	clockSetADCRate(TEST_ADC_RATE);
+	TEST_EQUAL(0, cyw43_arch_init());
+	TEST_CHECK(clockAddListener(wifiClockChanged));
+
+	uint32_t fromKHz = clock_get_hz(clk_sys) / 1000u;
+	for (uint32_t i = 0; i < sizeof(clocksKHz) / sizeof(clocksKHz[0]); i++) {
+		for (uint8_t adcSource = CLOCK_SOURCE_SYS; adcSource <= CLOCK_SOURCE_USB; adcSource++) {
+			const uint32_t calls = listenerCalls;
+			clockDefaults(&profile);
+			profile.sysKHz = clocksKHz[i];
+			profile.adcSource = adcSource;
+			profile.periSource = adcSource;
+			TEST_EQUAL(CLOCK_OK, clockApply(&profile));
+			TEST_EQUAL(calls + 1u, listenerCalls);
+			checkPLLChange(fromKHz, clocksKHz[i]);
+			fromKHz = clocksKHz[i];
+
+			const uint32_t sysHz = clocksKHz[i] * 1000u;
+			TEST_EQUAL(sysHz, clock_get_hz(clk_sys));
+			TEST_EQUAL(adcSource == CLOCK_SOURCE_USB ? CLOCK_USB_KHZ * 1000u : sysHz, clock_get_hz(clk_peri));
+			TEST_CHECK(clock_get_hz(clk_adc) <= CLOCK_ADC_MAX_KHZ * 1000u);
+			TEST_EQUAL(clockPIODivider(sysHz, TEST_PIO_HZ), simPIODivider(0u, 1u));
+
+			// ADC keeps its rate whichever clock it runs from
+			uint32_t rate = clockADCRate(clock_get_hz(clk_adc), adc_hw->div);
+			TEST_CHECK(errorPPM(rate, TEST_ADC_RATE) < 500u);
+
+			if (adcSource == CLOCK_SOURCE_SYS) {
+				snprintf(scenario, sizeof(scenario), "clock_%umhz", clocksKHz[i] / 1000u);
+				testMetric(scenario, "adc_rate_error_ppm", errorPPM(rate, TEST_ADC_RATE));
+			}
+		}
+	}
+
+	// faster than CLOCK_SYS_MAX_KHZ is refused and nothing changes
+	for (uint32_t i = 0; i < sizeof(tooFastKHz) / sizeof(tooFastKHz[0]); i++) {
+		const uint32_t calls = listenerCalls;
+		const uint32_t sysHz = clock_get_hz(clk_sys);
+		clockDefaults(&profile);
+		profile.sysKHz = tooFastKHz[i];
+		TEST_EQUAL(CLOCK_BAD_FREQ, clockApply(&profile));
+		TEST_EQUAL(sysHz, clock_get_hz(clk_sys));
+		TEST_EQUAL(calls, listenerCalls);
+	}
+	clockDefaults(&profile);
+	profile.sysKHz = CLOCK_SYS_MIN_KHZ - 1000u;
+	TEST_EQUAL(CLOCK_BAD_FREQ, clockApply(&profile));
+
+	clockGetProfile(&profile);
+	TEST_EQUAL(clocksKHz[sizeof(clocksKHz) / sizeof(clocksKHz[0]) - 1u], profile.sysKHz);
+
+	// straight back down from fastest, voltage and flash follow after PLL
+	clockDefaults(&profile);
+	profile.sysKHz = CLOCK_SYS_MIN_KHZ;
+	TEST_EQUAL(CLOCK_OK, clockApply(&profile));
+	checkPLLChange(fromKHz, CLOCK_SYS_MIN_KHZ);
+	TEST_EQUAL(VREG_VOLTAGE_DEFAULT, simVoltageGet());
+}
+
+int main(void) {
+
+	uint32_t adcWorst = 0u;
+	uint32_t pioWorst = 0u;
+
+	for (uint32_t i = 0; i < sizeof(clocksKHz) / sizeof(clocksKHz[0]); i++) {
+		const uint32_t sysHz = clocksKHz[i] * 1000u;
+		const uint32_t adcHz = sysHz / clockADCSourceDivider(sysHz);
+		uint32_t error = testADCDivider(adcHz);
+		adcWorst = error > adcWorst ? error : adcWorst;
+		error = testPIODivider(sysHz);
+		pioWorst = error > pioWorst ? error : pioWorst;
+		testADCSource(sysHz);
+	}
+	testADCSource(CLOCK_USB_KHZ * 1000u);
+	const uint32_t usbError = testADCDivider(CLOCK_USB_KHZ * 1000u);
+	adcWorst = usbError > adcWorst ? usbError : adcWorst;
+	testMetric("clock_dividers", "adc_worst_error_ppm", adcWorst);
+	testMetric("clock_dividers", "pio_worst_error_ppm", pioWorst);
+
+	testOverclockSteps();
+	testApply();
+
+	return testResult("clock");
+}
\ No newline at end of file
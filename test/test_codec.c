@@ -0,0 +1,216 @@
+/*
+	test_codec.c - checks capture codec round trip and ratio, times encoder
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <inherited/pico/board_pico_codec.h>
+
+#include <math.h>
+#include <string.h>
+
+#include "test.h"
+
+#define TEST_SAMPLES 65536u // samples in each test signal
+#define TEST_BLOCK 4096u // samples in each capture buffer
+#define TEST_RATE 500000u // sample rate in Hz
+#define TEST_STREAM_MAX (TEST_SAMPLES * 3u + TEST_SAMPLES / TEST_BLOCK * CODEC_HEADER_BYTES) // fits any format
+#define TEST_BENCH_RUNS 16u
+
+enum TestSignal {
+	TEST_SINE,
+	TEST_SQUARE,
+	TEST_NOISE,
+};
+
+static const char *signalNames[] = {"sine", "square", "noise"};
+static const char *formatNames[] = {"varint", "rice"};
+
+static uint32_t testSeed = 0xa54ff53au;
+
+static sample_t samples[TEST_SAMPLES];
+static sample_t decoded[TEST_SAMPLES];
+static uint8_t stream[TEST_STREAM_MAX];
+
+static sample_t clampSample(double value) {
+	if (value < 0.0) {
+		return 0u;
+	}
+	if (value > SAMPLE_MAX) {
+		return SAMPLE_MAX;
+	}
+	return (sample_t)lround(value);
+}
+
+/**
+ * Fills samples with test signal
+ */
+static void makeSignal(enum TestSignal signal) {
+	for (uint32_t i = 0; i < TEST_SAMPLES; i++) {
+		double noise = (double)(testRandom(&testSeed) % 5u) - 2.0;
+		switch (signal) {
+			case TEST_SINE:
+				samples[i] = clampSample(2048.0 + 1500.0 * sin(2.0 * M_PI * 1000.0 * i / TEST_RATE) + noise);
+				break;
+			case TEST_SQUARE:
+				samples[i] = clampSample(((i / 125u) & 1u ? 3500.0 : 500.0) + noise);
+				break;
+			default:
+				samples[i] = (sample_t)(testRandom(&testSeed) & SAMPLE_MAX);
+				break;
+		}
+	}
+}
+
+/**
+ * Encodes signal one capture buffer a block, decodes stream back
+ *
+ * @return bytes of whole stream
+ */
+static uint32_t checkRoundTrip(enum CodecFormat format, const char *name) {
+
+	uint32_t bytes = 0u;
+	uint32_t index = 0u;
+
+	for (uint32_t i = 0; i < TEST_SAMPLES; i += TEST_BLOCK) {
+		uint32_t size = codecEncode(format, samples + i, TEST_BLOCK, stream + bytes, sizeof(stream) - bytes);
+		TEST_CHECK(size > 0u);
+		TEST_CHECK(size <= codecMaxBytes(format, TEST_BLOCK));
+		bytes += size;
+	}
+
+	// blocks follow each other, consumed finds next one
+	memset(decoded, 0, sizeof(decoded));
+	for (uint32_t offset = 0u; offset < bytes && index < TEST_SAMPLES;) {
+		uint32_t consumed = 0u;
+		uint32_t count = codecDecode(stream + offset, bytes - offset, decoded + index, TEST_SAMPLES - index, &consumed);
+		TEST_EQUAL(TEST_BLOCK, count);
+		if (count == 0u) {
+			break;
+		}
+		offset += consumed;
+		index += count;
+	}
+	TEST_EQUAL(TEST_SAMPLES, index);
+	if (memcmp(samples, decoded, sizeof(samples)) != 0) {
+		fprintf(stderr, "%s %s doesn't round trip\n", formatNames[format], name);
+		testFailures++;
+	}
+	return bytes;
+}
+
+static void testSignals(void) {
+
+	char scenario[32];
+	uint32_t bytes[2][3];
+
+	for (uint32_t signal = TEST_SINE; signal <= TEST_NOISE; signal++) {
+		makeSignal((enum TestSignal)signal);
+		for (uint32_t format = CODEC_VARINT; format <= CODEC_RICE; format++) {
+			bytes[format][signal] = checkRoundTrip((enum CodecFormat)format, signalNames[signal]);
+			snprintf(scenario, sizeof(scenario), "codec_%s_%s", formatNames[format], signalNames[signal]);
+			testMetric(scenario, "milli_bits_per_sample", bytes[format][signal] * 8000ull / TEST_SAMPLES);
+		}
+	}
+
+	// packed 12 bit samples take 12 bits, link has to beat that,
+	// 2 LSB of noise alone costs rice about 5 bits
+	TEST_CHECK(bytes[CODEC_VARINT][TEST_SINE] * 8u < TEST_SAMPLES * 9u);
+	TEST_CHECK(bytes[CODEC_VARINT][TEST_SQUARE] * 8u < TEST_SAMPLES * 9u);
+	TEST_CHECK(bytes[CODEC_RICE][TEST_SINE] * 8u < TEST_SAMPLES * 7u);
+	TEST_CHECK(bytes[CODEC_RICE][TEST_SQUARE] * 8u < TEST_SAMPLES * 7u);
+	TEST_CHECK(bytes[CODEC_RICE][TEST_SINE] < bytes[CODEC_VARINT][TEST_SINE]);
+	// noise can't compress, escapes keep it near raw
+	TEST_CHECK(bytes[CODEC_RICE][TEST_NOISE] * 8u < TEST_SAMPLES * 15u);
+}
+
+static void testEdges(void) {
+
+	const sample_t one = 0xABCu;
+	const sample_t full[4] = {0u, SAMPLE_MAX, 0u, SAMPLE_MAX};
+	sample_t out[4];
+	uint8_t block[32];
+	uint32_t consumed = 0u;
+
+	for (uint32_t format = CODEC_VARINT; format <= CODEC_RICE; format++) {
+
+		// single sample is header only
+		TEST_EQUAL(CODEC_HEADER_BYTES, codecEncode((enum CodecFormat)format, &one, 1u, block, sizeof(block)));
+		TEST_EQUAL(1u, codecDecode(block, CODEC_HEADER_BYTES, out, 4u, &consumed));
+		TEST_EQUAL(one, out[0]);
+		TEST_EQUAL(CODEC_HEADER_BYTES, consumed);
+
+		// largest deltas both ways
+		uint32_t size = codecEncode((enum CodecFormat)format, full, 4u, block, sizeof(block));
+		TEST_CHECK(size > 0u && size <= codecMaxBytes((enum CodecFormat)format, 4u));
+		TEST_EQUAL(4u, codecDecode(block, size, out, 4u, NULL));
+		TEST_CHECK(memcmp(full, out, sizeof(full)) == 0);
+
+		// truncated block and too little output are refused
+		TEST_EQUAL(0u, codecDecode(block, size - 1u, out, 4u, NULL));
+		TEST_EQUAL(0u, codecDecode(block, size, out, 3u, NULL));
+
+		// output too small never writes past its end
+		memset(block, 0xA5, sizeof(block));
+		TEST_EQUAL(0u, codecEncode((enum CodecFormat)format, full, 4u, block, CODEC_HEADER_BYTES + 1u));
+		TEST_EQUAL(0xA5u, block[CODEC_HEADER_BYTES + 1u]);
+	}
+
+	TEST_EQUAL(0u, codecEncode(CODEC_VARINT, NULL, 1u, block, sizeof(block)));
+	TEST_EQUAL(0u, codecEncode(CODEC_VARINT, &one, 0u, block, sizeof(block)));
+	TEST_EQUAL(0u, codecEncode(CODEC_VARINT, samples, CODEC_BLOCK_MAX + 1u, stream, sizeof(stream)));
+	TEST_EQUAL(0u, codecEncode(CODEC_VARINT, &one, 1u, block, CODEC_HEADER_BYTES - 1u));
+	TEST_EQUAL(0u, codecMaxBytes(CODEC_RICE, 0u));
+
+	// unknown format
+	codecEncode(CODEC_VARINT, &one, 1u, block, sizeof(block));
+	block[0] = 7u;
+	TEST_EQUAL(0u, codecDecode(block, CODEC_HEADER_BYTES, out, 4u, NULL));
+}
+
+/**
+ * Times encoder on each capture buffer of each signal
+ */
+static void benchEncode(void) {
+
+	char scenario[32];
+
+	for (uint32_t signal = TEST_SINE; signal <= TEST_NOISE; signal++) {
+		makeSignal((enum TestSignal)signal);
+		for (uint32_t format = CODEC_VARINT; format <= CODEC_RICE; format++) {
+			uint64_t best = UINT64_MAX;
+			for (uint32_t run = 0; run < TEST_BENCH_RUNS; run++) {
+				uint32_t bytes = 0u;
+				uint64_t start = testHostNS();
+				for (uint32_t i = 0; i < TEST_SAMPLES; i += TEST_BLOCK) {
+					bytes += codecEncode((enum CodecFormat)format, samples + i, TEST_BLOCK, stream + bytes, sizeof(stream) - bytes);
+				}
+				uint64_t taken = testHostNS() - start;
+				best = taken < best ? taken : best;
+			}
+			snprintf(scenario, sizeof(scenario), "codec_%s_%s", formatNames[format], signalNames[signal]);
+			testHostMetric(scenario, "encode_msamples_per_s", best > 0u ? TEST_SAMPLES * 1000ull / best : 0u);
+		}
+	}
+}
+
+int main(void) {
+
+	testEdges();
+	testSignals();
+	benchEncode();
+
+	return testResult("codec");
+}
\ No newline at end of file
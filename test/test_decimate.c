@@ -0,0 +1,184 @@
+/*
+	test_decimate.c - checks min/max decimation keeps spikes and times it per ratio
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <inherited/pico/board_pico_decimate.h>
+
+#include "test.h"
+
+#define TEST_SAMPLES (1u << 18) // samples in each test signal
+#define TEST_BUCKETS_MAX TEST_SAMPLES // enough output for ratio 1
+#define TEST_CHUNK_MAX 700u // largest DMA buffer fed at once
+#define TEST_SPIKES 97u // spikes hidden in signal
+#define TEST_BENCH_RUNS 8u
+
+static uint32_t testSeed = 0x9e3779b9u;
+
+static sample_t samples[TEST_SAMPLES];
+static struct decimateBucket buckets[TEST_BUCKETS_MAX];
+static sample_t averages[TEST_BUCKETS_MAX];
+
+/**
+ * Fills signal with low noise and single sample spikes both ways
+ *
+ * @param spikes pointer to spike indexes, filled in
+ */
+static void makeSignal(uint32_t *spikes) {
+	for (uint32_t i = 0; i < TEST_SAMPLES; i++) {
+		samples[i] = (sample_t)(2000u + testRandom(&testSeed) % 64u);
+	}
+	for (uint32_t i = 0; i < TEST_SPIKES; i++) {
+		spikes[i] = testRandom(&testSeed) % TEST_SAMPLES;
+		samples[spikes[i]] = (i & 1u) ? 0u : SAMPLE_MAX;
+	}
+}
+
+/**
+ * Feeds whole signal in random sized chunks and checks every bucket
+ * against a direct reduction of the same samples
+ *
+ * @return amount of spikes no bucket shows
+ */
+static uint32_t checkRatio(uint32_t ratio, const uint32_t *spikes) {
+
+	struct decimator dec;
+	uint32_t index = 0u;
+	uint32_t completed = 0u;
+
+	TEST_CHECK(decimateBegin(&dec, ratio, buckets, averages, TEST_BUCKETS_MAX));
+	while (index < TEST_SAMPLES) {
+		uint32_t chunk = 1u + testRandom(&testSeed) % TEST_CHUNK_MAX;
+		if (chunk > TEST_SAMPLES - index) {
+			chunk = TEST_SAMPLES - index;
+		}
+		completed += decimateFeed(&dec, samples + index, chunk);
+		index += chunk;
+	}
+	const bool partial = TEST_SAMPLES % ratio != 0u;
+	TEST_EQUAL(partial, decimateFlush(&dec));
+	TEST_CHECK(!decimateFlush(&dec));
+
+	const uint32_t expected = (TEST_SAMPLES + ratio - 1u) / ratio;
+	TEST_EQUAL(TEST_SAMPLES / ratio, completed);
+	TEST_EQUAL(expected, dec.written);
+
+	for (uint32_t b = 0; b < expected; b++) {
+		uint32_t start = b * ratio;
+		uint32_t end = start + ratio < TEST_SAMPLES ? start + ratio : TEST_SAMPLES;
+		uint32_t min = SAMPLE_MAX;
+		uint32_t max = 0u;
+		uint64_t sum = 0u;
+		for (uint32_t i = start; i < end; i++) {
+			min = samples[i] < min ? samples[i] : min;
+			max = samples[i] > max ? samples[i] : max;
+			sum += samples[i];
+		}
+		uint32_t taken = end - start;
+		TEST_EQUAL(min, buckets[b].min);
+		TEST_EQUAL(max, buckets[b].max);
+		TEST_EQUAL((sum + taken / 2u) / taken, averages[b]);
+		if (buckets[b].min != min || buckets[b].max != max) {
+			fprintf(stderr, "ratio %u bucket %u\n", ratio, b);
+			break;
+		}
+	}
+
+	// every spike stays visible in bucket it fell in
+	uint32_t lost = 0u;
+	for (uint32_t i = 0; i < TEST_SPIKES; i++) {
+		const struct decimateBucket *bucket = &buckets[spikes[i] / ratio];
+		if ((i & 1u) ? bucket->min != 0u : bucket->max != SAMPLE_MAX) {
+			lost++;
+		}
+	}
+	return lost;
+}
+
+static void testLimits(void) {
+
+	struct decimator dec;
+	struct decimateBucket out[2];
+	const sample_t full[6] = {SAMPLE_MAX, SAMPLE_MAX, SAMPLE_MAX, SAMPLE_MAX, SAMPLE_MAX, SAMPLE_MAX};
+
+	TEST_CHECK(!decimateBegin(&dec, 0u, out, NULL, 2u));
+	TEST_CHECK(!decimateBegin(&dec, DECIMATE_RATIO_MAX + 1u, out, NULL, 2u));
+	TEST_CHECK(!decimateBegin(&dec, 2u, NULL, NULL, 2u));
+
+	// output full drops rest of samples
+	TEST_CHECK(decimateBegin(&dec, 2u, out, NULL, 2u));
+	TEST_EQUAL(2u, decimateFeed(&dec, full, 6u));
+	TEST_CHECK(!decimateFlush(&dec));
+
+	// largest bucket of largest samples keeps sum in range
+	static sample_t big[DECIMATE_RATIO_MAX];
+	sample_t average = 0u;
+	for (uint32_t i = 0; i < DECIMATE_RATIO_MAX; i++) {
+		big[i] = SAMPLE_MAX;
+	}
+	TEST_CHECK(decimateBegin(&dec, DECIMATE_RATIO_MAX, out, &average, 2u));
+	TEST_EQUAL(1u, decimateFeed(&dec, big, DECIMATE_RATIO_MAX));
+	TEST_EQUAL(SAMPLE_MAX, average);
+}
+
+/**
+ * Times decimation of whole signal at each ratio
+ */
+static void benchRatios(void) {
+
+	static const uint32_t ratios[] = {4u, 16u, 64u, 256u, 4096u};
+	char scenario[32];
+	struct decimator dec;
+
+	for (uint32_t r = 0; r < sizeof(ratios) / sizeof(ratios[0]); r++) {
+		uint64_t best = UINT64_MAX;
+		uint64_t bestMinMax = UINT64_MAX;
+		for (uint32_t run = 0; run < TEST_BENCH_RUNS; run++) {
+			decimateBegin(&dec, ratios[r], buckets, averages, TEST_BUCKETS_MAX);
+			uint64_t start = testHostNS();
+			decimateFeed(&dec, samples, TEST_SAMPLES);
+			uint64_t taken = testHostNS() - start;
+			best = taken < best ? taken : best;
+
+			decimateBegin(&dec, ratios[r], buckets, NULL, TEST_BUCKETS_MAX);
+			start = testHostNS();
+			decimateFeed(&dec, samples, TEST_SAMPLES);
+			taken = testHostNS() - start;
+			bestMinMax = taken < bestMinMax ? taken : bestMinMax;
+		}
+		snprintf(scenario, sizeof(scenario), "decimate_%u", ratios[r]);
+		testHostMetric(scenario, "msamples_per_s", best > 0u ? TEST_SAMPLES * 1000ull / best : 0u);
+		testHostMetric(scenario, "min_max_msamples_per_s", bestMinMax > 0u ? TEST_SAMPLES * 1000ull / bestMinMax : 0u);
+	}
+}
+
+int main(void) {
+
+	static const uint32_t ratios[] = {1u, 2u, 3u, 7u, 64u, 1000u, 4096u, DECIMATE_RATIO_MAX};
+	uint32_t spikes[TEST_SPIKES];
+	uint32_t lost = 0u;
+
+	testLimits();
+	makeSignal(spikes);
+	for (uint32_t r = 0; r < sizeof(ratios) / sizeof(ratios[0]); r++) {
+		lost += checkRatio(ratios[r], spikes);
+	}
+	TEST_EQUAL(0u, lost);
+	testMetric("decimate", "spikes_lost", lost);
+	benchRatios();
+
+	return testResult("decimate");
+}
\ No newline at end of file
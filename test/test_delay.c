@@ -0,0 +1,155 @@
+/*
+	test_delay.c - checks ns to cycle maths and calibrated delays at several clocks
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+
+#include <hardware/clocks.h>
+#include <hardware/structs/systick.h>
+#include <inherited/pico/board_pico_perf.h>
+#include <pico1w/board_pico1w_delay.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_MATHS_VALUES 100000u // random ns checked at each clock
+#define TEST_DELAYS 200u // delays timed at each clock
+#define TEST_OWNER_RELOAD 12499u // SysTick period of someone else, 100 us at 125 MHz
+
+static const uint32_t clocksKHz[] = {48000u, 125000u, 133000u, 200000u, 250000u};
+
+static uint32_t testSeed = 0x1f83d9abu;
+
+/**
+ * Gets cycles a delay needs
+ */
+static uint64_t exactCycles(uint32_t ns, uint32_t hz) {
+	return ((uint64_t)ns * hz + DELAY_NS_PER_S - 1u) / DELAY_NS_PER_S;
+}
+
+/**
+ * Checks conversion is never short and at most a cycle long
+ */
+static void testMaths(uint32_t hz) {
+
+	const uint32_t factor = DELAY_FACTOR(hz);
+	const uint32_t edges[] = {0u, 1u, 7u, 999u, 1000u, 1001u, 1000000u, 1000000000u, UINT32_MAX / 4u};
+
+	for (uint32_t i = 0; i < TEST_MATHS_VALUES + sizeof(edges) / sizeof(edges[0]); i++) {
+		uint32_t ns = i < sizeof(edges) / sizeof(edges[0]) ? edges[i] : testRandom(&testSeed) % 10000000u;
+		uint64_t exact = exactCycles(ns, hz);
+		uint32_t cycles = DELAY_NS_TO_CYCLES(ns, factor);
+		if (cycles < exact || cycles > exact + 1u) {
+			fprintf(stderr, "%u ns at %u Hz is %u cycles, needs %llu\n", ns, hz, cycles, (unsigned long long)exact);
+			testFailures++;
+			return;
+		}
+	}
+}
+
+/**
+ * Times runtime delays on simulated clock after calibrating
+ *
+ * @return most cycles a delay ran over
+ */
+static uint32_t testDelays(uint32_t khz) {
+
+	uint32_t worst = 0u;
+
+	set_sys_clock_khz(khz, true);
+	delayCalibrate();
+	TEST_EQUAL(DELAY_FACTOR(khz * 1000u), delayFactor);
+
+	for (uint32_t i = 0; i < TEST_DELAYS; i++) {
+		volatile uint32_t ns = 100u + testRandom(&testSeed) % 20000u;
+		const uint64_t exact = exactCycles(ns, khz * 1000u);
+		const uint64_t start = simCycles();
+		hardDelayNS(ns);
+		const uint64_t taken = simCycles() - start;
+		TEST_CHECK(taken >= exact);
+		if (taken > exact + worst) {
+			worst = (uint32_t)(taken - exact);
+		}
+	}
+
+	// one loop of rounding plus the ns conversion
+	TEST_CHECK(worst <= DELAY_LOOP_CYCLES + 1u);
+	return worst;
+}
+
+/**
+ * Checks calibration reads a running SysTick without writing it
+ * and puts a stopped one back
+ */
+static void testSysTick(void) {
+
+	set_sys_clock_khz(125000u, true);
+
+	// someone else's periodic tick keeps its phase
+	systick_hw->rvr = TEST_OWNER_RELOAD;
+	systick_hw->cvr = 0u;
+	systick_hw->csr = PERF_SYSTICK_PROCESSOR | PERF_SYSTICK_ENABLE | 0x2u;
+	const uint32_t writes = simSysTickWrites(0u);
+	const uint32_t startValue = systick_hw->cvr;
+	const uint64_t startCycles = simCycles();
+	const uint32_t overhead = delayOverhead;
+	delayCalibrate();
+	const uint32_t endValue = systick_hw->cvr;
+	const uint64_t elapsed = simCycles() - startCycles;
+	TEST_EQUAL(writes, simSysTickWrites(0u));
+	TEST_EQUAL(TEST_OWNER_RELOAD, systick_hw->rvr);
+	TEST_EQUAL(PERF_SYSTICK_PROCESSOR | PERF_SYSTICK_ENABLE | 0x2u, systick_hw->csr);
+	TEST_EQUAL((uint32_t)(elapsed % (TEST_OWNER_RELOAD + 1u)),
+		(startValue + TEST_OWNER_RELOAD + 1u - endValue) % (TEST_OWNER_RELOAD + 1u));
+	TEST_EQUAL(overhead, delayOverhead);
+
+	// too short a period to measure with is borrowed and given back
+	systick_hw->rvr = 99u;
+	delayCalibrate();
+	TEST_EQUAL(99u, systick_hw->rvr);
+	TEST_EQUAL(PERF_SYSTICK_PROCESSOR | PERF_SYSTICK_ENABLE | 0x2u, systick_hw->csr);
+	TEST_CHECK(systick_hw->cvr <= 99u);
+	TEST_EQUAL(overhead, delayOverhead);
+
+	// stopped SysTick stays stopped
+	systick_hw->csr = 0u;
+	systick_hw->rvr = 0u;
+	delayCalibrate();
+	TEST_EQUAL(0u, systick_hw->csr);
+	TEST_EQUAL(0u, systick_hw->rvr);
+	TEST_EQUAL(overhead, delayOverhead);
+	perfBegin();
+	perfEnd();
+	TEST_EQUAL(0u, systick_hw->csr);
+	TEST_EQUAL(0u, systick_hw->rvr);
+}
+
+int main(void) {
+
+	char scenario[32];
+
+	for (uint32_t i = 0; i < sizeof(clocksKHz) / sizeof(clocksKHz[0]); i++) {
+		testMaths(clocksKHz[i] * 1000u);
+		snprintf(scenario, sizeof(scenario), "delay_%umhz", clocksKHz[i] / 1000u);
+		testMetric(scenario, "worst_over_cycles", testDelays(clocksKHz[i]));
+		testMetric(scenario, "overhead_cycles", delayOverhead);
+	}
+	testMaths(133333333u);
+	testSysTick();
+
+	return testResult("delay");
+}
\ No newline at end of file
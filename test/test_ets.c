@@ -0,0 +1,191 @@
+/*
+	test_ets.c - reconstructs a repetitive signal from shifted noisy captures
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+
+#include <hardware/clocks.h>
+#include <inherited/pico/board_pico_clock.h>
+#include <inherited/pico/board_pico_ets.h>
+
+#include <math.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_INTERLEAVE 32u // phases per sample period
+#define TEST_SAMPLE_NS 2048u // ADC sample period
+#define TEST_SAMPLES 64u // samples per capture
+#define TEST_SIGNAL_NS 1234.0 // period of signal, shorter than sample period
+#define TEST_NOISE 8 // most LSB of each of two noise terms
+#define TEST_PASSES 16u // captures of each phase
+#define TEST_SLOTS (TEST_INTERLEAVE * TEST_SAMPLES)
+
+static sample_t record[TEST_SLOTS];
+static uint32_t recordSums[TEST_SLOTS];
+static sample_t capture[TEST_SAMPLES];
+static double sums[TEST_SLOTS];
+
+static uint32_t testSeed = 0x2545f491u;
+
+/**
+ * Gets signal at time after trigger event
+ */
+static double signalAt(double ns) {
+	const double angle = 2.0 * M_PI * ns / TEST_SIGNAL_NS;
+	return 2048.0 + 1500.0 * sin(angle) + 300.0 * sin(3.0 * angle);
+}
+
+/**
+ * Samples signal with triangular noise from a shifted start
+ */
+static void captureAt(uint32_t shiftNs) {
+	for (uint32_t i = 0; i < TEST_SAMPLES; i++) {
+		int32_t noise = (int32_t)(testRandom(&testSeed) % (2u * TEST_NOISE + 1u)) - TEST_NOISE;
+		noise += (int32_t)(testRandom(&testSeed) % (2u * TEST_NOISE + 1u)) - TEST_NOISE;
+		capture[i] = (sample_t)lround(signalAt(shiftNs + (double)i * TEST_SAMPLE_NS) + noise);
+	}
+}
+
+/**
+ * Gets RMS error of record against signal
+ *
+ * @return error in thousandths of LSB
+ */
+static uint64_t recordError(const struct etsRecord *ets) {
+	double total = 0.0;
+	for (uint32_t slot = 0; slot < TEST_SLOTS; slot++) {
+		const double error = record[slot] - signalAt((double)slot * ets->stepNs);
+		total += error * error;
+	}
+	return (uint64_t)llround(sqrt(total / TEST_SLOTS) * 1000.0);
+}
+
+/**
+ * Fills record phase by phase, checking each slot is the mean of its captures
+ */
+static void testReconstruct(void) {
+
+	struct etsRecord ets;
+
+	TEST_CHECK(!etsBegin(&ets, record, NULL, TEST_SLOTS, TEST_INTERLEAVE, TEST_SAMPLE_NS, TEST_SAMPLES));
+	TEST_CHECK(!etsBegin(&ets, record, recordSums, TEST_SLOTS, 1u, TEST_SAMPLE_NS, TEST_SAMPLES));
+	TEST_CHECK(!etsBegin(&ets, record, recordSums, TEST_SLOTS - 1u, TEST_INTERLEAVE, TEST_SAMPLE_NS, TEST_SAMPLES));
+	TEST_CHECK(etsBegin(&ets, record, recordSums, TEST_SLOTS, TEST_INTERLEAVE, TEST_SAMPLE_NS, TEST_SAMPLES));
+	TEST_EQUAL(TEST_SAMPLE_NS / TEST_INTERLEAVE, ets.stepNs);
+	TEST_EQUAL(500000u * TEST_INTERLEAVE, etsEffectiveRate(&ets, 500000u));
+
+	uint64_t firstPass = 0u;
+	for (uint32_t pass = 0; pass < TEST_PASSES; pass++) {
+		for (uint32_t i = 0; i < TEST_INTERLEAVE; i++) {
+			const uint32_t shift = etsNextShiftNs(&ets);
+			TEST_EQUAL(ets.phase * ets.stepNs, shift);
+			captureAt(shift);
+			TEST_CHECK(etsAddCapture(&ets, capture, TEST_SAMPLES));
+			for (uint32_t sample = 0; sample < TEST_SAMPLES; sample++) {
+				sums[sample * TEST_INTERLEAVE + ets.phase] += capture[sample];
+			}
+		}
+		TEST_CHECK(etsComplete(&ets));
+
+		// every capture counts the same
+		double worst = 0.0;
+		for (uint32_t slot = 0; slot < TEST_SLOTS; slot++) {
+			const double error = fabs(record[slot] - sums[slot] / (pass + 1u));
+			worst = error > worst ? error : worst;
+		}
+		TEST_CHECK(worst <= 0.5);
+		if (pass == 0u) {
+			firstPass = recordError(&ets);
+		}
+	}
+
+	TEST_EQUAL(TEST_INTERLEAVE * TEST_PASSES, ets.captures);
+	TEST_EQUAL(TEST_PASSES, ets.hits[TEST_INTERLEAVE - 1u]);
+	TEST_CHECK(!etsAddCapture(&ets, capture, TEST_SAMPLES - 1u));
+	TEST_EQUAL(1u, ets.rejected);
+
+	// averaging brings noise down by the square root of the passes
+	const uint64_t lastPass = recordError(&ets);
+	TEST_CHECK(lastPass * 3u < firstPass);
+	testMetric("ets_reconstruct", "rms_error_milli_lsb_1_pass", firstPass);
+	testMetric("ets_reconstruct", "rms_error_milli_lsb_16_passes", lastPass);
+}
+
+static uint64_t triggerNS = 0u;
+static uint64_t startNS = 0u;
+
+/**
+ * Stands in for starting acquisition
+ */
+static void startCapture(void *param) {
+	(void)param;
+	startNS = simNowNS();
+}
+
+/**
+ * Checks start lands on each shift, spun or from an alarm
+ *
+ * @return latest start past its shift in ns
+ */
+static uint32_t testRestart(uint32_t samplePeriodNs) {
+
+	struct etsRecord ets;
+	uint32_t worst = 0u;
+
+	TEST_CHECK(etsBegin(&ets, record, recordSums, TEST_SLOTS, TEST_INTERLEAVE, samplePeriodNs, TEST_SAMPLES));
+	TEST_CHECK(!etsRestart(&ets, NULL, NULL));
+	for (uint32_t i = 0; i < TEST_INTERLEAVE; i++) {
+		startNS = 0u;
+		triggerNS = simNowNS();
+		TEST_CHECK(etsRestart(&ets, startCapture, NULL));
+		simRunUS(samplePeriodNs / 1000u + 2u);
+		const uint64_t shift = (uint64_t)ets.phase * ets.stepNs;
+		TEST_CHECK(startNS >= triggerNS + shift);
+		const uint64_t late = startNS - triggerNS - shift;
+		worst = late > worst ? (uint32_t)late : worst;
+	}
+	return worst;
+}
+
+int main(void) {
+
+	struct clockProfile profile;
+
+	testReconstruct();
+
+	// shifts follow clk_sys changes
+	clockDefaults(&profile);
+	profile.sysKHz = 48000u;
+	TEST_EQUAL(CLOCK_OK, clockApply(&profile));
+	TEST_EQUAL(CLOCK_NS_FACTOR(clock_get_hz(clk_sys)), clockNSFactor);
+	const uint32_t spunSlow = testRestart(TEST_SAMPLE_NS);
+	profile.sysKHz = 125000u;
+	TEST_EQUAL(CLOCK_OK, clockApply(&profile));
+	const uint32_t spun = testRestart(TEST_SAMPLE_NS);
+	const uint32_t alarmed = testRestart(HARD_TIMER_SPIN_MAX_NS * 2u);
+
+	// spun starts are a cycle or two late, alarms land within their us then take the interrupt
+	TEST_CHECK(spunSlow < 100u);
+	TEST_CHECK(spun < 100u);
+	TEST_CHECK(alarmed < 2000u);
+	testMetric("ets_restart_48mhz", "worst_late_ns", spunSlow);
+	testMetric("ets_restart_125mhz", "worst_late_ns", spun);
+	testMetric("ets_restart_alarm", "worst_late_ns", alarmed);
+
+	return testResult("ets");
+}
\ No newline at end of file
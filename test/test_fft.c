@@ -0,0 +1,301 @@
+/*
+	test_fft.c - checks fixed point spectrum against a double precision DFT
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+#include <nvm/nvm.h>
+
+#include <inherited/pico/board_pico_fft.h>
+#include <inherited/pico/board_pico_nvm.h>
+#include <inherited/pico/board_pico_threads.h>
+
+#include <math.h>
+#include <string.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_MAGNITUDE_ERROR 0.045 // alpha max plus beta min is within 4%
+#define TEST_NOISE_FLOOR 24.0 // Q15 counts of rounding through every stage
+#define TEST_BENCH_RUNS 32u
+
+static uint32_t testSeed = 0x6a09e667u;
+
+static sample_t buffer[FFT_POINTS_MAX] __attribute__((aligned(4)));
+static sample_t input[FFT_POINTS_MAX];
+static double reference[FFT_POINTS_MAX / 2u];
+static double cosines[FFT_POINTS_MAX]; // cos(2 * pi * i / points)
+static double sines[FFT_POINTS_MAX]; // sin(2 * pi * i / points)
+
+static sample_t clampSample(double value) {
+	if (value < 0.0) {
+		return 0u;
+	}
+	if (value > SAMPLE_MAX) {
+		return SAMPLE_MAX;
+	}
+	return (sample_t)lround(value);
+}
+
+/**
+ * Calculates magnitudes the way fftSpectrum scales them, full scale
+ * sine on a bin is 32768, in double precision
+ */
+static void referenceSpectrum(uint32_t points, enum FFTWindow window) {
+
+	static double values[FFT_POINTS_MAX];
+
+	for (uint32_t i = 0; i < points; i++) {
+		cosines[i] = cos(2.0 * M_PI * i / points);
+		sines[i] = sin(2.0 * M_PI * i / points);
+		values[i] = ((double)input[i] - 2048.0) / 2048.0;
+		if (window == FFT_WINDOW_HANN) {
+			values[i] *= 0.5 - 0.5 * cosines[i];
+		}
+	}
+
+	for (uint32_t k = 0; k < points / 2u; k++) {
+		double real = 0.0;
+		double imag = 0.0;
+		// i * k wraps a whole number of periods
+		for (uint32_t i = 0, angle = 0; i < points; i++, angle = (angle + k) & (points - 1u)) {
+			real += values[i] * cosines[angle];
+			imag -= values[i] * sines[angle];
+		}
+		reference[k] = fmin(sqrt(real * real + imag * imag) / (points / 2u) * 32768.0, UINT16_MAX);
+	}
+}
+
+/**
+ * Runs spectrum over input and checks every bin against reference
+ *
+ * @return largest error of any bin in Q15 counts
+ */
+static double checkSpectrum(uint32_t points, enum FFTWindow window) {
+
+	double worst = 0.0;
+
+	memcpy(buffer, input, points * sizeof(sample_t));
+	TEST_CHECK(fftSpectrum(buffer, points, window));
+	referenceSpectrum(points, window);
+
+	for (uint32_t k = 0; k < points / 2u; k++) {
+		double error = fabs(buffer[k] - reference[k]);
+		double allowed = reference[k] * TEST_MAGNITUDE_ERROR + TEST_NOISE_FLOOR;
+		if (error > allowed) {
+			fprintf(stderr, "%u points bin %u is %u, expected %.1f\n", points, k, buffer[k], reference[k]);
+			testFailures++;
+			break;
+		}
+		worst = fmax(worst, error - reference[k] * TEST_MAGNITUDE_ERROR);
+	}
+	return worst;
+}
+
+static void testTones(void) {
+
+	for (uint32_t points = FFT_POINTS_MIN; points <= FFT_POINTS_MAX; points <<= 1) {
+
+		// full scale sine centered on a bin
+		const uint32_t bin = points / 8u + 3u;
+		for (uint32_t i = 0; i < points; i++) {
+			input[i] = clampSample(2048.0 + 2047.0 * sin(2.0 * M_PI * bin * i / points));
+		}
+		checkSpectrum(points, FFT_WINDOW_RECTANGLE);
+		TEST_NEAR(32752.0, buffer[bin], 32752.0 * TEST_MAGNITUDE_ERROR);
+
+		// two tones between bins, hann keeps leakage down far from them
+		for (uint32_t i = 0; i < points; i++) {
+			input[i] = clampSample(2048.0 + 1000.0 * sin(2.0 * M_PI * 10.5 * i / points) + 500.0 * cos(2.0 * M_PI * (points / 4u + 0.25) * i / points));
+		}
+		checkSpectrum(points, FFT_WINDOW_RECTANGLE);
+		const uint32_t rectangleLeak = buffer[points / 8u];
+		checkSpectrum(points, FFT_WINDOW_HANN);
+		TEST_CHECK(buffer[points / 8u] < rectangleLeak);
+	}
+}
+
+static void testFullScale(void) {
+
+	double worst = 0.0;
+
+	for (uint32_t points = FFT_POINTS_MIN; points <= FFT_POINTS_MAX; points <<= 1) {
+
+		// rail to rail noise puts full scale pairs into every butterfly
+		for (uint32_t run = 0; run < 4u; run++) {
+			for (uint32_t i = 0; i < points; i++) {
+				input[i] = (testRandom(&testSeed) & 1u) ? SAMPLE_MAX : 0u;
+			}
+			worst = fmax(worst, checkSpectrum(points, FFT_WINDOW_RECTANGLE));
+			worst = fmax(worst, checkSpectrum(points, FFT_WINDOW_HANN));
+		}
+
+		// full scale square and DC land on clamp
+		for (uint32_t i = 0; i < points; i++) {
+			input[i] = (i / 16u) & 1u ? 0u : SAMPLE_MAX;
+		}
+		checkSpectrum(points, FFT_WINDOW_RECTANGLE);
+		for (uint32_t i = 0; i < points; i++) {
+			input[i] = 0u;
+		}
+		checkSpectrum(points, FFT_WINDOW_RECTANGLE);
+	}
+	testHostMetric("fft", "worst_error_past_magnitude_q15", (uint64_t)worst);
+}
+
+static void testInvalid(void) {
+
+	TEST_CHECK(!fftValidPoints(128u));
+	TEST_CHECK(!fftValidPoints(1000u));
+	TEST_CHECK(!fftValidPoints(8192u));
+	TEST_CHECK(fftValidPoints(1024u));
+	TEST_CHECK(!fftSpectrum(NULL, 256u, FFT_WINDOW_RECTANGLE));
+	TEST_CHECK(!fftSpectrum(buffer + 1, 256u, FFT_WINDOW_RECTANGLE));
+	TEST_CHECK(!fftSpectrum(buffer, 512u + 1u, FFT_WINDOW_RECTANGLE));
+}
+
+struct testSafety {
+	volatile bool done;
+	uint32_t core;
+	bool first;
+	bool nested;
+	bool ended;
+	bool endedTwice;
+	uint32_t erasesBefore;
+	uint32_t erasesAfter;
+};
+
+/**
+ * Takes thread safety and queues a commit from core 1
+ */
+static void safetyJob(void *param) {
+
+	struct testSafety *safety = (struct testSafety*)param;
+	struct simFlashStats flash;
+
+	safety->core = get_core_num();
+	safety->first = startThreadSafety();
+	safety->nested = startThreadSafety();
+	safety->ended = endThreadSafety();
+	safety->endedTwice = endThreadSafety();
+
+	simFlashGetStats(&flash);
+	safety->erasesBefore = flash.erases;
+	nvmCommit();
+	simFlashGetStats(&flash);
+	safety->erasesAfter = flash.erases;
+
+	safety->done = true;
+}
+
+static void testCore1(void) {
+
+	struct fftJob job;
+	struct testSafety safety;
+	struct simFlashStats flash;
+	struct nvmStats stats;
+
+	for (uint32_t i = 0; i < 1024u; i++) {
+		input[i] = clampSample(2048.0 + 2047.0 * sin(2.0 * M_PI * 37.0 * i / 1024u));
+	}
+	memcpy(buffer, input, sizeof(buffer));
+
+	// thread safety before core 1 only masks interrupts
+	TEST_CHECK(startThreadSafety());
+	TEST_CHECK(!startThreadSafety());
+	TEST_CHECK(!core1Begin());
+	TEST_CHECK(endThreadSafety());
+	TEST_CHECK(!endThreadSafety());
+
+	TEST_CHECK(!fftQueueCore1(&job));
+	TEST_CHECK(core1Begin());
+	TEST_CHECK(!core1Begin());
+	TEST_CHECK(core1Started());
+
+	job.buffer = buffer;
+	job.points = 1024u;
+	job.window = FFT_WINDOW_RECTANGLE;
+	TEST_CHECK(fftQueueCore1(&job));
+	while (!job.done) {
+		tight_loop_contents();
+	}
+	TEST_CHECK(job.result);
+	TEST_NEAR(32752.0, buffer[37], 32752.0 * TEST_MAGNITUDE_ERROR);
+
+	// core 0 commits pause core 1, core 1 commits are queued to core 0
+	TEST_EQUAL(NVM_OK, nvmInit(FLASH_NVM_SIZE));
+	memset(&safety, 0, sizeof(safety));
+	TEST_CHECK(core1Queue(safetyJob, &safety));
+	nvmCommit();
+	while (!safety.done) {
+		tight_loop_contents();
+	}
+	TEST_EQUAL(1u, safety.core);
+	TEST_CHECK(safety.first);
+	TEST_CHECK(!safety.nested);
+	TEST_CHECK(safety.ended);
+	TEST_CHECK(!safety.endedTwice);
+	TEST_EQUAL(safety.erasesBefore, safety.erasesAfter);
+	while (nvmCommitPending()) {
+		tight_loop_contents();
+	}
+	simFlashGetStats(&flash);
+	TEST_EQUAL(2u, flash.erases);
+
+	nvmCommit();
+	simFlashGetStats(&flash);
+	TEST_EQUAL(3u, flash.erases);
+	TEST_EQUAL(0u, flash.unsafe);
+	nvmGetStats(&stats);
+	TEST_EQUAL(1u, stats.queued);
+	TEST_EQUAL(0u, stats.failed);
+}
+
+/**
+ * Times spectrum at each size
+ */
+static void benchSpectrum(void) {
+
+	char scenario[32];
+
+	for (uint32_t points = FFT_POINTS_MIN; points <= FFT_POINTS_MAX; points <<= 1) {
+		uint64_t best = UINT64_MAX;
+		for (uint32_t i = 0; i < points; i++) {
+			input[i] = (sample_t)(testRandom(&testSeed) & SAMPLE_MAX);
+		}
+		for (uint32_t run = 0; run < TEST_BENCH_RUNS; run++) {
+			memcpy(buffer, input, points * sizeof(sample_t));
+			uint64_t start = testHostNS();
+			fftSpectrum(buffer, points, FFT_WINDOW_HANN);
+			uint64_t taken = testHostNS() - start;
+			best = taken < best ? taken : best;
+		}
+		snprintf(scenario, sizeof(scenario), "fft_%u", points);
+		testHostMetric(scenario, "ns", best);
+	}
+}
+
+int main(void) {
+
+	testInvalid();
+	testTones();
+	testFullScale();
+	testCore1();
+	benchSpectrum();
+
+	return testResult("fft");
+}
\ No newline at end of file
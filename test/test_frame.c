@@ -0,0 +1,393 @@
+/*
+	test_frame.c - checks framing survives loss and measures its overhead
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <inherited/pico/board_pico_frame.h>
+
+#include <string.h>
+
+#include "test.h"
+
+#define TEST_PAYLOAD_MAX 1024u // largest payload sent
+#define TEST_FRAMES 2000u // frames in each loss test
+#define TEST_WIRE_MAX (TEST_FRAMES * (TEST_PAYLOAD_MAX + 32u)) // fits every encoded frame
+#define TEST_MB (1024u * 1024u) // payload bytes in overhead test
+#define TEST_BENCH_RUNS 8u
+
+struct testReceived {
+	uint32_t frames; // frames handler saw
+	uint32_t mismatched; // frames not matching what was sent
+	uint16_t firstSequence; // sequence of first frame
+	uint16_t lastSequence; // sequence of last frame
+};
+
+static uint32_t testSeed = 0x9b05688cu;
+
+static uint8_t wire[TEST_WIRE_MAX];
+static uint32_t wireLength = 0u;
+static uint8_t decodeBuffer[TEST_PAYLOAD_MAX + 64u];
+
+/**
+ * Collects encoded bytes like serialWrite would
+ */
+static void wireSink(const uint8_t *data, uint32_t length, void *context) {
+	(void)context;
+	if (length <= TEST_WIRE_MAX - wireLength) {
+		memcpy(wire + wireLength, data, length);
+	}
+	wireLength += length;
+}
+
+struct testSpans {
+	const uint8_t *payload; // payload frame was sent from
+	uint32_t length; // bytes of payload
+	uint32_t inPayload; // bytes sink got pointing into payload
+	uint32_t staged; // bytes sink got from anywhere else
+	uint32_t codes; // staged calls of one byte, COBS codes and delimiter
+	uint32_t longest; // most bytes in one call
+};
+
+/**
+ * Sorts encoded bytes by where sink got them from
+ */
+static void spanSink(const uint8_t *data, uint32_t length, void *context) {
+	struct testSpans *spans = (struct testSpans*)context;
+	if (data >= spans->payload && data + length <= spans->payload + spans->length) {
+		spans->inPayload += length;
+	}
+	else {
+		spans->staged += length;
+		spans->codes += length == 1u ? 1u : 0u;
+	}
+	spans->longest = length > spans->longest ? length : spans->longest;
+	wireSink(data, length, NULL);
+}
+
+/**
+ * Makes payload of frame from its sequence so receiver can check it,
+ * about 1 in 16 bytes is a delimiter COBS has to remove
+ *
+ * @return payload length
+ */
+static uint32_t makePayload(uint16_t sequence, uint8_t *payload) {
+	uint32_t seed = 0x2545f491u ^ ((uint32_t)sequence * 0x9e3779b9u);
+	uint32_t length = (sequence * 97u) % (TEST_PAYLOAD_MAX + 1u);
+	for (uint32_t i = 0; i < length; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		payload[i] = (seed >> 28) == 0u ? 0u : (uint8_t)(seed >> 20);
+	}
+	return length;
+}
+
+/**
+ * Checks decoded frame against payload made for its sequence
+ */
+static void checkFrame(const struct frameHeader *header, const uint8_t *payload, uint32_t length, void *context) {
+
+	struct testReceived *received = (struct testReceived*)context;
+	static uint8_t expected[TEST_PAYLOAD_MAX];
+
+	uint32_t expectedLength = makePayload(header->sequence, expected);
+	if (length != expectedLength || memcmp(payload, expected, length) != 0
+		|| header->type != FRAME_RAW_SAMPLES || header->channel != (header->sequence & 3u)
+		|| header->samplePeriodNs != 2000u || header->firstSample != header->sequence * 512u) {
+		received->mismatched++;
+	}
+	if (received->frames++ == 0u) {
+		received->firstSequence = header->sequence;
+	}
+	received->lastSequence = header->sequence;
+}
+
+/**
+ * Encodes frames onto wire
+ *
+ * @param encoder encoder, sequence carries on between calls
+ * @param frames amount of frames
+ */
+static void sendFrames(struct frameEncoder *encoder, uint32_t frames) {
+
+	static uint8_t payload[TEST_PAYLOAD_MAX];
+	struct frameHeader header;
+
+	memset(&header, 0, sizeof(header));
+	header.type = FRAME_RAW_SAMPLES;
+	header.samplePeriodNs = 2000u;
+	for (uint32_t i = 0; i < frames; i++) {
+		uint16_t sequence = encoder->sequence;
+		header.channel = (uint8_t)(sequence & 3u);
+		header.firstSample = sequence * 512u;
+		uint32_t length = makePayload(sequence, payload);
+		TEST_EQUAL(sequence, frameSend(encoder, &header, payload, length));
+	}
+	TEST_CHECK(wireLength <= TEST_WIRE_MAX);
+}
+
+static void testRoundTrip(void) {
+
+	struct frameEncoder encoder;
+	struct frameDecoder decoder;
+	struct testReceived received;
+
+	wireLength = 0u;
+	memset(&received, 0, sizeof(received));
+	frameEncoderBegin(&encoder, wireSink, NULL);
+	frameDecoderBegin(&decoder, decodeBuffer, sizeof(decodeBuffer), checkFrame, &received);
+	sendFrames(&encoder, TEST_FRAMES);
+
+	// only delimiters are zero and no frame is over its bound
+	uint32_t zeros = 0u;
+	uint32_t frameStart = 0u;
+	for (uint32_t i = 0; i < wireLength; i++) {
+		if (wire[i] == FRAME_DELIMITER) {
+			uint16_t sequence = (uint16_t)zeros;
+			uint8_t payload[TEST_PAYLOAD_MAX];
+			TEST_CHECK(i + 1u - frameStart <= frameMaxEncoded(makePayload(sequence, payload)));
+			frameStart = i + 1u;
+			zeros++;
+		}
+	}
+	TEST_EQUAL(TEST_FRAMES, zeros);
+
+	// random splits across reads
+	for (uint32_t index = 0u; index < wireLength;) {
+		uint32_t chunk = 1u + testRandom(&testSeed) % 300u;
+		chunk = chunk < wireLength - index ? chunk : wireLength - index;
+		frameDecoderFeed(&decoder, wire + index, chunk);
+		index += chunk;
+	}
+	TEST_EQUAL(TEST_FRAMES, received.frames);
+	TEST_EQUAL(0u, received.mismatched);
+	TEST_EQUAL(TEST_FRAMES, decoder.stats.frames);
+	TEST_EQUAL(0u, decoder.stats.crcErrors);
+	TEST_EQUAL(0u, decoder.stats.lostFrames);
+	TEST_EQUAL(0u, decoder.stats.resyncs);
+}
+
+/**
+ * Drops or damages bytes on the wire, every frame that gets through
+ * has to be whole and every missing one counted
+ *
+ * @param dropEvery drop one byte in this many, 0 for none
+ * @param flipEvery flip a bit in one byte in this many, 0 for none
+ * @param scenario name of metric scenario
+ */
+static void checkLoss(uint32_t dropEvery, uint32_t flipEvery, const char *scenario) {
+
+	struct frameEncoder encoder;
+	struct frameDecoder decoder;
+	struct testReceived received;
+	static uint8_t damaged[TEST_WIRE_MAX];
+	uint32_t damagedLength = 0u;
+
+	wireLength = 0u;
+	memset(&received, 0, sizeof(received));
+	frameEncoderBegin(&encoder, wireSink, NULL);
+	sendFrames(&encoder, TEST_FRAMES);
+
+	for (uint32_t i = 0; i < wireLength; i++) {
+		if (dropEvery != 0u && testRandom(&testSeed) % dropEvery == 0u) {
+			continue;
+		}
+		uint8_t byte = wire[i];
+		if (flipEvery != 0u && testRandom(&testSeed) % flipEvery == 0u) {
+			byte ^= (uint8_t)(1u << (testRandom(&testSeed) & 7u));
+		}
+		damaged[damagedLength++] = byte;
+	}
+
+	frameDecoderBegin(&decoder, decodeBuffer, sizeof(decodeBuffer), checkFrame, &received);
+	frameDecoderFeed(&decoder, damaged, damagedLength);
+
+	TEST_EQUAL(0u, received.mismatched);
+	TEST_CHECK(received.frames > 0u);
+	TEST_CHECK(received.frames < TEST_FRAMES);
+	TEST_CHECK(decoder.stats.crcErrors + decoder.stats.overruns > 0u);
+	// frames between first and last good one are either seen or counted lost
+	TEST_EQUAL(received.lastSequence - received.firstSequence + 1u, received.frames + decoder.stats.lostFrames);
+	TEST_EQUAL(0u, decoder.stats.resyncs);
+	testMetric(scenario, "frames_lost", TEST_FRAMES - received.frames);
+}
+
+static void testLoss(void) {
+
+	checkLoss(5000u, 0u, "frame_drop");
+	checkLoss(0u, 5000u, "frame_flip");
+	checkLoss(20000u, 20000u, "frame_mixed");
+}
+
+static void testResync(void) {
+
+	struct frameEncoder encoder;
+	struct frameDecoder decoder;
+	struct testReceived received;
+	static uint8_t payload[TEST_PAYLOAD_MAX];
+	struct frameHeader header;
+
+	memset(&received, 0, sizeof(received));
+	memset(&header, 0, sizeof(header));
+	header.samplePeriodNs = 2000u;
+	frameDecoderBegin(&decoder, decodeBuffer, sizeof(decodeBuffer), checkFrame, &received);
+
+	// sender restarts part way, sequence going back is a resync not 65000 lost
+	wireLength = 0u;
+	frameEncoderBegin(&encoder, wireSink, NULL);
+	sendFrames(&encoder, 100u);
+	frameEncoderBegin(&encoder, wireSink, NULL);
+	sendFrames(&encoder, 10u);
+	frameDecoderFeed(&decoder, wire, wireLength);
+	TEST_EQUAL(110u, received.frames);
+	TEST_EQUAL(0u, decoder.stats.lostFrames);
+	TEST_EQUAL(1u, decoder.stats.resyncs);
+
+	// small gap is loss, a jump past resync gap is not
+	wireLength = 0u;
+	encoder.sequence = 20u;
+	sendFrames(&encoder, 1u);
+	encoder.sequence = (uint16_t)(21u + FRAME_RESYNC_GAP);
+	sendFrames(&encoder, 1u);
+	frameDecoderFeed(&decoder, wire, wireLength);
+	TEST_EQUAL(10u, decoder.stats.lostFrames);
+	TEST_EQUAL(2u, decoder.stats.resyncs);
+
+	// sequence wraps without loss
+	wireLength = 0u;
+	encoder.sequence = UINT16_MAX - 1u;
+	frameDecoderBegin(&decoder, decodeBuffer, sizeof(decodeBuffer), checkFrame, &received);
+	sendFrames(&encoder, 4u);
+	frameDecoderFeed(&decoder, wire, wireLength);
+	TEST_EQUAL(4u, decoder.stats.frames);
+	TEST_EQUAL(0u, decoder.stats.lostFrames);
+	TEST_EQUAL(0u, decoder.stats.resyncs);
+
+	// frame bigger than decoder buffer is dropped, next one still arrives
+	uint8_t small[64];
+	wireLength = 0u;
+	frameEncoderBegin(&encoder, wireSink, NULL);
+	frameDecoderBegin(&decoder, small, sizeof(small), NULL, NULL);
+	memset(payload, 0x55, sizeof(payload));
+	frameSend(&encoder, &header, payload, sizeof(payload));
+	frameSend(&encoder, &header, payload, 8u);
+	frameDecoderFeed(&decoder, wire, wireLength);
+	TEST_EQUAL(1u, decoder.stats.overruns);
+	TEST_EQUAL(1u, decoder.stats.frames);
+
+	// known crc32 check value
+	TEST_EQUAL(0xCBF43926u, frameCRC32(0u, (const uint8_t*)"123456789", 9u));
+}
+
+/**
+ * Frames a megabyte of capture buffers and times encoder and decoder
+ */
+static void benchOverhead(void) {
+
+	static uint8_t payload[TEST_PAYLOAD_MAX];
+	struct frameEncoder encoder;
+	struct frameDecoder decoder;
+	struct frameHeader header;
+	uint64_t bestEncode = UINT64_MAX;
+	uint64_t bestDecode = UINT64_MAX;
+	uint32_t encoded = 0u;
+
+	memset(&header, 0, sizeof(header));
+	for (uint32_t i = 0; i < TEST_PAYLOAD_MAX; i++) {
+		payload[i] = (uint8_t)testRandom(&testSeed);
+	}
+
+	for (uint32_t run = 0; run < TEST_BENCH_RUNS; run++) {
+		wireLength = 0u;
+		frameEncoderBegin(&encoder, wireSink, NULL);
+		uint64_t start = testHostNS();
+		for (uint32_t sent = 0u; sent < TEST_MB; sent += TEST_PAYLOAD_MAX) {
+			frameSend(&encoder, &header, payload, TEST_PAYLOAD_MAX);
+		}
+		uint64_t taken = testHostNS() - start;
+		bestEncode = taken < bestEncode ? taken : bestEncode;
+		encoded = wireLength;
+
+		frameDecoderBegin(&decoder, decodeBuffer, sizeof(decodeBuffer), NULL, NULL);
+		start = testHostNS();
+		frameDecoderFeed(&decoder, wire, wireLength < TEST_WIRE_MAX ? wireLength : TEST_WIRE_MAX);
+		taken = testHostNS() - start;
+		bestDecode = taken < bestDecode ? taken : bestDecode;
+	}
+	TEST_CHECK(encoded <= TEST_WIRE_MAX);
+	TEST_EQUAL(TEST_MB / TEST_PAYLOAD_MAX, decoder.stats.frames);
+
+	// header, crc, COBS codes and delimiter for each 1 KiB buffer
+	testMetric("frame", "overhead_bytes_per_mb", encoded - TEST_MB);
+	testHostMetric("frame", "encode_mb_per_s", bestEncode > 0u ? 1000000000ull / bestEncode : 0u);
+	testHostMetric("frame", "decode_mb_per_s", bestDecode > 0u ? 1000000000ull / bestDecode : 0u);
+}
+
+/**
+ * Checks sink gets payload where it is, only codes, header and crc are staged
+ */
+static void testZeroCopy(void) {
+
+	static uint8_t payload[TEST_PAYLOAD_MAX];
+	struct frameEncoder encoder;
+	struct frameDecoder decoder;
+	struct frameHeader header;
+	struct testReceived received;
+	struct testSpans spans;
+
+	memset(&header, 0, sizeof(header));
+	memset(&received, 0, sizeof(received));
+	header.type = FRAME_RAW_SAMPLES;
+	header.samplePeriodNs = 2000u;
+	frameDecoderBegin(&decoder, decodeBuffer, sizeof(decodeBuffer), checkFrame, &received);
+
+	// every length has its own mix of runs, zeros and full blocks
+	for (uint16_t sequence = 0u; sequence < 64u; sequence++) {
+		const uint32_t length = makePayload(sequence, payload);
+		uint32_t zeros = 0u;
+		for (uint32_t i = 0; i < length; i++) {
+			zeros += payload[i] == 0u ? 1u : 0u;
+		}
+
+		memset(&spans, 0, sizeof(spans));
+		spans.payload = payload;
+		spans.length = length;
+		wireLength = 0u;
+		frameEncoderBegin(&encoder, spanSink, &spans);
+		encoder.sequence = sequence;
+		header.channel = (uint8_t)(sequence & 3u);
+		header.firstSample = sequence * 512u;
+		frameSend(&encoder, &header, payload, length);
+
+		TEST_EQUAL(length - zeros, spans.inPayload);
+		TEST_CHECK(spans.staged - spans.codes <= FRAME_HEADER_BYTES + FRAME_CRC_BYTES);
+		TEST_CHECK(spans.longest <= FRAME_COBS_BLOCK);
+		TEST_EQUAL(wireLength, spans.inPayload + spans.staged);
+		frameDecoderFeed(&decoder, wire, wireLength);
+	}
+	TEST_EQUAL(64u, received.frames);
+	TEST_EQUAL(0u, received.mismatched);
+	TEST_EQUAL(0u, decoder.stats.crcErrors);
+}
+
+int main(void) {
+
+	testRoundTrip();
+	testZeroCopy();
+	testLoss();
+	testResync();
+	benchOverhead();
+
+	return testResult("frame");
+}
\ No newline at end of file
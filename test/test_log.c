@@ -0,0 +1,192 @@
+/*
+	test_log.c - checks deferred log records and times them against printf
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+
+#include <inherited/pico/board_pico_log.h>
+#include <inherited/pico/board_pico_threads.h>
+
+#include <string.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_WORDS_MAX (LOG_BUFFER_WORDS * 2u)
+#define TEST_BENCH_CALLS 100000u
+
+static uint32_t words[TEST_WORDS_MAX];
+static FILE *capture = NULL;
+
+/**
+ * Writes frames to capture file for log_decode.py
+ */
+static void captureSink(const uint8_t *data, uint32_t length, void *context) {
+	uint32_t *bytes = (uint32_t*)context;
+	if (capture != NULL) {
+		fwrite(data, 1u, length, capture);
+	}
+	*bytes += length;
+}
+
+static void testRecords(void) {
+
+	struct logStats before;
+	struct logStats after;
+
+	logGetStats(0u, &before);
+	LOG_DEFERRED("value %d hex %x\n", -5, 0x2a);
+	simRunUS(10u);
+	LOG_DEFERRED("no args\n");
+	LOG_DEFERRED("six %d %d %d %d %d %d\n", 1, 2, 3, 4, 5, 6);
+	logGetStats(0u, &after);
+	TEST_EQUAL(3u, after.records - before.records);
+
+	TEST_EQUAL(3u * LOG_HEADER_WORDS + 2u + 6u, logRead(0u, words, TEST_WORDS_MAX));
+
+	// argument count, offset, time then arguments
+	TEST_EQUAL(2u, words[0] >> LOG_COUNT_SHIFT);
+	TEST_EQUAL((uint32_t)-5, words[2]);
+	TEST_EQUAL(0x2au, words[3]);
+	TEST_EQUAL(0u, words[4] >> LOG_COUNT_SHIFT);
+	TEST_CHECK(words[5] >= words[1] + 10u);
+	TEST_EQUAL(6u, words[6] >> LOG_COUNT_SHIFT);
+	TEST_EQUAL(1u, words[8]);
+	TEST_EQUAL(6u, words[13]);
+
+	// each call site has its own format
+	TEST_CHECK((words[0] & LOG_OFFSET_MASK) != (words[4] & LOG_OFFSET_MASK));
+	TEST_CHECK((words[4] & LOG_OFFSET_MASK) != (words[6] & LOG_OFFSET_MASK));
+
+	// read stops before a record that doesn't fit
+	LOG_DEFERRED("one %u\n", 1u);
+	TEST_EQUAL(0u, logRead(0u, words, LOG_HEADER_WORDS));
+	TEST_EQUAL(LOG_HEADER_WORDS + 1u, logRead(0u, words, TEST_WORDS_MAX));
+	TEST_EQUAL(0u, logRead(0u, words, TEST_WORDS_MAX));
+	TEST_EQUAL(0u, logRead(2u, words, TEST_WORDS_MAX));
+}
+
+static void testFull(void) {
+
+	struct logStats before;
+	struct logStats after;
+	const uint32_t fit = LOG_BUFFER_WORDS / (LOG_HEADER_WORDS + 1u);
+
+	logGetStats(0u, &before);
+	for (uint32_t i = 0; i < fit + 10u; i++) {
+		LOG_DEFERRED("fill %u\n", i);
+	}
+	logGetStats(0u, &after);
+	TEST_EQUAL(fit, after.records - before.records);
+	TEST_EQUAL(10u, after.dropped - before.dropped);
+
+	// oldest records are kept, newest dropped
+	TEST_EQUAL(fit * (LOG_HEADER_WORDS + 1u), logRead(0u, words, TEST_WORDS_MAX));
+	TEST_EQUAL(0u, words[LOG_HEADER_WORDS]);
+	TEST_EQUAL(fit - 1u, words[(fit - 1u) * (LOG_HEADER_WORDS + 1u) + LOG_HEADER_WORDS]);
+}
+
+/**
+ * Logs from core 1 into its own buffer
+ */
+static void core1Log(void *param) {
+	volatile bool *done = (volatile bool*)param;
+	LOG_DEFERRED("from core %u %d\n", get_core_num(), 17);
+	*done = true;
+}
+
+/**
+ * Sends records from both cores as frames, to capture file when given
+ */
+static void testFlush(const char *path) {
+
+	struct frameEncoder encoder;
+	volatile bool done = false;
+	uint32_t bytes = 0u;
+
+	if (path != NULL) {
+		capture = fopen(path, "wb");
+		TEST_CHECK(capture != NULL);
+	}
+
+	TEST_CHECK(core1Begin());
+	TEST_CHECK(core1Queue(core1Log, (void*)&done));
+	while (!done) {
+		tight_loop_contents();
+	}
+	LOG_DEFERRED("decode %d %u 0x%04x %c %5d%%\n", -7, 42u, 0xbeefu, 'Z', 99);
+
+	frameEncoderBegin(&encoder, captureSink, &bytes);
+	TEST_EQUAL(2u * LOG_HEADER_WORDS + 2u + 5u, logFlush(&encoder));
+	TEST_EQUAL(2u, encoder.sequence);
+	TEST_CHECK(bytes > 0u);
+	TEST_EQUAL(0u, logFlush(&encoder));
+
+	if (capture != NULL) {
+		fclose(capture);
+		capture = NULL;
+	}
+}
+
+/**
+ * Times log call on simulated board and on host against snprintf
+ */
+static void benchCalls(void) {
+
+	char text[64];
+	uint64_t best = UINT64_MAX;
+	uint64_t bestPrintf = UINT64_MAX;
+
+	uint64_t start = simCycles();
+	LOG_DEFERRED("adc %u at %u us\n", 2048u, 1000u);
+	testMetric("log", "cycles_per_call", simCycles() - start);
+	logRead(0u, words, TEST_WORDS_MAX);
+
+	for (uint32_t run = 0; run < 8u; run++) {
+		start = testHostNS();
+		for (uint32_t i = 0; i < TEST_BENCH_CALLS; i++) {
+			LOG_DEFERRED("adc %u at %u us\n", i & 0xFFFu, i);
+			if ((i & 63u) == 63u) {
+				logRead(0u, words, TEST_WORDS_MAX);
+			}
+		}
+		logRead(0u, words, TEST_WORDS_MAX);
+		uint64_t taken = testHostNS() - start;
+		best = taken < best ? taken : best;
+
+		start = testHostNS();
+		for (uint32_t i = 0; i < TEST_BENCH_CALLS; i++) {
+			snprintf(text, sizeof(text), "adc %u at %u us\n", i & 0xFFFu, i);
+			__asm__ volatile("" : : "r"(text) : "memory");
+		}
+		taken = testHostNS() - start;
+		bestPrintf = taken < bestPrintf ? taken : bestPrintf;
+	}
+	// host time includes sim masking interrupts, board only pays cycles above
+	testHostMetric("log", "ps_per_call", best * 1000u / TEST_BENCH_CALLS);
+	testHostMetric("log", "printf_ps_per_call", bestPrintf * 1000u / TEST_BENCH_CALLS);
+}
+
+int main(int argc, char **argv) {
+
+	testRecords();
+	testFull();
+	benchCalls();
+	testFlush(argc > 1 ? argv[1] : NULL);
+
+	return testResult("log");
+}
\ No newline at end of file
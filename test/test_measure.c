@@ -0,0 +1,270 @@
+/*
+	test_measure.c - checks incremental measurements against a double precision reference
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <inherited/pico/board_pico_measure.h>
+
+#include <math.h>
+
+#include "test.h"
+
+#define TEST_SAMPLES 100000u // samples in each test signal
+#define TEST_CHUNK_MAX 1000u // largest buffer fed at once
+#define TEST_RATE 500000u // sample rate in Hz
+#define TEST_BENCH_RUNS 16u
+
+struct reference {
+	double min;
+	double max;
+	double mean;
+	double rms;
+	double acRms;
+};
+
+static uint32_t testSeed = 0x2545f491u;
+
+static sample_t samples[TEST_SAMPLES];
+
+static sample_t clampSample(double value) {
+	if (value < 0.0) {
+		return 0u;
+	}
+	if (value > SAMPLE_MAX) {
+		return SAMPLE_MAX;
+	}
+	return (sample_t)lround(value);
+}
+
+static double noise(uint32_t amount) {
+	return amount == 0u ? 0.0 : (double)(testRandom(&testSeed) % (2u * amount + 1u)) - amount;
+}
+
+/**
+ * Fills samples with sine
+ *
+ * @param offset DC level
+ * @param amplitude peak amplitude
+ * @param hz sine frequency
+ * @param noiseAmount largest noise either side of sine
+ */
+static void makeSine(double offset, double amplitude, double hz, uint32_t noiseAmount) {
+	for (uint32_t i = 0; i < TEST_SAMPLES; i++) {
+		samples[i] = clampSample(offset + amplitude * sin(2.0 * M_PI * hz * i / TEST_RATE) + noise(noiseAmount));
+	}
+}
+
+/**
+ * Fills samples with pulse wave starting low
+ *
+ * @param low low level
+ * @param high high level
+ * @param period samples per period
+ * @param highSamples samples per period spent high
+ * @param noiseAmount largest noise either side of levels
+ */
+static void makePulse(double low, double high, uint32_t period, uint32_t highSamples, uint32_t noiseAmount) {
+	for (uint32_t i = 0; i < TEST_SAMPLES; i++) {
+		samples[i] = clampSample((i % period >= period - highSamples ? high : low) + noise(noiseAmount));
+	}
+}
+
+/**
+ * Measures samples directly in double precision
+ */
+static void referenceMeasure(struct reference *ref) {
+
+	double sum = 0.0;
+	double squares = 0.0;
+
+	ref->min = SAMPLE_MAX;
+	ref->max = 0.0;
+	for (uint32_t i = 0; i < TEST_SAMPLES; i++) {
+		double sample = samples[i];
+		ref->min = fmin(ref->min, sample);
+		ref->max = fmax(ref->max, sample);
+		sum += sample;
+		squares += sample * sample;
+	}
+	ref->mean = sum / TEST_SAMPLES;
+	ref->rms = sqrt(squares / TEST_SAMPLES);
+	ref->acRms = sqrt(fmax(squares / TEST_SAMPLES - ref->mean * ref->mean, 0.0));
+}
+
+/**
+ * Feeds samples in random chunks
+ */
+static void feedChunks(struct measureState *state) {
+
+	uint32_t index = 0u;
+
+	while (index < TEST_SAMPLES) {
+		uint32_t chunk = 1u + testRandom(&testSeed) % TEST_CHUNK_MAX;
+		if (chunk > TEST_SAMPLES - index) {
+			chunk = TEST_SAMPLES - index;
+		}
+		measureFeed(state, samples + index, chunk);
+		index += chunk;
+	}
+}
+
+/**
+ * Checks amplitude results against reference
+ */
+static void checkAmplitude(const struct measureResults *results) {
+
+	struct reference ref;
+
+	referenceMeasure(&ref);
+	TEST_EQUAL(ref.min, results->min);
+	TEST_EQUAL(ref.max, results->max);
+	TEST_EQUAL(ref.max - ref.min, results->peakToPeak);
+	TEST_NEAR(ref.mean, results->mean, 0.5);
+	TEST_NEAR(ref.rms, results->rms, 0.51);
+	TEST_NEAR(ref.acRms, results->acRms, 0.51);
+}
+
+/**
+ * Checks timing results against signal made
+ *
+ * @param hz frequency of signal
+ * @param duty fraction of period spent high
+ * @param jitter samples noise can move a crossing by
+ */
+static void checkTiming(const struct measureResults *results, double hz, double duty, double jitter) {
+
+	// crossings land on whole samples and first period is spent arming,
+	// so span of whole periods is off by a sample plus jitter at each end
+	const double span = (floor(TEST_SAMPLES * hz / TEST_RATE) - 2.0) * TEST_RATE / hz;
+	const double tolerance = (1.0 + 2.0 * jitter) / span;
+
+	TEST_NEAR(hz * 1000.0, results->frequencyMilliHz, hz * 1000.0 * tolerance + 1.0);
+	TEST_NEAR(1e9 / hz, results->periodNs, 1e9 / hz * tolerance + 1.0);
+	// sample on level counts as high, biasing duty by up to half a sample a period
+	TEST_NEAR(duty * MEASURE_DUTY_SCALE, results->duty, MEASURE_DUTY_SCALE * (tolerance + (0.5 + jitter) * hz / TEST_RATE) + 1.0);
+}
+
+static void testSine(void) {
+
+	static const double rates[] = {50.0, 1000.0, 3333.3, 12500.0, 41000.0};
+	struct measureState state;
+	struct measureResults results;
+
+	for (uint32_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+		makeSine(2048.0, 1500.0, rates[r], 20u);
+		measureBegin(&state, 2048u, 200u);
+		feedChunks(&state);
+		TEST_CHECK(measureGetResults(&state, TEST_RATE, &results));
+		checkAmplitude(&results);
+		// noise over slope at crossing
+		checkTiming(&results, rates[r], 0.5, 20.0 / (1500.0 * 2.0 * M_PI * rates[r] / TEST_RATE));
+	}
+
+	// full scale keeps sums in range
+	makeSine(2048.0, 2047.0, 1000.0, 0u);
+	measureBegin(&state, 2048u, 200u);
+	feedChunks(&state);
+	TEST_CHECK(measureGetResults(&state, TEST_RATE, &results));
+	checkAmplitude(&results);
+	TEST_EQUAL(SAMPLE_MAX, results.peakToPeak + 1u);
+}
+
+static void testPulse(void) {
+
+	static const double duties[] = {0.1, 0.2, 0.5, 0.9}; // whole samples of 250 sample period
+	struct measureState state;
+	struct measureResults results;
+
+	for (uint32_t d = 0; d < sizeof(duties) / sizeof(duties[0]); d++) {
+		makePulse(300.0, 3700.0, TEST_RATE / 2000u, (uint32_t)(duties[d] * TEST_RATE / 2000u), 50u);
+		measureBegin(&state, 0u, 0u);
+		measureFeed(&state, samples, TEST_SAMPLES / 10u);
+
+		// level found from first tenth of signal
+		measureRestartAuto(&state, 500u);
+		TEST_NEAR(2000.0, state.level, 60.0);
+		feedChunks(&state);
+		TEST_CHECK(measureGetResults(&state, TEST_RATE, &results));
+		checkAmplitude(&results);
+		checkTiming(&results, 2000.0, duties[d], 0.0);
+	}
+}
+
+static void testEdges(void) {
+
+	struct measureState state;
+	struct measureResults results;
+	const sample_t flat[4] = {1000u, 1000u, 1000u, 1000u};
+
+	measureBegin(&state, 2000u, 100u);
+	TEST_CHECK(!measureGetResults(&state, TEST_RATE, &results));
+
+	// no crossing leaves timing at 0
+	measureFeed(&state, flat, 4u);
+	TEST_CHECK(measureGetResults(&state, TEST_RATE, &results));
+	TEST_EQUAL(1000u, results.mean);
+	TEST_EQUAL(1000u, results.rms);
+	TEST_EQUAL(0u, results.acRms);
+	TEST_EQUAL(0u, results.frequencyMilliHz);
+	TEST_EQUAL(0u, results.periodNs);
+
+	// hysteresis can't go below 0
+	measureBegin(&state, 50u, 100u);
+	TEST_EQUAL(50u, state.hysteresis);
+
+	TEST_EQUAL(0u, measureCodeToMV(0u));
+	TEST_EQUAL(ADC_REF_MV, measureCodeToMV(SAMPLE_MAX));
+	TEST_EQUAL(ADC_REF_MV / 2u, measureCodeToMV(SAMPLE_MAX / 2u));
+}
+
+/**
+ * Times one pass against reference doing the same in double
+ */
+static void benchFeed(void) {
+
+	struct measureState state;
+	struct reference ref;
+	uint64_t best = UINT64_MAX;
+	uint64_t refBest = UINT64_MAX;
+
+	makeSine(2048.0, 1500.0, 1000.0, 20u);
+	for (uint32_t run = 0; run < TEST_BENCH_RUNS; run++) {
+		measureBegin(&state, 2048u, 200u);
+		uint64_t start = testHostNS();
+		measureFeed(&state, samples, TEST_SAMPLES);
+		uint64_t taken = testHostNS() - start;
+		best = taken < best ? taken : best;
+
+		start = testHostNS();
+		referenceMeasure(&ref);
+		taken = testHostNS() - start;
+		refBest = taken < refBest ? taken : refBest;
+	}
+	TEST_EQUAL(TEST_SAMPLES, state.count);
+
+	testHostMetric("measure", "ps_per_sample", best * 1000u / TEST_SAMPLES);
+	testHostMetric("measure", "reference_ps_per_sample", refBest * 1000u / TEST_SAMPLES);
+}
+
+int main(void) {
+
+	testEdges();
+	testSine();
+	testPulse();
+	benchFeed();
+
+	return testResult("measure");
+}
\ No newline at end of file
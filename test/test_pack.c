@@ -0,0 +1,192 @@
+/*
+	test_pack.c - checks packed samples round trip and times pack and unpack
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <inherited/pico/board_pico_pack.h>
+
+#include <string.h>
+
+#include "test.h"
+
+#define TEST_SAMPLES 65536u // samples in each test signal
+#define TEST_CHUNK_MAX 333u // largest DMA buffer packed at once
+#define TEST_READS 4096u // random runs read back
+#define TEST_BENCH_RUNS 32u
+
+static uint32_t testSeed = 0x3c6ef372u;
+
+static sample_t samples[TEST_SAMPLES];
+static sample_t unpacked[TEST_SAMPLES];
+static uint8_t storage[TEST_SAMPLES * 2u + 4u] __attribute__((aligned(4)));
+
+/**
+ * Gets sample as 8 bit mode gives it back
+ */
+static sample_t expected8(sample_t sample) {
+	uint32_t byte = sample >> (SAMPLE_BITS - 8);
+	return (sample_t)((byte << (SAMPLE_BITS - 8)) | (byte >> (16 - SAMPLE_BITS)));
+}
+
+static sample_t expectedSample(enum PackMode mode, sample_t sample) {
+	return mode == PACK_8_BIT ? expected8(sample) : sample;
+}
+
+/**
+ * Packs every sample in random chunks then reads them back
+ * every way storage can be read
+ *
+ * @param mode storage format
+ * @param offset bytes storage starts past a word
+ */
+static void checkRoundTrip(enum PackMode mode, uint32_t offset) {
+
+	struct packedSamples packed;
+	uint32_t index = 0u;
+
+	for (uint32_t i = 0; i < TEST_SAMPLES; i++) {
+		samples[i] = (sample_t)(testRandom(&testSeed) & SAMPLE_MAX);
+	}
+
+	memset(storage, 0xA5, sizeof(storage));
+	TEST_CHECK(packBegin(&packed, storage + offset, packBytes(mode, TEST_SAMPLES), mode));
+	TEST_EQUAL(TEST_SAMPLES, packed.capacity);
+	while (index < TEST_SAMPLES) {
+		uint32_t chunk = 1u + testRandom(&testSeed) % TEST_CHUNK_MAX;
+		if (chunk > TEST_SAMPLES - index) {
+			chunk = TEST_SAMPLES - index;
+		}
+		TEST_EQUAL(chunk, packAppend(&packed, samples + index, chunk));
+		index += chunk;
+	}
+	TEST_EQUAL(TEST_SAMPLES, packed.count);
+
+	// full storage takes nothing more and nothing past it is touched
+	TEST_EQUAL(0u, packAppend(&packed, samples, 1u));
+	TEST_EQUAL(0xA5u, storage[offset + packBytes(mode, TEST_SAMPLES)]);
+
+	memset(unpacked, 0, sizeof(unpacked));
+	TEST_EQUAL(TEST_SAMPLES, packRead(&packed, 0u, unpacked, TEST_SAMPLES));
+	for (uint32_t i = 0; i < TEST_SAMPLES; i++) {
+		if (unpacked[i] != expectedSample(mode, samples[i])) {
+			TEST_EQUAL(expectedSample(mode, samples[i]), unpacked[i]);
+			fprintf(stderr, "mode %d offset %u sample %u\n", mode, offset, i);
+			break;
+		}
+	}
+
+	// random runs and single samples for trigger and measurement
+	for (uint32_t r = 0; r < TEST_READS; r++) {
+		uint32_t start = testRandom(&testSeed) % TEST_SAMPLES;
+		uint32_t count = 1u + testRandom(&testSeed) % 100u;
+		uint32_t expected = count < TEST_SAMPLES - start ? count : TEST_SAMPLES - start;
+		TEST_EQUAL(expected, packRead(&packed, start, unpacked, count));
+		for (uint32_t i = 0; i < expected; i++) {
+			if (unpacked[i] != expectedSample(mode, samples[start + i])) {
+				TEST_EQUAL(expectedSample(mode, samples[start + i]), unpacked[i]);
+				break;
+			}
+		}
+		TEST_EQUAL(expectedSample(mode, samples[start]), packGet(&packed, start));
+	}
+	TEST_EQUAL(0u, packGet(&packed, TEST_SAMPLES));
+	TEST_EQUAL(0u, packRead(&packed, TEST_SAMPLES, unpacked, 1u));
+}
+
+static void testSizes(void) {
+
+	struct packedSamples packed;
+	const sample_t odd[3] = {0x123u, 0xABCu, 0xFFFu};
+	sample_t out[3];
+
+	TEST_EQUAL(0u, packBytes(PACK_12_BIT, 0u));
+	TEST_EQUAL(2u, packBytes(PACK_12_BIT, 1u));
+	TEST_EQUAL(3u, packBytes(PACK_12_BIT, 2u));
+	TEST_EQUAL(5u, packBytes(PACK_12_BIT, 3u));
+	TEST_EQUAL(1500u, packBytes(PACK_12_BIT, 1000u));
+	TEST_EQUAL(1000u, packBytes(PACK_8_BIT, 1000u));
+
+	TEST_CHECK(!packBegin(NULL, storage, 3u, PACK_12_BIT));
+	TEST_CHECK(!packBegin(&packed, NULL, 3u, PACK_12_BIT));
+
+	// byte left over after a pair can't hold a sample
+	TEST_CHECK(packBegin(&packed, storage, 4u, PACK_12_BIT));
+	TEST_EQUAL(2u, packed.capacity);
+	TEST_CHECK(packBegin(&packed, storage, 5u, PACK_12_BIT));
+	TEST_EQUAL(3u, packed.capacity);
+
+	// odd sample carries into next append, bit layout as documented
+	TEST_EQUAL(1u, packAppend(&packed, odd, 1u));
+	TEST_EQUAL(2u, packAppend(&packed, odd + 1, 3u));
+	TEST_EQUAL(0x23u, storage[0]);
+	TEST_EQUAL(0xC1u, storage[1]);
+	TEST_EQUAL(0xABu, storage[2]);
+	TEST_EQUAL(3u, packRead(&packed, 0u, out, 3u));
+	TEST_CHECK(memcmp(odd, out, sizeof(odd)) == 0);
+
+	packClear(&packed);
+	TEST_EQUAL(0u, packed.count);
+	TEST_EQUAL(0u, packGet(&packed, 0u));
+
+	// 8 bit mode keeps full scale at full scale
+	TEST_CHECK(packBegin(&packed, storage, 3u, PACK_8_BIT));
+	TEST_EQUAL(3u, packAppend(&packed, odd, 3u));
+	TEST_EQUAL(SAMPLE_MAX, packGet(&packed, 2u));
+	TEST_EQUAL(0x121u, packGet(&packed, 0u));
+}
+
+/**
+ * Times pack and unpack of whole signal in DMA sized chunks
+ */
+static void benchMode(enum PackMode mode, const char *scenario) {
+
+	struct packedSamples packed;
+	uint64_t bestPack = UINT64_MAX;
+	uint64_t bestUnpack = UINT64_MAX;
+
+	for (uint32_t run = 0; run < TEST_BENCH_RUNS; run++) {
+		packBegin(&packed, storage, sizeof(storage), mode);
+		uint64_t start = testHostNS();
+		for (uint32_t i = 0; i < TEST_SAMPLES; i += 1024u) {
+			packAppend(&packed, samples + i, 1024u);
+		}
+		uint64_t taken = testHostNS() - start;
+		bestPack = taken < bestPack ? taken : bestPack;
+
+		start = testHostNS();
+		packRead(&packed, 0u, unpacked, TEST_SAMPLES);
+		taken = testHostNS() - start;
+		bestUnpack = taken < bestUnpack ? taken : bestUnpack;
+	}
+	TEST_EQUAL(TEST_SAMPLES, packed.count);
+
+	testHostMetric(scenario, "pack_msamples_per_s", bestPack > 0u ? TEST_SAMPLES * 1000ull / bestPack : 0u);
+	testHostMetric(scenario, "unpack_msamples_per_s", bestUnpack > 0u ? TEST_SAMPLES * 1000ull / bestUnpack : 0u);
+}
+
+int main(void) {
+
+	testSizes();
+	for (uint32_t offset = 0; offset < 4u; offset++) {
+		checkRoundTrip(PACK_12_BIT, offset);
+		checkRoundTrip(PACK_8_BIT, offset);
+	}
+	testMetric("pack", "bytes_per_1000_samples", packBytes(PACK_12_BIT, 1000u));
+	benchMode(PACK_12_BIT, "pack_12");
+	benchMode(PACK_8_BIT, "pack_8");
+
+	return testResult("pack");
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+/*
+	test_perf.c - runs perf scenarios on the simulated board
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+#include <nvm/nvm.h>
+#include <comm/hard_serial/hard_serial.h>
+
+#include <inherited/pico/board_pico_nvm.h>
+#include <inherited/pico/board_pico_perf.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_PIN 15u // output toggled by GPIO scenario
+#define TEST_BAUD 115200u
+
+int main(void) {
+
+	struct perfTimerResult timer;
+	struct simFlashStats flash;
+
+	hardPrintBegin(TEST_BAUD);
+	hardPinMode(TEST_PIN, PIN_MODE_OUTPUT);
+
+	// commits need NVM, scenario skips them before it starts
+	TEST_CHECK(!nvmStarted());
+	TEST_EQUAL(NVM_OK, nvmInit(FLASH_NVM_SIZE));
+	TEST_CHECK(nvmStarted());
+
+	TEST_CHECK(perfRunAll(TEST_PIN));
+	simFlashGetStats(&flash);
+	TEST_EQUAL(PERF_TIMER_COMMITS, flash.erases);
+	// first write is low, which pin already is
+	TEST_EQUAL(PERF_GPIO_WRITES - 1u, simGPIOChanges(TEST_PIN));
+
+	// period is set before first tick, so a clean run drops nothing
+	TEST_CHECK(perfTimerScenario(&timer, 1000u, 100u, 0u));
+	TEST_EQUAL(1000u, timer.freq);
+	TEST_EQUAL(100u, timer.expected);
+	TEST_CHECK(timer.fired >= 99u);
+	TEST_EQUAL(0u, timer.dropped);
+
+	TEST_CHECK(!perfTimerScenario(&timer, 0u, 100u, 0u));
+
+	return testResult("perf");
+}
\ No newline at end of file
@@ -0,0 +1,270 @@
+/*
+	test_serial.c - checks DMA serial through a pseudo terminal, times writes
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+#include <comm/hard_serial/hard_serial.h>
+
+#include <inherited/pico/board_pico_serial.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_BYTES 65536u // bytes sent in throughput test
+#define TEST_CHUNK 256u // bytes in each write
+#define TEST_LINE 16u // bytes in each interrupt or main line
+#define TEST_IRQ_CYCLES 100u // cycles of main write interrupt is swept over
+
+static uint8_t sent[TEST_BYTES];
+static uint8_t received[TEST_BYTES];
+static uint32_t receivedLength = 0u;
+static int ptyFD = -1;
+
+static uint32_t testSeed = 0x510e527fu;
+
+/**
+ * Reads whatever terminal has so its buffer never fills
+ */
+static void drainPty(void) {
+	while (ptyFD >= 0 && receivedLength < TEST_BYTES) {
+		ssize_t got = read(ptyFD, received + receivedLength, TEST_BYTES - receivedLength);
+		if (got <= 0) {
+			return;
+		}
+		receivedLength += (uint32_t)got;
+	}
+}
+
+/**
+ * Waits for terminal to pass on bytes already shifted out
+ *
+ * @param expected total bytes to wait for
+ */
+static void waitPty(uint32_t expected) {
+
+	struct pollfd ready = {ptyFD, POLLIN, 0};
+
+	drainPty();
+	while (receivedLength < expected && poll(&ready, 1u, 1000) > 0) {
+		drainPty();
+	}
+}
+
+/**
+ * Sends random bytes at a baud and checks they come out the terminal
+ */
+static void checkThroughput(uint32_t baud, const char *scenario) {
+
+	struct serialStats before;
+	struct serialStats after;
+	uint32_t index = 0u;
+
+	hardPrintBegin(baud);
+	serialGetStats(&before);
+	TEST_NEAR(baud, before.baud, baud * 0.02);
+
+	for (uint32_t i = 0; i < TEST_BYTES; i++) {
+		sent[i] = (uint8_t)testRandom(&testSeed);
+	}
+	simUARTClear();
+	receivedLength = 0u;
+
+	const uint64_t start = simNowNS();
+	while (index < TEST_BYTES) {
+		// waits for space like a caller that can't drop bytes
+		while (serialFree() < TEST_CHUNK) {
+			simRunUS(TEST_CHUNK * 10u * 1000000u / baud / 4u + 1u);
+			drainPty();
+		}
+		index += serialWrite(sent + index, TEST_CHUNK);
+		drainPty();
+	}
+	// flush spins a cycle at a time, sim gets there faster in steps
+	while (serialPending() > TEST_CHUNK) {
+		simRunUS(TEST_CHUNK * 10u * 1000000u / baud / 4u + 1u);
+		drainPty();
+	}
+	serialFlush();
+	const uint64_t taken = simNowNS() - start;
+	waitPty(TEST_BYTES);
+
+	serialGetStats(&after);
+	TEST_EQUAL(TEST_BYTES, after.queued - before.queued);
+	TEST_EQUAL(TEST_BYTES, after.sent - before.sent);
+	TEST_EQUAL(before.dropped, after.dropped);
+	TEST_EQUAL(TEST_BYTES, receivedLength);
+	TEST_CHECK(memcmp(sent, received, TEST_BYTES) == 0);
+
+	// DMA keeps UART busy, line time is the only cost,
+	// sim rounds each byte down to whole ns
+	const uint64_t lineNS = (uint64_t)TEST_BYTES * 10u * 1000000000u / after.baud;
+	TEST_CHECK(taken * 1000u >= lineNS * 999u);
+	testMetric(scenario, "idle_permille", taken > lineNS ? (taken - lineNS) * 1000u / lineNS : 0u);
+	testHostMetric(scenario, "kbytes_per_s", TEST_BYTES * 1000000ull / taken);
+}
+
+/**
+ * Times caller side of writes while DMA is sending
+ */
+static void checkLatency(void) {
+
+	uint8_t line[TEST_LINE];
+	uint64_t total = 0u;
+	uint64_t worst = 0u;
+	uint32_t writes = 0u;
+
+	hardPrintBegin(921600u);
+	receivedLength = 0u;
+	memset(line, '.', sizeof(line));
+	for (uint32_t i = 0; i < 1000u; i++) {
+		if (serialFree() < TEST_LINE) {
+			simRunUS(100u);
+			drainPty();
+			continue;
+		}
+		const uint64_t start = simCycles();
+		TEST_EQUAL(TEST_LINE, serialWrite(line, TEST_LINE));
+		const uint64_t taken = simCycles() - start;
+		total += taken;
+		worst = taken > worst ? taken : worst;
+		writes++;
+		drainPty();
+	}
+	serialFlush();
+	waitPty(writes * TEST_LINE);
+
+	TEST_EQUAL(writes * TEST_LINE, receivedLength);
+	TEST_CHECK(writes > 0u);
+	// a blocking write at this baud would take 170 us
+	TEST_CHECK(worst < 1000u);
+	testMetric("serial_pty", "enqueue_cycles_average", total / writes);
+	testMetric("serial_pty", "enqueue_cycles_max", worst);
+}
+
+/**
+ * Writes a numbered line from interrupt
+ */
+static int64_t irqWrite(alarm_id_t id, void *param) {
+
+	uint32_t *count = (uint32_t*)param;
+	uint8_t line[TEST_LINE + 1u];
+
+	(void)id;
+	snprintf((char*)line, sizeof(line), "I%014u\n", *count);
+	if (serialWrite(line, TEST_LINE) == TEST_LINE) {
+		(*count)++;
+	}
+	return 0;
+}
+
+/**
+ * Checks every line is whole when an interrupt writes in the middle of a write
+ */
+static void checkInterrupts(void) {
+
+	struct serialStats before;
+	struct serialStats after;
+	uint32_t irqLines = 0u;
+	uint32_t mainLines = 0u;
+	uint8_t line[TEST_LINE + 1u];
+	const uint32_t cyclesPerUS = clock_get_hz(clk_sys) / 1000000u;
+
+	hardPrintBegin(3000000u);
+	serialFlush();
+	serialGetStats(&before);
+	simUARTClear();
+	receivedLength = 0u;
+
+	// alarm lands a cycle later into main write each time round
+	for (uint32_t offset = 0; offset < TEST_IRQ_CYCLES; offset++) {
+		while (serialFree() < 2u * TEST_LINE) {
+			simRunUS(10u);
+			drainPty();
+		}
+		TEST_CHECK(add_alarm_in_us(1u, irqWrite, &irqLines, true) > 0);
+		simCharge(cyclesPerUS - offset);
+		snprintf((char*)line, sizeof(line), "M%014u\n", mainLines);
+		if (serialWrite(line, TEST_LINE) == TEST_LINE) {
+			mainLines++;
+		}
+		simRunUS(2u);
+		drainPty();
+	}
+	serialFlush();
+	serialGetStats(&after);
+	waitPty(after.queued - before.queued);
+
+	TEST_EQUAL(TEST_IRQ_CYCLES, irqLines);
+
+	// lines can interleave but never mix
+	uint32_t length;
+	const uint8_t *output = simUARTOutput(&length);
+	uint32_t nextMain = 0u;
+	uint32_t nextIRQ = 0u;
+	uint32_t broken = 0u;
+	TEST_EQUAL(after.queued - before.queued, length);
+	TEST_EQUAL(length, receivedLength);
+	for (uint32_t i = 0; i + TEST_LINE <= length; i += TEST_LINE) {
+		char text[TEST_LINE + 1u];
+		unsigned number = 0u;
+		memcpy(text, output + i, TEST_LINE);
+		text[TEST_LINE] = '\0';
+		if (text[TEST_LINE - 1u] != '\n' || sscanf(text + 1, "%14u", &number) != 1) {
+			broken++;
+		}
+		else if (text[0] == 'M' && number == nextMain) {
+			nextMain++;
+		}
+		else if (text[0] == 'I' && number == nextIRQ) {
+			nextIRQ++;
+		}
+		else {
+			broken++;
+		}
+	}
+	TEST_EQUAL(0u, length % TEST_LINE);
+	TEST_EQUAL(TEST_IRQ_CYCLES, nextMain);
+	TEST_EQUAL(irqLines, nextIRQ);
+	TEST_EQUAL(0u, broken);
+	testMetric("serial_irq", "broken_lines", broken);
+}
+
+int main(void) {
+
+	char name[64];
+
+	TEST_CHECK(simUARTOpenPty(name, sizeof(name)));
+	ptyFD = open(name, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+	TEST_CHECK(ptyFD >= 0);
+
+	// nothing queued before start
+	TEST_EQUAL(0u, serialWrite((const uint8_t*)"x", 1u));
+
+	checkThroughput(115200u, "serial_115200");
+	checkThroughput(921600u, "serial_921600");
+	checkThroughput(3000000u, "serial_3000000");
+	checkLatency();
+	checkInterrupts();
+
+	close(ptyFD);
+	return testResult("serial");
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+/*
+	test_timer.c - checks batched timer schedule and its overhead against a timer per period
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+
+#include <inherited/pico/board_pico_timer.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_FREQ 10000u // periods per second
+#define TEST_RUN_MS 100u // time each timer runs
+
+static const uint32_t blockCounts[] = {1u, 4u, 16u, 64u};
+
+static uint32_t periods = 0u;
+static uint32_t blocks = 0u;
+static uint64_t nextFirst = 0u;
+static uint32_t worstLateUS = 0u;
+
+/**
+ * Counts one period
+ */
+static hard_timer_return_t countPeriod(hard_timer_param_t emptyParams) {
+	(void)emptyParams;
+	periods++;
+	HARD_TIMER_END();
+}
+
+/**
+ * Counts block of periods and checks it follows on from the last
+ */
+static bool countBlock(const struct hardTimerBatch *batch) {
+	if (blocks > 0u) {
+		TEST_EQUAL(nextFirst, batch->first);
+	}
+	TEST_EQUAL(hardTimerBatchTime(batch, 1u) - batch->first, batch->periodUS);
+	nextFirst = batch->first + (uint64_t)batch->periodUS * batch->count;
+	worstLateUS = batch->lateUS > worstLateUS ? batch->lateUS : worstLateUS;
+	periods += batch->count;
+	blocks++;
+	return true;
+}
+
+/**
+ * Runs timer and gets interrupt cycles per period
+ *
+ * @param count periods per block, 0 for a timer per period
+ */
+static uint64_t runTimer(uint32_t count) {
+
+	hard_timer_t timer = HARD_TIMER_INVALID;
+	freq_t freq = TEST_FREQ;
+
+	periods = 0u;
+	blocks = 0u;
+	worstLateUS = 0u;
+
+	const uint64_t startCycles = simInterruptCyclesSpent();
+	if (count == 0u) {
+		TEST_CHECK(setHardTimer(&timer, &freq, countPeriod, 0u));
+	}
+	else {
+		TEST_CHECK(setHardTimerBatched(&timer, &freq, count, countBlock, NULL));
+	}
+	TEST_EQUAL(TEST_FREQ, freq);
+	simRunUS(TEST_RUN_MS * 1000u);
+	TEST_CHECK(cancelHardTimer(timer));
+	const uint64_t cycles = simInterruptCyclesSpent() - startCycles;
+
+	// whole blocks only, none lost, late by no more than the us the alarm rounds up to
+	const uint32_t expected = TEST_RUN_MS * TEST_FREQ / 1000u;
+	const uint32_t perBlock = count == 0u ? 1u : count;
+	TEST_EQUAL(expected / perBlock * perBlock, periods);
+	TEST_CHECK(worstLateUS <= 1u);
+	return periods > 0u ? cycles / periods : 0u;
+}
+
+int main(void) {
+
+	char scenario[32];
+
+	// stopped timers don't fire
+	TEST_CHECK(!cancelHardTimer(HARD_TIMER_INVALID));
+	hard_timer_t timer = HARD_TIMER_INVALID;
+	freq_t freq = TEST_FREQ;
+	TEST_CHECK(!setHardTimerBatched(&timer, &freq, 0u, countBlock, NULL));
+	TEST_CHECK(!setHardTimerBatched(&timer, &freq, HARD_TIMER_BATCH_MAX + 1u, countBlock, NULL));
+
+	const uint64_t single = runTimer(0u);
+	testMetric("timer_single", "irq_cycles_per_period", single);
+	for (uint32_t i = 0; i < sizeof(blockCounts) / sizeof(blockCounts[0]); i++) {
+		const uint64_t batched = runTimer(blockCounts[i]);
+		TEST_CHECK(blockCounts[i] == 1u || batched < single);
+		snprintf(scenario, sizeof(scenario), "timer_batch%u", blockCounts[i]);
+		testMetric(scenario, "irq_cycles_per_period", batched);
+	}
+
+	return testResult("timer");
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+/*
+	test_trace.c - checks trace rings and frames trace_to_json.py reads
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#define TRACE_ENABLED
+
+#include <board_common.h>
+
+#include <inherited/pico/board_pico_threads.h>
+#include <inherited/pico/board_pico_trace.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_RECORDS_MAX (TRACE_BUFFER_RECORDS * 2u)
+#define TEST_ACQUIRE TRACE_USER // sketch event named in trace_names.txt
+
+static struct traceRecord records[TEST_RECORDS_MAX];
+static FILE *capture = NULL;
+
+/**
+ * Writes frames to capture file for trace_to_json.py
+ */
+static void captureSink(const uint8_t *data, uint32_t length, void *context) {
+	uint32_t *bytes = (uint32_t*)context;
+	if (capture != NULL) {
+		fwrite(data, 1u, length, capture);
+	}
+	*bytes += length;
+}
+
+static void testRecords(void) {
+
+	struct traceStats before;
+	struct traceStats after;
+
+	traceGetStats(0u, &before);
+	const uint32_t start = time_us_32();
+	TRACE_BEGIN(TRACE_TIMER + 3u);
+	simRunUS(25u);
+	TRACE_END(TRACE_TIMER + 3u);
+	traceGetStats(0u, &after);
+	TEST_EQUAL(2u, after.records - before.records);
+
+	TEST_EQUAL(2u, traceRead(0u, records, TEST_RECORDS_MAX));
+	TEST_EQUAL((uint32_t)TRACE_PHASE_BEGIN << TRACE_PHASE_SHIFT | (TRACE_TIMER + 3u), records[0].event);
+	TEST_EQUAL((uint32_t)TRACE_PHASE_END << TRACE_PHASE_SHIFT | (TRACE_TIMER + 3u), records[1].event);
+	TEST_CHECK(records[0].time >= start);
+	TEST_CHECK(records[1].time - records[0].time >= 25u);
+
+	// reads stop at what was asked for and carry on after
+	TRACE_BEGIN(TEST_ACQUIRE);
+	TRACE_END(TEST_ACQUIRE);
+	TEST_EQUAL(1u, traceRead(0u, records, 1u));
+	TEST_EQUAL(1u, traceRead(0u, records + 1, TEST_RECORDS_MAX));
+	TEST_EQUAL(TRACE_PHASE_END, records[1].event >> TRACE_PHASE_SHIFT);
+	TEST_EQUAL(0u, traceRead(0u, records, TEST_RECORDS_MAX));
+	TEST_EQUAL(0u, traceRead(2u, records, TEST_RECORDS_MAX));
+	TEST_EQUAL(0u, traceRead(0u, NULL, TEST_RECORDS_MAX));
+}
+
+static void testFull(void) {
+
+	struct traceStats before;
+	struct traceStats after;
+
+	traceGetStats(0u, &before);
+	for (uint32_t i = 0; i < TRACE_BUFFER_RECORDS + 10u; i++) {
+		TRACE_BEGIN(TEST_ACQUIRE + i);
+	}
+	traceGetStats(0u, &after);
+	TEST_EQUAL(TRACE_BUFFER_RECORDS, after.records - before.records);
+	TEST_EQUAL(10u, after.dropped - before.dropped);
+
+	// oldest records are kept, newest dropped
+	TEST_EQUAL(TRACE_BUFFER_RECORDS, traceRead(0u, records, TEST_RECORDS_MAX));
+	TEST_EQUAL(TEST_ACQUIRE, records[0].event & 0xFFFFu);
+	TEST_EQUAL(TEST_ACQUIRE + TRACE_BUFFER_RECORDS - 1u, records[TRACE_BUFFER_RECORDS - 1u].event & 0xFFFFu);
+}
+
+/**
+ * Traces from core 1 into its own ring
+ */
+static void core1Trace(void *param) {
+	volatile bool *done = (volatile bool*)param;
+	TRACE_BEGIN(TRACE_NVM_COMMIT);
+	simRunUS(100u);
+	TRACE_END(TRACE_NVM_COMMIT);
+	*done = true;
+}
+
+/**
+ * Sends records of both cores as frames, to capture file when given
+ */
+static void testFlush(const char *path) {
+
+	struct frameEncoder encoder;
+	volatile bool done = false;
+	uint32_t bytes = 0u;
+
+	if (path != NULL) {
+		capture = fopen(path, "wb");
+		TEST_CHECK(capture != NULL);
+	}
+
+	TEST_CHECK(core1Begin());
+	TEST_CHECK(core1Queue(core1Trace, (void*)&done));
+	TRACE_BEGIN(TEST_ACQUIRE);
+	while (!done) {
+		tight_loop_contents();
+	}
+	TRACE_END(TEST_ACQUIRE);
+
+	frameEncoderBegin(&encoder, captureSink, &bytes);
+	TEST_EQUAL(4u, traceFlush(&encoder));
+	TEST_EQUAL(2u, encoder.sequence);
+	TEST_CHECK(bytes > 4u * sizeof(struct traceRecord));
+	TEST_EQUAL(0u, traceFlush(&encoder));
+
+	if (capture != NULL) {
+		fclose(capture);
+		capture = NULL;
+	}
+}
+
+/**
+ * Times tracepoint on simulated board
+ */
+static void benchWrite(void) {
+
+	const uint64_t start = simCycles();
+	TRACE_BEGIN(TEST_ACQUIRE);
+	testMetric("trace", "cycles_per_record", simCycles() - start);
+	traceRead(0u, records, TEST_RECORDS_MAX);
+}
+
+int main(int argc, char **argv) {
+
+	testRecords();
+	testFull();
+	benchWrite();
+	testFlush(argc > 1 ? argv[1] : NULL);
+
+	return testResult("trace");
+}
\ No newline at end of file
@@ -0,0 +1,473 @@
+/*
+	test_trigger.c - checks trigger search against a sample by sample reference
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <inherited/pico/board_pico_trigger.h>
+
+#include <math.h>
+#include <string.h>
+
+#include "test.h"
+
+#define TEST_SAMPLES 4096u // samples in each synthetic waveform
+#define TEST_RANDOM_RUNS 400u // random configurations checked against reference
+#define TEST_BENCH_SAMPLES (1u << 20) // samples scanned by benchmark
+#define TEST_BENCH_RUNS 16u
+
+#define REF_ARM 0u
+#define REF_READY 1u
+#define REF_PULSE 2u
+
+struct refSearch {
+	uint32_t phase;
+	uint32_t holdoffLeft;
+	uint32_t pulseLength;
+};
+
+static uint32_t testSeed = 0x12345678u;
+
+static uint32_t testRange(uint32_t low, uint32_t high) {
+	return low + testRandom(&testSeed) % (high - low + 1u);
+}
+
+static bool armsHigh(const struct triggerConfig *config) {
+	return config->mode == TRIGGER_FALLING || (config->mode == TRIGGER_PULSE_WIDTH && !config->pulsePositive);
+}
+
+static bool refArmed(const struct triggerConfig *config, uint32_t sample) {
+	if (config->mode == TRIGGER_WINDOW) {
+		return sample >= config->windowLow + config->hysteresis && sample <= config->windowHigh - config->hysteresis;
+	}
+	if (armsHigh(config)) {
+		return sample > config->level + config->hysteresis;
+	}
+	return sample + config->hysteresis < config->level;
+}
+
+static bool refReady(const struct triggerConfig *config, uint32_t sample) {
+	if (config->mode == TRIGGER_WINDOW) {
+		return sample < config->windowLow || sample > config->windowHigh;
+	}
+	if (armsHigh(config)) {
+		return sample <= config->level;
+	}
+	return sample >= config->level;
+}
+
+static void refReset(const struct triggerConfig *config, struct refSearch *search) {
+	search->phase = config->mode == TRIGGER_LEVEL ? REF_READY : REF_ARM;
+	search->holdoffLeft = 0u;
+	search->pulseLength = 0u;
+}
+
+/**
+ * Searches one sample at a time the way the trigger is documented
+ *
+ * @return index of trigger sample, count if not found
+ */
+static uint32_t refScan(const struct triggerConfig *config, struct refSearch *search, const trigger_sample_t *samples, uint32_t count) {
+
+	for (uint32_t i = 0; i < count; i++) {
+
+		const uint32_t sample = samples[i];
+		bool fired = false;
+
+		if (search->holdoffLeft > 0u) {
+			search->holdoffLeft--;
+			continue;
+		}
+		if (search->phase == REF_ARM && refArmed(config, sample)) {
+			search->phase = REF_READY;
+		}
+		if (search->phase == REF_PULSE) {
+			if (!refArmed(config, sample)) {
+				search->pulseLength++;
+				continue;
+			}
+			if (search->pulseLength >= config->pulseMin && search->pulseLength <= config->pulseMax) {
+				fired = true;
+			}
+			search->phase = REF_READY;
+		}
+		if (!fired && search->phase == REF_READY && refReady(config, sample)) {
+			if (config->mode != TRIGGER_PULSE_WIDTH) {
+				fired = true;
+			}
+			else {
+				search->phase = REF_PULSE;
+				search->pulseLength = 0u;
+				if (!refArmed(config, sample)) {
+					search->pulseLength++;
+				}
+			}
+		}
+		if (fired) {
+			search->phase = config->mode == TRIGGER_LEVEL ? REF_READY : REF_ARM;
+			search->holdoffLeft = config->holdoff;
+			return i;
+		}
+	}
+	return count;
+}
+
+/**
+ * Fills samples with a noisy square wave
+ *
+ * @param samples samples to fill
+ * @param count amount of samples
+ * @param noise largest noise either side of each level
+ */
+static void makeSquare(trigger_sample_t *samples, uint32_t count, uint32_t noise) {
+
+	uint32_t level = testRange(0u, 1u);
+	uint32_t left = 0u;
+
+	for (uint32_t i = 0; i < count; i++) {
+		if (left == 0u) {
+			level ^= 1u;
+			left = testRange(1u, 64u);
+		}
+		left--;
+		int32_t value = level ? 3000 : 1000;
+		value += (int32_t)testRange(0u, 2u * noise) - (int32_t)noise;
+		samples[i] = (trigger_sample_t)value;
+	}
+}
+
+/**
+ * Fills samples with a noisy sine
+ *
+ * @param samples samples to fill
+ * @param count amount of samples
+ * @param period samples per cycle
+ * @param noise largest noise either side of sine
+ */
+static void makeSine(trigger_sample_t *samples, uint32_t count, uint32_t period, uint32_t noise) {
+	for (uint32_t i = 0; i < count; i++) {
+		int32_t value = 2048 + (int32_t)lround(1600.0 * sin(2.0 * M_PI * i / period));
+		value += (int32_t)testRange(0u, 2u * noise) - (int32_t)noise;
+		samples[i] = (trigger_sample_t)value;
+	}
+}
+
+static void randomConfig(struct triggerConfig *config) {
+
+	memset(config, 0, sizeof(*config));
+	config->mode = (enum TriggerMode)testRange(TRIGGER_RISING, TRIGGER_WINDOW);
+	config->level = (trigger_sample_t)testRange(800u, 3200u);
+	config->hysteresis = (trigger_sample_t)testRange(0u, 300u);
+	config->windowLow = (trigger_sample_t)testRange(500u, 1700u);
+	config->windowHigh = (trigger_sample_t)testRange(2300u, 3500u);
+	config->pulseMin = testRange(0u, 20u);
+	config->pulseMax = config->pulseMin + testRange(0u, 40u);
+	config->pulsePositive = testRange(0u, 1u);
+	config->holdoff = testRange(0u, 1u) ? testRange(0u, 200u) : 0u;
+	config->preTrigger = 16u;
+	config->postTrigger = 16u;
+}
+
+/**
+ * Checks every trigger in samples matches reference, feeding both
+ * in random chunks so search state is carried between calls
+ */
+static void checkAgainstReference(const struct triggerConfig *config, const trigger_sample_t *samples, uint32_t count) {
+
+	struct triggerSearch search;
+	struct refSearch ref;
+	uint32_t index = 0u;
+
+	triggerSearchReset(&search);
+	refReset(config, &ref);
+
+	while (index < count) {
+		uint32_t chunk = testRange(1u, 300u);
+		if (chunk > count - index) {
+			chunk = count - index;
+		}
+		uint32_t found = triggerScan(config, &search, samples + index, chunk);
+		uint32_t refFound = refScan(config, &ref, samples + index, chunk);
+
+		TEST_EQUAL(refFound, found);
+		if (found != refFound) {
+			fprintf(stderr, "mode %d at sample %u\n", (int)config->mode, index);
+			return;
+		}
+		if (found < chunk) {
+			found++;
+		}
+		index += found;
+	}
+	TEST_EQUAL(ref.phase, search.phase);
+}
+
+static void testRandomWaveforms(void) {
+
+	trigger_sample_t samples[TEST_SAMPLES + 1u];
+	struct triggerConfig config;
+
+	for (uint32_t run = 0; run < TEST_RANDOM_RUNS; run++) {
+		randomConfig(&config);
+		TEST_CHECK(triggerConfigValid(&config, 64u));
+		if (run & 1u) {
+			makeSquare(samples, TEST_SAMPLES + 1u, testRange(0u, 400u));
+		}
+		else {
+			makeSine(samples, TEST_SAMPLES + 1u, testRange(8u, 500u), testRange(0u, 400u));
+		}
+		// odd runs start on a half word so lone first sample is searched
+		checkAgainstReference(&config, samples + (run & 2u ? 1u : 0u), TEST_SAMPLES);
+	}
+}
+
+/**
+ * Counts triggers in whole waveform
+ */
+static uint32_t countTriggers(const struct triggerConfig *config, const trigger_sample_t *samples, uint32_t count, uint32_t *first) {
+
+	struct triggerSearch search;
+	uint32_t index = 0u;
+	uint32_t triggers = 0u;
+
+	triggerSearchReset(&search);
+	*first = count;
+	while (index < count) {
+		uint32_t found = triggerScan(config, &search, samples + index, count - index);
+		if (found == count - index) {
+			break;
+		}
+		if (triggers == 0u) {
+			*first = index + found;
+		}
+		triggers++;
+		index += found + 1u;
+	}
+	return triggers;
+}
+
+static void testSine(void) {
+
+	static trigger_sample_t samples[TEST_SAMPLES];
+	struct triggerConfig config;
+	uint32_t first;
+
+	memset(&config, 0, sizeof(config));
+	config.postTrigger = 1u;
+
+	// noise crosses level many times per edge, hysteresis keeps one trigger per cycle,
+	// sine starts rising from level so first cycle can't arm
+	makeSine(samples, TEST_SAMPLES, 256u, 150u);
+	config.mode = TRIGGER_RISING;
+	config.level = 2048u;
+	config.hysteresis = 300u;
+	TEST_EQUAL(TEST_SAMPLES / 256u - 1u, countTriggers(&config, samples, TEST_SAMPLES, &first));
+	TEST_NEAR(256.0, first, 16.0);
+
+	config.hysteresis = 0u;
+	TEST_CHECK(countTriggers(&config, samples, TEST_SAMPLES, &first) > TEST_SAMPLES / 256u - 1u);
+
+	config.mode = TRIGGER_FALLING;
+	config.hysteresis = 300u;
+	TEST_EQUAL(TEST_SAMPLES / 256u, countTriggers(&config, samples, TEST_SAMPLES, &first));
+	TEST_NEAR(128.0, first, 16.0);
+
+	// holdoff over two cycles skips every other edge
+	config.holdoff = 300u;
+	TEST_EQUAL(TEST_SAMPLES / 512u, countTriggers(&config, samples, TEST_SAMPLES, &first));
+
+	// window leaves twice per cycle once past each bound
+	memset(&config, 0, sizeof(config));
+	config.postTrigger = 1u;
+	config.mode = TRIGGER_WINDOW;
+	config.windowLow = 800u;
+	config.windowHigh = 3300u;
+	config.hysteresis = 300u;
+	TEST_EQUAL(2u * TEST_SAMPLES / 256u, countTriggers(&config, samples, TEST_SAMPLES, &first));
+}
+
+static void testPulseWidth(void) {
+
+	trigger_sample_t samples[256];
+	struct triggerConfig config;
+	uint32_t first;
+
+	// high pulses 5, 10 and 20 samples wide
+	for (uint32_t i = 0; i < 256u; i++) {
+		bool high = (i >= 20u && i < 25u) || (i >= 60u && i < 70u) || (i >= 120u && i < 140u);
+		samples[i] = high ? 3000u : 1000u;
+	}
+
+	memset(&config, 0, sizeof(config));
+	config.postTrigger = 1u;
+	config.mode = TRIGGER_PULSE_WIDTH;
+	config.pulsePositive = true;
+	config.level = 2000u;
+	config.hysteresis = 100u;
+	config.pulseMin = 8u;
+	config.pulseMax = 12u;
+
+	// fires on sample that ends pulse
+	TEST_EQUAL(1u, countTriggers(&config, samples, 256u, &first));
+	TEST_EQUAL(70u, first);
+
+	config.pulseMin = 0u;
+	config.pulseMax = 100u;
+	TEST_EQUAL(3u, countTriggers(&config, samples, 256u, &first));
+	TEST_EQUAL(25u, first);
+
+	// low pulses are the gaps between them
+	config.pulsePositive = false;
+	config.pulseMin = 30u;
+	config.pulseMax = 50u;
+	TEST_EQUAL(2u, countTriggers(&config, samples, 256u, &first));
+	TEST_EQUAL(60u, first);
+}
+
+static void testConfig(void) {
+
+	struct triggerConfig config;
+
+	memset(&config, 0, sizeof(config));
+	config.mode = TRIGGER_RISING;
+	config.level = 100u;
+	config.hysteresis = 10u;
+	config.preTrigger = 8u;
+	config.postTrigger = 8u;
+	TEST_CHECK(triggerConfigValid(&config, 16u));
+	TEST_CHECK(!triggerConfigValid(&config, 12u));
+	TEST_CHECK(!triggerConfigValid(&config, 8u));
+	TEST_CHECK(!triggerConfigValid(NULL, 16u));
+
+	// rising edge can't arm below zero
+	config.hysteresis = 100u;
+	TEST_CHECK(!triggerConfigValid(&config, 16u));
+
+	config.hysteresis = 10u;
+	config.postTrigger = 0u;
+	TEST_CHECK(!triggerConfigValid(&config, 16u));
+
+	config.postTrigger = 8u;
+	config.level = TRIGGER_SAMPLE_MAX + 1u;
+	TEST_CHECK(!triggerConfigValid(&config, 16u));
+}
+
+static void testCapture(void) {
+
+	trigger_sample_t buffer[64];
+	struct triggerCapture capture;
+	struct triggerConfig config;
+	uint32_t start = 0u;
+	uint32_t length = 0u;
+
+	memset(&config, 0, sizeof(config));
+	config.mode = TRIGGER_RISING;
+	config.level = 2000u;
+	config.hysteresis = 100u;
+	config.preTrigger = 10u;
+	config.postTrigger = 20u;
+
+	// signal stays low while pre trigger fills and rises right after,
+	// search armed during the fill so edge is caught
+	for (uint32_t i = 0; i < 64u; i++) {
+		buffer[i] = i < 10u ? 1000u : 3000u;
+	}
+	TEST_CHECK(triggerBegin(&capture, buffer, 64u, &config));
+	TEST_EQUAL(TRIGGER_WAITING, triggerFeed(&capture, 4u));
+	TEST_EQUAL(TRIGGER_FIRED, triggerFeed(&capture, 10u));
+	TEST_EQUAL(TRIGGER_FIRED, triggerFeed(&capture, 15u));
+	TEST_EQUAL(TRIGGER_COMPLETE, triggerFeed(&capture, 1u));
+	TEST_CHECK(triggerGetCapture(&capture, &start, &length));
+	TEST_EQUAL(0u, start);
+	TEST_EQUAL(30u, length);
+
+	// edge inside pre trigger fill is dropped, next edge is used
+	for (uint32_t i = 0; i < 64u; i++) {
+		buffer[i] = (i >= 2u && i < 30u) || i >= 40u ? 3000u : 1000u;
+	}
+	TEST_CHECK(triggerBegin(&capture, buffer, 64u, &config));
+	TEST_EQUAL(TRIGGER_FIRED, triggerFeed(&capture, 41u));
+	TEST_EQUAL(40u, capture.triggerIndex);
+	TEST_EQUAL(TRIGGER_COMPLETE, triggerFeed(&capture, 23u));
+	TEST_CHECK(triggerGetCapture(&capture, &start, &length));
+	TEST_EQUAL(30u, start);
+
+	// post trigger samples run past end of buffer and wrap
+	for (uint32_t i = 0; i < 64u; i++) {
+		buffer[i] = i >= 4u && i < 50u ? 1000u : 3000u;
+	}
+	TEST_CHECK(triggerBegin(&capture, buffer, 64u, &config));
+	TEST_EQUAL(TRIGGER_FIRED, triggerFeed(&capture, 64u));
+	TEST_EQUAL(50u, capture.triggerIndex);
+	TEST_EQUAL(TRIGGER_COMPLETE, triggerFeed(&capture, 10u));
+	TEST_CHECK(triggerGetCapture(&capture, &start, &length));
+	TEST_EQUAL(40u, start);
+	TEST_CHECK(!triggerBegin(&capture, buffer, 48u, &config));
+	TEST_EQUAL(TRIGGER_INVALID, capture.status);
+}
+
+/**
+ * Times word at a time search against sample at a time reference
+ * over a signal that never triggers
+ */
+static void benchScan(void) {
+
+	static trigger_sample_t samples[TEST_BENCH_SAMPLES];
+	struct triggerConfig config;
+	struct triggerSearch search;
+	struct refSearch ref;
+	uint64_t best = UINT64_MAX;
+	uint64_t refBest = UINT64_MAX;
+	uint32_t found = 0u;
+
+	for (uint32_t i = 0; i < TEST_BENCH_SAMPLES; i++) {
+		samples[i] = (trigger_sample_t)testRange(0u, 1999u);
+	}
+	memset(&config, 0, sizeof(config));
+	config.mode = TRIGGER_RISING;
+	config.level = 2000u;
+	config.hysteresis = 100u;
+	config.postTrigger = 1u;
+
+	for (uint32_t run = 0; run < TEST_BENCH_RUNS; run++) {
+		triggerSearchReset(&search);
+		uint64_t start = testHostNS();
+		found += triggerScan(&config, &search, samples, TEST_BENCH_SAMPLES);
+		uint64_t taken = testHostNS() - start;
+		best = taken < best ? taken : best;
+
+		refReset(&config, &ref);
+		start = testHostNS();
+		found += refScan(&config, &ref, samples, TEST_BENCH_SAMPLES);
+		taken = testHostNS() - start;
+		refBest = taken < refBest ? taken : refBest;
+	}
+	TEST_EQUAL(2u * TEST_BENCH_RUNS * TEST_BENCH_SAMPLES, found);
+
+	testHostMetric("trigger", "scan_msamples_per_s", best > 0u ? TEST_BENCH_SAMPLES * 1000ull / best : 0u);
+	testHostMetric("trigger", "reference_msamples_per_s", refBest > 0u ? TEST_BENCH_SAMPLES * 1000ull / refBest : 0u);
+}
+
+int main(void) {
+
+	testConfig();
+	testRandomWaveforms();
+	testSine();
+	testPulseWidth();
+	testCapture();
+	benchScan();
+
+	return testResult("trigger");
+}
\ No newline at end of file
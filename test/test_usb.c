@@ -0,0 +1,242 @@
+/*
+	test_usb.c - checks USB writes and streaming through a pseudo terminal
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+
+#include <inherited/pico/board_pico_usb.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_BYTES 32768u // bytes sent in throughput test
+#define TEST_CHUNK 1024u // bytes in each write, more than CDC FIFO holds
+#define TEST_LINE 200u // bytes in a write that fits in CDC FIFO
+#define TEST_STREAM 4096u // bytes in each streamed buffer
+
+static uint8_t sent[TEST_BYTES];
+static uint8_t received[TEST_BYTES];
+static uint32_t receivedLength = 0u;
+static int ptyFD = -1;
+
+static uint32_t testSeed = 0x9b05688cu;
+
+/**
+ * Reads whatever terminal has so its buffer never fills
+ */
+static void drainPty(void) {
+	while (ptyFD >= 0 && receivedLength < TEST_BYTES) {
+		ssize_t got = read(ptyFD, received + receivedLength, TEST_BYTES - receivedLength);
+		if (got <= 0) {
+			return;
+		}
+		receivedLength += (uint32_t)got;
+	}
+}
+
+/**
+ * Waits for terminal to pass on bytes host already read
+ *
+ * @param expected total bytes to wait for
+ */
+static void waitPty(uint32_t expected) {
+
+	struct pollfd ready = {ptyFD, POLLIN, 0};
+
+	drainPty();
+	while (receivedLength < expected && poll(&ready, 1u, 1000) > 0) {
+		drainPty();
+	}
+}
+
+/**
+ * Runs USB stack until host has read bytes out of the FIFO
+ *
+ * @param expected total bytes host should have
+ */
+static void waitHost(uint32_t expected) {
+
+	uint32_t length;
+
+	simUSBOutput(&length);
+	while (length < expected) {
+		usbTask();
+		drainPty();
+		simUSBOutput(&length);
+	}
+}
+
+/**
+ * Counts release callbacks
+ */
+static void countRelease(const void *buffer, void *context) {
+	(void)buffer;
+	(*(uint32_t*)context)++;
+}
+
+/**
+ * Checks a caller waiting on usbFree gets every byte through at host speed
+ */
+static void testWrite(void) {
+
+	struct usbStats before;
+	struct usbStats after;
+
+	for (uint32_t i = 0; i < TEST_BYTES; i++) {
+		sent[i] = (uint8_t)testRandom(&testSeed);
+	}
+	simUSBClear();
+	receivedLength = 0u;
+	usbGetStats(&before);
+
+	const uint64_t start = simNowNS();
+	uint32_t index = 0u;
+	while (index < TEST_BYTES) {
+		// waits for space like a caller that can't drop bytes
+		uint32_t take = usbFree();
+		if (take > TEST_BYTES - index) {
+			take = TEST_BYTES - index;
+		}
+		TEST_EQUAL(take, usbWrite(sent + index, take));
+		index += take;
+		drainPty();
+	}
+	waitHost(TEST_BYTES);
+	const uint64_t taken = simNowNS() - start;
+	waitPty(TEST_BYTES);
+
+	usbGetStats(&after);
+	TEST_EQUAL(TEST_BYTES, after.sent - before.sent);
+	TEST_EQUAL(before.dropped, after.dropped);
+	TEST_EQUAL(TEST_BYTES, receivedLength);
+	TEST_CHECK(memcmp(sent, received, TEST_BYTES) == 0);
+
+	// host reading is the only limit
+	const uint64_t lineNS = (uint64_t)TEST_BYTES * 1000000u / SIM_USB_BYTES_PER_MS;
+	TEST_CHECK(taken * 1000u >= lineNS * 999u);
+	testMetric("usb_write", "idle_permille", taken > lineNS ? (taken - lineNS) * 1000u / lineNS : 0u);
+}
+
+/**
+ * Checks write drops bytes while streamed buffers are sending so they come out whole and first
+ */
+static void testOrder(void) {
+
+	struct usbStats before;
+	struct usbStats after;
+	uint32_t released = 0u;
+
+	for (uint32_t i = 0; i < TEST_BYTES; i++) {
+		sent[i] = (uint8_t)i;
+	}
+	simUSBClear();
+	receivedLength = 0u;
+
+	TEST_CHECK(usbStreamSubmit(sent, TEST_STREAM, countRelease, &released));
+	TEST_CHECK(usbStreamSubmit(sent + TEST_STREAM, TEST_STREAM, countRelease, &released));
+	TEST_CHECK(!usbStreamReady());
+	usbGetStats(&before);
+	TEST_EQUAL(0u, usbFree());
+	TEST_EQUAL(0u, usbWrite(sent, TEST_LINE));
+	usbGetStats(&after);
+	TEST_EQUAL(1u, after.overflows - before.overflows);
+	TEST_EQUAL(TEST_LINE, after.dropped - before.dropped);
+
+	TEST_CHECK(usbFlush(1000000u));
+	TEST_EQUAL(2u, released);
+	while (usbFree() < TEST_LINE) {
+		drainPty();
+	}
+	TEST_EQUAL(TEST_LINE, usbWrite(sent + 2u * TEST_STREAM, TEST_LINE));
+	waitHost(2u * TEST_STREAM + TEST_LINE);
+	waitPty(2u * TEST_STREAM + TEST_LINE);
+
+	TEST_EQUAL(2u * TEST_STREAM + TEST_LINE, receivedLength);
+	TEST_CHECK(memcmp(sent, received, receivedLength) == 0);
+}
+
+/**
+ * Checks writes drop without waiting and flush gives up when host stops reading
+ */
+static void testStall(void) {
+
+	struct usbStats before;
+	struct usbStats after;
+	uint32_t released = 0u;
+
+	usbFlush(1000000u);
+	simUSBSetReading(false);
+	usbGetStats(&before);
+
+	// only what fits in the FIFO goes, straight away
+	uint64_t start = simNowNS();
+	uint32_t written = usbWrite(sent, TEST_CHUNK);
+	TEST_CHECK(written <= SIM_USB_FIFO_BYTES);
+	TEST_EQUAL(0u, usbWrite(sent, TEST_CHUNK));
+	uint64_t taken = simNowNS() - start;
+	usbGetStats(&after);
+	TEST_EQUAL(2u * TEST_CHUNK - written, after.dropped - before.dropped);
+	TEST_EQUAL(2u, after.overflows - before.overflows);
+	TEST_CHECK(taken < 100000u);
+	testMetric("usb_write", "stalled_ns", taken);
+
+	// flush returns after its timeout with buffer still queued
+	TEST_CHECK(usbStreamSubmit(sent, TEST_STREAM, countRelease, &released));
+	start = simNowNS();
+	TEST_CHECK(!usbFlush(5000u));
+	taken = simNowNS() - start;
+	// timer counts whole us, start can be part way through one
+	TEST_CHECK(taken + 1000u >= 5000000u && taken < 6000000u);
+	TEST_EQUAL(1u, usbPending());
+	TEST_EQUAL(0u, released);
+
+	simUSBSetReading(true);
+	TEST_CHECK(usbFlush(1000000u));
+	TEST_EQUAL(1u, released);
+
+	// disconnect abandons buffers and refuses writes straight away
+	TEST_CHECK(usbStreamSubmit(sent, TEST_STREAM, countRelease, &released));
+	simUSBSetConnected(false);
+	start = simNowNS();
+	TEST_EQUAL(0u, usbWrite(sent, TEST_CHUNK));
+	TEST_CHECK(usbFlush(1000u));
+	TEST_CHECK(simNowNS() - start < 1000000u);
+	TEST_EQUAL(2u, released);
+	simUSBSetConnected(true);
+}
+
+int main(void) {
+
+	char name[64];
+
+	TEST_CHECK(simUSBOpenPty(name, sizeof(name)));
+	ptyFD = open(name, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+	TEST_CHECK(ptyFD >= 0);
+	TEST_CHECK(usbBegin());
+
+	testWrite();
+	testOrder();
+	testStall();
+
+	close(ptyFD);
+	return testResult("usb");
+}
\ No newline at end of file
@@ -0,0 +1,325 @@
+/*
+	test_wavegen.c - checks waveform tables, DMA timer pacing and table swaps
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+
+#include <hardware/clocks.h>
+#include <hardware/pwm.h>
+#include <inherited/pico/board_pico_clock.h>
+#include <inherited/pico/board_pico_wavegen.h>
+
+#include <string.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_LENGTH 64u // words in each table
+#define TEST_TOP 1000u // PWM wrap
+#define TEST_PIN 15u
+#define TEST_FREQ 500u // waveform frequency, under the carrier at 48 MHz
+#define TEST_FRACTION_RATES 200u // random rates checked against every fraction
+#define TEST_WRITES_MAX 8192u // compare writes recorded
+
+static WAVEGEN_BUFFERS(buffers, TEST_LENGTH);
+static uint32_t table[WAVEGEN_LENGTH_MAX];
+static sample_t samples[TEST_LENGTH];
+
+static uint32_t writes[TEST_WRITES_MAX];
+static uint64_t writeNS[TEST_WRITES_MAX];
+static uint32_t writeCount = 0u;
+static volatile void *compare = NULL;
+
+static uint32_t testSeed = 0x68e31da4u;
+
+/**
+ * Gets level of table word, checking both channels match
+ */
+static uint32_t level(uint32_t word) {
+	TEST_EQUAL(word & 0xFFFFu, word >> 16);
+	return word & 0xFFFFu;
+}
+
+static void testTables(void) {
+
+	// sine starts at mid level, peaks a quarter in and mirrors about mid
+	wavegenSine(table, TEST_LENGTH, TEST_TOP);
+	TEST_EQUAL(TEST_TOP / 2u, level(table[0]));
+	TEST_EQUAL(TEST_TOP, level(table[TEST_LENGTH / 4u]));
+	TEST_EQUAL(0u, level(table[3u * TEST_LENGTH / 4u]));
+	for (uint32_t i = 1; i < TEST_LENGTH / 2u; i++) {
+		TEST_NEAR(TEST_TOP, level(table[i]) + level(table[TEST_LENGTH - i]), 1u);
+		TEST_CHECK(level(table[i]) <= TEST_TOP);
+	}
+	wavegenSine(table, WAVEGEN_SINE_POINTS, 4095u);
+	TEST_EQUAL(4095u, level(table[WAVEGEN_SINE_POINTS / 4u]));
+
+	// duty rounds to whole words
+	wavegenSquare(table, TEST_LENGTH, TEST_TOP, 2500u);
+	for (uint32_t i = 0; i < TEST_LENGTH; i++) {
+		TEST_EQUAL(i < TEST_LENGTH / 4u ? TEST_TOP : 0u, level(table[i]));
+	}
+	wavegenSquare(table, TEST_LENGTH, TEST_TOP, WAVEGEN_DUTY_SCALE + 1u);
+	TEST_EQUAL(TEST_TOP, level(table[TEST_LENGTH - 1u]));
+
+	wavegenTriangle(table, TEST_LENGTH, TEST_TOP);
+	TEST_EQUAL(0u, level(table[0]));
+	TEST_EQUAL(TEST_TOP, level(table[TEST_LENGTH / 2u]));
+	for (uint32_t i = 1; i <= TEST_LENGTH / 2u; i++) {
+		TEST_CHECK(level(table[i]) > level(table[i - 1u]));
+		TEST_EQUAL(level(table[i]), level(table[(TEST_LENGTH - i) % TEST_LENGTH]));
+	}
+
+	// as many samples as words copies them, half as many interpolates and wraps
+	for (uint32_t i = 0; i < TEST_LENGTH; i++) {
+		samples[i] = (sample_t)(i * SAMPLE_MAX / (TEST_LENGTH - 1u));
+	}
+	wavegenArbitrary(table, TEST_LENGTH, TEST_TOP, samples, TEST_LENGTH);
+	for (uint32_t i = 0; i < TEST_LENGTH; i++) {
+		TEST_EQUAL((samples[i] * TEST_TOP + SAMPLE_MAX / 2u) / SAMPLE_MAX, level(table[i]));
+	}
+	wavegenArbitrary(table, TEST_LENGTH, TEST_TOP, samples, TEST_LENGTH / 2u);
+	TEST_NEAR((level(table[0]) + level(table[2])) / 2u, level(table[1]), 1u);
+	TEST_NEAR((level(table[TEST_LENGTH - 2u]) + level(table[0])) / 2u, level(table[TEST_LENGTH - 1u]), 1u);
+	wavegenArbitrary(table, TEST_LENGTH, TEST_TOP, samples, 0u);
+	TEST_EQUAL(0u, level(table[TEST_LENGTH / 2u]));
+}
+
+/**
+ * Gets distance of x / y from rate / sys scaled by sys * y
+ */
+static uint64_t fractionError(uint32_t sysHz, uint32_t rateHz, uint64_t x, uint64_t y) {
+	uint64_t made = x * sysHz;
+	uint64_t wanted = y * rateHz;
+	return made > wanted ? made - wanted : wanted - made;
+}
+
+/**
+ * Checks fraction is the closest of all 16 bit fractions
+ *
+ * @return error in parts per billion
+ */
+static uint64_t checkFraction(uint32_t sysHz, uint32_t rateHz) {
+
+	uint16_t x;
+	uint16_t y;
+
+	TEST_CHECK(wavegenTimerFraction(sysHz, rateHz, &x, &y));
+	TEST_CHECK(x > 0u && x <= y);
+	const uint64_t error = fractionError(sysHz, rateHz, x, y);
+
+	for (uint64_t tryY = 1u; tryY <= WAVEGEN_FRACTION_MAX; tryY++) {
+		uint64_t tryX = (tryY * rateHz + sysHz / 2u) / sysHz;
+		if (tryX == 0u || tryX > WAVEGEN_FRACTION_MAX) {
+			continue;
+		}
+		// compared as error / y without dividing
+		if (fractionError(sysHz, rateHz, tryX, tryY) * y < error * tryY) {
+			fprintf(stderr, "%u Hz of %u Hz got %u / %u, %llu / %llu is closer\n", rateHz, sysHz, x, y,
+				(unsigned long long)tryX, (unsigned long long)tryY);
+			testFailures++;
+			break;
+		}
+	}
+
+	const uint64_t milliHz = wavegenTimerRateMilliHz(sysHz, x, y);
+	TEST_NEAR((uint64_t)sysHz * x * 1000u / y, milliHz, 1u);
+	return error * 1000000000u / ((uint64_t)y * rateHz);
+}
+
+static void testFractions(void) {
+
+	uint16_t x;
+	uint16_t y;
+	uint64_t worst = 0u;
+
+	TEST_CHECK(!wavegenTimerFraction(125000000u, 0u, &x, &y));
+	TEST_CHECK(!wavegenTimerFraction(125000000u, 125000001u, &x, &y));
+	TEST_CHECK(!wavegenTimerFraction(125000000u, 125000000u / WAVEGEN_FRACTION_MAX - 1u, &x, &y));
+	TEST_CHECK(wavegenTimerFraction(125000000u, 125000000u, &x, &y));
+	TEST_EQUAL(x, y);
+	TEST_CHECK(wavegenTimerFraction(125000000u, 64000u, &x, &y));
+	TEST_EQUAL(64000u * 1000u, wavegenTimerRateMilliHz(125000000u, x, y));
+	TEST_EQUAL(0u, wavegenTimerRateMilliHz(125000000u, 1u, 0u));
+
+	for (uint32_t i = 0; i < TEST_FRACTION_RATES; i++) {
+		const uint32_t sysHz = (i & 1u) ? 125000000u : 48000000u;
+		const uint32_t rateHz = sysHz / WAVEGEN_FRACTION_MAX + 1u + testRandom(&testSeed) % (sysHz / 64u);
+		const uint64_t error = checkFraction(sysHz, rateHz);
+		worst = error > worst ? error : worst;
+	}
+	testMetric("wavegen_fraction", "worst_error_ppb", worst);
+}
+
+/**
+ * Records writes to compare register of generator
+ */
+static void recordWrite(volatile void *address, uint32_t value, uint64_t ns) {
+	if (address == compare && writeCount < TEST_WRITES_MAX) {
+		writes[writeCount] = value;
+		writeNS[writeCount] = ns;
+		writeCount++;
+	}
+}
+
+/**
+ * Finds first write of a sine period
+ *
+ * @return index of write, writeCount if none
+ */
+static uint32_t sineStart(void) {
+	wavegenSine(table, TEST_LENGTH, TEST_TOP);
+	for (uint32_t i = 0; i + 1u < writeCount; i++) {
+		if (writes[i] == table[0] && writes[i + 1u] == table[1]) {
+			return i;
+		}
+	}
+	return writeCount;
+}
+
+/**
+ * Checks every period written from start is whole, once square stays square
+ *
+ * @param start first write of a period
+ * @param expectSquare whether a square period should be seen
+ *
+ * @return periods checked
+ */
+static uint32_t checkPeriods(uint32_t start, bool expectSquare) {
+
+	uint32_t periods = 0u;
+	bool square = false;
+
+	for (uint32_t first = start; first + TEST_LENGTH <= writeCount; first += TEST_LENGTH) {
+		uint32_t highs = 0u;
+		uint32_t squareWords = 0u;
+		for (uint32_t i = 0; i < TEST_LENGTH; i++) {
+			const uint32_t value = level(writes[first + i]);
+			squareWords += value == 0u || value == TEST_TOP;
+			highs += value == TEST_TOP;
+		}
+		// sine only reaches top and 0 at its peak and trough
+		const bool isSquare = squareWords == TEST_LENGTH && highs == TEST_LENGTH / 2u;
+		TEST_CHECK(isSquare || squareWords <= 2u);
+		TEST_CHECK(!square || isSquare);
+		square = square || isSquare;
+		periods++;
+	}
+	TEST_EQUAL(expectSquare, square);
+	return periods;
+}
+
+/**
+ * Gets playback rate from recorded write times
+ *
+ * @return rate in mHz
+ */
+static uint64_t recordedRate(void) {
+	return (uint64_t)(writeCount - 1u) * 1000000000000ull / (writeNS[writeCount - 1u] - writeNS[0]);
+}
+
+static void testPlayback(void) {
+
+	struct wavegen gen;
+	struct clockProfile profile;
+	const uint64_t wordMilliHz = (uint64_t)TEST_FREQ * TEST_LENGTH * 1000u;
+
+	TEST_CHECK(!wavegenBegin(&gen, TEST_PIN, buffers, 48u, TEST_TOP));
+	TEST_CHECK(!wavegenBegin(&gen, TEST_PIN, buffers + 1, TEST_LENGTH, TEST_TOP));
+	TEST_CHECK(wavegenBegin(&gen, TEST_PIN, buffers, TEST_LENGTH, TEST_TOP));
+	compare = &pwm_hw->slice[gen.slice].cc;
+	simSetDMAHook(recordWrite);
+
+	TEST_CHECK(!wavegenStart(&gen));
+	TEST_CHECK(!wavegenSwap(&gen));
+	TEST_CHECK(!wavegenSetFrequency(&gen, 0u));
+	TEST_CHECK(!wavegenSetFrequency(&gen, 125000000u / (TEST_TOP + 1u) / TEST_LENGTH + 1u));
+	TEST_CHECK(wavegenSetFrequency(&gen, TEST_FREQ));
+	TEST_NEAR(TEST_FREQ * 1000u, wavegenGetFrequencyMilliHz(&gen), 1u);
+
+	// stopped generator fills table 0, which plays first
+	uint32_t *next = wavegenNextTable(&gen);
+	TEST_CHECK(next == buffers);
+	wavegenSine(next, TEST_LENGTH, TEST_TOP);
+	TEST_CHECK(wavegenSwap(&gen));
+	TEST_CHECK(memcmp(buffers, buffers + TEST_LENGTH, TEST_LENGTH * sizeof(uint32_t)) == 0);
+	TEST_CHECK(!wavegenSwap(&gen));
+
+	TEST_CHECK(wavegenStart(&gen));
+	TEST_CHECK(!wavegenStart(&gen));
+	simRunUS(20000u);
+	TEST_EQUAL(20000u * TEST_FREQ * TEST_LENGTH / 1000000u, writeCount);
+	TEST_EQUAL(0u, sineStart());
+	checkPeriods(0u, false);
+	TEST_NEAR(wordMilliHz, recordedRate(), 100u);
+
+	// table handed out starts playing before swap, swap still keeps it
+	writeCount = 0u;
+	next = wavegenNextTable(&gen);
+	const uint8_t filling = next == buffers ? 0u : 1u;
+	TEST_CHECK(dma_channel_is_busy((uint)gen.dma[filling ^ 1u]));
+	wavegenSquare(next, TEST_LENGTH, TEST_TOP, WAVEGEN_DUTY_SCALE / 2u);
+	while (!dma_channel_is_busy((uint)gen.dma[filling])) {
+		simRunUS(10u);
+	}
+	TEST_CHECK(wavegenSwap(&gen));
+	simRunUS(10000u);
+	TEST_CHECK(checkPeriods(sineStart(), true) >= 4u);
+	TEST_CHECK(memcmp(buffers, buffers + TEST_LENGTH, TEST_LENGTH * sizeof(uint32_t)) == 0);
+
+	// swapped in on time, new waveform starts on a period boundary
+	writeCount = 0u;
+	next = wavegenNextTable(&gen);
+	wavegenSine(next, TEST_LENGTH, TEST_TOP);
+	TEST_CHECK(wavegenSwap(&gen));
+	simRunUS(10000u);
+	const uint32_t start = sineStart();
+	TEST_CHECK(start < writeCount);
+	for (uint32_t i = 0; i < start; i++) {
+		TEST_CHECK(level(writes[i]) == 0u || level(writes[i]) == TEST_TOP);
+	}
+	TEST_CHECK(checkPeriods(start, false) >= 4u);
+
+	// frequency is kept across clock changes
+	clockDefaults(&profile);
+	profile.sysKHz = 48000u;
+	TEST_EQUAL(CLOCK_OK, clockApply(&profile));
+	// transfers held up while clocks switched catch up first
+	simRunUS(1000u);
+	writeCount = 0u;
+	simRunUS(20000u);
+	TEST_NEAR(TEST_FREQ * 1000u, wavegenGetFrequencyMilliHz(&gen), 1u);
+	const uint64_t rate = recordedRate();
+	const uint64_t error = rate > wordMilliHz ? rate - wordMilliHz : wordMilliHz - rate;
+	TEST_CHECK(error * 10000u < wordMilliHz);
+	testMetric("wavegen_48mhz", "rate_error_ppm", error * 1000000u / wordMilliHz);
+
+	wavegenStop(&gen);
+	writeCount = 0u;
+	simRunUS(5000u);
+	TEST_EQUAL(0u, writeCount);
+	simSetDMAHook(NULL);
+}
+
+int main(void) {
+
+	testTables();
+	testFractions();
+	testPlayback();
+
+	return testResult("wavegen");
+}
\ No newline at end of file
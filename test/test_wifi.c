@@ -0,0 +1,206 @@
+/*
+	test_wifi.c - checks UDP capture streaming over loopback, with and without loss
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <board_common.h>
+
+#include <pico1w/board_pico1w_wifi.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "sim.h"
+#include "test.h"
+
+#define TEST_BUFFER 16384u // bytes in each capture buffer
+#define TEST_BUFFERS 64u // buffers streamed in each scenario
+#define TEST_DATAGRAM_MAX 2048u
+
+static uint8_t buffers[WIFI_STREAM_SLOTS][TEST_BUFFER];
+static uint8_t received[TEST_BUFFER];
+static int receiveFD = -1;
+
+struct testReceiver {
+	uint32_t datagrams; // datagrams read
+	uint32_t bytes; // payload bytes read
+	uint32_t lost; // gaps in sequence
+	uint32_t nextSequence; // sequence expected next
+	uint32_t corrupt; // payloads that don't match what was sent
+};
+
+/**
+ * Makes byte of buffer from its number and offset
+ */
+static uint8_t testByte(uint32_t number, uint32_t offset) {
+	return (uint8_t)(number * 31u + offset * 7u + (offset >> 8));
+}
+
+/**
+ * Reads every datagram waiting on loopback
+ */
+static void receiveAll(struct testReceiver *receiver) {
+
+	uint8_t datagram[TEST_DATAGRAM_MAX];
+
+	while (true) {
+		ssize_t got = recv(receiveFD, datagram, sizeof(datagram), MSG_DONTWAIT);
+		if (got < (ssize_t)WIFI_HEADER_BYTES) {
+			return;
+		}
+		uint32_t sequence;
+		uint32_t offset;
+		uint32_t length;
+		memcpy(&sequence, datagram, 4u);
+		memcpy(&offset, datagram + 4u, 4u);
+		memcpy(&length, datagram + 8u, 4u);
+		uint16_t number = (uint16_t)(datagram[12] | (datagram[13] << 8));
+
+		receiver->lost += sequence - receiver->nextSequence;
+		receiver->nextSequence = sequence + 1u;
+		receiver->datagrams++;
+
+		const uint32_t payload = (uint32_t)got - WIFI_HEADER_BYTES;
+		receiver->bytes += payload;
+		if (length != TEST_BUFFER || offset + payload > TEST_BUFFER) {
+			receiver->corrupt++;
+			continue;
+		}
+		for (uint32_t i = 0; i < payload; i++) {
+			received[i] = testByte(number, offset + i);
+		}
+		if (memcmp(received, datagram + WIFI_HEADER_BYTES, payload) != 0) {
+			receiver->corrupt++;
+		}
+	}
+}
+
+/**
+ * Marks slot free again
+ */
+static void release(const void *buffer, void *context) {
+	(void)buffer;
+	*(volatile bool*)context = false;
+}
+
+/**
+ * Streams buffers as fast as they free up and checks what arrives
+ */
+static void checkStream(uint32_t lossPermille, const char *scenario) {
+
+	struct wifiStats before;
+	struct wifiStats after;
+	struct simWifiStats linkBefore;
+	struct simWifiStats linkAfter;
+	struct testReceiver receiver;
+	volatile bool busy[WIFI_STREAM_SLOTS] = {false};
+	uint32_t submitted = 0u;
+	uint32_t number = 0u;
+
+	wifiGetStats(&before);
+	after = before;
+	simWifiGetStats(&linkBefore);
+	simWifiSetLoss(lossPermille);
+
+	// buffer number carries on from earlier scenarios
+	memset(&receiver, 0, sizeof(receiver));
+	receiver.nextSequence = before.datagrams + before.sendErrors;
+	number = before.submitted;
+
+	const uint64_t start = simNowNS();
+	while (submitted < TEST_BUFFERS || before.released + TEST_BUFFERS != after.released) {
+		for (uint32_t slot = 0; slot < WIFI_STREAM_SLOTS && submitted < TEST_BUFFERS; slot++) {
+			if (busy[slot] || !wifiStreamReady()) {
+				continue;
+			}
+			for (uint32_t i = 0; i < TEST_BUFFER; i++) {
+				buffers[slot][i] = testByte(number, i);
+			}
+			busy[slot] = true;
+			TEST_CHECK(wifiStreamSubmit(buffers[slot], TEST_BUFFER, release, (void*)&busy[slot]));
+			submitted++;
+			number++;
+		}
+		if (wifiTask() == 0u) {
+			simRunUS(50u);
+		}
+		receiveAll(&receiver);
+		wifiGetStats(&after);
+	}
+
+	// let link finish sending what driver still holds
+	simRunUS(10000u);
+	wifiTask();
+	const uint64_t taken = simNowNS() - start;
+	struct pollfd ready = {receiveFD, POLLIN, 0};
+	while (poll(&ready, 1u, 100) > 0) {
+		receiveAll(&receiver);
+	}
+	simWifiGetStats(&linkAfter);
+	simWifiSetLoss(0u);
+	receiver.lost += after.datagrams + after.sendErrors - receiver.nextSequence;
+
+	const uint32_t perBuffer = (TEST_BUFFER + WIFI_PAYLOAD_BYTES - 1u) / WIFI_PAYLOAD_BYTES;
+	TEST_EQUAL(TEST_BUFFERS, after.submitted - before.submitted);
+	TEST_EQUAL(TEST_BUFFERS * perBuffer, after.datagrams - before.datagrams + after.sendErrors - before.sendErrors);
+	TEST_EQUAL(0u, receiver.corrupt);
+	TEST_EQUAL(TEST_BUFFERS * perBuffer, receiver.datagrams + receiver.lost);
+
+	// every gap the receiver sees is a datagram the link or driver dropped
+	const uint32_t dropped = linkAfter.lost - linkBefore.lost + after.sendErrors - before.sendErrors;
+	TEST_EQUAL(dropped, receiver.lost);
+	TEST_EQUAL(TEST_BUFFERS * perBuffer * lossPermille / 1000u, linkAfter.lost - linkBefore.lost);
+
+	// compared to link carrying payload alone, includes headers and the final 10 ms
+	const uint64_t lineNS = (uint64_t)TEST_BUFFERS * TEST_BUFFER * 8u * 1000000000u / SIM_WIFI_BITS_PER_S;
+	testMetric(scenario, "datagrams_lost", receiver.lost);
+	testMetric(scenario, "overhead_permille", taken > lineNS ? (taken - lineNS) * 1000u / lineNS : 0u);
+	testHostMetric(scenario, "kbytes_per_s", (uint64_t)receiver.bytes * 1000000u / taken);
+}
+
+int main(void) {
+
+	struct sockaddr_in address;
+	socklen_t length = sizeof(address);
+	char text[INET_ADDRSTRLEN];
+	int size = 1 << 22;
+
+	// loopback socket stands in for the capture host
+	receiveFD = socket(AF_INET, SOCK_DGRAM, 0);
+	TEST_CHECK(receiveFD >= 0);
+	setsockopt(receiveFD, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	TEST_CHECK(bind(receiveFD, (struct sockaddr*)&address, sizeof(address)) == 0);
+	TEST_CHECK(getsockname(receiveFD, (struct sockaddr*)&address, &length) == 0);
+	inet_ntop(AF_INET, &address.sin_addr, text, sizeof(text));
+
+	TEST_CHECK(!wifiStreamBegin("not an address", 1u));
+	TEST_CHECK(wifiBegin("lab", "password", 5000u));
+	TEST_CHECK(wifiStreamBegin(text, ntohs(address.sin_port)));
+
+	checkStream(0u, "wifi_udp");
+	checkStream(20u, "wifi_udp_loss20");
+	checkStream(100u, "wifi_udp_loss100");
+
+	close(receiveFD);
+	return testResult("wifi");
+}
\ No newline at end of file
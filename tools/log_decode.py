@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+#	log_decode.py - decodes deferred log records from Raspberry Pi Picos
+#	Copyright (C) 2025 Camren Chraplak
+#
+#	This program is free software: you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation, either version 3 of the License, or
+#	(at your option) any later version.
+#
+#	This program is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#
+#	You should have received a copy of the GNU General Public License
+#	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Formats LOG_DEFERRED records on the host
+
+Format strings come from the log_strings section of the firmware ELF
+(.log_strings when linked with board_pico_log.ld), records come from
+FRAME_LOG frames (see board_pico_frame.h) or, with --raw, a file of
+bare record words
+
+usage: log_decode.py firmware.elf capture.bin [--raw]
+"""
+
+import re
+import struct
+import sys
+import zlib
+
+from pico_elf import Elf
+
+SECTIONS = (".log_strings", "log_strings") # non allocated, allocated
+FRAME_HEADER_BYTES = 16
+FRAME_CRC_BYTES = 4
+FRAME_LOG = 3
+LOG_HEADER_WORDS = 2
+LOG_COUNT_SHIFT = 24
+LOG_OFFSET_MASK = 0x00FFFFFF
+
+SPEC = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(?:hh|h|ll|l|z|j|t)?([diouxXcp%])")
+
+
+def readStrings(path):
+	"""Gets contents of log_strings section"""
+
+	elf = Elf(path)
+	for name in SECTIONS:
+		section = elf.section(name)
+		if section is not None:
+			return elf.contents(section)
+	sys.exit(path + " has no log_strings section")
+
+
+def formatRecord(strings, offset, args):
+	"""Formats record like printf on device"""
+
+	end = strings.find(b"\0", offset)
+	if offset >= len(strings) or end < 0:
+		return "<unknown format %d>" % offset
+	text = strings[offset:end].decode(errors="replace")
+	values = iter(args)
+
+	def convert(match):
+		flags, width, precision, kind = match.groups()
+		if kind == "%":
+			return "%"
+		value = next(values, 0)
+		if kind in "di":
+			value -= (value & 0x80000000) << 1
+			kind = "d"
+		elif kind == "u":
+			kind = "d"
+		elif kind == "p":
+			return "0x%08x" % value
+		spec = "%" + flags + width + ("." + precision if precision else "") + kind
+		return spec % value
+
+	return SPEC.sub(convert, text)
+
+
+def records(data):
+	"""Splits record words into (time, format offset, args)"""
+
+	words = struct.unpack("<%dI" % (len(data) // 4), data[:len(data) & ~3])
+	index = 0
+	while index + LOG_HEADER_WORDS <= len(words):
+		count = words[index] >> LOG_COUNT_SHIFT
+		offset = words[index] & LOG_OFFSET_MASK
+		args = words[index + LOG_HEADER_WORDS:index + LOG_HEADER_WORDS + count]
+		yield words[index + 1], offset, args
+		index += LOG_HEADER_WORDS + count
+
+
+def cobsDecode(data):
+	"""Removes COBS encoding, None if damaged"""
+
+	out = bytearray()
+	index = 0
+	while index < len(data):
+		code = data[index]
+		if code == 0 or index + code > len(data) + 1:
+			return None
+		out += data[index + 1:index + code]
+		index += code
+		if code != 0xFF and index < len(data):
+			out.append(0)
+	return bytes(out)
+
+
+def frames(stream, frameType=FRAME_LOG):
+	"""Gets (channel, payload) of every valid frame of frameType"""
+
+	for encoded in stream.split(b"\0"):
+		frame = cobsDecode(encoded) if encoded else None
+		if frame is None or len(frame) < FRAME_HEADER_BYTES + FRAME_CRC_BYTES:
+			continue
+		body, crc = frame[:-FRAME_CRC_BYTES], frame[-FRAME_CRC_BYTES:]
+		if zlib.crc32(body) != struct.unpack("<I", crc)[0]:
+			continue
+		if body[1] == frameType:
+			yield body[2], body[FRAME_HEADER_BYTES:]
+
+
+def main(argv):
+
+	if len(argv) < 3:
+		sys.exit(__doc__)
+
+	strings = readStrings(argv[1])
+	with open(argv[2], "rb") as file:
+		stream = file.read()
+
+	payloads = [(0, stream)] if "--raw" in argv[3:] else frames(stream)
+	for core, payload in payloads:
+		for time, offset, args in records(payload):
+			sys.stdout.write("[%10u us] core %d: %s" % (time, core, formatRecord(strings, offset, args)))
+
+
+if __name__ == "__main__":
+	main(sys.argv)
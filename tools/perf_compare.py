@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+#	perf_compare.py - checks benchmark runs from Raspberry Pi Picos
+#	Copyright (C) 2025 Camren Chraplak
+#
+#	This program is free software: you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation, either version 3 of the License, or
+#	(at your option) any later version.
+#
+#	This program is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#
+#	You should have received a copy of the GNU General Public License
+#	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Compares metric lines printed by perfRunAll (see board_pico_perf.h)
+against a stored baseline, exits with 1 if any metric got worse
+
+Every metric is lower is better, a metric regresses once it is over
+its baseline by more than tolerance percent (default 10) plus its
+slack, baseline entries are a value or {"value": v, "slack": s}
+
+Metrics seen more than once in a capture keep their worst value
+
+usage: perf_compare.py capture.txt baseline.json [tolerance]
+       perf_compare.py --update capture.txt baseline.json
+"""
+
+import json
+import sys
+
+DEFAULT_TOLERANCE = 10.0
+
+
+def readMetrics(path):
+	"""Gets worst value of every metric in capture"""
+
+	metrics = {}
+	with open(path, errors="replace") as file:
+		for line in file:
+			line = line.strip()
+			if not line.startswith("{"):
+				continue
+			try:
+				entry = json.loads(line)
+				name = "%s.%s" % (entry["scenario"], entry["metric"])
+				value = int(entry["value"])
+			except (ValueError, KeyError, TypeError):
+				continue
+			metrics[name] = max(value, metrics.get(name, value))
+	return metrics
+
+
+def readBaseline(path):
+	"""Gets baseline of every metric as (value, slack)"""
+
+	with open(path) as file:
+		stored = json.load(file)
+
+	baseline = {}
+	for name, entry in stored.items():
+		if isinstance(entry, dict):
+			baseline[name] = (entry["value"], entry.get("slack", 0))
+		else:
+			baseline[name] = (entry, 0)
+	return baseline
+
+
+def update(capturePath, baselinePath):
+	"""Stores capture as baseline, keeping slack already set"""
+
+	metrics = readMetrics(capturePath)
+	if not metrics:
+		sys.exit("no metrics in %s" % capturePath)
+
+	try:
+		previous = readBaseline(baselinePath)
+	except FileNotFoundError:
+		previous = {}
+
+	stored = {}
+	for name in sorted(metrics):
+		slack = previous.get(name, (0, 0))[1]
+		stored[name] = {"value": metrics[name], "slack": slack} if slack else metrics[name]
+
+	with open(baselinePath, "w") as file:
+		json.dump(stored, file, indent=1, sort_keys=True)
+		file.write("\n")
+	print("stored %d metrics in %s" % (len(stored), baselinePath))
+
+
+def compare(capturePath, baselinePath, tolerance):
+	"""Prints every metric against baseline, returns whether none regressed"""
+
+	metrics = readMetrics(capturePath)
+	baseline = readBaseline(baselinePath)
+	passed = True
+
+	for name in sorted(set(metrics) | set(baseline)):
+		if name not in baseline:
+			print("%-28s %10d  new" % (name, metrics[name]))
+			continue
+		value, slack = baseline[name]
+		if name not in metrics:
+			print("%-28s %10s  MISSING (baseline %d)" % (name, "-", value))
+			passed = False
+			continue
+
+		limit = value * (1.0 + tolerance / 100.0) + slack
+		measured = metrics[name]
+		if measured > limit:
+			status = "REGRESSED"
+			passed = False
+		elif measured < value:
+			status = "improved"
+		else:
+			status = "ok"
+		print("%-28s %10d  %s (baseline %d, limit %d)" % (name, measured, status, value, int(limit)))
+
+	return passed
+
+
+def main(argv):
+
+	if len(argv) > 1 and argv[1] == "--update":
+		if len(argv) < 4:
+			sys.exit(__doc__)
+		update(argv[2], argv[3])
+		return
+
+	if len(argv) < 3:
+		sys.exit(__doc__)
+
+	tolerance = float(argv[3]) if len(argv) > 3 else DEFAULT_TOLERANCE
+	if not compare(argv[1], argv[2], tolerance):
+		sys.exit(1)
+
+
+if __name__ == "__main__":
+	main(sys.argv)
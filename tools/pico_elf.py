@@ -0,0 +1,126 @@
+#	pico_elf.py - ELF reading shared by host tools for Raspberry Pi Picos
+#	Copyright (C) 2025 Camren Chraplak
+#
+#	This program is free software: you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation, either version 3 of the License, or
+#	(at your option) any later version.
+#
+#	This program is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#
+#	You should have received a copy of the GNU General Public License
+#	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Minimal ELF32/ELF64 reader, only needs the standard library"""
+
+import struct
+import sys
+
+SHT_SYMTAB = 2
+STT_OBJECT = 1
+STT_FUNC = 2
+
+
+class Section:
+	"""ELF section header"""
+
+	def __init__(self, name, kind, address, offset, size, link):
+		self.name = name
+		self.kind = kind
+		self.address = address
+		self.offset = offset
+		self.size = size
+		self.link = link
+
+
+class Symbol:
+	"""ELF symbol"""
+
+	def __init__(self, name, value, size, kind, section):
+		self.name = name
+		self.value = value
+		self.size = size
+		self.kind = kind
+		self.section = section
+
+
+class Elf:
+	"""Sections and symbols of an ELF file"""
+
+	def __init__(self, path):
+
+		with open(path, "rb") as file:
+			self.data = file.read()
+
+		if self.data[:4] != b"\x7fELF":
+			sys.exit(path + " is not an ELF file")
+
+		self.path = path
+		self.is64 = self.data[4] == 2
+		self.endian = "<" if self.data[5] == 1 else ">"
+		self.sections = self.readSections()
+
+	def unpack(self, layout, offset):
+		return struct.unpack_from(self.endian + layout, self.data, offset)
+
+	def string(self, offset):
+		end = self.data.index(b"\0", offset)
+		return self.data[offset:end].decode(errors="replace")
+
+	def readSections(self):
+
+		if self.is64:
+			shoff, = self.unpack("Q", 0x28)
+			shentsize, shnum, shstrndx = self.unpack("HHH", 0x3A)
+		else:
+			shoff, = self.unpack("I", 0x20)
+			shentsize, shnum, shstrndx = self.unpack("HHH", 0x2E)
+
+		headers = []
+		for index in range(shnum):
+			base = shoff + index * shentsize
+			if self.is64:
+				name, kind = self.unpack("II", base)
+				address, offset, size = self.unpack("QQQ", base + 0x10)
+				link, = self.unpack("I", base + 0x28)
+			else:
+				name, kind = self.unpack("II", base)
+				address, offset, size, link = self.unpack("IIII", base + 0x0C)
+			headers.append((name, kind, address, offset, size, link))
+
+		names = headers[shstrndx][3]
+		return [Section(self.string(names + name), kind, address, offset, size, link)
+			for name, kind, address, offset, size, link in headers]
+
+	def section(self, name):
+		"""Gets section by name, None if missing"""
+		for section in self.sections:
+			if section.name == name:
+				return section
+		return None
+
+	def contents(self, section):
+		"""Gets bytes of section"""
+		return self.data[section.offset:section.offset + section.size]
+
+	def symbols(self):
+		"""Gets every symbol of symbol table"""
+
+		table = next((section for section in self.sections if section.kind == SHT_SYMTAB), None)
+		if table is None:
+			return []
+		strings = self.sections[table.link].offset
+
+		entry = 24 if self.is64 else 16
+		found = []
+		for base in range(table.offset, table.offset + table.size, entry):
+			if self.is64:
+				name, info, _, index, value, size = self.unpack("IBBHQQ", base)
+			else:
+				name, value, size, info, _, index = self.unpack("IIIBBH", base)
+			section = self.sections[index].name if 0 < index < len(self.sections) else ""
+			found.append(Symbol(self.string(strings + name), value, size, info & 0xF, section))
+		return found
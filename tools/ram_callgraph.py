@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+#	ram_callgraph.py - checks RAM placement of interrupt paths for Raspberry Pi Picos
+#	Copyright (C) 2025 Camren Chraplak
+#
+#	This program is free software: you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation, either version 3 of the License, or
+#	(at your option) any later version.
+#
+#	This program is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#
+#	You should have received a copy of the GNU General Public License
+#	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Walks the call graph from interrupt and flash write roots and flags every
+reachable function that runs from flash instead of RAM (RUN_IN_RAM)
+
+Works on a linked ELF or object files, calls through
+function pointers can't be followed so list their targets as roots
+
+Calls to static functions and compiler clones are relocated against their
+section, these are matched to the function at that offset
+
+Exits with 1 when a flash resident or unresolved function is reachable
+
+usage: ram_callgraph.py file.elf|file.o... [--root name] [--allow name]
+	[--objdump arm-none-eabi-objdump]
+"""
+
+import re
+import subprocess
+import sys
+
+# library functions that must not touch flash
+ROOTS = [
+	"traceTimerCallback",
+	"timerBatchCallback",
+	"timerOneShotCallback",
+	"perfTimerTick",
+	"serialDMAHandler",
+	"serialStartTransfer",
+	"hardDigitalWrite",
+	"nvmCommit",
+	"startThreadSafety",
+	"endThreadSafety",
+]
+
+# SDK functions that call into ROM, compiler helpers like __aeabi_uidiv
+# are walked like the rest since pico_divider only puts them in RAM
+# with PICO_DIVIDER_IN_RAM
+ALLOWED = {
+	"flash_range_erase",
+	"flash_range_program",
+	"__wrap___aeabi_memcpy",
+	"__wrap_memcpy",
+	"memcpy",
+	"__aeabi_memcpy",
+	"save_and_disable_interrupts",
+	"restore_interrupts",
+	# called while XIP is still on, before and after flash writes
+	"multicore_lockout_start_blocking",
+	"multicore_lockout_end_blocking",
+	# nvmCommit on core 1 queues to core 0 without touching flash
+	"add_alarm_in_us",
+	# Pico W LED is on the wireless chip, its driver can't move to RAM
+	"cyw43_arch_gpio_put",
+}
+
+RAM_SECTIONS = (".time_critical", ".data", ".ram", ".scratch_x", ".scratch_y")
+RAM_START = 0x20000000
+RAM_END = 0x22000000
+
+SECTION = re.compile(r"^Disassembly of section (\S+):")
+FUNCTION = re.compile(r"^([0-9a-f]+) <([^>]+)>:")
+INSTRUCTION = re.compile(r"^\s+[0-9a-f]+:\s+(?:[0-9a-f]{2,8} )+\s*([a-z][\w.]*)\s*(.*)$")
+TARGET = re.compile(r"<([^>+]+)(?:\+0x[0-9a-f]+)?>")
+RELOCATION = re.compile(r"^\s+[0-9a-f]+:\s+(R_\w+)\s+(\S+?)(?:([+-])0x([0-9a-f]+))?\s*$")
+CALLS = {"bl", "blx", "b", "b.n", "b.w", "call", "callq", "jmp", "jmpq"}
+CALL_RELOCATIONS = ("CALL", "JUMP", "PC24", "PLT32", "PC32")
+# x86 PC relative addends count from the end of the 4 byte field, ARM keeps
+# the addend in the instruction so objdump shows none
+PC_BIAS = {"R_X86_64_PC32": 4, "R_X86_64_PLT32": 4}
+
+
+def options(argv, flag):
+	"""Gets every value given after flag"""
+	return [argv[index + 1] for index in range(len(argv) - 1) if argv[index] == flag]
+
+
+def baseName(name):
+	"""Gets function name without compiler clone suffix like .constprop.0"""
+	return name.split(".", 1)[0] if not name.startswith(".") else name
+
+
+def resolve(starts, section, offset):
+	"""Gets function holding offset in section, None if there isn't one"""
+	found = None
+	for start, name in starts.get(section, []):
+		if start <= offset and (found is None or start >= found[0]):
+			found = (start, name)
+	return found[1] if found else None
+
+
+def parse(listing):
+	"""Gets {function: (in RAM, callees)} from objdump -dr output"""
+
+	functions = {}
+	starts = {}
+	relative = []
+	section = ""
+	current = None
+	pendingCall = False
+
+	for line in listing.splitlines():
+
+		match = SECTION.match(line)
+		if match:
+			section = match.group(1)
+			continue
+
+		match = FUNCTION.match(line)
+		if match:
+			address = int(match.group(1), 16)
+			name = match.group(2)
+			inRAM = section.startswith(RAM_SECTIONS) or RAM_START <= address < RAM_END
+			current = functions.setdefault(name, (inRAM, set()))
+			currentName = name
+			starts.setdefault(section, []).append((address, name))
+			continue
+
+		if current is None:
+			continue
+
+		match = RELOCATION.match(line)
+		if match:
+			# object files show call targets as relocations
+			kind, symbol, sign, addend = match.groups()
+			if pendingCall and kind.endswith(CALL_RELOCATIONS):
+				if symbol.startswith("."):
+					# section symbol, callee is found once every function is known
+					offset = int(addend or "0", 16) * (-1 if sign == "-" else 1) + PC_BIAS.get(kind, 0)
+					relative.append((currentName, current[1], symbol, offset))
+				elif symbol != currentName:
+					current[1].add(symbol)
+			pendingCall = False
+			continue
+
+		match = INSTRUCTION.match(line)
+		if match:
+			mnemonic, operands = match.groups()
+			pendingCall = mnemonic in CALLS
+			if pendingCall:
+				target = TARGET.search(operands)
+				# branches inside a function aren't calls
+				if target and target.group(1) != currentName and not target.group(1).startswith("."):
+					current[1].add(target.group(1))
+
+	for caller, callees, symbol, offset in relative:
+		callee = resolve(starts, symbol, offset)
+		if callee is None:
+			# kept so the walk reports it as unresolved
+			callees.add("%s+0x%x" % (symbol, offset))
+		elif callee != caller:
+			callees.add(callee)
+
+	return functions
+
+
+def main(argv):
+
+	files = [arg for index, arg in enumerate(argv[1:], 1) if not arg.startswith("--") and
+		argv[index - 1] not in ("--root", "--allow", "--objdump")]
+	if not files:
+		sys.exit(__doc__)
+
+	objdump = (options(argv, "--objdump") or ["arm-none-eabi-objdump"])[-1]
+	roots = options(argv, "--root") or ROOTS
+	allowed = ALLOWED | set(options(argv, "--allow"))
+
+	functions = {}
+	for path in files:
+		listing = subprocess.run([objdump, "-dr", path], check=True, capture_output=True, text=True).stdout
+		for name, (inRAM, callees) in parse(listing).items():
+			previous = functions.get(name)
+			if previous is None or not previous[1]:
+				functions[name] = (inRAM, callees)
+
+	failed = False
+	seen = set()
+	stack = [(root, [root]) for root in roots if root in functions]
+
+	for root in roots:
+		if root not in functions:
+			print("note: root %s not found" % root)
+
+	while stack:
+		name, path = stack.pop()
+		if name in seen:
+			continue
+		seen.add(name)
+
+		if name in allowed or baseName(name) in allowed:
+			continue
+		if name not in functions:
+			print("error: %s is not defined, can't check it" % " -> ".join(path), file=sys.stderr)
+			failed = True
+			continue
+
+		inRAM, callees = functions[name]
+		if not inRAM:
+			print("error: %s runs from flash" % " -> ".join(path), file=sys.stderr)
+			failed = True
+		for callee in sorted(callees):
+			stack.append((callee, path + [callee]))
+
+	sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+	main(sys.argv)
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+#	sram_layout.py - reports SRAM bank placement for Raspberry Pi Picos
+#	Copyright (C) 2025 Camren Chraplak
+#
+#	This program is free software: you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation, either version 3 of the License, or
+#	(at your option) any later version.
+#
+#	This program is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#
+#	You should have received a copy of the GNU General Public License
+#	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Lists which SRAM bank each large object landed in and checks that
+DMA buffers (SRAM_DMA) never share a bank with core 1 buffers (SRAM_CORE1),
+see board_pico_sram.h
+
+Exits with 1 when the check fails so it can run as a post build step
+
+usage: sram_layout.py firmware.elf [--min bytes] [--dma symbol] [--core1 symbol]
+"""
+
+import sys
+
+from pico_elf import Elf, STT_OBJECT
+
+STRIPED_BASE = 0x20000000
+STRIPED_SIZE = 0x40000
+SCRATCH_X_BASE = 0x20040000
+SCRATCH_Y_BASE = 0x20041000
+SCRATCH_SIZE = 0x1000
+BANK_BASE = 0x21000000
+BANK_SIZE = 0x10000
+MAIN_BANKS = 4
+
+DMA_SECTION = ".sram_dma"
+CORE1_SECTION = ".sram_core1"
+MIN_SIZE = 256
+
+
+def banks(address, size):
+	"""Gets names of banks object touches, empty if not in SRAM"""
+
+	end = address + max(size, 1)
+	if STRIPED_BASE <= address < STRIPED_BASE + STRIPED_SIZE:
+		# striping puts consecutive words in consecutive banks
+		if size >= 4 * MAIN_BANKS:
+			return {"SRAM%d" % bank for bank in range(MAIN_BANKS)}
+		return {"SRAM%d" % ((word >> 2) % MAIN_BANKS) for word in range(address & ~3, end, 4)}
+	if SCRATCH_X_BASE <= address < SCRATCH_X_BASE + SCRATCH_SIZE:
+		return {"SCRATCH_X"}
+	if SCRATCH_Y_BASE <= address < SCRATCH_Y_BASE + SCRATCH_SIZE:
+		return {"SCRATCH_Y"}
+	if BANK_BASE <= address < BANK_BASE + MAIN_BANKS * BANK_SIZE:
+		first = (address - BANK_BASE) // BANK_SIZE
+		last = (end - 1 - BANK_BASE) // BANK_SIZE
+		return {"SRAM%d" % bank for bank in range(first, min(last, MAIN_BANKS - 1) + 1)}
+	return set()
+
+
+def options(argv, flag):
+	"""Gets every value given after flag"""
+	return [argv[index + 1] for index in range(len(argv) - 1) if argv[index] == flag]
+
+
+def main(argv):
+
+	if len(argv) < 2:
+		sys.exit(__doc__)
+
+	minSize = int((options(argv, "--min") or [str(MIN_SIZE)])[-1], 0)
+	dmaNames = set(options(argv, "--dma"))
+	core1Names = set(options(argv, "--core1"))
+
+	objects = []
+	for symbol in Elf(argv[1]).symbols():
+		if symbol.kind != STT_OBJECT:
+			continue
+		placed = banks(symbol.value, symbol.size)
+		if placed:
+			objects.append((symbol, placed))
+
+	print("%-32s %-10s %8s  %-16s %s" % ("object", "address", "bytes", "section", "banks"))
+	for symbol, placed in sorted(objects, key=lambda item: -item[0].size):
+		if symbol.size >= minSize or symbol.section in (DMA_SECTION, CORE1_SECTION):
+			print("%-32s 0x%08x %8d  %-16s %s" % (symbol.name, symbol.value, symbol.size,
+				symbol.section, ",".join(sorted(placed))))
+
+	dma = [(s, p) for s, p in objects if s.section == DMA_SECTION or s.name in dmaNames]
+	core1 = [(s, p) for s, p in objects if s.section == CORE1_SECTION or s.name in core1Names]
+
+	failed = False
+	for dmaSymbol, dmaBanks in dma:
+		for core1Symbol, core1Banks in core1:
+			shared = dmaBanks & core1Banks
+			if shared:
+				print("error: DMA buffer %s shares %s with core 1 buffer %s" % (
+					dmaSymbol.name, ",".join(sorted(shared)), core1Symbol.name), file=sys.stderr)
+				failed = True
+
+	if not dma or not core1:
+		print("note: no SRAM_DMA or SRAM_CORE1 objects to check")
+	sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+	main(sys.argv)
@@ -0,0 +1,36 @@
+#	sram_layout_post.py - PlatformIO post build check of SRAM bank placement
+#	Copyright (C) 2025 Camren Chraplak
+#
+#	This program is free software: you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation, either version 3 of the License, or
+#	(at your option) any later version.
+#
+#	This program is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#
+#	You should have received a copy of the GNU General Public License
+#	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Runs sram_layout.py on the firmware ELF after every link, a DMA buffer
+sharing a bank with a core 1 buffer fails the build
+
+usage (platformio.ini): extra_scripts = post:path/to/lib_pico/tools/sram_layout_post.py
+	custom_sram_layout_flags = --dma name --core1 name (optional)
+"""
+
+import inspect
+import os
+
+Import("env")
+
+# SCons runs extra scripts without __file__
+TOOLS = os.path.dirname(os.path.abspath(inspect.getfile(lambda: None)))
+FLAGS = env.GetProjectOption("custom_sram_layout_flags", "")
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", env.VerboseAction(
+	'"$PYTHONEXE" "%s" $SOURCE %s' % (os.path.join(TOOLS, "sram_layout.py"), FLAGS),
+	"Checking SRAM banks of $SOURCE"))
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+#	trace_to_json.py - converts trace records from Raspberry Pi Picos
+#	Copyright (C) 2025 Camren Chraplak
+#
+#	This program is free software: you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation, either version 3 of the License, or
+#	(at your option) any later version.
+#
+#	This program is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#
+#	You should have received a copy of the GNU General Public License
+#	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Turns FRAME_TRACE frames (see board_pico_trace.h) into Chrome trace JSON,
+open the output in chrome://tracing or ui.perfetto.dev
+
+Event names come from enum TraceEvent, sketch events can be named
+with a file of "id name" lines
+
+usage: trace_to_json.py capture.bin trace.json|- [names.txt]
+"""
+
+import json
+import struct
+import sys
+
+from log_decode import frames
+
+FRAME_TRACE = 4
+TRACE_TIMER = 0
+TRACE_TIMER_LAST = 31
+TRACE_NAMES = {
+	32: "nvmCommit",
+	33: "threadSafety",
+}
+TRACE_PHASES = {0: "B", 1: "E"}
+TIME_WRAP = 1 << 32
+
+
+def eventName(names, event):
+	"""Gets display name of event ID"""
+
+	if event in names:
+		return names[event]
+	if TRACE_TIMER <= event <= TRACE_TIMER_LAST:
+		return "timer %d" % (event - TRACE_TIMER)
+	return TRACE_NAMES.get(event, "event %d" % event)
+
+
+def readNames(path):
+	"""Gets sketch event names"""
+
+	names = {}
+	with open(path) as file:
+		for line in file:
+			parts = line.split(None, 1)
+			if len(parts) == 2 and not parts[0].startswith("#"):
+				names[int(parts[0], 0)] = parts[1].strip()
+	return names
+
+
+def convert(stream, names):
+	"""Gets Chrome trace events of every record"""
+
+	events = []
+	last = {}
+	for _, payload in frames(stream, FRAME_TRACE):
+		for offset in range(0, len(payload) - 7, 8):
+			time, word = struct.unpack_from("<II", payload, offset)
+			event = word & 0xFFFF
+			core = (word >> 16) & 0xFF
+			phase = TRACE_PHASES.get(word >> 24)
+			if phase is None:
+				continue
+
+			# time_us_32 wraps every 71 minutes
+			previous = last.get(core)
+			if previous is not None:
+				while time < previous:
+					time += TIME_WRAP
+			last[core] = time
+
+			events.append({
+				"name": eventName(names, event),
+				"ph": phase,
+				"ts": time,
+				"pid": 0,
+				"tid": core,
+			})
+
+	for core in sorted(last):
+		events.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": core, "args": {"name": "core %d" % core}})
+	return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+
+def main(argv):
+
+	if len(argv) < 3:
+		sys.exit(__doc__)
+
+	names = readNames(argv[3]) if len(argv) > 3 else {}
+	with open(argv[1], "rb") as file:
+		trace = convert(file.read(), names)
+	if argv[2] == "-":
+		json.dump(trace, sys.stdout, indent=1)
+		return
+	with open(argv[2], "w") as file:
+		json.dump(trace, file, indent=1)
+
+
+if __name__ == "__main__":
+	main(sys.argv)